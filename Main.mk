@@ -6,7 +6,7 @@ endif
 GENERIC_CXXFLAGS+=-I$(NNFORGE_PATH)
 LDLIBSDEPEND+=-lnnforge_plain -lnnforge
 VPATH+=$(NNFORGE_PATH)/lib
-LDFLAGS+=-L$(NNFORGE_PATH)/lib
+LDFLAGS+=-L$(NNFORGE_PATH)/lib $(ZLIB_LIBS)
 endif
 
 ifeq ($(USE_BOOST),yes)
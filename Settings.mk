@@ -14,7 +14,8 @@ NNFORGE_PATH=../..
 NNFORGE_INPUT_DATA_PATH=/home/max/nnforge/input_data
 NNFORGE_WORKING_DATA_PATH=/home/max/nnforge/working_data
 
-BOOST_LIBS=-lboost_thread -lboost_regex -lboost_chrono -lboost_filesystem -lboost_program_options -lboost_random -lboost_system -lboost_date_time
+BOOST_LIBS=-lboost_thread -lboost_regex -lboost_chrono -lboost_filesystem -lboost_program_options -lboost_random -lboost_system -lboost_date_time -lboost_iostreams
+ZLIB_LIBS=-lz
 OPENCV_LIBS=-lopencv_highgui -lopencv_imgproc -lopencv_core
 NETCDF_LIBS=-lnetcdf
 MATIO_LIBS=-lmatio
@@ -61,11 +61,18 @@ void gtsrb_toolset::prepare_training_data()
 		output_configuration.feature_map_count = class_count;
 		output_configuration.dimension_sizes.push_back(1);
 		output_configuration.dimension_sizes.push_back(1);
-		nnforge::supervised_data_stream_writer writer(
+		nnforge::data_writer_smart_ptr stream_writer(new nnforge::supervised_data_stream_writer(
 			file_with_data,
 			input_configuration,
-			output_configuration);
+			output_configuration,
+			nnforge::neuron_data_type::type_byte));
+		nnforge::supervised_parallel_data_writer writer(
+			stream_writer,
+			input_configuration,
+			output_configuration,
+			nnforge::neuron_data_type::type_byte);
 
+		unsigned int sequence_id = 0;
 		for(unsigned int folder_id = 0; folder_id < class_count; ++folder_id)
 		{
 			boost::filesystem::path subfolder_name = boost::filesystem::path("Final_Training") / "Images" / (boost::format("%|1$05d|") % folder_id).str();
@@ -73,10 +80,13 @@ void gtsrb_toolset::prepare_training_data()
 
 			write_folder(
 				writer,
+				sequence_id,
 				subfolder_name,
 				annotation_file_name.c_str(),
 				true);
 		}
+
+		writer.finish();
 	}
 	
 	{
@@ -92,24 +102,35 @@ void gtsrb_toolset::prepare_training_data()
 		output_configuration.feature_map_count = class_count;
 		output_configuration.dimension_sizes.push_back(1);
 		output_configuration.dimension_sizes.push_back(1);
-		nnforge::supervised_data_stream_writer writer(
+		nnforge::data_writer_smart_ptr stream_writer(new nnforge::supervised_data_stream_writer(
 			file_with_data,
 			input_configuration,
-			output_configuration);
+			output_configuration,
+			nnforge::neuron_data_type::type_byte));
+		nnforge::supervised_parallel_data_writer writer(
+			stream_writer,
+			input_configuration,
+			output_configuration,
+			nnforge::neuron_data_type::type_byte);
 
 		boost::filesystem::path subfolder_name = boost::filesystem::path("Final_Test") / "Images";
 		std::string annotation_file_name = "GT-final_test.csv";
 
+		unsigned int sequence_id = 0;
 		write_folder(
 			writer,
+			sequence_id,
 			subfolder_name,
 			annotation_file_name.c_str(),
 			false);
+
+		writer.finish();
 	}
 }
 
 void gtsrb_toolset::write_folder(
-	nnforge::supervised_data_stream_writer& writer,
+	nnforge::supervised_parallel_data_writer& writer,
+	unsigned int& sequence_id,
 	const boost::filesystem::path& relative_subfolder_path,
 	const char * annotation_file_name,
 	bool jitter)
@@ -128,6 +149,8 @@ void gtsrb_toolset::write_folder(
 	nnforge_uniform_real_distribution<float> contrast_distribution(1.0F / max_contrast_factor, max_contrast_factor);
 	nnforge_uniform_real_distribution<float> brightness_shift_distribution(-max_brightness_shift, max_brightness_shift);
 
+	// Random parameters are drawn here, so the output doesn't depend on the number of threads
+	std::vector<entry_to_write> entry_list;
 	std::string str;
 	std::getline(file_input, str); // read the header
 	unsigned int entry_read_count = 0;
@@ -153,51 +176,84 @@ void gtsrb_toolset::write_folder(
 		unsigned int bottom_right_y = static_cast<unsigned int>(strtol(strs[6].c_str(), &end, 10));
 		unsigned int class_id = static_cast<unsigned int>(strtol(strs[7].c_str(), &end, 10));
 
+		entry_to_write entry;
+		entry.absolute_file_path = absolute_file_path;
+		entry.class_id = class_id;
+		entry.roi_top_left_x = top_left_x;
+		entry.roi_top_left_y = top_left_y;
+		entry.roi_bottom_right_x = bottom_right_x;
+		entry.roi_bottom_right_y = bottom_right_y;
+		entry.rotation_angle_in_degrees = 0.0F;
+		entry.scale_factor = 1.0F;
+		entry.shift_x = 0.0F;
+		entry.shift_y = 0.0F;
+		entry.contrast = 1.0F;
+		entry.brightness_shift = 0.0F;
+
 		if (jitter)
 		{
 			for(int i = 0; i < random_sample_count; ++i)
 			{
-				float rotation_angle = rotate_angle_distribution(generator);
-				float scale = scale_distribution(generator);
-				float shift_x = shift_distribution(generator);
-				float shift_y = shift_distribution(generator);
-				float contrast = contrast_distribution(generator);
-				float brightness_shift = brightness_shift_distribution(generator);
-				write_single_entry(
-					writer,
-					absolute_file_path,
-					class_id,
-					top_left_x,
-					top_left_y,
-					bottom_right_x,
-					bottom_right_y,
-					rotation_angle,
-					scale,
-					shift_x,
-					shift_y,
-					contrast,
-					brightness_shift);
+				entry.rotation_angle_in_degrees = rotate_angle_distribution(generator);
+				entry.scale_factor = scale_distribution(generator);
+				entry.shift_x = shift_distribution(generator);
+				entry.shift_y = shift_distribution(generator);
+				entry.contrast = contrast_distribution(generator);
+				entry.brightness_shift = brightness_shift_distribution(generator);
+				entry_list.push_back(entry);
 			}
 		}
 		else
 		{
-			write_single_entry(
-				writer,
-				absolute_file_path,
-				class_id,
-				top_left_x,
-				top_left_y,
-				bottom_right_x,
-				bottom_right_y);
+			entry_list.push_back(entry);
 		}
 	}
 
 	if (entry_read_count == 0)
 		throw std::runtime_error((boost::format("No entries with class ID encountered in %1%") % annotation_file_path.string()).str());
+
+	std::string error;
+	#pragma omp parallel for schedule(dynamic)
+	for(int i = 0; i < static_cast<int>(entry_list.size()); ++i)
+	{
+		try
+		{
+			const entry_to_write& entry = entry_list[i];
+			write_single_entry(
+				writer,
+				sequence_id + i,
+				entry.absolute_file_path,
+				entry.class_id,
+				entry.roi_top_left_x,
+				entry.roi_top_left_y,
+				entry.roi_bottom_right_x,
+				entry.roi_bottom_right_y,
+				entry.rotation_angle_in_degrees,
+				entry.scale_factor,
+				entry.shift_x,
+				entry.shift_y,
+				entry.contrast,
+				entry.brightness_shift);
+		}
+		catch (const std::exception& e)
+		{
+			writer.abort(e.what());
+			#pragma omp critical
+			{
+				if (error.empty())
+					error = e.what();
+			}
+		}
+	}
+	if (!error.empty())
+		throw std::runtime_error(error);
+
+	sequence_id += static_cast<unsigned int>(entry_list.size());
 }
 
 void gtsrb_toolset::write_single_entry(
-		nnforge::supervised_data_stream_writer& writer,
+		nnforge::supervised_parallel_data_writer& writer,
+		unsigned int sequence_id,
 		const boost::filesystem::path& absolute_file_path,
 		unsigned int class_id,
 		unsigned int roi_top_left_x,
@@ -272,7 +328,7 @@ void gtsrb_toolset::write_single_entry(
 	std::vector<float> output(class_count, -1.0F);
 	output[class_id] = 1.0F;
 
-	writer.write(&(*inp.begin()), &(*output.begin()));
+	writer.write(sequence_id, &(*inp.begin()), &(*output.begin()));
 }
 
 std::map<unsigned int, float> gtsrb_toolset::get_dropout_rate_map() const
@@ -51,7 +51,8 @@ protected:
 	virtual void prepare_training_data();
 
 	void write_single_entry(
-		nnforge::supervised_data_stream_writer& writer,
+		nnforge::supervised_parallel_data_writer& writer,
+		unsigned int sequence_id,
 		const boost::filesystem::path& absolute_file_path,
 		unsigned int class_id,
 		unsigned int roi_top_left_x,
@@ -65,8 +66,10 @@ protected:
 		float contrast = 1.0F,
 		float brightness_shift = 0.0F);
 
+	// Entries are decoded and written in parallel, sequence_id is the sequence number of the first entry and is advanced past the last one
 	void write_folder(
-		nnforge::supervised_data_stream_writer& writer,
+		nnforge::supervised_parallel_data_writer& writer,
+		unsigned int& sequence_id,
 		const boost::filesystem::path& relative_subfolder_path,
 		const char * annotation_file_name,
 		bool jitter);
@@ -82,4 +85,21 @@ protected:
 	static const float max_contrast_factor;
 	static const float max_brightness_shift;
 	static const unsigned int random_sample_count;
+
+private:
+	struct entry_to_write
+	{
+		boost::filesystem::path absolute_file_path;
+		unsigned int class_id;
+		unsigned int roi_top_left_x;
+		unsigned int roi_top_left_y;
+		unsigned int roi_bottom_right_x;
+		unsigned int roi_bottom_right_y;
+		float rotation_angle_in_degrees;
+		float scale_factor;
+		float shift_x;
+		float shift_y;
+		float contrast;
+		float brightness_shift;
+	};
 };
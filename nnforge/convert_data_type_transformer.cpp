@@ -61,4 +61,14 @@ namespace nnforge
 	{
 		return neuron_data_type::type_float;
 	}
+
+	nnforge_shared_ptr<data_transformer> convert_data_type_transformer::clone(unsigned int seed) const
+	{
+		return nnforge_shared_ptr<data_transformer>(new convert_data_type_transformer(*this));
+	}
+
+	std::string convert_data_type_transformer::get_cache_key() const
+	{
+		return "convert_data_type";
+	}
 }
@@ -38,6 +38,10 @@ namespace nnforge
 
 		virtual bool is_deterministic() const;
 
+		virtual nnforge_shared_ptr<data_transformer> clone(unsigned int seed) const;
+
+		virtual std::string get_cache_key() const;
+
 		virtual bool is_in_place() const;
 
 		virtual neuron_data_type::input_type get_transformed_data_type(neuron_data_type::input_type original_data_type) const;
@@ -0,0 +1,142 @@
+/*
+ *  Copyright 2011-2014 Maxim Milakov
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include "data_reader_async_prefetcher.h"
+
+#include "neural_network_exception.h"
+
+#include <boost/bind.hpp>
+#include <boost/format.hpp>
+
+namespace nnforge
+{
+	data_reader_async_prefetcher::data_reader_async_prefetcher(
+		supervised_data_reader& reader,
+		unsigned int max_entry_count)
+		: reader(reader)
+		, supervised_reader(&reader)
+		, max_entry_count(max_entry_count)
+		, input_neuron_count(reader.get_input_configuration().get_neuron_count())
+		, output_neuron_count(reader.get_output_configuration().get_neuron_count())
+		, input_neuron_elem_size(reader.get_input_neuron_elem_size())
+		, front_buffer_id(0)
+		, entries_to_read_count(0)
+		, entries_read_count(0)
+	{
+		for(unsigned int i = 0; i < 2; ++i)
+		{
+			input_buffer_list[i].resize(max_entry_count * input_neuron_count * input_neuron_elem_size);
+			output_buffer_list[i].resize(max_entry_count * output_neuron_count);
+		}
+	}
+
+	data_reader_async_prefetcher::data_reader_async_prefetcher(
+		unsupervised_data_reader& reader,
+		unsigned int max_entry_count)
+		: reader(reader)
+		, supervised_reader(0)
+		, max_entry_count(max_entry_count)
+		, input_neuron_count(reader.get_input_configuration().get_neuron_count())
+		, output_neuron_count(0)
+		, input_neuron_elem_size(reader.get_input_neuron_elem_size())
+		, front_buffer_id(0)
+		, entries_to_read_count(0)
+		, entries_read_count(0)
+	{
+		for(unsigned int i = 0; i < 2; ++i)
+			input_buffer_list[i].resize(max_entry_count * input_neuron_count * input_neuron_elem_size);
+	}
+
+	data_reader_async_prefetcher::~data_reader_async_prefetcher()
+	{
+		join();
+	}
+
+	void data_reader_async_prefetcher::start(unsigned int entry_count)
+	{
+		if (reading_thread)
+			throw neural_network_exception("Previous read is not waited for in data_reader_async_prefetcher");
+		if (entry_count > max_entry_count)
+			throw neural_network_exception((boost::format("Unable to prefetch %1% entries, buffers are allocated for %2% entries") % entry_count % max_entry_count).str());
+
+		entries_to_read_count = entry_count;
+		entries_read_count = 0;
+		error.clear();
+		reading_thread = nnforge_shared_ptr<boost::thread>(new boost::thread(boost::bind(&data_reader_async_prefetcher::read_entries, this)));
+	}
+
+	unsigned int data_reader_async_prefetcher::wait()
+	{
+		if (!reading_thread)
+			throw neural_network_exception("No read is started in data_reader_async_prefetcher");
+
+		join();
+
+		if (!error.empty())
+			throw neural_network_exception(error);
+
+		front_buffer_id = 1 - front_buffer_id;
+
+		return entries_read_count;
+	}
+
+	const std::vector<unsigned char>& data_reader_async_prefetcher::get_input_buffer() const
+	{
+		return input_buffer_list[front_buffer_id];
+	}
+
+	const std::vector<float>& data_reader_async_prefetcher::get_output_buffer() const
+	{
+		return output_buffer_list[front_buffer_id];
+	}
+
+	size_t data_reader_async_prefetcher::get_buffers_size() const
+	{
+		return (input_buffer_list[0].size() + output_buffer_list[0].size() * sizeof(float)) * 2;
+	}
+
+	void data_reader_async_prefetcher::read_entries()
+	{
+		const unsigned int back_buffer_id = 1 - front_buffer_id;
+		try
+		{
+			if (entries_to_read_count > 0)
+			{
+				void * input_elems = &(*input_buffer_list[back_buffer_id].begin());
+				if (supervised_reader)
+					entries_read_count = supervised_reader->read_batch(
+						entries_to_read_count,
+						input_elems,
+						&(*output_buffer_list[back_buffer_id].begin()));
+				else
+					entries_read_count = reader.read_batch(entries_to_read_count, input_elems);
+			}
+		}
+		catch (const std::exception& e)
+		{
+			error = e.what();
+		}
+	}
+
+	void data_reader_async_prefetcher::join()
+	{
+		if (reading_thread)
+		{
+			reading_thread->join();
+			reading_thread.reset();
+		}
+	}
+}
@@ -0,0 +1,86 @@
+/*
+ *  Copyright 2011-2014 Maxim Milakov
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#pragma once
+
+#include "supervised_data_reader.h"
+#include "unsupervised_data_reader.h"
+#include "nn_types.h"
+
+#include <vector>
+#include <string>
+#include <boost/thread/thread.hpp>
+
+namespace nnforge
+{
+	// Reads entries on a background thread into the back buffers while the caller processes the front ones.
+	// The reader should not be used by the caller between start and wait
+	class data_reader_async_prefetcher
+	{
+	public:
+		// Both input and output buffers are filled
+		data_reader_async_prefetcher(
+			supervised_data_reader& reader,
+			unsigned int max_entry_count);
+
+		// Only input buffers are filled
+		data_reader_async_prefetcher(
+			unsupervised_data_reader& reader,
+			unsigned int max_entry_count);
+
+		// Waits for the pending read, if any
+		~data_reader_async_prefetcher();
+
+		// Starts reading up to entry_count entries into the back buffers
+		void start(unsigned int entry_count);
+
+		// Waits for the read started by start, makes the filled buffers front ones and returns the number of entries read.
+		// Rethrows the error the reader thread encountered
+		unsigned int wait();
+
+		const std::vector<unsigned char>& get_input_buffer() const;
+
+		const std::vector<float>& get_output_buffer() const;
+
+		// Size of all the buffers allocated
+		size_t get_buffers_size() const;
+
+	private:
+		void read_entries();
+
+		void join();
+
+		unsupervised_data_reader& reader;
+		supervised_data_reader * supervised_reader;
+		unsigned int max_entry_count;
+		unsigned int input_neuron_count;
+		unsigned int output_neuron_count;
+		size_t input_neuron_elem_size;
+
+		std::vector<unsigned char> input_buffer_list[2];
+		std::vector<float> output_buffer_list[2];
+		unsigned int front_buffer_id;
+
+		unsigned int entries_to_read_count;
+		unsigned int entries_read_count;
+		std::string error;
+		nnforge_shared_ptr<boost::thread> reading_thread;
+
+	private:
+		data_reader_async_prefetcher(const data_reader_async_prefetcher&);
+		data_reader_async_prefetcher& operator =(const data_reader_async_prefetcher&);
+	};
+}
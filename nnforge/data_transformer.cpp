@@ -22,6 +22,10 @@ namespace nnforge
 	{
 	}
 
+	data_transformer::data_transformer(const data_transformer&)
+	{
+	}
+
 	data_transformer::~data_transformer()
 	{
 	}
@@ -49,4 +53,14 @@ namespace nnforge
 	{
 		return original_data_type;
 	}
+
+	nnforge_shared_ptr<data_transformer> data_transformer::clone(unsigned int seed) const
+	{
+		return nnforge_shared_ptr<data_transformer>();
+	}
+
+	std::string data_transformer::get_cache_key() const
+	{
+		return std::string();
+	}
 }
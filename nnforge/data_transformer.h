@@ -20,6 +20,8 @@
 #include "neuron_data_type.h"
 #include "nn_types.h"
 
+#include <string>
+
 namespace nnforge
 {
 	class data_transformer
@@ -46,11 +48,20 @@ namespace nnforge
 
 		virtual neuron_data_type::input_type get_transformed_data_type(neuron_data_type::input_type original_data_type) const;
 
+		// Returns the copy to be used on another thread, the random generator of the copy, if any, is seeded with seed.
+		// Returns empty pointer if the transformer cannot be copied
+		virtual nnforge_shared_ptr<data_transformer> clone(unsigned int seed) const;
+
+		// Returns the string identifying the transformer and its parameters, transformers with equal keys transform data identically.
+		// Empty string means the output of the transformer should not be cached, which is the default
+		virtual std::string get_cache_key() const;
+
 	protected:
 		data_transformer();
 
-	private:
 		data_transformer(const data_transformer&);
+
+	private:
 		data_transformer& operator =(const data_transformer&);
 	};
 
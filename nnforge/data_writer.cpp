@@ -14,13 +14,21 @@
  *  limitations under the License.
  */
 
+
 #include "data_writer.h"
 
 #include "rnd.h"
 #include "neural_network_exception.h"
 
+#include <algorithm>
+#include <cstring>
+#include <boost/filesystem/fstream.hpp>
+#include <boost/format.hpp>
+
 namespace nnforge
 {
+	const float data_writer::default_max_memory_megabytes = 1024.0F;
+
 	data_writer::data_writer()
 	{
 	}
@@ -29,7 +37,20 @@ namespace nnforge
 	{
 	}
 
-	void data_writer::write_randomized(unsupervised_data_reader& reader)
+	void data_writer::raw_write_batch(
+		const void * all_entry_data,
+		size_t entry_size,
+		unsigned int entry_count)
+	{
+		const unsigned char * data = static_cast<const unsigned char *>(all_entry_data);
+		for(unsigned int entry_id = 0; entry_id < entry_count; ++entry_id)
+			raw_write(data + entry_id * entry_size, entry_size);
+	}
+
+	void data_writer::write_randomized(
+		unsupervised_data_reader& reader,
+		float max_memory_megabytes,
+		const boost::filesystem::path& temp_folder)
 	{
 		unsigned int entry_count = reader.get_entry_count();
 		if (entry_count == 0)
@@ -43,7 +64,8 @@ namespace nnforge
 			entry_to_write_list[i] = i;
 		}
 
-		std::vector<unsigned char> entry_data;
+		std::vector<unsigned int> entry_positions(entry_count);
+		unsigned int position = 0;
 
 		for(unsigned int entry_to_write_count = entry_count; entry_to_write_count > 0; --entry_to_write_count)
 		{
@@ -52,16 +74,20 @@ namespace nnforge
 			unsigned int index = dist(rnd);
 			unsigned int entry_id = entry_to_write_list[index];
 
-			reader.rewind(entry_id);
-			reader.raw_read(entry_data);
-			raw_write(&(*entry_data.begin()), entry_data.size());
+			entry_positions[entry_id] = position;
+			++position;
 
 			unsigned int leftover_entry_id = entry_to_write_list[entry_to_write_count - 1];
 			entry_to_write_list[index] = leftover_entry_id;
 		}
+
+		write_permuted(reader, entry_positions, max_memory_megabytes, temp_folder);
 	}
 
-	void data_writer::write_randomized_classifier(supervised_data_reader& reader)
+	void data_writer::write_randomized_classifier(
+		supervised_data_reader& reader,
+		float max_memory_megabytes,
+		const boost::filesystem::path& temp_folder)
 	{
 		unsigned int entry_count = reader.get_entry_count();
 		if (entry_count == 0)
@@ -69,10 +95,12 @@ namespace nnforge
 
 		random_generator rnd = rnd::get_random_generator();
 
+		reader.reset();
 		std::vector<randomized_classifier_keeper> class_buckets_entry_id_lists;
 		reader.fill_class_buckets_entry_id_lists(class_buckets_entry_id_lists);
 
-		std::vector<unsigned char> entry_data;
+		std::vector<unsigned int> entry_positions(entry_count);
+		unsigned int position = 0;
 
 		for(unsigned int entry_to_write_count = entry_count; entry_to_write_count > 0; --entry_to_write_count)
 		{
@@ -93,9 +121,123 @@ namespace nnforge
 
 			unsigned int entry_id = bucket_it->peek_random(rnd);
 
-			reader.rewind(entry_id);
-			reader.raw_read(entry_data);
-			raw_write(&(*entry_data.begin()), entry_data.size());
+			entry_positions[entry_id] = position;
+			++position;
+		}
+
+		write_permuted(reader, entry_positions, max_memory_megabytes, temp_folder);
+	}
+
+	void data_writer::write_permuted(
+		unsupervised_data_reader& reader,
+		const std::vector<unsigned int>& entry_positions,
+		float max_memory_megabytes,
+		const boost::filesystem::path& temp_folder)
+	{
+		const unsigned int entry_count = static_cast<unsigned int>(entry_positions.size());
+
+		reader.reset();
+
+		// Entries are taken from the reader's memory if it allows it, otherwise the first one is read to find out the entry size
+		std::vector<unsigned char> entry_data;
+		size_t entry_size;
+		const unsigned char * borrowed_entries = reader.borrow_raw_entries(0, entry_count, entry_size);
+		if (!borrowed_entries)
+		{
+			if (!reader.raw_read(entry_data))
+				throw neural_network_exception("Unable to read the first entry to shuffle");
+			entry_size = entry_data.size();
+		}
+
+		size_t max_memory_size = static_cast<size_t>(max_memory_megabytes * static_cast<float>(1 << 20));
+		const unsigned int bucket_entry_count = static_cast<unsigned int>(std::max<size_t>(std::min<size_t>(max_memory_size / entry_size, entry_count), 1));
+		const unsigned int bucket_count = (entry_count + bucket_entry_count - 1) / bucket_entry_count;
+
+		std::vector<boost::filesystem::path> bucket_file_path_list;
+		if (bucket_count > 1)
+		{
+			boost::filesystem::path folder = temp_folder.empty() ? boost::filesystem::temp_directory_path() : temp_folder;
+			std::string bucket_file_name_prefix = boost::filesystem::unique_path("shuffle_%%%%-%%%%-%%%%").string();
+			for(unsigned int bucket_id = 0; bucket_id < bucket_count; ++bucket_id)
+				bucket_file_path_list.push_back(folder / (boost::format("%1%_%2%.tmp") % bucket_file_name_prefix % bucket_id).str());
+		}
+
+		try
+		{
+			std::vector<unsigned char> bucket_data(entry_size * bucket_entry_count);
+
+			// Entries are placed straight to their positions in memory if there is a single bucket,
+			// otherwise they are scattered to bucket files, each preceded by its position
+			{
+				std::vector<nnforge_shared_ptr<boost::filesystem::ofstream> > bucket_file_list;
+				for(std::vector<boost::filesystem::path>::const_iterator it = bucket_file_path_list.begin(); it != bucket_file_path_list.end(); ++it)
+				{
+					nnforge_shared_ptr<boost::filesystem::ofstream> bucket_file(new boost::filesystem::ofstream(*it, std::ios_base::out | std::ios_base::binary | std::ios_base::trunc));
+					bucket_file->exceptions(std::ostream::eofbit | std::ostream::failbit | std::ostream::badbit);
+					bucket_file_list.push_back(bucket_file);
+				}
+
+				for(unsigned int entry_id = 0; entry_id < entry_count; ++entry_id)
+				{
+					const unsigned char * entry;
+					if (borrowed_entries)
+						entry = borrowed_entries + entry_size * entry_id;
+					else
+					{
+						if ((entry_id > 0) && ((!reader.raw_read(entry_data)) || (entry_data.size() != entry_size)))
+							throw neural_network_exception((boost::format("Unable to read entry %1% of %2% bytes to shuffle") % entry_id % entry_size).str());
+						entry = &(*entry_data.begin());
+					}
+
+					unsigned int position = entry_positions[entry_id];
+					if (bucket_count == 1)
+						memcpy(&(*(bucket_data.begin() + entry_size * position)), entry, entry_size);
+					else
+					{
+						boost::filesystem::ofstream& bucket_file = *bucket_file_list[position / bucket_entry_count];
+						bucket_file.write(reinterpret_cast<const char *>(&position), sizeof(position));
+						bucket_file.write(reinterpret_cast<const char *>(entry), entry_size);
+					}
+				}
+			}
+
+			if (bucket_count == 1)
+			{
+				for(unsigned int position = 0; position < entry_count; ++position)
+					raw_write(&(*(bucket_data.begin() + entry_size * position)), entry_size);
+				return;
+			}
+
+			// Reorder each bucket in memory and write it
+			for(unsigned int bucket_id = 0; bucket_id < bucket_count; ++bucket_id)
+			{
+				const unsigned int base_position = bucket_id * bucket_entry_count;
+				const unsigned int current_bucket_entry_count = std::min(bucket_entry_count, entry_count - base_position);
+
+				{
+					boost::filesystem::ifstream bucket_file(bucket_file_path_list[bucket_id], std::ios_base::in | std::ios_base::binary);
+					bucket_file.exceptions(std::ostream::eofbit | std::ostream::failbit | std::ostream::badbit);
+					for(unsigned int i = 0; i < current_bucket_entry_count; ++i)
+					{
+						unsigned int position;
+						bucket_file.read(reinterpret_cast<char *>(&position), sizeof(position));
+						bucket_file.read(reinterpret_cast<char *>(&(*(bucket_data.begin() + entry_size * (position - base_position)))), entry_size);
+					}
+				}
+				boost::filesystem::remove(bucket_file_path_list[bucket_id]);
+
+				for(unsigned int i = 0; i < current_bucket_entry_count; ++i)
+					raw_write(&(*(bucket_data.begin() + entry_size * i)), entry_size);
+			}
+		}
+		catch (...)
+		{
+			for(std::vector<boost::filesystem::path>::const_iterator it = bucket_file_path_list.begin(); it != bucket_file_path_list.end(); ++it)
+			{
+				boost::system::error_code ec;
+				boost::filesystem::remove(*it, ec);
+			}
+			throw;
 		}
 	}
 }
@@ -14,11 +14,15 @@
  *  limitations under the License.
  */
 
+
 #pragma once
 
 #include "unsupervised_data_reader.h"
 #include "supervised_data_reader.h"
 
+#include <vector>
+#include <boost/filesystem.hpp>
+
 namespace nnforge
 {
 	class data_writer
@@ -30,12 +34,39 @@ namespace nnforge
 			const void * all_entry_data,
 			size_t data_length) = 0;
 
-		void write_randomized(unsupervised_data_reader& reader);
+		// Writes entry_count entries of entry_size bytes each stored contiguously in raw_write layout
+		// The default implementation calls raw_write for each entry, writers should override it when they can do it cheaper
+		virtual void raw_write_batch(
+			const void * all_entry_data,
+			size_t entry_size,
+			unsigned int entry_count);
+
+		// Entries are shuffled reading the reader sequentially once, see write_permuted
+		void write_randomized(
+			unsupervised_data_reader& reader,
+			float max_memory_megabytes = default_max_memory_megabytes,
+			const boost::filesystem::path& temp_folder = boost::filesystem::path());
+
+		// Classes are spread evenly in the output, entries of each class are shuffled
+		void write_randomized_classifier(
+			supervised_data_reader& reader,
+			float max_memory_megabytes = default_max_memory_megabytes,
+			const boost::filesystem::path& temp_folder = boost::filesystem::path());
 
-		void write_randomized_classifier(supervised_data_reader& reader);
+		static const float default_max_memory_megabytes;
 
 	protected:
 		data_writer();
+
+		// Writes entry entry_id of the reader at position entry_positions[entry_id], reading the reader sequentially once.
+		// Entries are scattered by their positions to bucket files in temp_folder, each bucket fitting into max_memory_megabytes,
+		// then each bucket is loaded, reordered and written. No files are created if all the entries fit into memory.
+		// The system temporary folder is used if temp_folder is empty
+		void write_permuted(
+			unsupervised_data_reader& reader,
+			const std::vector<unsigned int>& entry_positions,
+			float max_memory_megabytes,
+			const boost::filesystem::path& temp_folder);
 	};
 
 	typedef nnforge_shared_ptr<data_writer> data_writer_smart_ptr;
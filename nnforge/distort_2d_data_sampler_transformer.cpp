@@ -106,4 +106,9 @@ namespace nnforge
 	{
 		return true;
 	}
+
+	nnforge_shared_ptr<data_transformer> distort_2d_data_sampler_transformer::clone(unsigned int seed) const
+	{
+		return nnforge_shared_ptr<data_transformer>(new distort_2d_data_sampler_transformer(*this));
+	}
 }
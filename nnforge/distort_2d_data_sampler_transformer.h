@@ -56,6 +56,8 @@ namespace nnforge
 
 		virtual bool is_deterministic() const;
 
+		virtual nnforge_shared_ptr<data_transformer> clone(unsigned int seed) const;
+
 	protected:
 		std::vector<distort_2d_data_sampler_param> params;
 	};
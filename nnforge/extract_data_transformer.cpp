@@ -136,4 +136,20 @@ namespace nnforge
 	{
 		return true;
 	}
+
+	nnforge_shared_ptr<data_transformer> extract_data_transformer::clone(unsigned int seed) const
+	{
+		return nnforge_shared_ptr<data_transformer>(new extract_data_transformer(*this));
+	}
+
+	std::string extract_data_transformer::get_cache_key() const
+	{
+		std::string res = "extract input";
+		for(std::vector<unsigned int>::const_iterator it = input_window_sizes.begin(); it != input_window_sizes.end(); ++it)
+			res += (boost::format(" %1%") % *it).str();
+		res += " output";
+		for(std::vector<unsigned int>::const_iterator it = output_window_sizes.begin(); it != output_window_sizes.end(); ++it)
+			res += (boost::format(" %1%") % *it).str();
+		return res;
+	}
 }
@@ -44,6 +44,10 @@ namespace nnforge
 
 		virtual bool is_deterministic() const;
 
+		virtual nnforge_shared_ptr<data_transformer> clone(unsigned int seed) const;
+
+		virtual std::string get_cache_key() const;
+
 	protected:
 		std::vector<unsigned int> input_window_sizes;
 		std::vector<unsigned int> output_window_sizes;
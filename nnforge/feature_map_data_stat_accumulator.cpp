@@ -0,0 +1,264 @@
+/*
+ *  Copyright 2011-2014 Maxim Milakov
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include "feature_map_data_stat_accumulator.h"
+
+#include "supervised_data_reader.h"
+#include "data_reader_async_prefetcher.h"
+#include "neural_network_exception.h"
+#include "rnd.h"
+#include "nn_types.h"
+
+#include <algorithm>
+#include <limits>
+#include <cmath>
+#include <boost/format.hpp>
+#include <boost/bind.hpp>
+#include <boost/thread/thread.hpp>
+
+namespace nnforge
+{
+	feature_map_data_stat_accumulator::feature_map_data_stat_accumulator(
+		unsigned int feature_map_count,
+		unsigned int neuron_count_per_feature_map)
+		: neuron_count_per_feature_map(neuron_count_per_feature_map)
+		, entry_count(0)
+		, feature_map_list(feature_map_count)
+	{
+		for(std::vector<feature_map_accumulator>::iterator it = feature_map_list.begin(); it != feature_map_list.end(); ++it)
+		{
+			it->min = std::numeric_limits<float>::max();
+			it->max = -std::numeric_limits<float>::max();
+			it->average = 0.0;
+			it->m2 = 0.0;
+			it->entry_average_m2 = 0.0;
+		}
+	}
+
+	void feature_map_data_stat_accumulator::add(const float * entry_data)
+	{
+		++entry_count;
+		double old_weight = static_cast<double>(entry_count - 1) / static_cast<double>(entry_count);
+		double new_weight = 1.0 / static_cast<double>(entry_count);
+
+		const float * data_it = entry_data;
+		for(std::vector<feature_map_accumulator>::iterator fm_it = feature_map_list.begin(); fm_it != feature_map_list.end(); ++fm_it)
+		{
+			// The entry is in memory, so its own statistics are calculated in 2 passes
+			double sum = 0.0;
+			for(unsigned int i = 0; i < neuron_count_per_feature_map; ++i)
+			{
+				float val = data_it[i];
+				fm_it->min = std::min(fm_it->min, val);
+				fm_it->max = std::max(fm_it->max, val);
+				sum += static_cast<double>(val);
+			}
+			double entry_average = sum / static_cast<double>(neuron_count_per_feature_map);
+			double entry_m2 = 0.0;
+			for(unsigned int i = 0; i < neuron_count_per_feature_map; ++i)
+			{
+				double diff = static_cast<double>(data_it[i]) - entry_average;
+				entry_m2 += diff * diff;
+			}
+			data_it += neuron_count_per_feature_map;
+
+			double delta = entry_average - fm_it->average;
+			fm_it->average += delta * new_weight;
+			fm_it->m2 += entry_m2 + delta * delta * old_weight * static_cast<double>(neuron_count_per_feature_map);
+			fm_it->entry_average_m2 += delta * (entry_average - fm_it->average);
+		}
+	}
+
+	void feature_map_data_stat_accumulator::add(
+		const float * entry_data,
+		unsigned int entry_count,
+		unsigned int worker_count)
+	{
+		size_t entry_size = feature_map_list.size() * neuron_count_per_feature_map;
+
+		worker_count = std::max(std::min(worker_count, entry_count), 1U);
+		if (worker_count == 1)
+		{
+			for(unsigned int entry_id = 0; entry_id < entry_count; ++entry_id)
+				add(entry_data + entry_id * entry_size);
+			return;
+		}
+
+		// Parts are merged in order, so the result doesn't depend on the timing of threads
+		std::vector<feature_map_data_stat_accumulator> part_list(worker_count, feature_map_data_stat_accumulator(static_cast<unsigned int>(feature_map_list.size()), neuron_count_per_feature_map));
+		std::vector<nnforge_shared_ptr<boost::thread> > thread_list;
+		for(unsigned int part_id = 1; part_id < worker_count; ++part_id)
+		{
+			unsigned int first = part_id * entry_count / worker_count;
+			unsigned int last = (part_id + 1) * entry_count / worker_count;
+			void (feature_map_data_stat_accumulator::*add_entries)(const float *, unsigned int, unsigned int) = &feature_map_data_stat_accumulator::add;
+			thread_list.push_back(nnforge_shared_ptr<boost::thread>(new boost::thread(boost::bind(add_entries, &part_list[part_id], entry_data + first * entry_size, last - first, 1U))));
+		}
+		part_list[0].add(entry_data, entry_count / worker_count, 1);
+
+		for(std::vector<nnforge_shared_ptr<boost::thread> >::iterator it = thread_list.begin(); it != thread_list.end(); ++it)
+			(*it)->join();
+
+		for(std::vector<feature_map_data_stat_accumulator>::const_iterator it = part_list.begin(); it != part_list.end(); ++it)
+			add(*it);
+	}
+
+	void feature_map_data_stat_accumulator::add(const feature_map_data_stat_accumulator& other)
+	{
+		if (other.entry_count == 0)
+			return;
+
+		double total_count = static_cast<double>(entry_count) + static_cast<double>(other.entry_count);
+		double other_weight = static_cast<double>(other.entry_count) / total_count;
+		double cross_weight = static_cast<double>(entry_count) * static_cast<double>(other.entry_count) / total_count;
+
+		std::vector<feature_map_accumulator>::const_iterator other_it = other.feature_map_list.begin();
+		for(std::vector<feature_map_accumulator>::iterator fm_it = feature_map_list.begin(); fm_it != feature_map_list.end(); ++fm_it, ++other_it)
+		{
+			fm_it->min = std::min(fm_it->min, other_it->min);
+			fm_it->max = std::max(fm_it->max, other_it->max);
+
+			double delta = other_it->average - fm_it->average;
+			fm_it->average += delta * other_weight;
+			fm_it->m2 += other_it->m2 + delta * delta * cross_weight * static_cast<double>(neuron_count_per_feature_map);
+			fm_it->entry_average_m2 += other_it->entry_average_m2 + delta * delta * cross_weight;
+		}
+
+		entry_count += other.entry_count;
+	}
+
+	void feature_map_data_stat_accumulator::add_input(
+		unsupervised_data_reader& reader,
+		unsigned int worker_count,
+		unsigned int sample_entry_count)
+	{
+		add_entries(reader, 0, worker_count, sample_entry_count);
+	}
+
+	void feature_map_data_stat_accumulator::add_output(
+		supervised_data_reader& reader,
+		unsigned int worker_count,
+		unsigned int sample_entry_count)
+	{
+		add_entries(reader, &reader, worker_count, sample_entry_count);
+	}
+
+	void feature_map_data_stat_accumulator::add_entries(
+		unsupervised_data_reader& reader,
+		supervised_data_reader * supervised_reader,
+		unsigned int worker_count,
+		unsigned int sample_entry_count)
+	{
+		const size_t chunk_size = 16 << 20;
+		size_t entry_size = feature_map_list.size() * neuron_count_per_feature_map;
+		// Input data are read along with output ones
+		size_t read_entry_size = reader.get_input_neuron_elem_size() * reader.get_input_configuration().get_neuron_count();
+		if (supervised_reader)
+			read_entry_size += entry_size * sizeof(float);
+		unsigned int chunk_entry_count = static_cast<unsigned int>(std::max(chunk_size / read_entry_size, static_cast<size_t>(1)));
+		unsigned int reader_entry_count = reader.get_entry_count();
+
+		reader.reset();
+
+		if ((sample_entry_count == 0) || (sample_entry_count >= reader_entry_count))
+		{
+			nnforge_shared_ptr<data_reader_async_prefetcher> prefetcher(supervised_reader ? new data_reader_async_prefetcher(*supervised_reader, chunk_entry_count) : new data_reader_async_prefetcher(reader, chunk_entry_count));
+			prefetcher->start(chunk_entry_count);
+			while (true)
+			{
+				unsigned int entries_read = prefetcher->wait();
+				if (entries_read == 0)
+					break;
+				prefetcher->start(chunk_entry_count);
+
+				const float * chunk_data = supervised_reader ? &(*prefetcher->get_output_buffer().begin()) : reinterpret_cast<const float *>(&(*prefetcher->get_input_buffer().begin()));
+				add(chunk_data, entries_read, worker_count);
+			}
+		}
+		else
+		{
+			// Partial Fisher-Yates shuffle, entries are read in increasing order then
+			std::vector<unsigned int> entry_id_list(reader_entry_count);
+			for(unsigned int i = 0; i < reader_entry_count; ++i)
+				entry_id_list[i] = i;
+			random_generator gen = rnd::get_random_generator();
+			for(unsigned int i = 0; i < sample_entry_count; ++i)
+			{
+				nnforge_uniform_int_distribution<unsigned int> dist(i, reader_entry_count - 1);
+				std::swap(entry_id_list[i], entry_id_list[dist(gen)]);
+			}
+			entry_id_list.resize(sample_entry_count);
+			std::sort(entry_id_list.begin(), entry_id_list.end());
+
+			std::vector<float> chunk_data(chunk_entry_count * entry_size);
+			for(unsigned int first = 0; first < sample_entry_count; first += chunk_entry_count)
+			{
+				unsigned int entries_to_read = std::min(chunk_entry_count, sample_entry_count - first);
+				for(unsigned int i = 0; i < entries_to_read; ++i)
+				{
+					float * dst = &(*chunk_data.begin()) + i * entry_size;
+					reader.rewind(entry_id_list[first + i]);
+					bool entry_read = supervised_reader ? supervised_reader->read(0, dst) : reader.read(dst);
+					if (!entry_read)
+						throw neural_network_exception((boost::format("Unable to read entry %1% of %2%") % entry_id_list[first + i] % reader_entry_count).str());
+				}
+				add(&(*chunk_data.begin()), entries_to_read, worker_count);
+			}
+		}
+
+		reader.reset();
+	}
+
+	unsigned int feature_map_data_stat_accumulator::get_entry_count() const
+	{
+		return entry_count;
+	}
+
+	std::vector<feature_map_data_stat> feature_map_data_stat_accumulator::get_stat_list() const
+	{
+		std::vector<feature_map_data_stat> res(feature_map_list.size());
+
+		double mult = 1.0 / (static_cast<double>(entry_count) * static_cast<double>(neuron_count_per_feature_map));
+		std::vector<feature_map_data_stat>::iterator res_it = res.begin();
+		for(std::vector<feature_map_accumulator>::const_iterator fm_it = feature_map_list.begin(); fm_it != feature_map_list.end(); ++fm_it, ++res_it)
+		{
+			res_it->min = fm_it->min;
+			res_it->max = fm_it->max;
+			res_it->average = static_cast<float>(fm_it->average);
+			res_it->std_dev = static_cast<float>(sqrt(fm_it->m2 * mult));
+		}
+
+		return res;
+	}
+
+	std::vector<float> feature_map_data_stat_accumulator::get_average_confidence_list(unsigned int population_entry_count) const
+	{
+		std::vector<float> res(feature_map_list.size(), 0.0F);
+		if ((entry_count < 2) || (entry_count >= population_entry_count))
+			return res;
+
+		// Standard error of the average of per-entry averages, with finite population correction
+		double finite_population_correction = 1.0 - static_cast<double>(entry_count) / static_cast<double>(population_entry_count);
+		std::vector<float>::iterator res_it = res.begin();
+		for(std::vector<feature_map_accumulator>::const_iterator fm_it = feature_map_list.begin(); fm_it != feature_map_list.end(); ++fm_it, ++res_it)
+		{
+			double entry_average_variance = fm_it->entry_average_m2 / static_cast<double>(entry_count - 1);
+			*res_it = static_cast<float>(1.96 * sqrt(entry_average_variance * finite_population_correction / static_cast<double>(entry_count)));
+		}
+
+		return res;
+	}
+}
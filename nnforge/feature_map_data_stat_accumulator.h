@@ -0,0 +1,96 @@
+/*
+ *  Copyright 2011-2014 Maxim Milakov
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#pragma once
+
+#include "feature_map_data_stat.h"
+
+#include <vector>
+
+namespace nnforge
+{
+	class unsupervised_data_reader;
+	class supervised_data_reader;
+
+	// Accumulates per feature map statistics of float entries in a single pass.
+	// Average and sum of squared deviations are updated with Chan's pairwise formula, entry by entry,
+	// so accumulators filled from different parts of the data might be merged without loss of precision
+	class feature_map_data_stat_accumulator
+	{
+	public:
+		feature_map_data_stat_accumulator(
+			unsigned int feature_map_count,
+			unsigned int neuron_count_per_feature_map);
+
+		// Adds a single entry
+		void add(const float * entry_data);
+
+		// Adds entry_count entries stored contiguously, splitting them between worker_count threads
+		void add(
+			const float * entry_data,
+			unsigned int entry_count,
+			unsigned int worker_count);
+
+		// Merges statistics accumulated by another accumulator
+		void add(const feature_map_data_stat_accumulator& other);
+
+		// Adds input data of the reader entries, see add_entries
+		void add_input(
+			unsupervised_data_reader& reader,
+			unsigned int worker_count,
+			unsigned int sample_entry_count);
+
+		// Adds output data of the reader entries, see add_entries
+		void add_output(
+			supervised_data_reader& reader,
+			unsigned int worker_count,
+			unsigned int sample_entry_count);
+
+		unsigned int get_entry_count() const;
+
+		std::vector<feature_map_data_stat> get_stat_list() const;
+
+		// Returns half-widths of 95% confidence intervals for averages, assuming entries added are randomly sampled
+		// without replacement from population_entry_count entries
+		std::vector<float> get_average_confidence_list(unsigned int population_entry_count) const;
+
+	private:
+		// Adds all the entries of the reader, reading chunks of them on a background thread while adding the previous chunk with worker_count threads.
+		// If sample_entry_count is non-zero and less than the entry count, only that many randomly chosen entries are read, with rewind.
+		// Output data are added if supervised_reader is not null, input data otherwise
+		void add_entries(
+			unsupervised_data_reader& reader,
+			supervised_data_reader * supervised_reader,
+			unsigned int worker_count,
+			unsigned int sample_entry_count);
+
+		struct feature_map_accumulator
+		{
+			float min;
+			float max;
+			double average;
+			// Sum of squared deviations from the average
+			double m2;
+			// Sum of squared deviations of per-entry averages from the average, for confidence intervals.
+			// All entries have the same number of neurons, so the average of per-entry averages is the average itself
+			double entry_average_m2;
+		};
+
+		unsigned int neuron_count_per_feature_map;
+		unsigned int entry_count;
+		std::vector<feature_map_accumulator> feature_map_list;
+	};
+}
@@ -81,4 +81,9 @@ namespace nnforge
 	{
 		return true;
 	}
+
+	nnforge_shared_ptr<data_transformer> flip_2d_data_sampler_transformer::clone(unsigned int seed) const
+	{
+		return nnforge_shared_ptr<data_transformer>(new flip_2d_data_sampler_transformer(*this));
+	}
 }
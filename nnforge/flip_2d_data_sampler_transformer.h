@@ -42,6 +42,8 @@ namespace nnforge
 
 		virtual bool is_deterministic() const;
 
+		virtual nnforge_shared_ptr<data_transformer> clone(unsigned int seed) const;
+
 	protected:
 		unsigned int flip_around_dimension_id;
 	};
@@ -74,4 +74,11 @@ namespace nnforge
 	{
 		return false;
 	}
+
+	nnforge_shared_ptr<data_transformer> intensity_2d_data_transformer::clone(unsigned int seed) const
+	{
+		nnforge_shared_ptr<intensity_2d_data_transformer> res(new intensity_2d_data_transformer(*this));
+		res->generator = rnd::get_random_generator(seed);
+		return res;
+	}
 }
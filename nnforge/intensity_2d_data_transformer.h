@@ -40,6 +40,8 @@ namespace nnforge
 			
 		virtual bool is_deterministic() const;
 
+		virtual nnforge_shared_ptr<data_transformer> clone(unsigned int seed) const;
+
 	protected:
 		random_generator generator;
 
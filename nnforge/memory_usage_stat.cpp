@@ -0,0 +1,116 @@
+/*
+ *  Copyright 2011-2014 Maxim Milakov
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include "memory_usage_stat.h"
+
+#include <algorithm>
+#include <boost/format.hpp>
+#include <boost/thread/locks.hpp>
+
+namespace nnforge
+{
+	memory_usage_stat::usage::usage()
+		: live_bytes(0)
+		, peak_bytes(0)
+	{
+	}
+
+	memory_usage_stat::scoped_usage::scoped_usage(
+		nnforge_shared_ptr<memory_usage_stat> stat,
+		const std::string& category,
+		size_t bytes)
+		: stat(stat)
+		, category(category)
+		, bytes(bytes)
+	{
+		if (stat)
+			stat->add(category, bytes);
+	}
+
+	memory_usage_stat::scoped_usage::~scoped_usage()
+	{
+		if (stat)
+			stat->remove(category, bytes);
+	}
+
+	memory_usage_stat::memory_usage_stat()
+	{
+	}
+
+	void memory_usage_stat::add(
+		const std::string& category,
+		size_t bytes)
+	{
+		boost::lock_guard<boost::mutex> lock(mtx);
+
+		usage& u = category_to_usage_map[category];
+		u.live_bytes += bytes;
+		u.peak_bytes = std::max(u.peak_bytes, u.live_bytes);
+
+		total_usage.live_bytes += bytes;
+		total_usage.peak_bytes = std::max(total_usage.peak_bytes, total_usage.live_bytes);
+	}
+
+	void memory_usage_stat::remove(
+		const std::string& category,
+		size_t bytes)
+	{
+		boost::lock_guard<boost::mutex> lock(mtx);
+
+		usage& u = category_to_usage_map[category];
+		u.live_bytes -= std::min(u.live_bytes, bytes);
+
+		total_usage.live_bytes -= std::min(total_usage.live_bytes, bytes);
+	}
+
+	std::map<std::string, memory_usage_stat::usage> memory_usage_stat::get_category_to_usage_map() const
+	{
+		boost::lock_guard<boost::mutex> lock(mtx);
+
+		return category_to_usage_map;
+	}
+
+	memory_usage_stat::usage memory_usage_stat::get_total_usage() const
+	{
+		boost::lock_guard<boost::mutex> lock(mtx);
+
+		return total_usage;
+	}
+
+	void memory_usage_stat::write_csv(std::ostream& out) const
+	{
+		std::map<std::string, usage> category_to_usage_map = get_category_to_usage_map();
+		usage total_usage = get_total_usage();
+
+		out << "category,live_bytes,peak_bytes" << std::endl;
+		for(std::map<std::string, usage>::const_iterator it = category_to_usage_map.begin(); it != category_to_usage_map.end(); ++it)
+			out << it->first << "," << it->second.live_bytes << "," << it->second.peak_bytes << std::endl;
+		out << "total," << total_usage.live_bytes << "," << total_usage.peak_bytes << std::endl;
+	}
+
+	std::ostream& operator<< (std::ostream& out, const memory_usage_stat& val)
+	{
+		const float mb = 1.0F / static_cast<float>(1 << 20);
+
+		out << (boost::format("Peak memory usage %|1$.1f| MB") % (static_cast<float>(val.get_total_usage().peak_bytes) * mb));
+
+		std::map<std::string, memory_usage_stat::usage> category_to_usage_map = val.get_category_to_usage_map();
+		for(std::map<std::string, memory_usage_stat::usage>::const_iterator it = category_to_usage_map.begin(); it != category_to_usage_map.end(); ++it)
+			out << (boost::format(", %1% %|2$.1f| MB") % it->first % (static_cast<float>(it->second.peak_bytes) * mb));
+
+		return out;
+	}
+}
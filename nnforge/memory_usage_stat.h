@@ -0,0 +1,138 @@
+/*
+ *  Copyright 2011-2014 Maxim Milakov
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#pragma once
+
+#include "nn_types.h"
+
+#include <map>
+#include <string>
+#include <ostream>
+#include <boost/thread/mutex.hpp>
+
+namespace nnforge
+{
+	// Live and peak sizes of buffers allocated by the backend, per category
+	class memory_usage_stat
+	{
+	public:
+		struct usage
+		{
+			usage();
+
+			size_t live_bytes;
+			size_t peak_bytes;
+		};
+
+		// Accounts bytes in the category during its lifetime
+		class scoped_usage
+		{
+		public:
+			scoped_usage(
+				nnforge_shared_ptr<memory_usage_stat> stat,
+				const std::string& category,
+				size_t bytes);
+
+			~scoped_usage();
+
+		private:
+			nnforge_shared_ptr<memory_usage_stat> stat;
+			std::string category;
+			size_t bytes;
+
+		private:
+			scoped_usage(const scoped_usage&);
+			scoped_usage& operator =(const scoped_usage&);
+		};
+
+		memory_usage_stat();
+
+		void add(
+			const std::string& category,
+			size_t bytes);
+
+		void remove(
+			const std::string& category,
+			size_t bytes);
+
+		std::map<std::string, usage> get_category_to_usage_map() const;
+
+		// Peak of the sum over all categories, it might be less than the sum of peaks
+		usage get_total_usage() const;
+
+		// Writes "category,live_bytes,peak_bytes" lines preceded by header, the last line is for the total
+		void write_csv(std::ostream& out) const;
+
+		// Returns pointer sharing ownership with ptr, bytes are accounted in the category until the last copy of the returned pointer is released.
+		// Returns ptr unchanged if stat is empty
+		template<typename data_type>
+		static nnforge_shared_ptr<data_type> track(
+			nnforge_shared_ptr<memory_usage_stat> stat,
+			nnforge_shared_ptr<data_type> ptr,
+			const std::string& category,
+			size_t bytes)
+		{
+			if ((!stat) || (!ptr))
+				return ptr;
+
+			stat->add(category, bytes);
+			return nnforge_shared_ptr<data_type>(ptr.get(), release<data_type>(stat, ptr, category, bytes));
+		}
+
+	private:
+		template<typename data_type>
+		class release
+		{
+		public:
+			release(
+				nnforge_shared_ptr<memory_usage_stat> stat,
+				nnforge_shared_ptr<data_type> ptr,
+				const std::string& category,
+				size_t bytes)
+				: stat(stat)
+				, ptr(ptr)
+				, category(category)
+				, bytes(bytes)
+			{
+			}
+
+			void operator()(data_type *)
+			{
+				stat->remove(category, bytes);
+				ptr.reset();
+			}
+
+		private:
+			nnforge_shared_ptr<memory_usage_stat> stat;
+			nnforge_shared_ptr<data_type> ptr;
+			std::string category;
+			size_t bytes;
+		};
+
+		std::map<std::string, usage> category_to_usage_map;
+		usage total_usage;
+		mutable boost::mutex mtx;
+
+	private:
+		memory_usage_stat(const memory_usage_stat&);
+		memory_usage_stat& operator =(const memory_usage_stat&);
+	};
+
+	std::ostream& operator<< (std::ostream& out, const memory_usage_stat& val);
+
+	typedef nnforge_shared_ptr<memory_usage_stat> memory_usage_stat_smart_ptr;
+	typedef nnforge_shared_ptr<const memory_usage_stat> const_memory_usage_stat_smart_ptr;
+}
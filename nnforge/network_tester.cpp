@@ -167,4 +167,9 @@ namespace nnforge
 	{
 		return flops;
 	}
+
+	const_memory_usage_stat_smart_ptr network_tester::get_memory_usage_stat() const
+	{
+		return memory_usage;
+	}
 }
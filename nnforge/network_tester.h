@@ -24,6 +24,7 @@
 #include "layer_configuration_specific.h"
 #include "layer_configuration_specific_snapshot.h"
 #include "neuron_data_type.h"
+#include "memory_usage_stat.h"
 #include "nn_types.h"
 
 #include <vector>
@@ -78,6 +79,9 @@ namespace nnforge
 		// set_input_configuration_specific should be called prior to this method call for this method to succeed
 		float get_flops_for_single_entry() const;
 
+		// Returns buffer usage of the last test or run call with data reader, empty if the backend doesn't track it
+		const_memory_usage_stat_smart_ptr get_memory_usage_stat() const;
+
 	protected:
 		network_tester(network_schema_smart_ptr schema);
 
@@ -109,6 +113,7 @@ namespace nnforge
 		network_schema_smart_ptr schema;
 		layer_configuration_specific_list layer_config_list;
 		float flops;
+		memory_usage_stat_smart_ptr memory_usage;
 
 	private:
 		network_tester();
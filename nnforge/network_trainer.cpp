@@ -17,17 +17,26 @@
 #include "network_trainer.h"
 
 #include <vector>
+#include <algorithm>
+#include <boost/thread/thread.hpp>
+#include <boost/bind.hpp>
+#include <boost/ref.hpp>
 
 #include "neural_network_exception.h"
 
 namespace nnforge
 {
+	const unsigned int network_trainer::concurrent_queue_entry_count = 1024;
+
 	network_trainer::network_trainer(network_schema_smart_ptr schema)
 		: schema(schema)
 		, epoch_count(50)
 		, learning_rate_decay_tail_epoch_count(0)
 		, learning_rate_decay_rate(0.5F)
 		, learning_rate(0.02F)
+		, learning_rate_rise_head_epoch_count(0)
+		, learning_rate_rise_rate(0.1F)
+		, weight_decay(0.0F)
 		, batch_size(1)
 		, momentum(0.0F)
 	{
@@ -101,6 +110,141 @@ namespace nnforge
 		}
 	}
 
+	void network_trainer::train_concurrently(
+		const std::vector<network_trainer_smart_ptr>& trainer_list,
+		supervised_data_reader& reader,
+		network_data_peeker& peeker,
+		network_data_pusher& progress_pusher,
+		network_data_pusher& pusher)
+	{
+		unsigned int reader_epoch_id = 0;
+
+		for(std::vector<network_trainer_smart_ptr>::const_iterator it = trainer_list.begin(); it != trainer_list.end(); ++it)
+			(*it)->initialize_train(reader);
+
+		supervised_data_sharer sharer(reader, static_cast<unsigned int>(trainer_list.size()), concurrent_queue_entry_count);
+
+		bool peeker_exhausted = false;
+		while(!peeker_exhausted)
+		{
+			std::vector<training_task_state> task_list;
+			while (task_list.size() < trainer_list.size())
+			{
+				const network_trainer& trainer = *trainer_list[task_list.size()];
+				network_data_peek_entry entry_peeked = peeker.peek(trainer.schema);
+				if (entry_peeked.data == 0)
+				{
+					peeker_exhausted = true;
+					break;
+				}
+
+				training_task_state new_task;
+				new_task.index_peeked = entry_peeked.index;
+				new_task.data = entry_peeked.data;
+				new_task.initial_epoch = entry_peeked.start_epoch;
+
+				if (trainer.is_last_epoch(new_task))
+				{
+					std::cout << "Warning: Task is allocated which is already complete. Index " << new_task.index_peeked << ", Base epoch " << new_task.initial_epoch << std::endl;
+					continue;
+				}
+
+				std::cout << "New task allocated: Index " << new_task.index_peeked << ", Base epoch " << new_task.initial_epoch << std::endl;
+
+				task_list.push_back(new_task);
+			}
+
+			if (task_list.empty())
+				break;
+
+			unsigned int group_initial_epoch = task_list.front().initial_epoch;
+			for(std::vector<training_task_state>::const_iterator it = task_list.begin(); it != task_list.end(); ++it)
+				group_initial_epoch = std::min(group_initial_epoch, it->initial_epoch);
+
+			if (group_initial_epoch > reader_epoch_id)
+			{
+				for(unsigned int i = reader_epoch_id; i < group_initial_epoch; ++i)
+					reader.next_epoch();
+				reader_epoch_id += (group_initial_epoch - reader_epoch_id);
+			}
+			else if (group_initial_epoch < reader_epoch_id)
+				std::cout << "Warning: negative scrolling through reader requested. Index " << task_list.front().index_peeked << ", Initial epoch " << group_initial_epoch << std::endl;
+
+			// Tasks resumed from later epochs join the group when it reaches their epochs
+			std::vector<bool> running_list(task_list.size(), true);
+			for(unsigned int epoch = group_initial_epoch; std::find(running_list.begin(), running_list.end(), true) != running_list.end(); ++epoch)
+			{
+				std::vector<unsigned int> active_task_id_list;
+				for(unsigned int task_id = 0; task_id < task_list.size(); ++task_id)
+					if (running_list[task_id] && (task_list[task_id].get_current_epoch() <= epoch))
+						active_task_id_list.push_back(task_id);
+
+				sharer.start_pass(active_task_id_list);
+
+				std::vector<std::string> error_list(task_list.size());
+				{
+					std::vector<nnforge_shared_ptr<boost::thread> > thread_list;
+					for(std::vector<unsigned int>::const_iterator it = active_task_id_list.begin(); it != active_task_id_list.end(); ++it)
+						thread_list.push_back(nnforge_shared_ptr<boost::thread>(new boost::thread(boost::bind(
+							&network_trainer::shared_train_step,
+							trainer_list[*it].get(),
+							boost::ref(sharer),
+							*it,
+							boost::ref(task_list[*it]),
+							boost::ref(error_list[*it])))));
+					for(std::vector<nnforge_shared_ptr<boost::thread> >::iterator it = thread_list.begin(); it != thread_list.end(); ++it)
+						(*it)->join();
+				}
+				for(std::vector<std::string>::const_iterator it = error_list.begin(); it != error_list.end(); ++it)
+					if (!it->empty())
+						throw neural_network_exception(*it);
+
+				reader.next_epoch();
+				++reader_epoch_id;
+
+				for(std::vector<unsigned int>::const_iterator it = active_task_id_list.begin(); it != active_task_id_list.end(); ++it)
+				{
+					training_task_state& task = task_list[*it];
+
+					progress_pusher.push(task);
+
+					if (trainer_list[*it]->is_broken(task))
+					{
+						std::cout << "# " << task.index_peeked << " - broken weights while training, discarding it." << std::endl;
+						running_list[*it] = false;
+						continue;
+					}
+
+					if (trainer_list[*it]->is_last_epoch(task))
+					{
+						pusher.push(task);
+						running_list[*it] = false;
+					}
+				}
+			}
+		}
+	}
+
+	void network_trainer::shared_train_step(
+		supervised_data_sharer& sharer,
+		unsigned int consumer_id,
+		training_task_state& task,
+		std::string& error)
+	{
+		try
+		{
+			train_step(
+				*sharer.get_consumer_reader(consumer_id),
+				task);
+		}
+		catch (const std::exception& e)
+		{
+			error = e.what();
+		}
+
+		sharer.finish(consumer_id);
+	}
+
 	bool network_trainer::is_last_epoch(const training_task_state& state) const
 	{
 		return (state.get_current_epoch() >= epoch_count);
@@ -21,9 +21,12 @@
 #include "training_task_state.h"
 #include "network_schema.h"
 #include "supervised_data_reader.h"
+#include "supervised_data_sharer.h"
 #include "nn_types.h"
 
 #include <map>
+#include <vector>
+#include <string>
 
 namespace nnforge
 {
@@ -38,6 +41,21 @@ namespace nnforge
 			network_data_pusher& progress_pusher,
 			network_data_pusher& pusher);
 
+		// Networks are peeked in groups of trainer_list.size(), network i of the group is trained by trainer_list[i] in its own thread.
+		// The networks of the group share single pass over the reader per epoch, each of them reads the same entries
+		// it would read if it was trained alone, starting from the reader position the group starts at.
+		// The results differ from those of train: there networks see consecutive reader epochs, updaters are seeded randomly,
+		// and each updater of the group gets a part of the memory, so its chunks might be smaller, changing dropout masks and summation order
+		static void train_concurrently(
+			const std::vector<nnforge_shared_ptr<network_trainer> >& trainer_list,
+			supervised_data_reader& reader,
+			network_data_peeker& peeker,
+			network_data_pusher& progress_pusher,
+			network_data_pusher& pusher);
+
+		// The number of entries networks trained concurrently might be ahead of the slowest one
+		static const unsigned int concurrent_queue_entry_count;
+
 		unsigned int epoch_count;
 		unsigned int batch_size;
 		float learning_rate;
@@ -68,6 +86,12 @@ namespace nnforge
 
 		bool is_broken(const training_task_state& state) const;
 
+		void shared_train_step(
+			supervised_data_sharer& sharer,
+			unsigned int consumer_id,
+			training_task_state& task,
+			std::string& error);
+
 	private:
 		network_trainer(const network_trainer&);
 		network_trainer& operator =(const network_trainer&);
@@ -0,0 +1,46 @@
+/*
+ *  Copyright 2011-2014 Maxim Milakov
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#pragma once
+
+#include "network_trainer_sgd.h"
+
+namespace nnforge
+{
+	// Lock-free asynchronous SGD (Hogwild): workers apply their gradients to shared weights without synchronization
+	class network_trainer_hogwild : public network_trainer_sgd
+	{
+	public:
+		// worker_count = 0 lets the updater choose it
+		network_trainer_hogwild(
+			network_schema_smart_ptr schema,
+			network_updater_smart_ptr updater,
+			unsigned int worker_count);
+
+		virtual ~network_trainer_hogwild();
+
+	protected:
+		// The method should add testing result to the training history of each element
+		virtual void train_step(
+			supervised_data_reader& reader,
+			training_task_state& task);
+
+	private:
+		unsigned int worker_count;
+	};
+
+	typedef nnforge_shared_ptr<network_trainer_hogwild> network_trainer_hogwild_smart_ptr;
+}
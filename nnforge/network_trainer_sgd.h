@@ -45,7 +45,7 @@ namespace nnforge
 			unsigned int epoch,
 			network_data_smart_ptr data);
 
-	private:
+	protected:
 		network_updater_smart_ptr updater;
 	};
 
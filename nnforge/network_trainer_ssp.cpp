@@ -0,0 +1,188 @@
+/*
+ *  Copyright 2011-2014 Maxim Milakov
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include "network_trainer_ssp.h"
+
+#include "neural_network_exception.h"
+
+#include <algorithm>
+#include <boost/format.hpp>
+
+namespace nnforge
+{
+	network_trainer_ssp::network_trainer_ssp(
+		network_schema_smart_ptr schema,
+		network_updater_smart_ptr updater,
+		parameter_server_client_smart_ptr client,
+		unsigned int staleness,
+		unsigned int push_batch_count)
+		: network_trainer_sgd(schema, updater)
+		, client(client)
+		, staleness(staleness)
+		, synchronizer(new ssp_synchronizer(client, staleness, std::max(push_batch_count, 1U)))
+		, task_started(false)
+		, task_index(0)
+	{
+		updater->set_weight_synchronizer(synchronizer);
+	}
+
+	network_trainer_ssp::~network_trainer_ssp()
+	{
+	}
+
+	void network_trainer_ssp::train_step(
+		supervised_data_reader& reader,
+		training_task_state& task)
+	{
+		boost::chrono::steady_clock::time_point start = boost::chrono::high_resolution_clock::now();
+
+		layer_data_list& data = task.data->data_list;
+
+		if (!task_started || (task.index_peeked != task_index))
+		{
+			// The servers don't wait for this worker while the next network is started
+			if (task_started)
+				client->finish(task_index);
+
+			task_started = true;
+			task_index = task.index_peeked;
+			if (client->get_worker_id() == 0)
+				client->init(task_index, data);
+			synchronizer->start_task(task_index);
+		}
+
+		std::pair<std::vector<std::vector<float> >, std::string> lr_and_comment = prepare_learning_rates(task.get_current_epoch(), task.data);
+
+		client->reset_stat();
+
+		std::pair<testing_result_smart_ptr, training_stat_smart_ptr> train_result = updater->update(
+			reader,
+			lr_and_comment.first,
+			task.data,
+			batch_size,
+			weight_decay,
+			momentum,
+			layer_to_dropout_rate_map);
+
+		synchronizer->update_finished(data);
+
+		unsigned int push_count = synchronizer->get_push_count();
+		if (push_count == 0)
+			throw neural_network_exception("No training entries available for the worker");
+
+		double sent_ratio = (client->get_delta_elem_count() > 0) ? static_cast<double>(client->get_sent_elem_count()) / static_cast<double>(client->get_delta_elem_count()) : 0.0;
+		task.comments.push_back(lr_and_comment.second + (boost::format(" SSP %1% pushes, staleness %2%, %3$.1f%% of delta sent, %4$.2f s in pull") % push_count % staleness % (sent_ratio * 100.0) % client->get_wait_seconds()).str());
+
+		boost::chrono::duration<float> sec = (boost::chrono::high_resolution_clock::now() - start);
+
+		float flops = updater->get_flops_for_single_entry();
+
+		train_result.first->time_to_complete_seconds = sec.count();
+		train_result.first->flops = static_cast<float>(train_result.first->get_entry_count()) * flops;
+
+		task.history.push_back(train_result);
+	}
+
+	network_trainer_ssp::ssp_synchronizer::ssp_synchronizer(
+		parameter_server_client_smart_ptr client,
+		unsigned int staleness,
+		unsigned int push_batch_count)
+		: client(client)
+		, staleness(staleness)
+		, push_batch_count(push_batch_count)
+		, task_index(0)
+		, clock(0)
+		, unpushed_count(0)
+		, push_count(0)
+	{
+	}
+
+	network_trainer_ssp::ssp_synchronizer::~ssp_synchronizer()
+	{
+	}
+
+	void network_trainer_ssp::ssp_synchronizer::start_task(unsigned int task_index)
+	{
+		this->task_index = task_index;
+		clock = 0;
+	}
+
+	void network_trainer_ssp::ssp_synchronizer::update_started(layer_data_list& data)
+	{
+		client->pull(task_index, clock, staleness, data);
+
+		if (base_data.size() != data.size())
+		{
+			base_data.resize(data.size());
+			for(unsigned int layer_id = 0; layer_id < data.size(); ++layer_id)
+				base_data[layer_id] = layer_data_smart_ptr(new layer_data(*data[layer_id]));
+		}
+		else
+		{
+			for(unsigned int layer_id = 0; layer_id < data.size(); ++layer_id)
+				*base_data[layer_id] = *data[layer_id];
+		}
+
+		unpushed_count = 0;
+		push_count = 0;
+	}
+
+	void network_trainer_ssp::ssp_synchronizer::gradient_applied(layer_data_list& data)
+	{
+		++unpushed_count;
+		if (unpushed_count < push_batch_count)
+			return;
+
+		push(data);
+		client->pull(task_index, clock, staleness, data);
+		for(unsigned int layer_id = 0; layer_id < data.size(); ++layer_id)
+			*base_data[layer_id] = *data[layer_id];
+	}
+
+	void network_trainer_ssp::ssp_synchronizer::update_finished(layer_data_list& data)
+	{
+		if (unpushed_count > 0)
+			push(data);
+
+		client->pull(task_index, clock, staleness, data);
+	}
+
+	unsigned int network_trainer_ssp::ssp_synchronizer::get_push_count() const
+	{
+		return push_count;
+	}
+
+	void network_trainer_ssp::ssp_synchronizer::push(const layer_data_list& data)
+	{
+		// base_data gets the delta
+		for(unsigned int layer_id = 0; layer_id < data.size(); ++layer_id)
+		{
+			layer_data& delta = *base_data[layer_id];
+			const layer_data& updated = *data[layer_id];
+			for(unsigned int i = 0; i < delta.size(); ++i)
+			{
+				std::vector<float>::iterator delta_it = delta[i].begin();
+				for(std::vector<float>::const_iterator it = updated[i].begin(); it != updated[i].end(); ++it, ++delta_it)
+					*delta_it = *it - *delta_it;
+			}
+		}
+
+		client->push(task_index, clock, base_data);
+		++clock;
+		++push_count;
+		unpushed_count = 0;
+	}
+}
@@ -0,0 +1,97 @@
+/*
+ *  Copyright 2011-2014 Maxim Milakov
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#pragma once
+
+#include "network_trainer_sgd.h"
+#include "parameter_server_client.h"
+#include "weight_synchronizer.h"
+
+namespace nnforge
+{
+	// Stale-synchronous SGD with parameter server: the worker pulls weights from the server, trains them locally
+	// for push_batch_count batches and pushes the resulting delta, each push advances the worker's clock.
+	// Pull blocks while any other worker is more than staleness clocks behind, staleness = 0 makes training bulk-synchronous.
+	// The exchanges happen inside a single update per epoch, so momentum is kept across them.
+	// The updater should support set_weight_synchronizer
+	class network_trainer_ssp : public network_trainer_sgd
+	{
+	public:
+		network_trainer_ssp(
+			network_schema_smart_ptr schema,
+			network_updater_smart_ptr updater,
+			parameter_server_client_smart_ptr client,
+			unsigned int staleness,
+			unsigned int push_batch_count);
+
+		virtual ~network_trainer_ssp();
+
+	protected:
+		// The method should add testing result to the training history of each element
+		virtual void train_step(
+			supervised_data_reader& reader,
+			training_task_state& task);
+
+	private:
+		class ssp_synchronizer : public weight_synchronizer
+		{
+		public:
+			ssp_synchronizer(
+				parameter_server_client_smart_ptr client,
+				unsigned int staleness,
+				unsigned int push_batch_count);
+
+			virtual ~ssp_synchronizer();
+
+			// Clocks start from 0 for each network
+			void start_task(unsigned int task_index);
+
+			// Pulls the weights
+			virtual void update_started(layer_data_list& data);
+
+			// Pushes the delta and pulls the weights after every push_batch_count gradient applications
+			virtual void gradient_applied(layer_data_list& data);
+
+			// Pushes the delta not pushed yet and pulls the weights, which include the updates from the other workers
+			void update_finished(layer_data_list& data);
+
+			// The number of pushes since the update started
+			unsigned int get_push_count() const;
+
+		private:
+			void push(const layer_data_list& data);
+
+			parameter_server_client_smart_ptr client;
+			unsigned int staleness;
+			unsigned int push_batch_count;
+
+			unsigned int task_index;
+			unsigned int clock;
+			unsigned int unpushed_count;
+			unsigned int push_count;
+			layer_data_list base_data;
+		};
+
+		parameter_server_client_smart_ptr client;
+		unsigned int staleness;
+		nnforge_shared_ptr<ssp_synchronizer> synchronizer;
+
+		bool task_started;
+		unsigned int task_index;
+	};
+
+	typedef nnforge_shared_ptr<network_trainer_ssp> network_trainer_ssp_smart_ptr;
+}
@@ -65,6 +65,57 @@ namespace nnforge
 		float weight_decay,
 		float momentum,
 		const std::map<unsigned int, float>& layer_to_dropout_rate_map)
+	{
+		prepare_update(reader, data);
+
+		std::pair<testing_result_smart_ptr, training_stat_smart_ptr> res = actual_update(reader, learning_rates, data, batch_size, weight_decay, momentum, layer_to_dropout_rate_map);
+
+		return res;
+	}
+
+	std::pair<testing_result_smart_ptr, training_stat_smart_ptr> network_updater::update_asynchronous(
+		supervised_data_reader& reader,
+		const std::vector<std::vector<float> >& learning_rates,
+		network_data_smart_ptr data,
+		unsigned int batch_size,
+		float weight_decay,
+		float momentum,
+		const std::map<unsigned int, float>& layer_to_dropout_rate_map,
+		unsigned int worker_count)
+	{
+		prepare_update(reader, data);
+
+		std::pair<testing_result_smart_ptr, training_stat_smart_ptr> res = actual_update_asynchronous(reader, learning_rates, data, batch_size, weight_decay, momentum, layer_to_dropout_rate_map, worker_count);
+
+		return res;
+	}
+
+	std::pair<testing_result_smart_ptr, training_stat_smart_ptr> network_updater::actual_update_asynchronous(
+		supervised_data_reader& reader,
+		const std::vector<std::vector<float> >& learning_rates,
+		network_data_smart_ptr data,
+		unsigned int batch_size,
+		float weight_decay,
+		float momentum,
+		const std::map<unsigned int, float>& layer_to_dropout_rate_map,
+		unsigned int worker_count)
+	{
+		throw neural_network_exception("Asynchronous update is not implemented for this updater");
+	}
+
+	void network_updater::set_all_reducer(ring_all_reducer_smart_ptr all_reducer)
+	{
+		throw neural_network_exception("Data-parallel update is not implemented for this updater");
+	}
+
+	void network_updater::set_weight_synchronizer(weight_synchronizer_smart_ptr synchronizer)
+	{
+		throw neural_network_exception("Stale-synchronous update is not implemented for this updater");
+	}
+
+	void network_updater::prepare_update(
+		supervised_data_reader& reader,
+		network_data_smart_ptr data)
 	{
 		// Check data-schema consistency
 		data->check_network_data_consistency(*schema);
@@ -77,10 +128,6 @@ namespace nnforge
 		nnforge_uniform_real_distribution<float> dist(0.0F, 1.0F);
 		for(std::vector<float>::iterator it = random_uniform_list.begin(); it != random_uniform_list.end(); ++it)
 			*it = dist(gen);
-
-		std::pair<testing_result_smart_ptr, training_stat_smart_ptr> res = actual_update(reader, learning_rates, data, batch_size, weight_decay, momentum, layer_to_dropout_rate_map);
-
-		return res;
 	}
 
 	void network_updater::update_flops()
@@ -108,4 +155,9 @@ namespace nnforge
 	{
 		return flops;
 	}
+
+	const_memory_usage_stat_smart_ptr network_updater::get_memory_usage_stat() const
+	{
+		return memory_usage;
+	}
 }
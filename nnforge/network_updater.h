@@ -23,6 +23,9 @@
 #include "testing_result.h"
 #include "training_stat.h"
 #include "error_function.h"
+#include "memory_usage_stat.h"
+#include "ring_all_reducer.h"
+#include "weight_synchronizer.h"
 #include "nn_types.h"
 
 #include <map>
@@ -47,11 +50,36 @@ namespace nnforge
 			float momentum,
 			const std::map<unsigned int, float>& layer_to_dropout_rate_map);
 
+		// Lock-free asynchronous (Hogwild) update: each of worker_count workers takes batches of batch_size entries,
+		// computes the gradient on its own and applies it to data without any synchronization with the other workers.
+		// worker_count = 0 lets the backend choose the worker count
+		std::pair<testing_result_smart_ptr, training_stat_smart_ptr> update_asynchronous(
+			supervised_data_reader& reader,
+			const std::vector<std::vector<float> >& learning_rates,
+			network_data_smart_ptr data,
+			unsigned int batch_size,
+			float weight_decay,
+			float momentum,
+			const std::map<unsigned int, float>& layer_to_dropout_rate_map,
+			unsigned int worker_count);
+
 		// set_input_configuration_specific should be called prior to this method call for this method to succeed
 		float get_flops_for_single_entry() const;
 
 		void set_random_generator_seed(int seed);
 
+		// Returns buffer usage of the last update call, empty if the backend doesn't track it
+		const_memory_usage_stat_smart_ptr get_memory_usage_stat() const;
+
+		// Data-parallel training: update takes weights of worker 0 and sums gradients of all the workers before applying them,
+		// so data stay identical on all the workers. Each worker should read the same number of entries.
+		// The default implementation throws exception
+		virtual void set_all_reducer(ring_all_reducer_smart_ptr all_reducer);
+
+		// Stale-synchronous training: update lets synchronizer exchange weights before the first batch and after each gradient application.
+		// The default implementation throws exception
+		virtual void set_weight_synchronizer(weight_synchronizer_smart_ptr synchronizer);
+
 	protected:
 		network_updater(
 			network_schema_smart_ptr schema,
@@ -67,6 +95,18 @@ namespace nnforge
 			float momentum,
 			const std::map<unsigned int, float>& layer_to_dropout_rate_map) = 0;
 
+		// schema, data and reader are guaranteed to be compatible
+		// The default implementation throws exception
+		virtual std::pair<testing_result_smart_ptr, training_stat_smart_ptr> actual_update_asynchronous(
+			supervised_data_reader& reader,
+			const std::vector<std::vector<float> >& learning_rates,
+			network_data_smart_ptr data,
+			unsigned int batch_size,
+			float weight_decay,
+			float momentum,
+			const std::map<unsigned int, float>& layer_to_dropout_rate_map,
+			unsigned int worker_count);
+
 		// The method is called when client calls set_input_configuration_specific and the convolution specific configuration is modified.
 		// The layer_config_list is guaranteed to be compatible with schema
 		virtual void layer_config_list_modified() = 0;
@@ -79,10 +119,16 @@ namespace nnforge
 		layer_configuration_specific_list layer_config_list;
 		std::vector<float> random_uniform_list;
 		float flops;
+		memory_usage_stat_smart_ptr memory_usage;
 
 		random_generator gen;
 
 	private:
+		// Checks consistency of data and reader with schema and refreshes random list
+		void prepare_update(
+			supervised_data_reader& reader,
+			network_data_smart_ptr data);
+
 		network_updater();
 		network_updater(const network_updater&);
 		network_updater& operator =(const network_updater&);
@@ -16,6 +16,8 @@
 
 #include "network_updater_factory.h"
 
+#include "neural_network_exception.h"
+
 namespace nnforge
 {
 	network_updater_factory::network_updater_factory()
@@ -25,4 +27,13 @@ namespace nnforge
 	network_updater_factory::~network_updater_factory()
 	{
 	}
+
+	network_updater_smart_ptr network_updater_factory::create_concurrent(
+		network_schema_smart_ptr schema,
+		const_error_function_smart_ptr ef,
+		unsigned int updater_id,
+		unsigned int updater_count) const
+	{
+		throw neural_network_exception("Concurrent updaters are not supported by this backend");
+	}
 }
@@ -31,6 +31,14 @@ namespace nnforge
 			network_schema_smart_ptr schema,
 			const_error_function_smart_ptr ef) const = 0;
 
+		// Creates updater using part updater_id of updater_count equal parts of the computing resources,
+		// so that updater_count updaters could run concurrently. The default implementation throws exception
+		virtual network_updater_smart_ptr create_concurrent(
+			network_schema_smart_ptr schema,
+			const_error_function_smart_ptr ef,
+			unsigned int updater_id,
+			unsigned int updater_count) const;
+
 	protected:
 		network_updater_factory();
 	};
@@ -30,6 +30,9 @@
 #include "output_neuron_class_set.h"
 #include "classifier_result.h"
 #include "supervised_data_stream_reader.h"
+#include "supervised_data_mapped_reader.h"
+#include "supervised_compressed_data_stream_reader.h"
+#include "supervised_compressed_data_stream_writer.h"
 #include "unsupervised_data_stream_reader.h"
 #include "validate_progress_network_data_pusher.h"
 #include "network_data_peeker.h"
@@ -42,6 +45,7 @@
 #include "testing_complete_result_set_roc_visualizer.h"
 #include "summarize_network_data_pusher.h"
 #include "supervised_transformed_input_data_reader.h"
+#include "supervised_parallel_transformed_input_data_reader.h"
 #include "supervised_transformed_output_data_reader.h"
 #include "normalize_data_transformer.h"
 #include "unsupervised_transformed_input_data_reader.h"
@@ -49,8 +53,15 @@
 #include "nn_types.h"
 #include "supervised_data_stream_writer.h"
 #include "supervised_multiple_epoch_data_reader.h"
+#include "supervised_shuffled_data_reader.h"
+#include "supervised_sharded_data_reader.h"
+#include "supervised_cached_data_reader.h"
+#include "supervised_partitioned_data_reader.h"
 #include "supervised_limited_entry_count_data_reader.h"
 #include "network_trainer_sgd.h"
+#include "network_trainer_hogwild.h"
+#include "network_trainer_ssp.h"
+#include "parameter_server.h"
 #include "save_resume_network_data_pusher.h"
 #include "network_data_peeker_load_resume.h"
 #include "debug_util.h"
@@ -59,6 +70,7 @@ namespace nnforge
 {
 	const char * neural_network_toolset::training_data_filename = "training.sdt";
 	const char * neural_network_toolset::training_randomized_data_filename = "training_randomized.sdt";
+	const char * neural_network_toolset::training_transformed_cache_filename = "training_transformed_cache.sdt";
 	const char * neural_network_toolset::validating_data_filename = "validating.sdt";
 	const char * neural_network_toolset::testing_data_filename = "testing.sdt";
 	const char * neural_network_toolset::testing_unsupervised_data_filename = "testing.udt";
@@ -73,6 +85,7 @@ namespace nnforge
 	const char * neural_network_toolset::ann_resume_subfolder_name = "resume";
 	const char * neural_network_toolset::trained_ann_index_extractor_pattern = "^ann_trained_(\\d+)\\.data$";
 	const char * neural_network_toolset::logfile_name = "log.txt";
+	const char * neural_network_toolset::profile_updater_memory_usage_filename = "profile_updater_memory_usage.csv";
 	float neural_network_toolset::check_gradient_step_modifiers[] = {1.0, sqrtf(10.0F), 1.0F / sqrtf(10.0F), 10.0F, 0.1F, 10.0F * sqrtf(10.0F), 1.0F / (sqrtf(10.0F) * 10.0F), 100.0F, 0.01F, 100.0F * sqrtf(10.0F), 1.0F / (sqrtf(10.0F) * 100.0F), 1000.0F, 0.001F, -1.0F};
 
 	neural_network_toolset::neural_network_toolset(factory_generator_smart_ptr factory)
@@ -102,6 +115,10 @@ namespace nnforge
 		{
 			randomize_data();
 		}
+		else if (!action.compare("compress_data"))
+		{
+			compress_data();
+		}
 		else if (!action.compare("generate_input_normalizer"))
 		{
 			generate_input_normalizer();
@@ -126,6 +143,10 @@ namespace nnforge
 		{
 			train();
 		}
+		else if (!action.compare("parameter_server"))
+		{
+			run_parameter_server();
+		}
 		else if (!action.compare("profile_updater"))
 		{
 			profile_updater();
@@ -183,7 +204,7 @@ namespace nnforge
 		boost::program_options::options_description gener("Generic options");
 		gener.add_options()
 			("help", "produce help message")
-			("action,A", boost::program_options::value<std::string>(&action)->default_value(get_default_action()), "run action (info, create, prepare_training_data, prepare_testing_data, randomize_data, generate_input_normalizer, generate_output_normalizer, test, test_batch, validate, validate_batch, validate_infinite, train, snapshot, snapshot_data, snapshot_invalid, ann_snapshot, profile_updater, check_gradient)")
+			("action,A", boost::program_options::value<std::string>(&action)->default_value(get_default_action()), "run action (info, create, prepare_training_data, prepare_testing_data, randomize_data, compress_data, generate_input_normalizer, generate_output_normalizer, test, test_batch, validate, validate_batch, validate_infinite, train, snapshot, snapshot_data, snapshot_invalid, ann_snapshot, parameter_server, profile_updater, check_gradient)")
 			("config,C", boost::program_options::value<boost::filesystem::path>(&config_file)->default_value(default_config_path), "path to the configuration file.")
 			;
 
@@ -195,6 +216,10 @@ namespace nnforge
 			("input_data_folder,I", boost::program_options::value<boost::filesystem::path>(&input_data_folder)->default_value(""), "path to the folder where input data are located.")
 			("working_data_folder,W", boost::program_options::value<boost::filesystem::path>(&working_data_folder)->default_value(""), "path to the folder where data are processed.")
 			("ann_count,N", boost::program_options::value<unsigned int>(&ann_count)->default_value(1), "amount of networks to train.")
+			("concurrent_ann_count", boost::program_options::value<unsigned int>(&concurrent_ann_count)->default_value(1), "amount of networks to train concurrently, reading training data once per epoch for all of them and splitting computing resources between them.")
+			("data_parallel_worker_count", boost::program_options::value<unsigned int>(&data_parallel_worker_count)->default_value(1), "amount of worker processes training the same networks on their own partitions of training data, summing gradients with ring all-reduce.")
+			("data_parallel_worker_id", boost::program_options::value<unsigned int>(&data_parallel_worker_id)->default_value(0), "ID of this worker process in data-parallel training, worker 0 saves the networks trained.")
+			("data_parallel_endpoint", boost::program_options::value<std::string>(&data_parallel_endpoint)->default_value("tcp:127.0.0.1:19370"), "endpoint worker processes listen on in data-parallel training, tcp:<host>:<base_port> or unix:<path_prefix>, worker ID is added to the port or appended to the path.")
 			("training_epoch_count,E", boost::program_options::value<unsigned int>(&training_epoch_count)->default_value(50), "amount of epochs to perform during single ANN training.")
 			("snapshot_count", boost::program_options::value<unsigned int>(&snapshot_count)->default_value(100), "amount of snapshots to generate.")
 			("snapshot_extension", boost::program_options::value<std::string>(&snapshot_extension)->default_value("jpg"), "Extension (type) of the files for neuron values snapshots stored as images.")
@@ -215,13 +240,39 @@ namespace nnforge
 			("check_gradient_weights", boost::program_options::value<std::string>(&check_gradient_weights)->default_value("::"), "The set of weights to check for gradient, in the form Layer:WeightSet:WeightID.")
 			("check_gradient_threshold", boost::program_options::value<float>(&check_gradient_threshold)->default_value(1.05F), "Threshold for gradient check.")
 			("check_gradient_base_step", boost::program_options::value<float>(&check_gradient_base_step)->default_value(1.0e-3F), "Base step size for gradient check.")
-			("training_algo", boost::program_options::value<std::string>(&training_algo)->default_value("sgd"), "Training algorithm (sgd).")
+			("training_algo", boost::program_options::value<std::string>(&training_algo)->default_value("sgd"), "Training algorithm (sgd, hogwild, ssp).")
+			("hogwild_worker_count", boost::program_options::value<unsigned int>(&hogwild_worker_count)->default_value(0), "The number of workers updating weights asynchronously with hogwild training algo, 0 means the backend chooses it.")
+			("ps_endpoint", boost::program_options::value<std::string>(&ps_endpoint)->default_value("tcp:127.0.0.1:19470"), "endpoint parameter server shards listen on with ssp training algo, tcp:<host>:<base_port> or unix:<path_prefix>, shard ID is added to the port or appended to the path.")
+			("ps_shard_count", boost::program_options::value<unsigned int>(&ps_shard_count)->default_value(1), "The number of parameter server shards, layers are distributed between them round-robin.")
+			("ps_shard_id", boost::program_options::value<unsigned int>(&ps_shard_id)->default_value(0), "ID of the shard run by parameter_server action.")
+			("ps_worker_count", boost::program_options::value<unsigned int>(&ps_worker_count)->default_value(1), "The number of worker processes training with parameter server on their own partitions of training data.")
+			("ps_worker_id", boost::program_options::value<unsigned int>(&ps_worker_id)->default_value(0), "ID of this worker process in training with parameter server, worker 0 starts networks on the server and saves the networks trained.")
+			("ps_staleness", boost::program_options::value<unsigned int>(&ps_staleness)->default_value(2), "The number of pushes the worker might be ahead of the slowest one with ssp training algo, 0 makes training bulk-synchronous.")
+			("ps_push_batch_count", boost::program_options::value<unsigned int>(&ps_push_batch_count)->default_value(4), "The number of batches the worker trains locally before pushing the delta to parameter server.")
+			("ps_delta_threshold", boost::program_options::value<float>(&ps_delta_threshold)->default_value(0.0F), "Delta elements with smaller magnitude are accumulated by the worker instead of being pushed, 0 pushes deltas dense.")
 			("dump_resume", boost::program_options::value<bool>(&dump_resume)->default_value(true), "Dump neural network data after each epoch.")
 			("load_resume,R", boost::program_options::value<bool>(&load_resume)->default_value(false), "Resume neural network training strating from saved.")
 			("epoch_count_in_training_set", boost::program_options::value<unsigned int>(&epoch_count_in_training_set)->default_value(1), "The whole should be split in this amount of epochs.")
 			("weight_decay", boost::program_options::value<float>(&weight_decay)->default_value(0.0F), "Weight decay.")
 			("batch_size,B", boost::program_options::value<unsigned int>(&batch_size)->default_value(1), "Training mini-batch size.")
 			("momentum,M", boost::program_options::value<float>(&momentum)->default_value(0.0F), "Momentum in training.")
+			("transform_thread_count", boost::program_options::value<unsigned int>(&transform_thread_count)->default_value(0), "The number of threads applying input data transformers for training, 0 means transforming on the reading thread.")
+			("transform_queue_size", boost::program_options::value<unsigned int>(&transform_queue_size)->default_value(256), "The number of training entries read and transformed ahead when transforming with threads.")
+			("transform_seed", boost::program_options::value<unsigned int>(&transform_seed)->default_value(0), "Seed for random generators of input data transformers when transforming with threads, 0 means random seed.")
+			("epoch_shuffle_block_size", boost::program_options::value<unsigned int>(&epoch_shuffle_block_size)->default_value(0), "Training data are read in new random order each epoch, in blocks of this many contiguous entries, 0 reads them in the order randomize_data wrote them.")
+			("epoch_shuffle_window_block_count", boost::program_options::value<unsigned int>(&epoch_shuffle_window_block_count)->default_value(16), "The number of blocks entries are shuffled between when reading training data in new order each epoch.")
+			("shuffle_memory_size", boost::program_options::value<float>(&shuffle_memory_size)->default_value(data_writer::default_max_memory_megabytes), "Memory in MB randomize_data shuffles entries in, larger data sets are shuffled through temporary bucket files in working data folder.")
+			("mapped_data_files", boost::program_options::value<bool>(&mapped_data_files)->default_value(false), "Map training data files into memory instead of reading them through streams.")
+			("compress_block_entry_count", boost::program_options::value<unsigned int>(&compress_block_entry_count)->default_value(supervised_compressed_data_stream_writer::default_block_entry_count), "The number of entries compress_data groups into each compressed block.")
+			("decompression_thread_count", boost::program_options::value<unsigned int>(&decompression_thread_count)->default_value(2), "The number of threads decompressing blocks of compressed data files ahead of reading.")
+			("training_data_shards", boost::program_options::value<std::string>(&training_data_shards)->default_value(""), "Read training data from shards instead of the randomized training data file: name of the manifest file listing shard files or file name pattern with * and ? wildcards, relative to working data folder.")
+			("validating_data_shards", boost::program_options::value<std::string>(&validating_data_shards)->default_value(""), "Read validating data from shards instead of the validating data file, see training_data_shards.")
+			("shard_reader_thread_count", boost::program_options::value<unsigned int>(&shard_reader_thread_count)->default_value(4), "The number of threads reading data shards ahead in parallel.")
+			("shard_queue_entry_count", boost::program_options::value<unsigned int>(&shard_queue_entry_count)->default_value(1024), "The number of entries each shard reading thread reads ahead.")
+			("shuffle_shards", boost::program_options::value<bool>(&shuffle_shards)->default_value(true), "Read training data shards in new random order each epoch.")
+			("transformed_data_cache", boost::program_options::value<std::string>(&transformed_data_cache)->default_value("none"), "Cache training data transformed with leading deterministic input data transformers across epochs (none, memory, file).")
+			("normalizer_thread_count", boost::program_options::value<unsigned int>(&normalizer_thread_count)->default_value(0), "The number of threads computing statistics for generate_input_normalizer and generate_output_normalizer, 0 means the number of hardware threads.")
+			("normalizer_sample_entry_count", boost::program_options::value<unsigned int>(&normalizer_sample_entry_count)->default_value(0), "Compute statistics for normalizers over this many randomly chosen entries, 0 means all the entries.")
 			;
 
 		{
@@ -360,6 +411,10 @@ namespace nnforge
 			std::cout << "input_data_folder" << "=" << input_data_folder << std::endl;
 			std::cout << "working_data_folder" << "=" << working_data_folder << std::endl;
 			std::cout << "ann_count" << "=" << ann_count << std::endl;
+			std::cout << "concurrent_ann_count" << "=" << concurrent_ann_count << std::endl;
+			std::cout << "data_parallel_worker_count" << "=" << data_parallel_worker_count << std::endl;
+			std::cout << "data_parallel_worker_id" << "=" << data_parallel_worker_id << std::endl;
+			std::cout << "data_parallel_endpoint" << "=" << data_parallel_endpoint << std::endl;
 			std::cout << "training_epoch_count" << "=" << training_epoch_count << std::endl;
 			std::cout << "snapshot_count" << "=" << snapshot_count << std::endl;
 			std::cout << "snapshot_extension" << "=" << snapshot_extension << std::endl;
@@ -381,12 +436,38 @@ namespace nnforge
 			std::cout << "check_gradient_threshold" << "=" << check_gradient_threshold << std::endl;
 			std::cout << "check_gradient_base_step" << "=" << check_gradient_base_step << std::endl;
 			std::cout << "training_algo" << "=" << training_algo << std::endl;
+			std::cout << "hogwild_worker_count" << "=" << hogwild_worker_count << std::endl;
+			std::cout << "ps_endpoint" << "=" << ps_endpoint << std::endl;
+			std::cout << "ps_shard_count" << "=" << ps_shard_count << std::endl;
+			std::cout << "ps_shard_id" << "=" << ps_shard_id << std::endl;
+			std::cout << "ps_worker_count" << "=" << ps_worker_count << std::endl;
+			std::cout << "ps_worker_id" << "=" << ps_worker_id << std::endl;
+			std::cout << "ps_staleness" << "=" << ps_staleness << std::endl;
+			std::cout << "ps_push_batch_count" << "=" << ps_push_batch_count << std::endl;
+			std::cout << "ps_delta_threshold" << "=" << ps_delta_threshold << std::endl;
 			std::cout << "dump_resume" << "=" << dump_resume << std::endl;
 			std::cout << "load_resume" << "=" << load_resume << std::endl;
 			std::cout << "epoch_count_in_training_set" << "=" << epoch_count_in_training_set << std::endl;
 			std::cout << "weight_decay" << "=" << weight_decay << std::endl;
 			std::cout << "batch_size" << "=" << batch_size << std::endl;
 			std::cout << "momentum" << "=" << momentum << std::endl;
+			std::cout << "transform_thread_count" << "=" << transform_thread_count << std::endl;
+			std::cout << "transform_queue_size" << "=" << transform_queue_size << std::endl;
+			std::cout << "transform_seed" << "=" << transform_seed << std::endl;
+			std::cout << "epoch_shuffle_block_size" << "=" << epoch_shuffle_block_size << std::endl;
+			std::cout << "epoch_shuffle_window_block_count" << "=" << epoch_shuffle_window_block_count << std::endl;
+			std::cout << "shuffle_memory_size" << "=" << shuffle_memory_size << std::endl;
+			std::cout << "mapped_data_files" << "=" << mapped_data_files << std::endl;
+			std::cout << "compress_block_entry_count" << "=" << compress_block_entry_count << std::endl;
+			std::cout << "decompression_thread_count" << "=" << decompression_thread_count << std::endl;
+			std::cout << "training_data_shards" << "=" << training_data_shards << std::endl;
+			std::cout << "validating_data_shards" << "=" << validating_data_shards << std::endl;
+			std::cout << "shard_reader_thread_count" << "=" << shard_reader_thread_count << std::endl;
+			std::cout << "shard_queue_entry_count" << "=" << shard_queue_entry_count << std::endl;
+			std::cout << "shuffle_shards" << "=" << shuffle_shards << std::endl;
+			std::cout << "transformed_data_cache" << "=" << transformed_data_cache << std::endl;
+			std::cout << "normalizer_thread_count" << "=" << normalizer_thread_count << std::endl;
+			std::cout << "normalizer_sample_entry_count" << "=" << normalizer_sample_entry_count << std::endl;
 		}
 		{
 			std::vector<string_option> additional_string_options = get_string_options();
@@ -468,13 +549,27 @@ namespace nnforge
 		return ann_subfolder_name;
 	}
 
-	network_trainer_smart_ptr neural_network_toolset::get_network_trainer(network_schema_smart_ptr schema) const
+	network_trainer_smart_ptr neural_network_toolset::get_network_trainer(
+		network_schema_smart_ptr schema,
+		unsigned int concurrent_id,
+		unsigned int concurrent_count) const
 	{
 		network_trainer_smart_ptr res;
 
-		network_updater_smart_ptr updater = updater_factory->create(
-			schema,
-			get_error_function());
+		network_updater_smart_ptr updater;
+		if (concurrent_count > 1)
+			updater = updater_factory->create_concurrent(
+				schema,
+				get_error_function(),
+				concurrent_id,
+				concurrent_count);
+		else
+			updater = updater_factory->create(
+				schema,
+				get_error_function());
+
+		if (all_reducer)
+			updater->set_all_reducer(all_reducer);
 
 		if (training_algo == "sgd")
 		{
@@ -485,6 +580,28 @@ namespace nnforge
 
 			res = typed_res;
 		}
+		else if (training_algo == "hogwild")
+		{
+			network_trainer_hogwild_smart_ptr typed_res(
+				new network_trainer_hogwild(
+					schema,
+					updater,
+					hogwild_worker_count));
+
+			res = typed_res;
+		}
+		else if (training_algo == "ssp")
+		{
+			network_trainer_ssp_smart_ptr typed_res(
+				new network_trainer_ssp(
+					schema,
+					updater,
+					ps_client,
+					ps_staleness,
+					ps_push_batch_count));
+
+			res = typed_res;
+		}
 		else
 			throw neural_network_exception((boost::format("Unknown training algo specified: %1%") % training_algo).str());
 
@@ -524,25 +641,62 @@ namespace nnforge
 		else throw std::runtime_error((boost::format("Unknown data set for taking snapshots: %1%") % snapshot_data_set).str());
 	}
 
-	supervised_data_reader_smart_ptr neural_network_toolset::get_original_training_data_reader(const boost::filesystem::path& path) const
+	supervised_data_reader_smart_ptr neural_network_toolset::get_supervised_data_stream_reader(
+		const boost::filesystem::path& path,
+		bool allow_mapping) const
 	{
 		nnforge_shared_ptr<std::istream> in(new boost::filesystem::ifstream(path, std::ios_base::in | std::ios_base::binary));
+		if (supervised_compressed_data_stream_reader::is_compressed(*in))
+			return supervised_data_reader_smart_ptr(new supervised_compressed_data_stream_reader(in, decompression_thread_count));
+
+		if (allow_mapping && mapped_data_files)
+		{
+			in.reset();
+			return supervised_data_reader_smart_ptr(new supervised_data_mapped_reader(path));
+		}
+
 		supervised_data_reader_smart_ptr reader(new supervised_data_stream_reader(in));
 		return reader;
 	}
 
+	supervised_data_reader_smart_ptr neural_network_toolset::get_sharded_data_reader(
+		const std::string& shard_spec,
+		bool shuffle) const
+	{
+		std::vector<boost::filesystem::path> shard_path_list = supervised_sharded_data_reader::get_shard_path_list(get_working_data_folder(), shard_spec);
+
+		// Each shard is read by a single thread, so a single decompression thread per compressed shard keeps up with it
+		std::vector<supervised_data_reader_smart_ptr> shard_reader_list;
+		for(std::vector<boost::filesystem::path>::const_iterator it = shard_path_list.begin(); it != shard_path_list.end(); ++it)
+		{
+			nnforge_shared_ptr<std::istream> in(new boost::filesystem::ifstream(*it, std::ios_base::in | std::ios_base::binary));
+			if (supervised_compressed_data_stream_reader::is_compressed(*in))
+				shard_reader_list.push_back(supervised_data_reader_smart_ptr(new supervised_compressed_data_stream_reader(in, 1)));
+			else
+				shard_reader_list.push_back(supervised_data_reader_smart_ptr(new supervised_data_stream_reader(in)));
+		}
+
+		unsigned int seed = static_cast<unsigned int>(rnd::get_random_generator()());
+		return supervised_data_reader_smart_ptr(new supervised_sharded_data_reader(shard_reader_list, shard_reader_thread_count, shard_queue_entry_count, shuffle, seed));
+	}
+
+	supervised_data_reader_smart_ptr neural_network_toolset::get_original_training_data_reader(const boost::filesystem::path& path) const
+	{
+		return get_supervised_data_stream_reader(path, true);
+	}
+
 	data_writer_smart_ptr neural_network_toolset::get_randomized_training_data_writer(
 		supervised_data_reader& reader,
 		const boost::filesystem::path& path) const
 	{
 		nnforge_shared_ptr<std::ostream> out(new boost::filesystem::ofstream(path, std::ios_base::out | std::ios_base::binary | std::ios_base::trunc));
-		supervised_data_stream_reader& typed_reader = dynamic_cast<supervised_data_stream_reader&>(reader);
 		data_writer_smart_ptr writer(
 			new supervised_data_stream_writer(
 				out,
-				typed_reader.get_input_configuration(),
-				typed_reader.get_output_configuration(),
-				typed_reader.get_input_type()));
+				reader.get_input_configuration(),
+				reader.get_output_configuration(),
+				reader.get_input_type(),
+				reader.get_input_mul_add_list()));
 		return writer;
 	}
 
@@ -560,14 +714,54 @@ namespace nnforge
 		{
 		case network_output_type::type_classifier:
 		case network_output_type::type_roc:
-			writer->write_randomized_classifier(*reader);
+			writer->write_randomized_classifier(*reader, shuffle_memory_size, get_working_data_folder());
 			break;
 		default:
-			writer->write_randomized(*reader);
+			writer->write_randomized(*reader, shuffle_memory_size, get_working_data_folder());
 			break;
 		}
 	}
 
+	void neural_network_toolset::compress_data()
+	{
+		const char * data_filename_list[] = {training_data_filename, training_randomized_data_filename, validating_data_filename, testing_data_filename};
+		for(unsigned int i = 0; i < sizeof(data_filename_list) / sizeof(data_filename_list[0]); ++i)
+		{
+			boost::filesystem::path file_path = get_working_data_folder() / data_filename_list[i];
+			if (!boost::filesystem::exists(file_path))
+				continue;
+
+			boost::filesystem::path compressed_file_path = file_path;
+			compressed_file_path += ".tmp";
+			{
+				supervised_data_reader_smart_ptr reader = get_supervised_data_stream_reader(file_path, false);
+				if (dynamic_cast<supervised_compressed_data_stream_reader *>(reader.get()) != 0)
+				{
+					std::cout << file_path.filename().string() << " is compressed already" << std::endl;
+					continue;
+				}
+
+				std::cout << "Compressing " << reader->get_entry_count() << " entries of " << file_path.filename().string() << std::endl;
+
+				nnforge_shared_ptr<std::ostream> out(new boost::filesystem::ofstream(compressed_file_path, std::ios_base::out | std::ios_base::binary | std::ios_base::trunc));
+				supervised_compressed_data_stream_writer writer(
+					out,
+					reader->get_input_configuration(),
+					reader->get_output_configuration(),
+					reader->get_input_type(),
+					compress_block_entry_count,
+					reader->get_input_mul_add_list());
+
+				std::vector<unsigned char> entry_data;
+				while (reader->raw_read(entry_data))
+					writer.raw_write(&(*entry_data.begin()), entry_data.size());
+			}
+
+			std::cout << (boost::format("%1% bytes compressed to %2% bytes") % boost::filesystem::file_size(file_path) % boost::filesystem::file_size(compressed_file_path)) << std::endl;
+			boost::filesystem::rename(compressed_file_path, file_path);
+		}
+	}
+
 	void neural_network_toolset::create()
 	{
 		network_schema_smart_ptr schema = get_schema();
@@ -657,6 +851,9 @@ namespace nnforge
 			}
 		}
 
+		if (tester->get_memory_usage_stat())
+			std::cout << *tester->get_memory_usage_stat() << std::endl;
+
 		return predicted_neuron_value_set_list;
 	}
 
@@ -756,10 +953,10 @@ namespace nnforge
 	{
 		nnforge::supervised_data_reader_smart_ptr reader = get_initial_data_reader_for_normalizing();;
 
-		std::vector<nnforge::feature_map_data_stat> feature_map_data_stat_list = reader->get_feature_map_input_data_stat_list();
-		unsigned int feature_map_id = 0;
-		for(std::vector<nnforge::feature_map_data_stat>::const_iterator it = feature_map_data_stat_list.begin(); it != feature_map_data_stat_list.end(); ++it, ++feature_map_id)
-			std::cout << "Feature map # " << feature_map_id << ": " << *it << std::endl;
+		std::vector<float> average_confidence_list;
+		unsigned int thread_count = (normalizer_thread_count > 0) ? normalizer_thread_count : std::max(boost::thread::hardware_concurrency(), 1U);
+		std::vector<nnforge::feature_map_data_stat> feature_map_data_stat_list = reader->get_feature_map_input_data_stat_list(thread_count, normalizer_sample_entry_count, &average_confidence_list);
+		dump_feature_map_data_stat_list(feature_map_data_stat_list, average_confidence_list, (normalizer_sample_entry_count < reader->get_entry_count()) ? normalizer_sample_entry_count : 0);
 
 		normalize_data_transformer normalizer(feature_map_data_stat_list);
 
@@ -771,10 +968,10 @@ namespace nnforge
 	{
 		nnforge::supervised_data_reader_smart_ptr reader = get_initial_data_reader_for_normalizing();;
 
-		std::vector<nnforge::feature_map_data_stat> feature_map_data_stat_list = reader->get_feature_map_output_data_stat_list();
-		unsigned int feature_map_id = 0;
-		for(std::vector<nnforge::feature_map_data_stat>::const_iterator it = feature_map_data_stat_list.begin(); it != feature_map_data_stat_list.end(); ++it, ++feature_map_id)
-			std::cout << "Feature map # " << feature_map_id << ": " << *it << std::endl;
+		std::vector<float> average_confidence_list;
+		unsigned int thread_count = (normalizer_thread_count > 0) ? normalizer_thread_count : std::max(boost::thread::hardware_concurrency(), 1U);
+		std::vector<nnforge::feature_map_data_stat> feature_map_data_stat_list = reader->get_feature_map_output_data_stat_list(thread_count, normalizer_sample_entry_count, &average_confidence_list);
+		dump_feature_map_data_stat_list(feature_map_data_stat_list, average_confidence_list, (normalizer_sample_entry_count < reader->get_entry_count()) ? normalizer_sample_entry_count : 0);
 
 		normalize_data_transformer normalizer(feature_map_data_stat_list);
 
@@ -782,6 +979,25 @@ namespace nnforge
 		normalizer.write(file_with_schema);
 	}
 
+	void neural_network_toolset::dump_feature_map_data_stat_list(
+		const std::vector<feature_map_data_stat>& feature_map_data_stat_list,
+		const std::vector<float>& average_confidence_list,
+		unsigned int sampled_entry_count) const
+	{
+		bool sampled = (sampled_entry_count > 0);
+		if (sampled)
+			std::cout << "Statistics computed over " << sampled_entry_count << " randomly chosen entries" << std::endl;
+
+		unsigned int feature_map_id = 0;
+		for(std::vector<nnforge::feature_map_data_stat>::const_iterator it = feature_map_data_stat_list.begin(); it != feature_map_data_stat_list.end(); ++it, ++feature_map_id)
+		{
+			std::cout << "Feature map # " << feature_map_id << ": " << *it;
+			if (sampled)
+				std::cout << ", Average 95% confidence +/- " << average_confidence_list[feature_map_id];
+			std::cout << std::endl;
+		}
+	}
+
 	normalize_data_transformer_smart_ptr neural_network_toolset::get_input_data_normalize_transformer() const
 	{
 		boost::filesystem::path normalizer_filepath = get_working_data_folder() / normalizer_input_filename;
@@ -1296,6 +1512,67 @@ namespace nnforge
 	supervised_data_reader_smart_ptr neural_network_toolset::get_data_reader_for_training(bool deterministic_transformers_only) const
 	{
 		supervised_data_reader_smart_ptr current_reader = get_initial_data_reader_for_training();
+		std::string cache_key = get_training_data_cache_key();
+
+		if (data_parallel_worker_count > 1)
+		{
+			supervised_data_reader_smart_ptr new_reader(new supervised_partitioned_data_reader(current_reader, data_parallel_worker_id, data_parallel_worker_count));
+			current_reader = new_reader;
+			cache_key += (boost::format("\npartition %1% of %2%") % data_parallel_worker_id % data_parallel_worker_count).str();
+		}
+		else if ((training_algo == "ssp") && (ps_worker_count > 1))
+		{
+			supervised_data_reader_smart_ptr new_reader(new supervised_partitioned_data_reader(current_reader, ps_worker_id, ps_worker_count));
+			current_reader = new_reader;
+			cache_key += (boost::format("\npartition %1% of %2%") % ps_worker_id % ps_worker_count).str();
+		}
+
+		std::vector<data_transformer_smart_ptr> input_data_transformer_list = get_input_data_transformer_list_for_training();
+		std::vector<data_transformer_smart_ptr>::const_iterator uncached_input_data_transformer_it = input_data_transformer_list.begin();
+		// Deterministic transformers transform each entry on its own, so the leading ones are applied and cached before entries are reordered.
+		// Shards reshuffled each epoch are not cached as the cache would keep the order of the first epoch
+		if ((transformed_data_cache != "none") && (training_data_shards.empty() || (!shuffle_shards)))
+		{
+			if ((transformed_data_cache != "memory") && (transformed_data_cache != "file"))
+				throw std::runtime_error((boost::format("Unknown transformed_data_cache: %1%") % transformed_data_cache).str());
+
+			for(; uncached_input_data_transformer_it != input_data_transformer_list.end(); ++uncached_input_data_transformer_it)
+			{
+				const data_transformer& transformer = **uncached_input_data_transformer_it;
+				std::string transformer_cache_key = transformer.get_cache_key();
+				if ((!transformer.is_deterministic()) || (transformer.get_sample_count() != 1) || transformer_cache_key.empty())
+					break;
+
+				supervised_data_reader_smart_ptr new_reader(new supervised_transformed_input_data_reader(current_reader, *uncached_input_data_transformer_it));
+				current_reader = new_reader;
+				cache_key += "\n" + transformer_cache_key;
+			}
+
+			if (uncached_input_data_transformer_it != input_data_transformer_list.begin())
+			{
+				boost::filesystem::path cache_file_path;
+				if (transformed_data_cache == "file")
+				{
+					std::string cache_file_name = training_transformed_cache_filename;
+					if (data_parallel_worker_count > 1)
+						cache_file_name = (boost::format("%1%.%2%") % cache_file_name % data_parallel_worker_id).str();
+					else if ((training_algo == "ssp") && (ps_worker_count > 1))
+						cache_file_name = (boost::format("%1%.%2%") % cache_file_name % ps_worker_id).str();
+					cache_file_path = get_working_data_folder() / cache_file_name;
+				}
+
+				supervised_data_reader_smart_ptr new_reader(new supervised_cached_data_reader(current_reader, cache_key, cache_file_path));
+				current_reader = new_reader;
+			}
+		}
+
+		// Each worker reshuffles its own partition
+		if (epoch_shuffle_block_size > 0)
+		{
+			unsigned int seed = static_cast<unsigned int>(rnd::get_random_generator()());
+			supervised_data_reader_smart_ptr new_reader(new supervised_shuffled_data_reader(current_reader, epoch_shuffle_block_size, epoch_shuffle_window_block_count, seed));
+			current_reader = new_reader;
+		}
 
 		unsigned int epoch_count = epoch_count_in_training_set;
 		if (epoch_count > 1)
@@ -1305,10 +1582,27 @@ namespace nnforge
 		}
 
 		{
-			std::vector<data_transformer_smart_ptr> data_transformer_list = get_input_data_transformer_list_for_training();
-			for(std::vector<data_transformer_smart_ptr>::iterator it = data_transformer_list.begin(); it != data_transformer_list.end(); ++it)
+			std::vector<data_transformer_smart_ptr> data_transformer_list;
+			for(std::vector<data_transformer_smart_ptr>::const_iterator it = uncached_input_data_transformer_it; it != input_data_transformer_list.end(); ++it)
 			{
 				if ((!deterministic_transformers_only) || (*it)->is_deterministic())
+					data_transformer_list.push_back(*it);
+			}
+
+			if ((transform_thread_count > 0) && (!data_transformer_list.empty()))
+			{
+				unsigned int seed = (transform_seed != 0) ? transform_seed : static_cast<unsigned int>(rnd::get_random_generator()());
+				supervised_data_reader_smart_ptr new_reader(new supervised_parallel_transformed_input_data_reader(
+					current_reader,
+					data_transformer_list,
+					transform_thread_count,
+					transform_queue_size,
+					seed));
+				current_reader = new_reader;
+			}
+			else
+			{
+				for(std::vector<data_transformer_smart_ptr>::iterator it = data_transformer_list.begin(); it != data_transformer_list.end(); ++it)
 				{
 					supervised_data_reader_smart_ptr new_reader(new supervised_transformed_input_data_reader(current_reader, *it));
 					current_reader = new_reader;
@@ -1331,16 +1625,31 @@ namespace nnforge
 
 	supervised_data_reader_smart_ptr neural_network_toolset::get_initial_data_reader_for_training() const
 	{
-		nnforge_shared_ptr<std::istream> training_data_stream(new boost::filesystem::ifstream(get_working_data_folder() / training_randomized_data_filename, std::ios_base::in | std::ios_base::binary));
-		supervised_data_reader_smart_ptr current_reader(new supervised_data_stream_reader(training_data_stream));
-		return current_reader;
+		if (!training_data_shards.empty())
+			return get_sharded_data_reader(training_data_shards, shuffle_shards);
+
+		return get_supervised_data_stream_reader(get_working_data_folder() / training_randomized_data_filename, true);
+	}
+
+	std::string neural_network_toolset::get_training_data_cache_key() const
+	{
+		if (!training_data_shards.empty())
+		{
+			// Shards regenerated under the same spec invalidate the cache
+			std::string res = "shards " + training_data_shards;
+			std::vector<boost::filesystem::path> shard_path_list = supervised_sharded_data_reader::get_shard_path_list(get_working_data_folder(), training_data_shards);
+			for(std::vector<boost::filesystem::path>::const_iterator it = shard_path_list.begin(); it != shard_path_list.end(); ++it)
+				res += (boost::format("\n%1% %2% %3%") % it->string() % boost::filesystem::file_size(*it) % boost::filesystem::last_write_time(*it)).str();
+			return res;
+		}
+
+		boost::filesystem::path file_path = get_working_data_folder() / training_randomized_data_filename;
+		return (boost::format("%1% %2% %3%") % file_path.string() % boost::filesystem::file_size(file_path) % boost::filesystem::last_write_time(file_path)).str();
 	}
 
 	supervised_data_reader_smart_ptr neural_network_toolset::get_initial_data_reader_for_normalizing() const
 	{
-		nnforge_shared_ptr<std::istream> training_data_stream(new boost::filesystem::ifstream(get_working_data_folder() / training_data_filename, std::ios_base::in | std::ios_base::binary));
-		supervised_data_reader_smart_ptr current_reader(new supervised_data_stream_reader(training_data_stream));
-		return current_reader;
+		return get_supervised_data_stream_reader(get_working_data_folder() / training_data_filename, false);
 	}
 
 	std::pair<supervised_data_reader_smart_ptr, unsigned int> neural_network_toolset::get_data_reader_for_validating_and_sample_count() const
@@ -1372,9 +1681,10 @@ namespace nnforge
 
 	supervised_data_reader_smart_ptr neural_network_toolset::get_initial_data_reader_for_validating() const
 	{
-		nnforge_shared_ptr<std::istream> validating_data_stream(new boost::filesystem::ifstream(get_working_data_folder() / validating_data_filename, std::ios_base::in | std::ios_base::binary));
-		supervised_data_reader_smart_ptr current_reader(new supervised_data_stream_reader(validating_data_stream));
-		return current_reader;
+		if (!validating_data_shards.empty())
+			return get_sharded_data_reader(validating_data_shards, false);
+
+		return get_supervised_data_stream_reader(get_working_data_folder() / validating_data_filename, false);
 	}
 
 	std::pair<supervised_data_reader_smart_ptr, unsigned int> neural_network_toolset::get_data_reader_for_testing_supervised_and_sample_count() const
@@ -1405,9 +1715,7 @@ namespace nnforge
 
 	supervised_data_reader_smart_ptr neural_network_toolset::get_initial_data_reader_for_testing_supervised() const
 	{
-		nnforge_shared_ptr<std::istream> testing_data_stream(new boost::filesystem::ifstream(get_working_data_folder() / testing_data_filename, std::ios_base::in | std::ios_base::binary));
-		supervised_data_reader_smart_ptr current_reader(new supervised_data_stream_reader(testing_data_stream));
-		return current_reader;
+		return get_supervised_data_stream_reader(get_working_data_folder() / testing_data_filename, false);
 	}
 
 	std::pair<unsupervised_data_reader_smart_ptr, unsigned int> neural_network_toolset::get_data_reader_for_testing_unsupervised_and_sample_count() const
@@ -1442,7 +1750,27 @@ namespace nnforge
 			schema->read(in);
 		}
 
-		network_trainer_smart_ptr trainer = get_network_trainer(schema);
+		if (data_parallel_worker_count > 1)
+		{
+			if (concurrent_ann_count > 1)
+				throw neural_network_exception("Data-parallel training cannot be combined with concurrent training of several networks");
+			all_reducer = ring_all_reducer_smart_ptr(new ring_all_reducer(data_parallel_endpoint, data_parallel_worker_id, data_parallel_worker_count));
+		}
+		if (training_algo == "ssp")
+		{
+			if ((concurrent_ann_count > 1) || (data_parallel_worker_count > 1))
+				throw neural_network_exception("Training with parameter server cannot be combined with concurrent or data-parallel training");
+			if (ps_worker_id >= ps_worker_count)
+				throw neural_network_exception((boost::format("Invalid parameter server worker %1% of %2%") % ps_worker_id % ps_worker_count).str());
+			ps_client = parameter_server_client_smart_ptr(new parameter_server_client(ps_endpoint, ps_shard_count, ps_worker_id, ps_delta_threshold));
+		}
+		// Networks trained are identical on all the workers, only worker 0 saves and validates them
+		bool is_main_worker = (data_parallel_worker_id == 0) && ((training_algo != "ssp") || (ps_worker_id == 0));
+
+		std::vector<network_trainer_smart_ptr> trainer_list;
+		unsigned int trainer_count = std::max(concurrent_ann_count, 1U);
+		for(unsigned int trainer_id = 0; trainer_id < trainer_count; ++trainer_id)
+			trainer_list.push_back(get_network_trainer(schema, trainer_id, trainer_count));
 
 		supervised_data_reader_smart_ptr training_data_reader = get_data_reader_for_training();
 
@@ -1464,23 +1792,45 @@ namespace nnforge
 
 		complex_network_data_pusher progress;
 
-		if (dump_resume)
+		if (dump_resume && is_main_worker)
 		{
 			progress.push_back(network_data_pusher_smart_ptr(new save_resume_network_data_pusher(batch_resume_folder)));
 		}
 
 		progress.push_back(network_data_pusher_smart_ptr(new report_progress_network_data_pusher()));
 
-		std::vector<network_data_pusher_smart_ptr> validators_for_training = get_validators_for_training(schema);
-		progress.insert(progress.end(), validators_for_training.begin(), validators_for_training.end());
+		if (is_main_worker)
+		{
+			std::vector<network_data_pusher_smart_ptr> validators_for_training = get_validators_for_training(schema);
+			progress.insert(progress.end(), validators_for_training.begin(), validators_for_training.end());
+		}
 
-		summarize_network_data_pusher res(batch_folder);
+		summarize_network_data_pusher summarize_res(batch_folder);
+		complex_network_data_pusher worker_res;
+		network_data_pusher& res = is_main_worker ? static_cast<network_data_pusher&>(summarize_res) : static_cast<network_data_pusher&>(worker_res);
 
-		trainer->train(
-			*training_data_reader,
-			*peeker,
-			progress,
-			res);
+		if (trainer_list.size() > 1)
+			network_trainer::train_concurrently(
+				trainer_list,
+				*training_data_reader,
+				*peeker,
+				progress,
+				res);
+		else
+			trainer_list.front()->train(
+				*training_data_reader,
+				*peeker,
+				progress,
+				res);
+
+		// Parameter server shards stop once all the workers disconnect
+		ps_client.reset();
+	}
+
+	void neural_network_toolset::run_parameter_server()
+	{
+		parameter_server server(ps_endpoint, ps_shard_id, ps_shard_count, ps_worker_count);
+		server.run();
 	}
 
 	void neural_network_toolset::profile_updater()
@@ -1550,6 +1900,14 @@ namespace nnforge
 			std::cout << (boost::format("%|1$.1f| GFLOPs, %|2$.2f| seconds") % gflops % time_to_complete_seconds) << std::endl;
 		}
 
+		const_memory_usage_stat_smart_ptr memory_usage = updater->get_memory_usage_stat();
+		if (memory_usage)
+		{
+			std::cout << *memory_usage << std::endl;
+			boost::filesystem::ofstream memory_usage_file(get_working_data_folder() / profile_updater_memory_usage_filename, std::ios_base::out | std::ios_base::trunc);
+			memory_usage->write_csv(memory_usage_file);
+		}
+
 		std::cout << *training_result.second << std::endl;
 
 		std::cout << data->data_list.get_stat() << std::endl;
@@ -33,6 +33,8 @@
 #include "error_function.h"
 #include "network_trainer.h"
 #include "stream_duplicator.h"
+#include "ring_all_reducer.h"
+#include "parameter_server_client.h"
 
 #include <boost/filesystem.hpp>
 
@@ -124,6 +126,25 @@ namespace nnforge
 
 		virtual supervised_data_reader_smart_ptr get_original_training_data_reader(const boost::filesystem::path& path) const;
 
+		// Opens either uncompressed or compressed supervised data file, uncompressed one is mapped if allow_mapping and mapped_data_files are set
+		supervised_data_reader_smart_ptr get_supervised_data_stream_reader(
+			const boost::filesystem::path& path,
+			bool allow_mapping) const;
+
+		// Returns the string identifying the data get_initial_data_reader_for_training reads, used to key the transformed data cache
+		virtual std::string get_training_data_cache_key() const;
+
+		// Prints statistics, along with confidence intervals for averages if they are computed over sampled_entry_count sampled entries
+		void dump_feature_map_data_stat_list(
+			const std::vector<feature_map_data_stat>& feature_map_data_stat_list,
+			const std::vector<float>& average_confidence_list,
+			unsigned int sampled_entry_count) const;
+
+		// Opens shards matched by shard_spec in working data folder as a single reader, see supervised_sharded_data_reader::get_shard_path_list
+		supervised_data_reader_smart_ptr get_sharded_data_reader(
+			const std::string& shard_spec,
+			bool shuffle) const;
+
 		virtual data_writer_smart_ptr get_randomized_training_data_writer(
 			supervised_data_reader& reader,
 			const boost::filesystem::path& path) const;
@@ -145,6 +166,7 @@ namespace nnforge
 	protected:
 		static const char * training_data_filename;
 		static const char * training_randomized_data_filename;
+		static const char * training_transformed_cache_filename;
 		static const char * validating_data_filename;
 		static const char * testing_data_filename;
 		static const char * testing_unsupervised_data_filename;
@@ -159,15 +181,26 @@ namespace nnforge
 		static const char * ann_resume_subfolder_name;
 		static const char * trained_ann_index_extractor_pattern;
 		static const char * logfile_name;
+		static const char * profile_updater_memory_usage_filename;
 
 		network_tester_factory_smart_ptr tester_factory;
 		network_updater_factory_smart_ptr updater_factory;
 		network_analyzer_factory_smart_ptr analyzer_factory;
 
+		// Empty unless training is data-parallel
+		ring_all_reducer_smart_ptr all_reducer;
+
+		// Empty unless training with parameter server
+		parameter_server_client_smart_ptr ps_client;
+
 		std::string action;
 		std::string snapshot_extension;
 		std::string snapshot_extension_video;
 		unsigned int ann_count;
+		unsigned int concurrent_ann_count;
+		unsigned int data_parallel_worker_count;
+		unsigned int data_parallel_worker_id;
+		std::string data_parallel_endpoint;
 		unsigned int training_epoch_count;
 		unsigned int snapshot_count;
 		float learning_rate;
@@ -183,6 +216,15 @@ namespace nnforge
 		std::string snapshot_data_set;
 		unsigned int profile_updater_entry_count;
 		std::string training_algo;
+		unsigned int hogwild_worker_count;
+		std::string ps_endpoint;
+		unsigned int ps_shard_count;
+		unsigned int ps_shard_id;
+		unsigned int ps_worker_count;
+		unsigned int ps_worker_id;
+		unsigned int ps_staleness;
+		unsigned int ps_push_batch_count;
+		float ps_delta_threshold;
 		bool dump_resume;
 		bool load_resume;
 		unsigned int epoch_count_in_training_set;
@@ -190,6 +232,23 @@ namespace nnforge
 		unsigned int snapshot_scale;
 		unsigned int batch_size;
 		float momentum;
+		unsigned int transform_thread_count;
+		unsigned int transform_queue_size;
+		unsigned int transform_seed;
+		unsigned int epoch_shuffle_block_size;
+		unsigned int epoch_shuffle_window_block_count;
+		float shuffle_memory_size;
+		bool mapped_data_files;
+		unsigned int compress_block_entry_count;
+		unsigned int decompression_thread_count;
+		std::string training_data_shards;
+		std::string validating_data_shards;
+		unsigned int shard_reader_thread_count;
+		unsigned int shard_queue_entry_count;
+		bool shuffle_shards;
+		std::string transformed_data_cache;
+		unsigned int normalizer_thread_count;
+		unsigned int normalizer_sample_entry_count;
 		std::string check_gradient_weights;
 		float check_gradient_threshold;
 		float check_gradient_base_step;
@@ -203,6 +262,9 @@ namespace nnforge
 
 		void randomize_data();
 
+		// Converts uncompressed supervised data files in working data folder to compressed ones in place
+		void compress_data();
+
 		void create();
 
 		void generate_input_normalizer();
@@ -234,6 +296,8 @@ namespace nnforge
 
 		void train();
 
+		void run_parameter_server();
+
 		void profile_updater();
 
 		void check_gradient();
@@ -259,7 +323,11 @@ namespace nnforge
 			const std::vector<unsigned int>& location_list,
 			unsigned int feature_map_count) const;
 
-		network_trainer_smart_ptr get_network_trainer(network_schema_smart_ptr schema) const;
+		// Trainer number concurrent_id of concurrent_count ones trained concurrently gets its part of computing resources
+		network_trainer_smart_ptr get_network_trainer(
+			network_schema_smart_ptr schema,
+			unsigned int concurrent_id = 0,
+			unsigned int concurrent_count = 1) const;
 
 		void dump_settings();
 
@@ -18,6 +18,8 @@
 
 #include "neural_network_exception.h"
 #include <boost/format.hpp>
+#include <algorithm>
+#include <cmath>
 
 namespace nnforge
 {
@@ -29,8 +31,102 @@ namespace nnforge
 			return sizeof(unsigned char);
 		case type_float:
 			return sizeof(float);
+		case type_half:
+			return sizeof(unsigned short);
+		case type_uint8_scaled:
+			return sizeof(unsigned char);
 		}
 
 		throw neural_network_exception((boost::format("Unknown input type %1%") % t).str());
 	}
+
+	unsigned short neuron_data_type::float_to_half(float val)
+	{
+		unsigned int bits;
+		memcpy(&bits, &val, sizeof(bits));
+
+		unsigned int sign = (bits >> 16) & 0x8000;
+		unsigned int abs_bits = bits & 0x7FFFFFFF;
+
+		// Infinity and NaN
+		if (abs_bits >= 0x7F800000)
+			return static_cast<unsigned short>(sign | 0x7C00 | ((abs_bits > 0x7F800000) ? 0x200 : 0));
+
+		// Overflow
+		if (abs_bits >= 0x47800000)
+			return static_cast<unsigned short>(sign | 0x7C00);
+
+		unsigned int res;
+		unsigned int remainder;
+		unsigned int halfway;
+		if (abs_bits < 0x38800000)
+		{
+			// Subnormal half, values below half of the smallest one become zero
+			if (abs_bits < 0x33000000)
+				return static_cast<unsigned short>(sign);
+
+			unsigned int mantissa = (abs_bits & 0x7FFFFF) | 0x800000;
+			unsigned int shift = 126 - (abs_bits >> 23);
+			res = mantissa >> shift;
+			remainder = mantissa & ((1U << shift) - 1);
+			halfway = 1U << (shift - 1);
+		}
+		else
+		{
+			res = (abs_bits - ((127 - 15) << 23)) >> 13;
+			remainder = abs_bits & 0x1FFF;
+			halfway = 0x1000;
+		}
+
+		// Carry from mantissa to exponent produces the correct result, infinity included
+		if ((remainder > halfway) || ((remainder == halfway) && ((res & 1) != 0)))
+			++res;
+
+		return static_cast<unsigned short>(sign | res);
+	}
+
+	std::vector<std::pair<float, float> > neuron_data_type::get_uint8_scaled_mul_add_list(const std::vector<std::pair<float, float> >& min_max_list)
+	{
+		std::vector<std::pair<float, float> > res;
+		for(std::vector<std::pair<float, float> >::const_iterator it = min_max_list.begin(); it != min_max_list.end(); ++it)
+			res.push_back(std::make_pair(std::max(it->second - it->first, 0.0F) * (1.0F / 255.0F), it->first));
+
+		return res;
+	}
+
+	unsigned char neuron_data_type::float_to_uint8_scaled(
+		float val,
+		const std::pair<float, float>& mul_add)
+	{
+		if (mul_add.first <= 0.0F)
+			return 0;
+
+		float res = floorf((val - mul_add.second) / mul_add.first + 0.5F);
+		return static_cast<unsigned char>(std::min(std::max(res, 0.0F), 255.0F));
+	}
+
+	void neuron_data_type::write_mul_add_list(
+		std::ostream& binary_stream_to_write_to,
+		const std::vector<std::pair<float, float> >& mul_add_list)
+	{
+		for(std::vector<std::pair<float, float> >::const_iterator it = mul_add_list.begin(); it != mul_add_list.end(); ++it)
+		{
+			binary_stream_to_write_to.write(reinterpret_cast<const char*>(&(it->first)), sizeof(float));
+			binary_stream_to_write_to.write(reinterpret_cast<const char*>(&(it->second)), sizeof(float));
+		}
+	}
+
+	std::vector<std::pair<float, float> > neuron_data_type::read_mul_add_list(
+		std::istream& binary_stream_to_read_from,
+		unsigned int feature_map_count)
+	{
+		std::vector<std::pair<float, float> > res(feature_map_count);
+		for(std::vector<std::pair<float, float> >::iterator it = res.begin(); it != res.end(); ++it)
+		{
+			binary_stream_to_read_from.read(reinterpret_cast<char*>(&(it->first)), sizeof(float));
+			binary_stream_to_read_from.read(reinterpret_cast<char*>(&(it->second)), sizeof(float));
+		}
+
+		return res;
+	}
 }
@@ -17,6 +17,11 @@
 #pragma once
 
 #include <memory>
+#include <vector>
+#include <utility>
+#include <cstring>
+#include <istream>
+#include <ostream>
 
 namespace nnforge
 {
@@ -27,11 +32,61 @@ namespace nnforge
 		{
 			type_unknown = 0,
 			type_byte = 1,
-			type_float = 2
+			type_float = 2,
+			// IEEE 754 half precision float
+			type_half = 3,
+			// Byte per neuron, the value is byte * mult + add with mult and add defined per feature map,
+			// readers and writers keep (mult, add) pairs in the header, see get_uint8_scaled_mul_add_list
+			type_uint8_scaled = 4
 		};
 
 		static size_t get_input_size(input_type t);
 
+		// Rounds to nearest even, values exceeding half range are converted to infinity
+		static unsigned short float_to_half(float val);
+
+		static float half_to_float(unsigned short val)
+		{
+			unsigned int sign = static_cast<unsigned int>(val & 0x8000) << 16;
+			unsigned int exponent = (val >> 10) & 0x1F;
+			unsigned int mantissa = val & 0x3FF;
+			unsigned int bits;
+			if (exponent == 0)
+			{
+				if (mantissa == 0)
+					bits = sign;
+				else
+				{
+					float res = static_cast<float>(mantissa) * (1.0F / 16777216.0F);
+					return (sign != 0) ? -res : res;
+				}
+			}
+			else if (exponent == 0x1F)
+				bits = sign | 0x7F800000 | (mantissa << 13);
+			else
+				bits = sign | ((exponent + (127 - 15)) << 23) | (mantissa << 13);
+
+			float res;
+			memcpy(&res, &bits, sizeof(res));
+			return res;
+		}
+
+		// Returns (mult, add) pairs mapping [min, max] of each feature map to the whole byte range
+		static std::vector<std::pair<float, float> > get_uint8_scaled_mul_add_list(const std::vector<std::pair<float, float> >& min_max_list);
+
+		static unsigned char float_to_uint8_scaled(
+			float val,
+			const std::pair<float, float>& mul_add);
+
+		// Data files keep (mult, add) pairs for type_uint8_scaled right after the type code
+		static void write_mul_add_list(
+			std::ostream& binary_stream_to_write_to,
+			const std::vector<std::pair<float, float> >& mul_add_list);
+
+		static std::vector<std::pair<float, float> > read_mul_add_list(
+			std::istream& binary_stream_to_read_from,
+			unsigned int feature_map_count);
+
 	private:
 		neuron_data_type();
 		neuron_data_type(const neuron_data_type&);
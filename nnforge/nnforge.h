@@ -34,7 +34,14 @@
 #include "neural_network_toolset.h"
 #include "supervised_data_stream_reader.h"
 #include "supervised_data_stream_writer.h"
+#include "supervised_parallel_data_writer.h"
+#include "supervised_compressed_data_stream_reader.h"
+#include "supervised_sharded_data_reader.h"
+#include "supervised_cached_data_reader.h"
+#include "supervised_compressed_data_stream_writer.h"
 #include "varying_data_stream_writer.h"
+#include "varying_data_stream_reader.h"
+#include "supervised_image_data_reader.h"
 #include "varying_data_stream_schema.h"
 #include "unsupervised_data_stream_reader.h"
 #include "unsupervised_data_stream_writer.h"
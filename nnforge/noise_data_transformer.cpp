@@ -60,4 +60,11 @@ namespace nnforge
 	{
 		return false;
 	}
+
+	nnforge_shared_ptr<data_transformer> noise_data_transformer::clone(unsigned int seed) const
+	{
+		nnforge_shared_ptr<noise_data_transformer> res(new noise_data_transformer(*this));
+		res->generator = rnd::get_random_generator(seed);
+		return res;
+	}
 }
@@ -38,6 +38,8 @@ namespace nnforge
 			
 		virtual bool is_deterministic() const;
 
+		virtual nnforge_shared_ptr<data_transformer> clone(unsigned int seed) const;
+
 	protected:
 		bool is_same_sequence_from_reset;
 		random_generator generator;
@@ -150,4 +150,17 @@ namespace nnforge
 	{
 		return true;
 	}
+
+	nnforge_shared_ptr<data_transformer> normalize_data_transformer::clone(unsigned int seed) const
+	{
+		return nnforge_shared_ptr<data_transformer>(new normalize_data_transformer(*this));
+	}
+
+	std::string normalize_data_transformer::get_cache_key() const
+	{
+		std::string res = "normalize";
+		for(std::vector<std::pair<float, float> >::const_iterator it = mul_add_list.begin(); it != mul_add_list.end(); ++it)
+			res += (boost::format(" %|.9g|:%|.9g|") % it->first % it->second).str();
+		return res;
+	}
 }
@@ -56,6 +56,10 @@ namespace nnforge
 
 		virtual bool is_deterministic() const;
 
+		virtual nnforge_shared_ptr<data_transformer> clone(unsigned int seed) const;
+
+		virtual std::string get_cache_key() const;
+
 	public:
 		std::vector<std::pair<float, float> > mul_add_list;
 
@@ -0,0 +1,332 @@
+/*
+ *  Copyright 2011-2014 Maxim Milakov
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+
+#include "parameter_server.h"
+
+#include "neural_network_exception.h"
+
+#include <algorithm>
+#include <functional>
+#include <sstream>
+#include <iostream>
+#include <boost/bind.hpp>
+#include <boost/format.hpp>
+#include <boost/chrono.hpp>
+#include <boost/thread/thread.hpp>
+#include <boost/thread/locks.hpp>
+
+namespace nnforge
+{
+	parameter_server::parameter_server(
+		const std::string& endpoint,
+		unsigned int shard_id,
+		unsigned int shard_count,
+		unsigned int worker_count)
+		: endpoint(endpoint, shard_count)
+		, shard_id(shard_id)
+		, shard_count(shard_count)
+		, worker_count(worker_count)
+		, initialized(false)
+		, task_index(0)
+		, clock_list(worker_count, 0)
+		, finished_list(worker_count, false)
+		, disconnected_list(worker_count, false)
+		, push_count(0)
+		, received_byte_count(0)
+		, stale_wait_seconds(0.0)
+	{
+		if (shard_id >= shard_count)
+			throw neural_network_exception((boost::format("Invalid parameter server shard %1% of %2%") % shard_id % shard_count).str());
+		if (worker_count == 0)
+			throw neural_network_exception("Parameter server cannot serve zero workers");
+	}
+
+	parameter_server::~parameter_server()
+	{
+	}
+
+	void parameter_server::run()
+	{
+		boost::asio::io_service io_service;
+		boost::asio::basic_socket_acceptor<socket_endpoint::protocol> acceptor(io_service);
+		endpoint.listen(acceptor, shard_id);
+
+		std::cout << (boost::format("Parameter server shard %1% of %2% is waiting for %3% workers") % shard_id % shard_count % worker_count) << std::endl;
+
+		std::vector<nnforge_shared_ptr<boost::thread> > thread_list;
+		for(unsigned int i = 0; i < worker_count; ++i)
+		{
+			socket_smart_ptr socket(new socket_endpoint::protocol::socket(io_service));
+			acceptor.accept(*socket);
+			endpoint.set_options(*socket);
+			thread_list.push_back(nnforge_shared_ptr<boost::thread>(new boost::thread(boost::bind(&parameter_server::serve, this, socket))));
+		}
+		acceptor.close();
+		endpoint.unlink(shard_id);
+
+		for(std::vector<nnforge_shared_ptr<boost::thread> >::iterator it = thread_list.begin(); it != thread_list.end(); ++it)
+			(*it)->join();
+
+		if (initialized)
+			report_task_stat();
+
+		if (!error.empty())
+			throw neural_network_exception(error);
+	}
+
+	void parameter_server::serve(socket_smart_ptr socket)
+	{
+		unsigned int worker_id = worker_count;
+		try
+		{
+			message_header header;
+			std::string payload;
+			if (!receive_message(*socket, header, payload) || (header.type != message_hello) || (header.worker_id >= worker_count))
+				throw neural_network_exception("Invalid handshake received from a worker");
+			worker_id = header.worker_id;
+
+			while (receive_message(*socket, header, payload))
+			{
+				header.worker_id = worker_id;
+				switch (header.type)
+				{
+				case message_init:
+					init(header, payload);
+					break;
+				case message_pull:
+					pull(header, payload);
+					header.type = message_weights;
+					send_message(*socket, header, payload);
+					break;
+				case message_push:
+					push(header, payload);
+					break;
+				case message_finish:
+					finish(worker_id, false);
+					break;
+				default:
+					throw neural_network_exception((boost::format("Unknown message type %1% received from worker %2%") % header.type % worker_id).str());
+				}
+			}
+		}
+		catch (const std::exception& e)
+		{
+			boost::lock_guard<boost::mutex> lock(state_mutex);
+			if (error.empty())
+				error = e.what();
+		}
+
+		// The worker disconnected is never waited for
+		if (worker_id < worker_count)
+			finish(worker_id, true);
+	}
+
+	void parameter_server::init(
+		const message_header& header,
+		const std::string& payload)
+	{
+		boost::unique_lock<boost::mutex> lock(state_mutex);
+
+		// The previous network might still be trained by some workers
+		while (initialized && !is_task_finished())
+			state_changed.wait(lock);
+
+		if (initialized)
+			report_task_stat();
+
+		std::istringstream in(payload, std::ios_base::in | std::ios_base::binary);
+		unsigned int layer_count;
+		in.read(reinterpret_cast<char*>(&layer_count), sizeof(layer_count));
+		data.resize(layer_count);
+		for(layer_data_list::iterator it = data.begin(); it != data.end(); ++it)
+		{
+			*it = layer_data_smart_ptr(new layer_data());
+			(*it)->read(in);
+		}
+		if (!in)
+			throw neural_network_exception((boost::format("Truncated network data received from worker %1%") % header.worker_id).str());
+
+		initialized = true;
+		task_index = header.task_index;
+		std::fill(clock_list.begin(), clock_list.end(), 0);
+		finished_list = disconnected_list;
+		push_count = 0;
+		received_byte_count = 0;
+		stale_wait_seconds = 0.0;
+
+		state_changed.notify_all();
+	}
+
+	void parameter_server::pull(
+		const message_header& header,
+		std::string& payload)
+	{
+		boost::unique_lock<boost::mutex> lock(state_mutex);
+
+		boost::chrono::steady_clock::time_point start = boost::chrono::steady_clock::now();
+		while (!initialized || (task_index != header.task_index) || !is_clock_available(header.clock, header.staleness))
+			state_changed.wait(lock);
+		boost::chrono::duration<double> sec = boost::chrono::steady_clock::now() - start;
+		stale_wait_seconds += sec.count();
+
+		std::ostringstream out(std::ios_base::out | std::ios_base::binary);
+		for(layer_data_list::const_iterator it = data.begin(); it != data.end(); ++it)
+			(*it)->write(out);
+		payload = out.str();
+	}
+
+	void parameter_server::push(
+		const message_header& header,
+		const std::string& payload)
+	{
+		boost::lock_guard<boost::mutex> lock(state_mutex);
+
+		if (!initialized || (task_index != header.task_index))
+			throw neural_network_exception((boost::format("Worker %1% pushed delta for network %2% while the server keeps another one") % header.worker_id % header.task_index).str());
+
+		std::istringstream in(payload, std::ios_base::in | std::ios_base::binary);
+		unsigned int sparse;
+		in.read(reinterpret_cast<char*>(&sparse), sizeof(sparse));
+		layer_data delta;
+		std::vector<unsigned int> index_list;
+		std::vector<float> value_list;
+		for(layer_data_list::iterator it = data.begin(); it != data.end(); ++it)
+		{
+			layer_data& dst = **it;
+			if (sparse)
+			{
+				unsigned int weight_vector_count;
+				in.read(reinterpret_cast<char*>(&weight_vector_count), sizeof(weight_vector_count));
+				if (weight_vector_count != dst.size())
+					throw neural_network_exception((boost::format("Delta of invalid size pushed by worker %1%") % header.worker_id).str());
+				for(layer_data::iterator it2 = dst.begin(); it2 != dst.end(); ++it2)
+				{
+					unsigned int elem_count;
+					in.read(reinterpret_cast<char*>(&elem_count), sizeof(elem_count));
+					if (elem_count > it2->size())
+						throw neural_network_exception((boost::format("Delta of invalid size pushed by worker %1%") % header.worker_id).str());
+					if (elem_count == 0)
+						continue;
+					index_list.resize(elem_count);
+					value_list.resize(elem_count);
+					in.read(reinterpret_cast<char*>(&(*index_list.begin())), sizeof(unsigned int) * elem_count);
+					in.read(reinterpret_cast<char*>(&(*value_list.begin())), sizeof(float) * elem_count);
+					for(unsigned int i = 0; i < elem_count; ++i)
+					{
+						if (index_list[i] >= it2->size())
+							throw neural_network_exception((boost::format("Delta of invalid size pushed by worker %1%") % header.worker_id).str());
+						(*it2)[index_list[i]] += value_list[i];
+					}
+				}
+			}
+			else
+			{
+				delta.read(in);
+				if (delta.size() != dst.size())
+					throw neural_network_exception((boost::format("Delta of invalid size pushed by worker %1%") % header.worker_id).str());
+				for(unsigned int i = 0; i < delta.size(); ++i)
+				{
+					if (delta[i].size() != dst[i].size())
+						throw neural_network_exception((boost::format("Delta of invalid size pushed by worker %1%") % header.worker_id).str());
+					std::transform(dst[i].begin(), dst[i].end(), delta[i].begin(), dst[i].begin(), std::plus<float>());
+				}
+			}
+		}
+		if (!in)
+			throw neural_network_exception((boost::format("Truncated delta received from worker %1%") % header.worker_id).str());
+
+		clock_list[header.worker_id] = header.clock + 1;
+		++push_count;
+		received_byte_count += payload.size();
+
+		state_changed.notify_all();
+	}
+
+	void parameter_server::finish(
+		unsigned int worker_id,
+		bool disconnected)
+	{
+		boost::lock_guard<boost::mutex> lock(state_mutex);
+		finished_list[worker_id] = true;
+		if (disconnected)
+			disconnected_list[worker_id] = true;
+		state_changed.notify_all();
+	}
+
+	bool parameter_server::is_task_finished() const
+	{
+		return (std::find(finished_list.begin(), finished_list.end(), false) == finished_list.end());
+	}
+
+	bool parameter_server::is_clock_available(
+		unsigned int clock,
+		unsigned int staleness) const
+	{
+		for(unsigned int i = 0; i < worker_count; ++i)
+			if (!finished_list[i] && (clock_list[i] + staleness < clock))
+				return false;
+
+		return true;
+	}
+
+	void parameter_server::report_task_stat() const
+	{
+		std::cout << (boost::format("Parameter server shard %1%: network %2%, %3% deltas applied, %4$.1f MB received, %5$.2f seconds spent by workers waiting for the stale ones")
+			% shard_id % task_index % push_count % (static_cast<double>(received_byte_count) / (1024.0 * 1024.0)) % stale_wait_seconds) << std::endl;
+	}
+
+	bool parameter_server::is_layer_in_shard(
+		unsigned int layer_id,
+		unsigned int shard_id,
+		unsigned int shard_count)
+	{
+		return ((layer_id % shard_count) == shard_id);
+	}
+
+	void parameter_server::send_message(
+		socket_endpoint::protocol::socket& socket,
+		const message_header& header,
+		const std::string& payload)
+	{
+		message_header h = header;
+		h.payload_size = static_cast<unsigned int>(payload.size());
+		std::vector<boost::asio::const_buffer> buffers;
+		buffers.push_back(boost::asio::buffer(&h, sizeof(h)));
+		if (!payload.empty())
+			buffers.push_back(boost::asio::buffer(payload.data(), payload.size()));
+		boost::asio::write(socket, buffers);
+	}
+
+	bool parameter_server::receive_message(
+		socket_endpoint::protocol::socket& socket,
+		message_header& header,
+		std::string& payload)
+	{
+		boost::system::error_code ec;
+		boost::asio::read(socket, boost::asio::buffer(&header, sizeof(header)), ec);
+		if (ec == boost::asio::error::eof)
+			return false;
+		if (ec)
+			throw neural_network_exception((boost::format("Error receiving message: %1%") % ec.message()).str());
+
+		payload.resize(header.payload_size);
+		if (!payload.empty())
+			boost::asio::read(socket, boost::asio::buffer(&(*payload.begin()), payload.size()));
+
+		return true;
+	}
+}
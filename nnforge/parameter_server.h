@@ -0,0 +1,140 @@
+/*
+ *  Copyright 2011-2014 Maxim Milakov
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+
+#pragma once
+
+#include "layer_data_list.h"
+#include "socket_endpoint.h"
+#include "nn_types.h"
+
+#include <vector>
+#include <string>
+#include <boost/asio.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/condition_variable.hpp>
+
+namespace nnforge
+{
+	// Shard shard_id of shard_count of the parameter server, it keeps the layers with layer_id % shard_count == shard_id
+	// and applies the weight deltas pushed by the workers in the order they arrive.
+	// Updates are stale-synchronous: pull for clock c is served when all the workers training the same network
+	// have pushed at least c - staleness deltas, staleness is specified by the worker pulling.
+	// Layer data are transferred in the layer_data::write format
+	class parameter_server
+	{
+	public:
+		enum message_type
+		{
+			message_hello = 0,
+			message_init = 1,
+			message_pull = 2,
+			message_push = 3,
+			message_finish = 4,
+			message_weights = 5
+		};
+
+		struct message_header
+		{
+			unsigned int type;
+			unsigned int worker_id;
+			unsigned int task_index;
+			unsigned int clock;
+			unsigned int staleness;
+			unsigned int payload_size;
+		};
+
+		// endpoint is the same as for socket_endpoint, shard i listens on the endpoint of process i
+		parameter_server(
+			const std::string& endpoint,
+			unsigned int shard_id,
+			unsigned int shard_count,
+			unsigned int worker_count);
+
+		~parameter_server();
+
+		// Serves the workers until all of them disconnect
+		void run();
+
+		static bool is_layer_in_shard(
+			unsigned int layer_id,
+			unsigned int shard_id,
+			unsigned int shard_count);
+
+		static void send_message(
+			socket_endpoint::protocol::socket& socket,
+			const message_header& header,
+			const std::string& payload);
+
+		// Returns false if the peer has closed the connection
+		static bool receive_message(
+			socket_endpoint::protocol::socket& socket,
+			message_header& header,
+			std::string& payload);
+
+	protected:
+		typedef nnforge_shared_ptr<socket_endpoint::protocol::socket> socket_smart_ptr;
+
+		void serve(socket_smart_ptr socket);
+
+		void init(
+			const message_header& header,
+			const std::string& payload);
+
+		void pull(
+			const message_header& header,
+			std::string& payload);
+
+		void push(
+			const message_header& header,
+			const std::string& payload);
+
+		void finish(
+			unsigned int worker_id,
+			bool disconnected);
+
+		bool is_task_finished() const;
+
+		// Returns true if no worker still training the network is more than staleness clocks behind clock
+		bool is_clock_available(
+			unsigned int clock,
+			unsigned int staleness) const;
+
+		void report_task_stat() const;
+
+		socket_endpoint endpoint;
+		unsigned int shard_id;
+		unsigned int shard_count;
+		unsigned int worker_count;
+
+		boost::mutex state_mutex;
+		boost::condition_variable state_changed;
+		bool initialized;
+		unsigned int task_index;
+		layer_data_list data;
+		std::vector<unsigned int> clock_list;
+		std::vector<bool> finished_list;
+		std::vector<bool> disconnected_list;
+		unsigned int push_count;
+		unsigned long long received_byte_count;
+		double stale_wait_seconds;
+		std::string error;
+
+	private:
+		parameter_server(const parameter_server&);
+		parameter_server& operator =(const parameter_server&);
+	};
+}
@@ -0,0 +1,227 @@
+/*
+ *  Copyright 2011-2014 Maxim Milakov
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+
+#include "parameter_server_client.h"
+
+#include "neural_network_exception.h"
+
+#include <cmath>
+#include <sstream>
+#include <boost/format.hpp>
+#include <boost/chrono.hpp>
+
+namespace nnforge
+{
+	parameter_server_client::parameter_server_client(
+		const std::string& endpoint,
+		unsigned int shard_count,
+		unsigned int worker_id,
+		float delta_threshold,
+		float connect_timeout_seconds)
+		: worker_id(worker_id)
+		, delta_threshold(delta_threshold)
+		, residual_task_index(0)
+		, wait_seconds(0.0)
+		, sent_elem_count(0)
+		, delta_elem_count(0)
+	{
+		if (shard_count == 0)
+			throw neural_network_exception("Parameter server should have at least one shard");
+
+		socket_endpoint shard_endpoint(endpoint, shard_count);
+		parameter_server::message_header header = {parameter_server::message_hello, worker_id, 0, 0, 0, 0};
+		for(unsigned int shard_id = 0; shard_id < shard_count; ++shard_id)
+		{
+			socket_smart_ptr socket(new socket_endpoint::protocol::socket(io_service));
+			shard_endpoint.connect(*socket, shard_id, connect_timeout_seconds);
+			parameter_server::send_message(*socket, header, std::string());
+			shard_socket_list.push_back(socket);
+		}
+	}
+
+	parameter_server_client::~parameter_server_client()
+	{
+	}
+
+	void parameter_server_client::init(
+		unsigned int task_index,
+		const layer_data_list& data)
+	{
+		unsigned int shard_count = static_cast<unsigned int>(shard_socket_list.size());
+		parameter_server::message_header header = {parameter_server::message_init, worker_id, task_index, 0, 0, 0};
+		for(unsigned int shard_id = 0; shard_id < shard_count; ++shard_id)
+		{
+			std::ostringstream out(std::ios_base::out | std::ios_base::binary);
+			unsigned int layer_count = 0;
+			for(unsigned int layer_id = 0; layer_id < data.size(); ++layer_id)
+				if (parameter_server::is_layer_in_shard(layer_id, shard_id, shard_count))
+					++layer_count;
+			out.write(reinterpret_cast<const char*>(&layer_count), sizeof(layer_count));
+			for(unsigned int layer_id = 0; layer_id < data.size(); ++layer_id)
+				if (parameter_server::is_layer_in_shard(layer_id, shard_id, shard_count))
+					data[layer_id]->write(out);
+
+			parameter_server::send_message(*shard_socket_list[shard_id], header, out.str());
+		}
+	}
+
+	void parameter_server_client::pull(
+		unsigned int task_index,
+		unsigned int clock,
+		unsigned int staleness,
+		layer_data_list& data)
+	{
+		boost::chrono::steady_clock::time_point start = boost::chrono::steady_clock::now();
+
+		unsigned int shard_count = static_cast<unsigned int>(shard_socket_list.size());
+		parameter_server::message_header header = {parameter_server::message_pull, worker_id, task_index, clock, staleness, 0};
+		// Shards serve the requests concurrently
+		for(unsigned int shard_id = 0; shard_id < shard_count; ++shard_id)
+			parameter_server::send_message(*shard_socket_list[shard_id], header, std::string());
+
+		std::string payload;
+		for(unsigned int shard_id = 0; shard_id < shard_count; ++shard_id)
+		{
+			if (!parameter_server::receive_message(*shard_socket_list[shard_id], header, payload) || (header.type != parameter_server::message_weights))
+				throw neural_network_exception((boost::format("Parameter server shard %1% failed to send weights") % shard_id).str());
+
+			std::istringstream in(payload, std::ios_base::in | std::ios_base::binary);
+			for(unsigned int layer_id = 0; layer_id < data.size(); ++layer_id)
+				if (parameter_server::is_layer_in_shard(layer_id, shard_id, shard_count))
+					data[layer_id]->read(in);
+			if (!in)
+				throw neural_network_exception((boost::format("Truncated weights received from parameter server shard %1%") % shard_id).str());
+		}
+
+		boost::chrono::duration<double> sec = boost::chrono::steady_clock::now() - start;
+		wait_seconds += sec.count();
+	}
+
+	void parameter_server_client::push(
+		unsigned int task_index,
+		unsigned int clock,
+		const layer_data_list& delta)
+	{
+		if (residual.empty() || (residual_task_index != task_index))
+		{
+			residual.resize(delta.size());
+			for(unsigned int layer_id = 0; layer_id < delta.size(); ++layer_id)
+			{
+				residual[layer_id] = layer_data_smart_ptr(new layer_data(*delta[layer_id]));
+				residual[layer_id]->fill(0.0F);
+			}
+			residual_task_index = task_index;
+		}
+
+		unsigned int shard_count = static_cast<unsigned int>(shard_socket_list.size());
+		parameter_server::message_header header = {parameter_server::message_push, worker_id, task_index, clock, 0, 0};
+		unsigned int sparse = (delta_threshold > 0.0F) ? 1 : 0;
+		for(unsigned int shard_id = 0; shard_id < shard_count; ++shard_id)
+		{
+			std::ostringstream out(std::ios_base::out | std::ios_base::binary);
+			out.write(reinterpret_cast<const char*>(&sparse), sizeof(sparse));
+			for(unsigned int layer_id = 0; layer_id < delta.size(); ++layer_id)
+				if (parameter_server::is_layer_in_shard(layer_id, shard_id, shard_count))
+					write_delta(out, *residual[layer_id], *delta[layer_id]);
+
+			parameter_server::send_message(*shard_socket_list[shard_id], header, out.str());
+		}
+	}
+
+	void parameter_server_client::write_delta(
+		std::ostream& out,
+		layer_data& residual,
+		const layer_data& delta)
+	{
+		if (delta_threshold <= 0.0F)
+		{
+			delta.write(out);
+			for(layer_data::const_iterator it = delta.begin(); it != delta.end(); ++it)
+			{
+				delta_elem_count += it->size();
+				sent_elem_count += it->size();
+			}
+			return;
+		}
+
+		unsigned int weight_vector_count = static_cast<unsigned int>(delta.size());
+		out.write(reinterpret_cast<const char*>(&weight_vector_count), sizeof(weight_vector_count));
+		for(unsigned int i = 0; i < weight_vector_count; ++i)
+		{
+			std::vector<float>& res = residual[i];
+			const std::vector<float>& src = delta[i];
+			index_list.clear();
+			value_list.clear();
+			for(unsigned int j = 0; j < src.size(); ++j)
+			{
+				float val = res[j] + src[j];
+				if (fabsf(val) >= delta_threshold)
+				{
+					index_list.push_back(j);
+					value_list.push_back(val);
+					val = 0.0F;
+				}
+				res[j] = val;
+			}
+
+			unsigned int elem_count = static_cast<unsigned int>(index_list.size());
+			out.write(reinterpret_cast<const char*>(&elem_count), sizeof(elem_count));
+			if (elem_count > 0)
+			{
+				out.write(reinterpret_cast<const char*>(&(*index_list.begin())), sizeof(unsigned int) * elem_count);
+				out.write(reinterpret_cast<const char*>(&(*value_list.begin())), sizeof(float) * elem_count);
+			}
+
+			delta_elem_count += src.size();
+			sent_elem_count += elem_count;
+		}
+	}
+
+	void parameter_server_client::finish(unsigned int task_index)
+	{
+		parameter_server::message_header header = {parameter_server::message_finish, worker_id, task_index, 0, 0, 0};
+		for(std::vector<socket_smart_ptr>::iterator it = shard_socket_list.begin(); it != shard_socket_list.end(); ++it)
+			parameter_server::send_message(**it, header, std::string());
+	}
+
+	unsigned int parameter_server_client::get_worker_id() const
+	{
+		return worker_id;
+	}
+
+	double parameter_server_client::get_wait_seconds() const
+	{
+		return wait_seconds;
+	}
+
+	unsigned long long parameter_server_client::get_sent_elem_count() const
+	{
+		return sent_elem_count;
+	}
+
+	unsigned long long parameter_server_client::get_delta_elem_count() const
+	{
+		return delta_elem_count;
+	}
+
+	void parameter_server_client::reset_stat()
+	{
+		wait_seconds = 0.0;
+		sent_elem_count = 0;
+		delta_elem_count = 0;
+	}
+}
@@ -0,0 +1,110 @@
+/*
+ *  Copyright 2011-2014 Maxim Milakov
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+
+#pragma once
+
+#include "parameter_server.h"
+#include "layer_data_list.h"
+#include "socket_endpoint.h"
+#include "nn_types.h"
+
+#include <vector>
+#include <string>
+#include <boost/asio.hpp>
+
+namespace nnforge
+{
+	// Worker side of the parameter server, connected to all the shards.
+	// Deltas are accumulated locally per element until their magnitude reaches delta_threshold,
+	// the elements sent are encoded as (index, value) pairs; delta_threshold = 0 sends deltas dense
+	class parameter_server_client
+	{
+	public:
+		parameter_server_client(
+			const std::string& endpoint,
+			unsigned int shard_count,
+			unsigned int worker_id,
+			float delta_threshold,
+			float connect_timeout_seconds = 60.0F);
+
+		~parameter_server_client();
+
+		// Starts training the network on the servers, it is done by worker 0.
+		// Blocks until all the workers finish training the previous network
+		void init(
+			unsigned int task_index,
+			const layer_data_list& data);
+
+		// Gets the current weights, blocks while any worker still training the network is more than staleness clocks behind clock
+		void pull(
+			unsigned int task_index,
+			unsigned int clock,
+			unsigned int staleness,
+			layer_data_list& data);
+
+		// Sends the delta of clock, clocks start from 0 for each network
+		void push(
+			unsigned int task_index,
+			unsigned int clock,
+			const layer_data_list& delta);
+
+		// The worker is not waited for until the next network is started
+		void finish(unsigned int task_index);
+
+		unsigned int get_worker_id() const;
+
+		// Time spent in pull since the last reset, including waiting for the stale workers
+		double get_wait_seconds() const;
+
+		// The number of delta elements sent since the last reset
+		unsigned long long get_sent_elem_count() const;
+
+		// The number of delta elements produced since the last reset
+		unsigned long long get_delta_elem_count() const;
+
+		void reset_stat();
+
+	protected:
+		typedef nnforge_shared_ptr<socket_endpoint::protocol::socket> socket_smart_ptr;
+
+		void write_delta(
+			std::ostream& out,
+			layer_data& residual,
+			const layer_data& delta);
+
+		unsigned int worker_id;
+		float delta_threshold;
+
+		boost::asio::io_service io_service;
+		std::vector<socket_smart_ptr> shard_socket_list;
+
+		layer_data_list residual;
+		unsigned int residual_task_index;
+		std::vector<unsigned int> index_list;
+		std::vector<float> value_list;
+
+		double wait_seconds;
+		unsigned long long sent_elem_count;
+		unsigned long long delta_elem_count;
+
+	private:
+		parameter_server_client(const parameter_server_client&);
+		parameter_server_client& operator =(const parameter_server_client&);
+	};
+
+	typedef nnforge_shared_ptr<parameter_server_client> parameter_server_client_smart_ptr;
+}
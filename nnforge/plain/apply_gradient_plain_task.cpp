@@ -0,0 +1,170 @@
+/*
+ *  Copyright 2011-2014 Maxim Milakov
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include "apply_gradient_plain_task.h"
+
+#include <set>
+#include <cmath>
+#include <algorithm>
+
+namespace nnforge
+{
+	namespace plain
+	{
+		const unsigned int apply_gradient_plain_task::tile_elem_count = 4096;
+
+		apply_gradient_plain_task::apply_gradient_plain_task(
+			const const_layer_list& layer_list,
+			unsigned int start_layer_id,
+			std::vector<layer_data_smart_ptr>& data,
+			std::vector<layer_data_smart_ptr>& gradient,
+			const std::vector<std::vector<float> >& learning_rates,
+			float normalizer,
+			float weight_decay,
+			float momentum,
+			bool keep_momentum,
+			bool collect_update_stat)
+			: normalizer(normalizer)
+			, collect_update_stat(collect_update_stat)
+		{
+			for(unsigned int layer_id = start_layer_id; layer_id < static_cast<unsigned int>(data.size()); ++layer_id)
+			{
+				std::set<unsigned int> weight_decay_part_id_set = layer_list[layer_id]->get_weight_decay_part_id_set();
+				layer_data& data_layer = *data[layer_id];
+				layer_data& gradient_layer = *gradient[layer_id];
+				for(unsigned int part_id = 0; part_id < static_cast<unsigned int>(data_layer.size()); ++part_id)
+				{
+					unsigned int elem_count = static_cast<unsigned int>(data_layer[part_id].size());
+					if (elem_count == 0)
+						continue;
+
+					part p;
+					p.weights = &(*data_layer[part_id].begin());
+					p.gradient = &(*gradient_layer[part_id].begin());
+					p.learning_rate = learning_rates[layer_id][part_id];
+					p.weight_decay = (weight_decay_part_id_set.find(part_id) == weight_decay_part_id_set.end()) ? 0.0F : weight_decay;
+					float gradient_scale = p.learning_rate * normalizer;
+					p.momentum_mult = ((momentum > 0.0F) && keep_momentum && (gradient_scale != 0.0F)) ? momentum / gradient_scale : 0.0F;
+					p.layer_id = layer_id;
+					p.part_id = part_id;
+					part_list.push_back(p);
+
+					for(unsigned int offset = 0; offset < elem_count; offset += tile_elem_count)
+					{
+						tile t;
+						t.part_index = static_cast<unsigned int>(part_list.size() - 1);
+						t.offset = offset;
+						t.elem_count = std::min(elem_count - offset, tile_elem_count);
+						tile_list.push_back(t);
+					}
+				}
+			}
+
+			if (collect_update_stat)
+				tile_update_sum_list.resize(tile_list.size(), 0.0);
+		}
+
+		int apply_gradient_plain_task::get_workload_count() const
+		{
+			return static_cast<int>(tile_list.size());
+		}
+
+		void apply_gradient_plain_task::run_tile(
+			int start_workload_id,
+			int end_workload_id)
+		{
+			for(int tile_id = start_workload_id; tile_id < end_workload_id; ++tile_id)
+			{
+				const tile& t = tile_list[tile_id];
+				const part& p = part_list[t.part_index];
+				float * const weights = p.weights + t.offset;
+				float * const gradient = p.gradient + t.offset;
+				const float learning_rate = p.learning_rate;
+				const float actual_weight_decay = p.weight_decay;
+				const float normalizer = this->normalizer;
+				const int elem_count = static_cast<int>(t.elem_count);
+
+				// The loops are kept free of branches and stat accumulation when possible so that compiler vectorizes them
+				if (p.momentum_mult != 0.0F)
+				{
+					// Gradient includes momentum term left by the previous step
+					const float momentum_mult = p.momentum_mult;
+					if (collect_update_stat)
+					{
+						float accum = 0.0F;
+						for(int i = 0; i < elem_count; ++i)
+						{
+							float current_weight = weights[i];
+							float upd = learning_rate * (gradient[i] * normalizer - current_weight * actual_weight_decay);
+							accum += fabsf(upd);
+							weights[i] = current_weight + upd;
+							gradient[i] = upd * momentum_mult;
+						}
+						tile_update_sum_list[tile_id] = static_cast<double>(accum);
+					}
+					else
+					{
+						for(int i = 0; i < elem_count; ++i)
+						{
+							float current_weight = weights[i];
+							float upd = learning_rate * (gradient[i] * normalizer - current_weight * actual_weight_decay);
+							weights[i] = current_weight + upd;
+							gradient[i] = upd * momentum_mult;
+						}
+					}
+				}
+				else
+				{
+					if (collect_update_stat)
+					{
+						float accum = 0.0F;
+						for(int i = 0; i < elem_count; ++i)
+						{
+							float current_weight = weights[i];
+							float upd = learning_rate * (gradient[i] * normalizer - current_weight * actual_weight_decay);
+							accum += fabsf(upd);
+							weights[i] = current_weight + upd;
+							gradient[i] = 0.0F;
+						}
+						tile_update_sum_list[tile_id] = static_cast<double>(accum);
+					}
+					else
+					{
+						for(int i = 0; i < elem_count; ++i)
+						{
+							float current_weight = weights[i];
+							float upd = learning_rate * (gradient[i] * normalizer - current_weight * actual_weight_decay);
+							weights[i] = current_weight + upd;
+							gradient[i] = 0.0F;
+						}
+					}
+				}
+			}
+		}
+
+		void apply_gradient_plain_task::accumulate_updates(std::vector<std::vector<double> >& updates_accumulated) const
+		{
+			if (!collect_update_stat)
+				return;
+
+			for(unsigned int tile_id = 0; tile_id < static_cast<unsigned int>(tile_list.size()); ++tile_id)
+			{
+				const part& p = part_list[tile_list[tile_id].part_index];
+				updates_accumulated[p.layer_id][p.part_id] += tile_update_sum_list[tile_id];
+			}
+		}
+	}
+}
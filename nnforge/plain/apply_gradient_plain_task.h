@@ -0,0 +1,93 @@
+/*
+ *  Copyright 2011-2014 Maxim Milakov
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#pragma once
+
+#include "plain_thread_pool.h"
+
+#include "../layer.h"
+#include "../layer_data.h"
+
+#include <vector>
+
+namespace nnforge
+{
+	namespace plain
+	{
+		// Fused SGD step with momentum and weight decay: updates weights and reinitializes gradient in a single pass.
+		// Gradient buffer holds momentum as well: the step leaves momentum * update / (learning_rate * normalizer) in it,
+		// so that the next step applying the gradient accumulated on top of it gets the momentum term without separate buffer.
+		// This requires learning rates and normalizer to stay the same between the steps, gradient is zeroed without momentum.
+		// Workload item is a tile of at most tile_elem_count weights of a single part
+		class apply_gradient_plain_task : public plain_thread_pool::task
+		{
+		public:
+			// keep_momentum = false zeroes gradient even with positive momentum, the momentum term is then expected
+			// to be added to the gradient by someone else, like worker 0 in data-parallel training
+			apply_gradient_plain_task(
+				const const_layer_list& layer_list,
+				unsigned int start_layer_id,
+				std::vector<layer_data_smart_ptr>& data,
+				std::vector<layer_data_smart_ptr>& gradient,
+				const std::vector<std::vector<float> >& learning_rates,
+				float normalizer,
+				float weight_decay,
+				float momentum,
+				bool keep_momentum,
+				bool collect_update_stat);
+
+			int get_workload_count() const;
+
+			virtual void run_tile(
+				int start_workload_id,
+				int end_workload_id);
+
+			// Adds sums of absolute updates of each part, summed tile by tile in a fixed order
+			void accumulate_updates(std::vector<std::vector<double> >& updates_accumulated) const;
+
+			static const unsigned int tile_elem_count;
+
+		private:
+			struct part
+			{
+				float * weights;
+				float * gradient;
+				float learning_rate;
+				float weight_decay;
+				// Converts update to the gradient units, 0 if gradient should be zeroed
+				float momentum_mult;
+				unsigned int layer_id;
+				unsigned int part_id;
+			};
+
+			struct tile
+			{
+				unsigned int part_index;
+				unsigned int offset;
+				unsigned int elem_count;
+			};
+
+			std::vector<part> part_list;
+			std::vector<tile> tile_list;
+			std::vector<double> tile_update_sum_list;
+			const float normalizer;
+			const bool collect_update_stat;
+
+		private:
+			apply_gradient_plain_task& operator =(const apply_gradient_plain_task&);
+		};
+	}
+}
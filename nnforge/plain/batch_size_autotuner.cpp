@@ -0,0 +1,146 @@
+/*
+ *  Copyright 2011-2014 Maxim Milakov
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include "batch_size_autotuner.h"
+
+#include <iostream>
+#include <sstream>
+#include <algorithm>
+#include <vector>
+
+#include <boost/format.hpp>
+#include <boost/filesystem.hpp>
+#include <boost/filesystem/fstream.hpp>
+#include <boost/thread/locks.hpp>
+#include <boost/uuid/uuid_io.hpp>
+
+namespace nnforge
+{
+	namespace plain
+	{
+		const float batch_size_autotuner::min_benchmark_seconds = 0.05F;
+		const unsigned int batch_size_autotuner::max_candidate_entry_count = 4096;
+
+		batch_size_autotuner::benchmark::~benchmark()
+		{
+		}
+
+		batch_size_autotuner::batch_size_autotuner(const std::string& profile_file_path)
+			: profile_file_path(profile_file_path)
+		{
+			load();
+		}
+
+		batch_size_autotuner::~batch_size_autotuner()
+		{
+		}
+
+		unsigned int batch_size_autotuner::tune(
+			const std::string& key,
+			unsigned int max_entry_count,
+			benchmark& bm)
+		{
+			max_entry_count = std::max(std::min(max_entry_count, max_candidate_entry_count), 1U);
+
+			{
+				boost::lock_guard<boost::mutex> lock(map_mtx);
+				std::map<std::string, std::pair<unsigned int, float> >::const_iterator it = key_to_entry_count_and_rate_map.find(key);
+				if (it != key_to_entry_count_and_rate_map.end())
+				{
+					if (reported_key_set.insert(key).second)
+						std::cout << (boost::format("Batch size autotuning: %1% entries loaded from profile, %|2$.1f| entries/s") % it->second.first % it->second.second) << std::endl;
+					return std::min(it->second.first, max_entry_count);
+				}
+			}
+
+			std::vector<unsigned int> candidate_list;
+			for(unsigned int entry_count = 1; entry_count < max_entry_count; entry_count *= 2)
+				candidate_list.push_back(entry_count);
+			candidate_list.push_back(max_entry_count);
+
+			unsigned int best_entry_count = candidate_list.front();
+			float best_rate = 0.0F;
+			unsigned int worse_in_a_row_count = 0;
+			for(std::vector<unsigned int>::const_iterator it = candidate_list.begin(); it != candidate_list.end(); ++it)
+			{
+				float rate = bm.measure(*it);
+				std::cout << (boost::format("Batch size autotuning: %1% entries, %|2$.1f| entries/s") % *it % rate) << std::endl;
+				if (rate > best_rate)
+				{
+					best_rate = rate;
+					best_entry_count = *it;
+					worse_in_a_row_count = 0;
+				}
+				else if ((rate < best_rate * 0.9F) && (++worse_in_a_row_count >= 2))
+					break;
+			}
+
+			std::cout << (boost::format("Batch size autotuning: %1% entries chosen, %|2$.1f| entries/s") % best_entry_count % best_rate) << std::endl;
+
+			// The lock is not held while benchmarking so that concurrent updaters don't wait for each other
+			boost::lock_guard<boost::mutex> lock(map_mtx);
+			key_to_entry_count_and_rate_map.insert(std::make_pair(key, std::make_pair(best_entry_count, best_rate)));
+			reported_key_set.insert(key);
+			save();
+
+			return best_entry_count;
+		}
+
+		std::string batch_size_autotuner::get_key(
+			const char * kind,
+			const const_layer_list& layer_list,
+			const layer_configuration_specific_list& layer_config_list,
+			int thread_count)
+		{
+			std::ostringstream s;
+			s << kind << "_t" << thread_count;
+			layer_configuration_specific_list::const_iterator config_it = layer_config_list.begin();
+			for(const_layer_list::const_iterator it = layer_list.begin(); it != layer_list.end(); ++it, ++config_it)
+			{
+				s << "_" << (*it)->get_uuid() << "-" << config_it->feature_map_count;
+				for(std::vector<unsigned int>::const_iterator it2 = config_it->dimension_sizes.begin(); it2 != config_it->dimension_sizes.end(); ++it2)
+					s << "x" << *it2;
+			}
+
+			return s.str();
+		}
+
+		void batch_size_autotuner::load()
+		{
+			if (profile_file_path.empty() || !boost::filesystem::exists(profile_file_path))
+				return;
+
+			boost::filesystem::ifstream in(profile_file_path);
+			std::string key;
+			unsigned int entry_count;
+			float rate;
+			while (in >> key >> entry_count >> rate)
+				key_to_entry_count_and_rate_map.insert(std::make_pair(key, std::make_pair(entry_count, rate)));
+
+			std::cout << (boost::format("Batch size profile loaded from %1%, %2% records") % profile_file_path % key_to_entry_count_and_rate_map.size()) << std::endl;
+		}
+
+		void batch_size_autotuner::save() const
+		{
+			if (profile_file_path.empty())
+				return;
+
+			boost::filesystem::ofstream out(profile_file_path, std::ios_base::out | std::ios_base::trunc);
+			for(std::map<std::string, std::pair<unsigned int, float> >::const_iterator it = key_to_entry_count_and_rate_map.begin(); it != key_to_entry_count_and_rate_map.end(); ++it)
+				out << it->first << " " << it->second.first << " " << it->second.second << std::endl;
+		}
+	}
+}
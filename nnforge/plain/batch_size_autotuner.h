@@ -0,0 +1,86 @@
+/*
+ *  Copyright 2011-2014 Maxim Milakov
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#pragma once
+
+#include "../layer.h"
+#include "../layer_configuration_specific.h"
+#include "../nn_types.h"
+
+#include <string>
+#include <map>
+#include <set>
+#include <utility>
+#include <boost/thread/mutex.hpp>
+
+namespace nnforge
+{
+	namespace plain
+	{
+		// Picks entry counts (batch sizes) maximizing throughput by running benchmarks on the actual schema.
+		// Results are kept in memory and, if profile_file_path is not empty, cached in the profile file.
+		// Could be shared by updaters running concurrently, benchmarks for the same key might run more than once then.
+		class batch_size_autotuner
+		{
+		public:
+			class benchmark
+			{
+			public:
+				virtual ~benchmark();
+
+				// Returns throughput in entries per second
+				virtual float measure(unsigned int entry_count) = 0;
+			};
+
+			batch_size_autotuner(const std::string& profile_file_path);
+
+			~batch_size_autotuner();
+
+			// Returns the entry count not exceeding max_entry_count with the best throughput
+			unsigned int tune(
+				const std::string& key,
+				unsigned int max_entry_count,
+				benchmark& bm);
+
+			static std::string get_key(
+				const char * kind,
+				const const_layer_list& layer_list,
+				const layer_configuration_specific_list& layer_config_list,
+				int thread_count);
+
+			// Benchmark runs for each candidate are repeated until this time is elapsed
+			static const float min_benchmark_seconds;
+
+			static const unsigned int max_candidate_entry_count;
+
+		private:
+			void load();
+
+			void save() const;
+
+			std::string profile_file_path;
+			std::map<std::string, std::pair<unsigned int, float> > key_to_entry_count_and_rate_map;
+			std::set<std::string> reported_key_set;
+			boost::mutex map_mtx;
+
+		private:
+			batch_size_autotuner(const batch_size_autotuner&);
+			batch_size_autotuner& operator =(const batch_size_autotuner&);
+		};
+
+		typedef nnforge_shared_ptr<batch_size_autotuner> batch_size_autotuner_smart_ptr;
+	}
+}
@@ -0,0 +1,415 @@
+/*
+ *  Copyright 2011-2014 Maxim Milakov
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include "convolution_layer_plain_tasks.h"
+
+#include "../nn_types.h"
+
+#include <algorithm>
+
+namespace nnforge
+{
+	namespace plain
+	{
+		const int convolution_plain_geometry::max_dimension_count;
+
+		convolution_plain_geometry::convolution_plain_geometry(
+			const convolution_layer& layer,
+			const layer_configuration_specific& input_configuration_specific,
+			const layer_configuration_specific& output_configuration_specific)
+			: dimension_count(static_cast<unsigned int>(layer.window_sizes.size()))
+			, window_sizes(layer.window_sizes)
+			, left_zero_padding(layer.left_zero_padding)
+			, input_dimension_sizes(input_configuration_specific.dimension_sizes)
+			, output_dimension_sizes(output_configuration_specific.dimension_sizes)
+			, input_feature_map_count(input_configuration_specific.feature_map_count)
+			, output_feature_map_count(output_configuration_specific.feature_map_count)
+			, input_neuron_count(input_configuration_specific.get_neuron_count())
+			, input_neuron_count_per_feature_map(input_configuration_specific.get_neuron_count_per_feature_map())
+			, output_neuron_count(output_configuration_specific.get_neuron_count())
+			, output_neuron_count_per_feature_map(output_configuration_specific.get_neuron_count_per_feature_map())
+		{
+			window_sizes.resize(max_dimension_count, 1);
+			left_zero_padding.resize(max_dimension_count, 0);
+			input_dimension_sizes.resize(max_dimension_count, 1);
+
+			input_slices.resize(input_configuration_specific.dimension_sizes.size());
+			input_slices[0] = 1;
+			for(unsigned int i = 0; i < dimension_count - 1; ++i)
+				input_slices[i + 1] = input_slices[i] * input_configuration_specific.dimension_sizes[i];
+
+			window_elem_count = 1;
+			for(unsigned int i = 0; i < dimension_count; ++i)
+				window_elem_count *= window_sizes[i];
+
+			std::vector<unsigned int> current_local_input_position(dimension_count, 0);
+			offset_list.resize(window_elem_count);
+			for(unsigned int i = 1; i < window_elem_count; ++i)
+			{
+				int offset = 0;
+				for(unsigned int j = 0; j < dimension_count; ++j)
+				{
+					offset += static_cast<int>(input_slices[j]);
+					if ((++current_local_input_position[j]) < window_sizes[j])
+					{
+						offset_list[i] = offset_list[i-1] + offset;
+						break;
+					}
+					current_local_input_position[j] = 0;
+					offset -= static_cast<int>(window_sizes[j] * input_slices[j]);
+				}
+			}
+		}
+
+		convolution_forward_plain_task::convolution_forward_plain_task(
+			const convolution_plain_geometry& geometry,
+			std::vector<float>::const_iterator in_it_global,
+			std::vector<float>::iterator out_it_global,
+			std::vector<float>::const_iterator weights,
+			std::vector<float>::const_iterator biases)
+			: geometry(geometry)
+			, in_it_global(in_it_global)
+			, out_it_global(out_it_global)
+			, weights(weights)
+			, biases(biases)
+		{
+		}
+
+		void convolution_forward_plain_task::run_tile(
+			int start_workload_id,
+			int end_workload_id)
+		{
+			const unsigned int dimension_count = geometry.dimension_count;
+			const std::vector<unsigned int>& window_sizes = geometry.window_sizes;
+			const std::vector<unsigned int>& left_zero_padding = geometry.left_zero_padding;
+			const std::vector<unsigned int>& input_dimension_sizes = geometry.input_dimension_sizes;
+			const std::vector<unsigned int>::const_iterator output_dimension_sizes_it = geometry.output_dimension_sizes.begin();
+			const std::vector<unsigned int>::const_iterator input_slices_it = geometry.input_slices.begin();
+			const std::vector<unsigned int>::const_iterator offset_list_it = geometry.offset_list.begin();
+			const unsigned int const_window_elem_count = geometry.window_elem_count;
+			const unsigned int input_feature_map_count = geometry.input_feature_map_count;
+			const unsigned int output_feature_map_count = geometry.output_feature_map_count;
+			const unsigned int input_neuron_count = geometry.input_neuron_count;
+			const unsigned int input_neuron_count_per_feature_map = geometry.input_neuron_count_per_feature_map;
+			const unsigned int output_neuron_count = geometry.output_neuron_count;
+			const unsigned int output_neuron_count_per_feature_map = geometry.output_neuron_count_per_feature_map;
+
+			nnforge_array<unsigned int, convolution_plain_geometry::max_dimension_count> current_output_position;
+			nnforge_array<int, convolution_plain_geometry::max_dimension_count> current_input_position;
+
+			for(int workload_id = start_workload_id; workload_id < end_workload_id; ++workload_id)
+			{
+				int entry_id = workload_id / output_feature_map_count;
+				int output_feature_map_id = workload_id - (entry_id * output_feature_map_count);
+
+				std::vector<float>::iterator out_it_base = out_it_global + (entry_id * output_neuron_count) + (output_feature_map_id * output_neuron_count_per_feature_map);
+				std::vector<float>::const_iterator in_it_base = in_it_global + (entry_id * input_neuron_count);
+
+				std::fill_n(current_input_position.begin(), convolution_plain_geometry::max_dimension_count, 0);
+				std::fill_n(current_output_position.begin(), convolution_plain_geometry::max_dimension_count, 0);
+				for(std::vector<float>::iterator out_it = out_it_base; out_it != out_it_base + output_neuron_count_per_feature_map; ++out_it)
+				{
+					float sum = *(biases + output_feature_map_id);
+					std::vector<float>::const_iterator weights_it = weights + (output_feature_map_id * (const_window_elem_count * input_feature_map_count));
+
+					int in_it_offset2 = 0;
+
+					for(unsigned int i = 0; i < dimension_count; ++i)
+						current_input_position[i] = static_cast<int>(current_output_position[i]) - static_cast<int>(left_zero_padding[i]);
+
+					for(unsigned int i = 0; i < dimension_count; ++i)
+						in_it_offset2 += current_input_position[i] * (*(input_slices_it + i));
+
+					for(unsigned int input_feature_map_id = 0; input_feature_map_id < input_feature_map_count; ++input_feature_map_id)
+					{
+						// Define the starting position of the first input elem
+						int in_it_offset = in_it_offset2 + (input_feature_map_id * input_neuron_count_per_feature_map);
+
+						int ind = 0;
+						for(int w = current_input_position[3]; w < current_input_position[3] + static_cast<int>(window_sizes[3]); ++w)
+						{
+							bool fit3 = ((unsigned int)w < (unsigned int)input_dimension_sizes[3]);
+							for(int z = current_input_position[2]; z < current_input_position[2] + static_cast<int>(window_sizes[2]); ++z)
+							{
+								bool fit2 = fit3 && ((unsigned int)z < (unsigned int)input_dimension_sizes[2]);
+								for(int y = current_input_position[1]; y < current_input_position[1] + static_cast<int>(window_sizes[1]); ++y)
+								{
+									bool fit1 = fit2 && ((unsigned int)y < (unsigned int)input_dimension_sizes[1]);
+									for(int x = current_input_position[0]; x < current_input_position[0] + static_cast<int>(window_sizes[0]); ++x)
+									{
+										bool fit0 = fit1 && ((unsigned int)x < (unsigned int)input_dimension_sizes[0]);
+										if (fit0)
+											sum += (*(in_it_base + (in_it_offset + *(offset_list_it + ind)))) * (*weights_it);
+										++ind;
+										++weights_it;
+									}
+								}
+							}
+						}
+					}
+					*out_it = sum;
+
+					// Go to the next output element
+					for(unsigned int i = 0; i < dimension_count; ++i)
+					{
+						if ((++current_output_position[i]) < *(output_dimension_sizes_it + i))
+							break;
+						current_output_position[i] = 0;
+					}
+				}
+			}
+		}
+
+		convolution_backprop_plain_task::convolution_backprop_plain_task(
+			const convolution_plain_geometry& geometry,
+			std::vector<float>::iterator in_err_it_global,
+			std::vector<float>::const_iterator out_err_it_global,
+			std::vector<float>::const_iterator weights)
+			: geometry(geometry)
+			, in_err_it_global(in_err_it_global)
+			, out_err_it_global(out_err_it_global)
+			, weights(weights)
+		{
+		}
+
+		void convolution_backprop_plain_task::run_tile(
+			int start_workload_id,
+			int end_workload_id)
+		{
+			const unsigned int dimension_count = geometry.dimension_count;
+			const std::vector<unsigned int>& window_sizes = geometry.window_sizes;
+			const std::vector<unsigned int>& left_zero_padding = geometry.left_zero_padding;
+			const std::vector<unsigned int>& input_dimension_sizes = geometry.input_dimension_sizes;
+			const std::vector<unsigned int>::const_iterator output_dimension_sizes_it = geometry.output_dimension_sizes.begin();
+			const std::vector<unsigned int>::const_iterator input_slices_it = geometry.input_slices.begin();
+			const std::vector<unsigned int>::const_iterator offset_list_it = geometry.offset_list.begin();
+			const unsigned int const_window_elem_count = geometry.window_elem_count;
+			const unsigned int input_feature_map_count = geometry.input_feature_map_count;
+			const unsigned int output_feature_map_count = geometry.output_feature_map_count;
+			const unsigned int input_neuron_count = geometry.input_neuron_count;
+			const unsigned int input_neuron_count_per_feature_map = geometry.input_neuron_count_per_feature_map;
+			const unsigned int output_neuron_count = geometry.output_neuron_count;
+			const unsigned int output_neuron_count_per_feature_map = geometry.output_neuron_count_per_feature_map;
+
+			nnforge_array<unsigned int, convolution_plain_geometry::max_dimension_count> current_output_position;
+			nnforge_array<int, convolution_plain_geometry::max_dimension_count> current_input_position;
+
+			for(int workload_id = start_workload_id; workload_id < end_workload_id; ++workload_id)
+			{
+				int entry_id = workload_id / input_feature_map_count;
+				int input_feature_map_id = workload_id - (entry_id * input_feature_map_count);
+
+				std::vector<float>::const_iterator out_err_it_base = out_err_it_global + (entry_id * output_neuron_count);
+				std::vector<float>::iterator in_err_it_base = in_err_it_global + (entry_id * input_neuron_count) + (input_feature_map_id * input_neuron_count_per_feature_map);
+				std::vector<float>::const_iterator weights_it_base = weights + (const_window_elem_count * input_feature_map_id);
+
+				std::fill_n(in_err_it_base, input_neuron_count_per_feature_map, 0.0F);
+				std::fill_n(current_input_position.begin(), convolution_plain_geometry::max_dimension_count, 0);
+				std::fill_n(current_output_position.begin(), convolution_plain_geometry::max_dimension_count, 0);
+				for(std::vector<float>::const_iterator out_err_it_base2 = out_err_it_base; out_err_it_base2 != out_err_it_base + output_neuron_count_per_feature_map; ++out_err_it_base2)
+				{
+					int in_err_offset = 0;
+
+					for(unsigned int i = 0; i < dimension_count; ++i)
+						current_input_position[i] = static_cast<int>(current_output_position[i]) - static_cast<int>(left_zero_padding[i]);
+
+					for(unsigned int i = 0; i < dimension_count; ++i)
+						in_err_offset += current_input_position[i] * (*(input_slices_it + i));
+
+					for(unsigned int output_feature_map_id = 0; output_feature_map_id < output_feature_map_count; ++output_feature_map_id)
+					{
+						std::vector<float>::const_iterator out_err_it = out_err_it_base2 + (output_feature_map_id * output_neuron_count_per_feature_map);
+						std::vector<float>::const_iterator weights_it_base2 = weights_it_base + (output_feature_map_id * (const_window_elem_count * input_feature_map_count));
+						std::vector<float>::const_iterator weights_it = weights_it_base2;
+						float current_err = *out_err_it;
+
+						int ind = 0;
+						for(int w = current_input_position[3]; w < current_input_position[3] + static_cast<int>(window_sizes[3]); ++w)
+						{
+							bool fit3 = ((unsigned int)w < (unsigned int)input_dimension_sizes[3]);
+							for(int z = current_input_position[2]; z < current_input_position[2] + static_cast<int>(window_sizes[2]); ++z)
+							{
+								bool fit2 = fit3 && ((unsigned int)z < (unsigned int)input_dimension_sizes[2]);
+								for(int y = current_input_position[1]; y < current_input_position[1] + static_cast<int>(window_sizes[1]); ++y)
+								{
+									bool fit1 = fit2 && ((unsigned int)y < (unsigned int)input_dimension_sizes[1]);
+									for(int x = current_input_position[0]; x < current_input_position[0] + static_cast<int>(window_sizes[0]); ++x)
+									{
+										bool fit0 = fit1 && ((unsigned int)x < (unsigned int)input_dimension_sizes[0]);
+										if (fit0)
+										{
+											float w = *weights_it;
+											*(in_err_it_base + (in_err_offset + *(offset_list_it + ind))) += (w * current_err);
+										}
+										++ind;
+										++weights_it;
+									}
+								}
+							}
+						}
+					}
+
+					// Go to the next output element
+					for(unsigned int i = 0; i < dimension_count; ++i)
+					{
+						if ((++current_output_position[i]) < *(output_dimension_sizes_it + i))
+							break;
+						current_output_position[i] = 0;
+					}
+				}
+			}
+		}
+
+		convolution_update_weights_plain_task::convolution_update_weights_plain_task(
+			const convolution_plain_geometry& geometry,
+			std::vector<float>::const_iterator in_it_global,
+			std::vector<float>::const_iterator out_err_it_global,
+			std::vector<float>::iterator gradient_weights,
+			unsigned int entry_count)
+			: geometry(geometry)
+			, in_it_global(in_it_global)
+			, out_err_it_global(out_err_it_global)
+			, gradient_weights(gradient_weights)
+			, entry_count(static_cast<int>(entry_count))
+		{
+		}
+
+		void convolution_update_weights_plain_task::run_tile(
+			int start_workload_id,
+			int end_workload_id)
+		{
+			const unsigned int dimension_count = geometry.dimension_count;
+			const std::vector<unsigned int>& window_sizes = geometry.window_sizes;
+			const std::vector<unsigned int>& left_zero_padding = geometry.left_zero_padding;
+			const std::vector<unsigned int>& input_dimension_sizes = geometry.input_dimension_sizes;
+			const std::vector<unsigned int>::const_iterator output_dimension_sizes_it = geometry.output_dimension_sizes.begin();
+			const std::vector<unsigned int>::const_iterator input_slices_it = geometry.input_slices.begin();
+			const std::vector<unsigned int>::const_iterator offset_list_it = geometry.offset_list.begin();
+			const unsigned int const_window_elem_count = geometry.window_elem_count;
+			const unsigned int input_feature_map_count = geometry.input_feature_map_count;
+			const unsigned int input_neuron_count = geometry.input_neuron_count;
+			const unsigned int input_neuron_count_per_feature_map = geometry.input_neuron_count_per_feature_map;
+			const unsigned int output_neuron_count = geometry.output_neuron_count;
+			const unsigned int output_neuron_count_per_feature_map = geometry.output_neuron_count_per_feature_map;
+
+			nnforge_array<unsigned int, convolution_plain_geometry::max_dimension_count> current_output_position;
+			nnforge_array<int, convolution_plain_geometry::max_dimension_count> current_input_position;
+			std::vector<float> weights_local(const_window_elem_count, 0.0F);
+
+			for(int workload_id = start_workload_id; workload_id < end_workload_id; ++workload_id)
+			{
+				int feature_map_pair_id = workload_id;
+				int output_feature_map_id = feature_map_pair_id / input_feature_map_count;
+				int input_feature_map_id = feature_map_pair_id - (output_feature_map_id * input_feature_map_count);
+
+				std::vector<float>::iterator gradient_weights_it_base = gradient_weights + (output_feature_map_id * (const_window_elem_count * input_feature_map_count)) + (const_window_elem_count * input_feature_map_id);
+				std::fill_n(weights_local.begin(), const_window_elem_count, 0.0F);
+
+				for(int entry_id = 0; entry_id < entry_count; ++entry_id)
+				{
+					std::vector<float>::const_iterator in_it_base = in_it_global + (entry_id * input_neuron_count) + (input_feature_map_id * input_neuron_count_per_feature_map);
+					std::vector<float>::const_iterator out_err_it_base = out_err_it_global + (entry_id * output_neuron_count) + (output_feature_map_id * output_neuron_count_per_feature_map);
+
+					std::fill_n(current_input_position.begin(), convolution_plain_geometry::max_dimension_count, 0);
+					std::fill_n(current_output_position.begin(), convolution_plain_geometry::max_dimension_count, 0);
+					for(std::vector<float>::const_iterator out_err_it = out_err_it_base; out_err_it != out_err_it_base + output_neuron_count_per_feature_map; ++out_err_it)
+					{
+						int in_it_offset = 0;
+
+						for(unsigned int i = 0; i < dimension_count; ++i)
+							current_input_position[i] = static_cast<int>(current_output_position[i]) - static_cast<int>(left_zero_padding[i]);
+
+						for(unsigned int i = 0; i < dimension_count; ++i)
+							in_it_offset += current_input_position[i] * (*(input_slices_it + i));
+
+						float current_err = *out_err_it;
+
+						int ind = 0;
+						for(int w = current_input_position[3]; w < current_input_position[3] + static_cast<int>(window_sizes[3]); ++w)
+						{
+							bool fit3 = ((unsigned int)w < (unsigned int)input_dimension_sizes[3]);
+							for(int z = current_input_position[2]; z < current_input_position[2] + static_cast<int>(window_sizes[2]); ++z)
+							{
+								bool fit2 = fit3 && ((unsigned int)z < (unsigned int)input_dimension_sizes[2]);
+								for(int y = current_input_position[1]; y < current_input_position[1] + static_cast<int>(window_sizes[1]); ++y)
+								{
+									bool fit1 = fit2 && ((unsigned int)y < (unsigned int)input_dimension_sizes[1]);
+									for(int x = current_input_position[0]; x < current_input_position[0] + static_cast<int>(window_sizes[0]); ++x)
+									{
+										bool fit0 = fit1 && ((unsigned int)x < (unsigned int)input_dimension_sizes[0]);
+										if (fit0)
+										{
+											float in_neuron = *(in_it_base + (in_it_offset + *(offset_list_it + ind)));
+											weights_local[ind] += (in_neuron * current_err);
+										}
+										++ind;
+									}
+								}
+							}
+						}
+
+						// Go to the next output element
+						for(unsigned int i = 0; i < dimension_count; ++i)
+						{
+							if ((++current_output_position[i]) < *(output_dimension_sizes_it + i))
+								break;
+							current_output_position[i] = 0;
+						}
+					}
+				}
+
+				std::vector<float>::iterator weights_local_it = weights_local.begin();
+				for(std::vector<float>::iterator it = gradient_weights_it_base; it != gradient_weights_it_base + const_window_elem_count; ++it, ++weights_local_it)
+					*it += *weights_local_it;
+			}
+		}
+
+		convolution_update_biases_plain_task::convolution_update_biases_plain_task(
+			const convolution_plain_geometry& geometry,
+			std::vector<float>::const_iterator out_err_it_global,
+			std::vector<float>::iterator gradient_biases,
+			unsigned int entry_count)
+			: geometry(geometry)
+			, out_err_it_global(out_err_it_global)
+			, gradient_biases(gradient_biases)
+			, entry_count(static_cast<int>(entry_count))
+		{
+		}
+
+		void convolution_update_biases_plain_task::run_tile(
+			int start_workload_id,
+			int end_workload_id)
+		{
+			const unsigned int output_neuron_count = geometry.output_neuron_count;
+			const unsigned int output_neuron_count_per_feature_map = geometry.output_neuron_count_per_feature_map;
+
+			for(int workload_id = start_workload_id; workload_id < end_workload_id; ++workload_id)
+			{
+				int output_feature_map_id = workload_id;
+
+				float sum = 0.0F;
+				for(int entry_id = 0; entry_id < entry_count; ++entry_id)
+				{
+					std::vector<float>::const_iterator out_err_it_base = out_err_it_global + (entry_id * output_neuron_count) + (output_feature_map_id * output_neuron_count_per_feature_map);
+					for(std::vector<float>::const_iterator out_err_it = out_err_it_base; out_err_it != out_err_it_base + output_neuron_count_per_feature_map; ++out_err_it)
+						sum += *out_err_it;
+				}
+
+				*(gradient_biases + output_feature_map_id) += sum;
+			}
+		}
+	}
+}
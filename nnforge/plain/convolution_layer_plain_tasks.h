@@ -0,0 +1,156 @@
+/*
+ *  Copyright 2011-2014 Maxim Milakov
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#pragma once
+
+#include "plain_thread_pool.h"
+
+#include "../convolution_layer.h"
+#include "../layer_configuration_specific.h"
+
+#include <vector>
+
+namespace nnforge
+{
+	namespace plain
+	{
+		// Window geometry shared by plain convolution kernels, all the sizes are extended to max_dimension_count
+		struct convolution_plain_geometry
+		{
+			convolution_plain_geometry(
+				const convolution_layer& layer,
+				const layer_configuration_specific& input_configuration_specific,
+				const layer_configuration_specific& output_configuration_specific);
+
+			static const int max_dimension_count = 4;
+
+			unsigned int dimension_count;
+			std::vector<unsigned int> window_sizes;
+			std::vector<unsigned int> left_zero_padding;
+			std::vector<unsigned int> input_dimension_sizes;
+			std::vector<unsigned int> output_dimension_sizes;
+			std::vector<unsigned int> input_slices;
+			std::vector<unsigned int> offset_list;
+			unsigned int window_elem_count;
+			unsigned int input_feature_map_count;
+			unsigned int output_feature_map_count;
+			unsigned int input_neuron_count;
+			unsigned int input_neuron_count_per_feature_map;
+			unsigned int output_neuron_count;
+			unsigned int output_neuron_count_per_feature_map;
+		};
+
+		// Workload item is (entry, output feature map)
+		class convolution_forward_plain_task : public plain_thread_pool::task
+		{
+		public:
+			convolution_forward_plain_task(
+				const convolution_plain_geometry& geometry,
+				std::vector<float>::const_iterator in_it_global,
+				std::vector<float>::iterator out_it_global,
+				std::vector<float>::const_iterator weights,
+				std::vector<float>::const_iterator biases);
+
+			virtual void run_tile(
+				int start_workload_id,
+				int end_workload_id);
+
+		private:
+			const convolution_plain_geometry& geometry;
+			const std::vector<float>::const_iterator in_it_global;
+			const std::vector<float>::iterator out_it_global;
+			const std::vector<float>::const_iterator weights;
+			const std::vector<float>::const_iterator biases;
+
+		private:
+			convolution_forward_plain_task& operator =(const convolution_forward_plain_task&);
+		};
+
+		// Workload item is (entry, input feature map)
+		class convolution_backprop_plain_task : public plain_thread_pool::task
+		{
+		public:
+			convolution_backprop_plain_task(
+				const convolution_plain_geometry& geometry,
+				std::vector<float>::iterator in_err_it_global,
+				std::vector<float>::const_iterator out_err_it_global,
+				std::vector<float>::const_iterator weights);
+
+			virtual void run_tile(
+				int start_workload_id,
+				int end_workload_id);
+
+		private:
+			const convolution_plain_geometry& geometry;
+			const std::vector<float>::iterator in_err_it_global;
+			const std::vector<float>::const_iterator out_err_it_global;
+			const std::vector<float>::const_iterator weights;
+
+		private:
+			convolution_backprop_plain_task& operator =(const convolution_backprop_plain_task&);
+		};
+
+		// Workload item is (output feature map, input feature map)
+		class convolution_update_weights_plain_task : public plain_thread_pool::task
+		{
+		public:
+			convolution_update_weights_plain_task(
+				const convolution_plain_geometry& geometry,
+				std::vector<float>::const_iterator in_it_global,
+				std::vector<float>::const_iterator out_err_it_global,
+				std::vector<float>::iterator gradient_weights,
+				unsigned int entry_count);
+
+			virtual void run_tile(
+				int start_workload_id,
+				int end_workload_id);
+
+		private:
+			const convolution_plain_geometry& geometry;
+			const std::vector<float>::const_iterator in_it_global;
+			const std::vector<float>::const_iterator out_err_it_global;
+			const std::vector<float>::iterator gradient_weights;
+			const int entry_count;
+
+		private:
+			convolution_update_weights_plain_task& operator =(const convolution_update_weights_plain_task&);
+		};
+
+		// Workload item is output feature map
+		class convolution_update_biases_plain_task : public plain_thread_pool::task
+		{
+		public:
+			convolution_update_biases_plain_task(
+				const convolution_plain_geometry& geometry,
+				std::vector<float>::const_iterator out_err_it_global,
+				std::vector<float>::iterator gradient_biases,
+				unsigned int entry_count);
+
+			virtual void run_tile(
+				int start_workload_id,
+				int end_workload_id);
+
+		private:
+			const convolution_plain_geometry& geometry;
+			const std::vector<float>::const_iterator out_err_it_global;
+			const std::vector<float>::iterator gradient_biases;
+			const int entry_count;
+
+		private:
+			convolution_update_biases_plain_task& operator =(const convolution_update_biases_plain_task&);
+		};
+	}
+}
@@ -52,9 +52,6 @@ namespace nnforge
 				const layer_configuration_specific& input_configuration_specific,
 				const layer_configuration_specific& output_configuration_specific,
 				plain_running_configuration_const_smart_ptr plain_config) const;
-
-		private:
-			static const int max_dimension_count;
 		};
 	}
 }
@@ -21,6 +21,7 @@
 #include "network_analyzer_plain_factory.h"
 
 #include <iostream>
+#include <algorithm>
 
 #ifdef _OPENMP
 #include <omp.h>
@@ -37,6 +38,12 @@ namespace nnforge
 			: plain_openmp_thread_count(1)
 			#endif
 			, plain_max_global_memory_usage(0.5F)
+			, plain_batch_size_autotune(false)
+			, plain_thread_pool(false)
+			, plain_numa_node_count(1)
+			, plain_tester_chunk_cache_size(0.0F)
+			, plain_training_stat_sample_period(1)
+			, plain_overlap_weight_update(false)
 		{
 		}
 
@@ -46,7 +53,7 @@ namespace nnforge
 
 		void factory_generator_plain::initialize()
 		{
-			plain_config = plain_running_configuration_const_smart_ptr(new plain_running_configuration(plain_openmp_thread_count, plain_max_global_memory_usage));
+			plain_config = plain_running_configuration_const_smart_ptr(new plain_running_configuration(plain_openmp_thread_count, plain_max_global_memory_usage, plain_batch_size_autotune, plain_batch_size_profile, plain_thread_pool, plain_thread_affinity, plain_numa_node_count, plain_tester_chunk_cache_size, static_cast<unsigned int>(std::max(plain_training_stat_sample_period, 0)), plain_overlap_weight_update));
 		}
 
 		network_tester_factory_smart_ptr factory_generator_plain::create_tester_factory() const
@@ -69,6 +76,7 @@ namespace nnforge
 			std::vector<float_option> res;
 
 			res.push_back(float_option("plain_max_global_memory_usage,M", &plain_max_global_memory_usage, 0.5F, "memory to be used by single plain configuration, in GB."));
+			res.push_back(float_option("plain_tester_chunk_cache_size", &plain_tester_chunk_cache_size, 0.0F, "cache size in MB the tester fits chunks of entries into, streaming each chunk through all the layers, 0 disables chunking."));
 
 			return res;
 		}
@@ -80,6 +88,29 @@ namespace nnforge
 			#ifdef _OPENMP
 			res.push_back(int_option("plain_openmp_thread_count", &plain_openmp_thread_count, omp_get_max_threads(), "count of threads to be used in OpenMP."));
 			#endif
+			res.push_back(int_option("plain_numa_node_count", &plain_numa_node_count, 1, "count of NUMA shards the updater splits the batch between, 0 to use all the nodes, 1 disables sharding."));
+			res.push_back(int_option("plain_training_stat_sample_period", &plain_training_stat_sample_period, 1, "collect absolute update statistics on every n-th gradient application, 0 to collect them on the last application of the epoch only."));
+
+			return res;
+		}
+
+		std::vector<bool_option> factory_generator_plain::get_bool_options()
+		{
+			std::vector<bool_option> res;
+
+			res.push_back(bool_option("plain_batch_size_autotune", &plain_batch_size_autotune, false, "benchmark updater and tester batch sizes on the actual schema and use the fastest ones."));
+			res.push_back(bool_option("plain_thread_pool", &plain_thread_pool, false, "run convolution kernels and gradient application on persistent worker threads instead of OpenMP parallel regions. All the other layers keep using OpenMP, so both thread sets exist: pool threads sleep while OpenMP layers run, set OMP_WAIT_POLICY=passive to keep OpenMP threads from spinning while the pool runs."));
+			res.push_back(bool_option("plain_overlap_weight_update", &plain_overlap_weight_update, false, "compute weight gradient of each layer concurrently with backprop of the preceding layers, splitting the threads between them."));
+
+			return res;
+		}
+
+		std::vector<string_option> factory_generator_plain::get_string_options()
+		{
+			std::vector<string_option> res;
+
+			res.push_back(string_option("plain_batch_size_profile", &plain_batch_size_profile, "", "file to cache autotuned batch sizes in, no caching if empty."));
+			res.push_back(string_option("plain_thread_affinity", &plain_thread_affinity, "", "cores to pin thread pool workers to, like 0-3,8-11, enables thread pool, OpenMP threads are not pinned."));
 
 			return res;
 		}
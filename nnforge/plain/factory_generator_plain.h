@@ -44,9 +44,21 @@ namespace nnforge
 
 			virtual std::vector<int_option> get_int_options();
 
+			virtual std::vector<bool_option> get_bool_options();
+
+			virtual std::vector<string_option> get_string_options();
+
 		protected:
 			float plain_max_global_memory_usage;
 			int plain_openmp_thread_count;
+			bool plain_batch_size_autotune;
+			std::string plain_batch_size_profile;
+			bool plain_thread_pool;
+			std::string plain_thread_affinity;
+			int plain_numa_node_count;
+			float plain_tester_chunk_cache_size;
+			int plain_training_stat_sample_period;
+			bool plain_overlap_weight_update;
 
 			plain_running_configuration_const_smart_ptr plain_config;
 		};
@@ -109,6 +109,13 @@ namespace nnforge
 				for(int i = 0; i < elem_count; ++i)
 					*(input_converted_buf_it_start + i) = *(input_buf_it_start + i);
 			}
+			else if (type_code == neuron_data_type::type_half)
+			{
+				const unsigned short * const input_buf_it_start = static_cast<const unsigned short *>(input);
+				#pragma omp parallel for default(none) schedule(guided) num_threads(plain_config->openmp_thread_count)
+				for(int i = 0; i < elem_count; ++i)
+					*(input_converted_buf_it_start + i) = neuron_data_type::half_to_float(*(input_buf_it_start + i));
+			}
 			else
 				throw neural_network_exception((boost::format("actual_set_input_data cannot handle input neurons of type %1%") % type_code).str());
 
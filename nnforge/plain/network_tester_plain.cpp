@@ -17,11 +17,14 @@
 #include "network_tester_plain.h"
 
 #include "layer_tester_plain_factory.h"
+#include "plain_memory_usage_tracker.h"
 #include "../neural_network_exception.h"
 #include "../debug_util.h"
+#include "../data_reader_async_prefetcher.h"
 
 #include <boost/format.hpp>
 #include <boost/filesystem.hpp>
+#include <boost/chrono.hpp>
 
 namespace nnforge
 {
@@ -45,6 +48,7 @@ namespace nnforge
 		output_neuron_value_set_smart_ptr network_tester_plain::actual_run(unsupervised_data_reader& reader)
 		{
 			reader.reset();
+			memory_usage = memory_usage_stat_smart_ptr(new memory_usage_stat());
 
 			const unsigned int input_neuron_count = reader.get_input_configuration().get_neuron_count();
 			const unsigned int output_neuron_count = (layer_config_list.end() - 1)->get_neuron_count();
@@ -53,18 +57,41 @@ namespace nnforge
 			const unsigned int neuron_count_per_input_feature_map = reader.get_input_configuration().get_neuron_count_per_feature_map();
 			neuron_data_type::input_type type_code = reader.get_input_type();
 			size_t input_neuron_elem_size = reader.get_input_neuron_elem_size();
+			const std::vector<std::pair<float, float> > input_mul_add_list = reader.get_input_mul_add_list();
+			if ((type_code == neuron_data_type::type_uint8_scaled) && (input_mul_add_list.size() != input_feature_map_count))
+				throw neural_network_exception((boost::format("actual_test got %1% mult-add pairs for %2% input feature maps") % input_mul_add_list.size() % input_feature_map_count).str());
 
 			output_neuron_value_set_smart_ptr predicted_output_neuron_value_set(new output_neuron_value_set(entry_count, output_neuron_count));
 
 			buffer_plain_size_configuration buffers_config;
 			update_buffers_configuration_testing(buffers_config);
-			buffers_config.add_per_entry_buffer(input_neuron_count * input_neuron_elem_size); // input
 			buffers_config.add_per_entry_buffer(input_neuron_count * sizeof(float)); // converted input
+			const unsigned int cache_entry_count = plain_config->get_cache_entry_count(buffers_config);
+			if (cache_entry_count > 0)
+			{
+				// Layer buffers hold a single chunk, only input staging scales with the entry count read at once
+				buffers_config.add_constant_buffer(buffers_config.per_entry_buffer_size * cache_entry_count);
+				buffers_config.per_entry_buffer_size = 0;
+			}
+			buffers_config.add_per_entry_buffer(input_neuron_count * input_neuron_elem_size); // input
+			buffers_config.add_per_entry_buffer(input_neuron_count * input_neuron_elem_size); // input being prefetched
+
+			unsigned int max_entry_count = std::min<unsigned int>(plain_config->get_max_entry_count(buffers_config), reader.get_entry_count());
+			if (plain_config->autotuner)
+			{
+				tester_batch_size_benchmark bm(*this);
+				max_entry_count = std::min(max_entry_count, plain_config->autotuner->tune(
+					batch_size_autotuner::get_key("tester", *schema, layer_config_list, plain_config->openmp_thread_count),
+					plain_config->get_max_entry_count(buffers_config),
+					bm));
+			}
 
-			const unsigned int max_entry_count = std::min<unsigned int>(plain_config->get_max_entry_count(buffers_config), reader.get_entry_count());
+			const unsigned int chunk_entry_count = (cache_entry_count > 0) ? std::min(cache_entry_count, max_entry_count) : max_entry_count;
 
-			std::vector<unsigned char> input_buf(input_neuron_count * max_entry_count * input_neuron_elem_size);
-			additional_buffer_smart_ptr input_converted_buf(new std::vector<float>(input_neuron_count * max_entry_count));
+			data_reader_async_prefetcher prefetcher(reader, max_entry_count);
+			additional_buffer_smart_ptr input_converted_buf(new std::vector<float>(input_neuron_count * chunk_entry_count));
+			memory_usage_stat::scoped_usage prefetcher_usage(memory_usage, plain_memory_usage_tracker::input_staging_category, prefetcher.get_buffers_size());
+			input_converted_buf = plain_memory_usage_tracker::track_buffer(memory_usage, input_converted_buf, plain_memory_usage_tracker::input_staging_category);
 
 			additional_buffer_smart_ptr output_buffer = input_converted_buf;
 			std::vector<std::pair<additional_buffer_smart_ptr, additional_buffer_set> > input_buffer_and_additional_buffers_pack;
@@ -75,115 +102,149 @@ namespace nnforge
 				for(std::vector<const_layer_tester_plain_smart_ptr>::const_iterator it = tester_list.begin(); it != tester_list.end(); ++it, ++layer_it, ++input_config_it)
 				{
 					additional_buffer_set additional_buffers = (*it)->allocate_additional_buffers(
-						max_entry_count,
+						chunk_entry_count,
 						*layer_it,
 						*input_config_it,
 						*(input_config_it + 1),
 						plain_config);
+					additional_buffer_smart_ptr layer_output_buffer = plain_memory_usage_tracker::track_tester_buffers(
+						memory_usage,
+						additional_buffers,
+						(*it)->get_output_buffer(output_buffer, additional_buffers));
 					input_buffer_and_additional_buffers_pack.push_back(std::make_pair(output_buffer, additional_buffers));
-					output_buffer = (*it)->get_output_buffer(output_buffer, additional_buffers);
+					output_buffer = layer_output_buffer;
 				}
 			}
 
 			bool entries_remained_for_loading = true;
 			unsigned int entries_copied_count = 0;
+			prefetcher.start(max_entry_count);
 			while (entries_remained_for_loading)
 			{
-				unsigned int entries_available_for_processing_count = 0;
-				while(entries_available_for_processing_count < max_entry_count)
-				{
-					bool entry_read = reader.read(&(*(input_buf.begin() + (input_neuron_count * entries_available_for_processing_count * input_neuron_elem_size))));
-					if (!entry_read)
-					{
-						entries_remained_for_loading = false;
-						break;
-					}
-					entries_available_for_processing_count++;
-				}
+				unsigned int entries_available_for_processing_count = prefetcher.wait();
+				if (entries_available_for_processing_count < max_entry_count)
+					entries_remained_for_loading = false;
 
 				if (entries_available_for_processing_count == 0)
 					break;
 
-				// Convert input
+				// The next entries are read while the current ones are processed
+				if (entries_remained_for_loading)
+					prefetcher.start(max_entry_count);
+
+				const std::vector<unsigned char>& input_buf = prefetcher.get_input_buffer();
+
+				// Each chunk goes through all the layers before the next one starts
+				for(unsigned int chunk_start_entry_id = 0; chunk_start_entry_id < entries_available_for_processing_count; chunk_start_entry_id += chunk_entry_count)
 				{
-					const int elem_count = static_cast<int>(entries_available_for_processing_count * input_neuron_count);
-					const std::vector<float>::iterator input_converted_buf_it_start = input_converted_buf->begin();
-					if (type_code == neuron_data_type::type_byte)
-					{
-						const unsigned char * const input_buf_it_start = &(*input_buf.begin());
-						#pragma omp parallel for default(none) schedule(guided) num_threads(plain_config->openmp_thread_count)
-						for(int i = 0; i < elem_count; ++i)
-							*(input_converted_buf_it_start + i) = static_cast<float>(*(input_buf_it_start + i)) * (1.0F / 255.0F);
-					}
-					else if (type_code == neuron_data_type::type_float)
+					const unsigned int current_chunk_entry_count = std::min(chunk_entry_count, entries_available_for_processing_count - chunk_start_entry_id);
+
+					// Convert input
 					{
-						const float * const input_buf_it_start = reinterpret_cast<float *>(&(*input_buf.begin()));
-						#pragma omp parallel for default(none) schedule(guided) num_threads(plain_config->openmp_thread_count)
-						for(int i = 0; i < elem_count; ++i)
-							*(input_converted_buf_it_start + i) = *(input_buf_it_start + i);
+						const int elem_count = static_cast<int>(current_chunk_entry_count * input_neuron_count);
+						const std::vector<float>::iterator input_converted_buf_it_start = input_converted_buf->begin();
+						if (type_code == neuron_data_type::type_byte)
+						{
+							const unsigned char * const input_buf_it_start = &(*(input_buf.begin() + (input_neuron_count * chunk_start_entry_id * input_neuron_elem_size)));
+							#pragma omp parallel for default(none) schedule(guided) num_threads(plain_config->openmp_thread_count)
+							for(int i = 0; i < elem_count; ++i)
+								*(input_converted_buf_it_start + i) = static_cast<float>(*(input_buf_it_start + i)) * (1.0F / 255.0F);
+						}
+						else if (type_code == neuron_data_type::type_float)
+						{
+							const float * const input_buf_it_start = reinterpret_cast<const float *>(&(*(input_buf.begin() + (input_neuron_count * chunk_start_entry_id * input_neuron_elem_size))));
+							#pragma omp parallel for default(none) schedule(guided) num_threads(plain_config->openmp_thread_count)
+							for(int i = 0; i < elem_count; ++i)
+								*(input_converted_buf_it_start + i) = *(input_buf_it_start + i);
+						}
+						else if (type_code == neuron_data_type::type_half)
+						{
+							const unsigned short * const input_buf_it_start = reinterpret_cast<const unsigned short *>(&(*(input_buf.begin() + (input_neuron_count * chunk_start_entry_id * input_neuron_elem_size))));
+							#pragma omp parallel for default(none) schedule(guided) num_threads(plain_config->openmp_thread_count)
+							for(int i = 0; i < elem_count; ++i)
+								*(input_converted_buf_it_start + i) = neuron_data_type::half_to_float(*(input_buf_it_start + i));
+						}
+						else if (type_code == neuron_data_type::type_uint8_scaled)
+						{
+							// Each workload is a single feature map of a single entry
+							const unsigned char * const input_buf_it_start = &(*(input_buf.begin() + (input_neuron_count * chunk_start_entry_id * input_neuron_elem_size)));
+							const std::pair<float, float> * const mul_add_list_start = &(*input_mul_add_list.begin());
+							const int feature_map_count = static_cast<int>(input_feature_map_count);
+							const int neuron_count_per_feature_map = static_cast<int>(neuron_count_per_input_feature_map);
+							const int workload_count = static_cast<int>(current_chunk_entry_count * input_feature_map_count);
+							#pragma omp parallel for default(none) schedule(guided) num_threads(plain_config->openmp_thread_count)
+							for(int workload_id = 0; workload_id < workload_count; ++workload_id)
+							{
+								const std::pair<float, float> mul_add = *(mul_add_list_start + (workload_id % feature_map_count));
+								const unsigned char * src = input_buf_it_start + workload_id * neuron_count_per_feature_map;
+								std::vector<float>::iterator dst = input_converted_buf_it_start + workload_id * neuron_count_per_feature_map;
+								for(int i = 0; i < neuron_count_per_feature_map; ++i)
+									*(dst + i) = static_cast<float>(*(src + i)) * mul_add.first + mul_add.second;
+							}
+						}
+						else throw neural_network_exception((boost::format("actual_run cannot handle input neurons of type %1%") % type_code).str());
 					}
-					else throw neural_network_exception((boost::format("actual_run cannot handle input neurons of type %1%") % type_code).str());
-				}
 
-				// Run ann
-				{
-					const const_layer_list& layer_list = *schema;
-					const_layer_list::const_iterator layer_it = layer_list.begin();
-					layer_configuration_specific_list::const_iterator input_config_it = layer_config_list.begin();
-					std::vector<std::pair<additional_buffer_smart_ptr, additional_buffer_set> >::iterator buffers_it = input_buffer_and_additional_buffers_pack.begin();
-					layer_data_list::const_iterator data_it = net_data->data_list.begin();
-					layer_data_custom_list::const_iterator data_custom_it = net_data->data_custom_list.begin();
-					unsigned int layer_id = 0;
-					for(std::vector<const_layer_tester_plain_smart_ptr>::const_iterator it = tester_list.begin(); it != tester_list.end(); ++it, ++layer_it, ++input_config_it, ++buffers_it, ++data_it, ++data_custom_it, ++layer_id)
+					// Run ann
 					{
+						const const_layer_list& layer_list = *schema;
+						const_layer_list::const_iterator layer_it = layer_list.begin();
+						layer_configuration_specific_list::const_iterator input_config_it = layer_config_list.begin();
+						std::vector<std::pair<additional_buffer_smart_ptr, additional_buffer_set> >::iterator buffers_it = input_buffer_and_additional_buffers_pack.begin();
+						layer_data_list::const_iterator data_it = net_data->data_list.begin();
+						layer_data_custom_list::const_iterator data_custom_it = net_data->data_custom_list.begin();
+						unsigned int layer_id = 0;
+						for(std::vector<const_layer_tester_plain_smart_ptr>::const_iterator it = tester_list.begin(); it != tester_list.end(); ++it, ++layer_it, ++input_config_it, ++buffers_it, ++data_it, ++data_custom_it, ++layer_id)
+						{
+							/*
+							{
+								boost::filesystem::path dir = "Debug";
+								dir /= "CPU";
+								boost::filesystem::create_directories(dir);
+								debug_util::dump_list(
+									&(*buffers_it->first->begin()),
+									buffers_it->first->size(),
+									(dir / (boost::format("input_neurons_%1%.txt") % layer_id).str()).string().c_str());
+							}
+							*/
+
+							(*it)->test(
+								buffers_it->first,
+								buffers_it->second,
+								plain_config,
+								*layer_it,
+								*data_it,
+								*data_custom_it,
+								*input_config_it,
+								*(input_config_it + 1),
+								current_chunk_entry_count);
+						}
+
 						/*
 						{
 							boost::filesystem::path dir = "Debug";
 							dir /= "CPU";
 							boost::filesystem::create_directories(dir);
 							debug_util::dump_list(
-								&(*buffers_it->first->begin()),
-								buffers_it->first->size(),
-								(dir / (boost::format("input_neurons_%1%.txt") % layer_id).str()).string().c_str());
+								&(*output_buffer->begin()),
+								output_buffer->size(),
+								(dir / "output_neurons.txt").string().c_str());
 						}
 						*/
-
-						(*it)->test(
-							buffers_it->first,
-							buffers_it->second,
-							plain_config,
-							*layer_it,
-							*data_it,
-							*data_custom_it,
-							*input_config_it,
-							*(input_config_it + 1),
-							entries_available_for_processing_count);
 					}
 
-					/*
-					{
-						boost::filesystem::path dir = "Debug";
-						dir /= "CPU";
-						boost::filesystem::create_directories(dir);
-						debug_util::dump_list(
-							&(*output_buffer->begin()),
-							output_buffer->size(),
-							(dir / "output_neurons.txt").string().c_str());
-					}
-					*/
-				}
-
-				// Copy predicted values
-				{
-					const int total_workload = static_cast<int>(entries_available_for_processing_count);
-					const std::vector<float>::const_iterator output_buffer_it = output_buffer->begin();
-					const std::vector<std::vector<float> >::iterator neuron_value_list_it = predicted_output_neuron_value_set->neuron_value_list.begin() + entries_copied_count;
-					#pragma omp parallel for default(none) schedule(guided) num_threads(plain_config->openmp_thread_count)
-					for(int i = 0; i < total_workload; ++i)
+					// Copy predicted values
 					{
-						std::vector<float>::const_iterator src_it = output_buffer_it + (i * output_neuron_count);
-						std::vector<float>& value_list_dest = *(neuron_value_list_it + i);
-						std::copy(src_it, src_it + output_neuron_count, value_list_dest.begin());
+						const int total_workload = static_cast<int>(current_chunk_entry_count);
+						const std::vector<float>::const_iterator output_buffer_it = output_buffer->begin();
+						const std::vector<std::vector<float> >::iterator neuron_value_list_it = predicted_output_neuron_value_set->neuron_value_list.begin() + (entries_copied_count + chunk_start_entry_id);
+						#pragma omp parallel for default(none) schedule(guided) num_threads(plain_config->openmp_thread_count)
+						for(int i = 0; i < total_workload; ++i)
+						{
+							std::vector<float>::const_iterator src_it = output_buffer_it + (i * output_neuron_count);
+							std::vector<float>& value_list_dest = *(neuron_value_list_it + i);
+							std::copy(src_it, src_it + output_neuron_count, value_list_dest.begin());
+						}
 					}
 				}
 
@@ -268,6 +329,17 @@ namespace nnforge
 						*(input_elem_it_start + i) = val;
 					}
 				}
+				else if (type_code == neuron_data_type::type_half)
+				{
+					const unsigned short * const input_buf_it_start = static_cast<const unsigned short *>(input);
+					#pragma omp parallel for default(none) schedule(guided) num_threads(plain_config->openmp_thread_count)
+					for(int i = 0; i < elem_count; ++i)
+					{
+						float val = neuron_data_type::half_to_float(*(input_buf_it_start + i));
+						*(input_converted_buf_it_start + i) = val;
+						*(input_elem_it_start + i) = val;
+					}
+				}
 				else
 					throw neural_network_exception((boost::format("actual_get_snapshot cannot handle input neurons of type %1%") % type_code).str());
 			}
@@ -355,6 +427,13 @@ namespace nnforge
 					for(int i = 0; i < elem_count; ++i)
 						*(input_converted_buf_it_start + i) = *(input_buf_it_start + i);
 				}
+				else if (type_code == neuron_data_type::type_half)
+				{
+					const unsigned short * const input_buf_it_start = static_cast<const unsigned short *>(input);
+					#pragma omp parallel for default(none) schedule(guided) num_threads(plain_config->openmp_thread_count)
+					for(int i = 0; i < elem_count; ++i)
+						*(input_converted_buf_it_start + i) = neuron_data_type::half_to_float(*(input_buf_it_start + i));
+				}
 				else
 					throw neural_network_exception((boost::format("actual_run cannot handle input neurons of type %1%") % type_code).str());
 			}
@@ -413,5 +492,70 @@ namespace nnforge
 					plain_config);
 			}
 		}
+
+		float network_tester_plain::measure_tester_throughput(unsigned int entry_count) const
+		{
+			additional_buffer_smart_ptr input_converted_buf(new std::vector<float>(layer_config_list[0].get_neuron_count() * entry_count, 0.0F));
+
+			std::vector<std::pair<additional_buffer_smart_ptr, additional_buffer_set> > input_buffer_and_additional_buffers_pack;
+			{
+				additional_buffer_smart_ptr output_buffer = input_converted_buf;
+				const const_layer_list& layer_list = *schema;
+				const_layer_list::const_iterator layer_it = layer_list.begin();
+				layer_configuration_specific_list::const_iterator input_config_it = layer_config_list.begin();
+				for(std::vector<const_layer_tester_plain_smart_ptr>::const_iterator it = tester_list.begin(); it != tester_list.end(); ++it, ++layer_it, ++input_config_it)
+				{
+					additional_buffer_set additional_buffers = (*it)->allocate_additional_buffers(
+						entry_count,
+						*layer_it,
+						*input_config_it,
+						*(input_config_it + 1),
+						plain_config);
+					input_buffer_and_additional_buffers_pack.push_back(std::make_pair(output_buffer, additional_buffers));
+					output_buffer = (*it)->get_output_buffer(output_buffer, additional_buffers);
+				}
+			}
+
+			unsigned int iteration_count = 0;
+			boost::chrono::steady_clock::time_point start = boost::chrono::high_resolution_clock::now();
+			boost::chrono::duration<float> sec(0.0F);
+			while ((iteration_count < 2) || (sec.count() < batch_size_autotuner::min_benchmark_seconds))
+			{
+				const const_layer_list& layer_list = *schema;
+				const_layer_list::const_iterator layer_it = layer_list.begin();
+				layer_configuration_specific_list::const_iterator input_config_it = layer_config_list.begin();
+				std::vector<std::pair<additional_buffer_smart_ptr, additional_buffer_set> >::iterator buffers_it = input_buffer_and_additional_buffers_pack.begin();
+				layer_data_list::const_iterator data_it = net_data->data_list.begin();
+				layer_data_custom_list::const_iterator data_custom_it = net_data->data_custom_list.begin();
+				for(std::vector<const_layer_tester_plain_smart_ptr>::const_iterator it = tester_list.begin(); it != tester_list.end(); ++it, ++layer_it, ++input_config_it, ++buffers_it, ++data_it, ++data_custom_it)
+				{
+					(*it)->test(
+						buffers_it->first,
+						buffers_it->second,
+						plain_config,
+						*layer_it,
+						*data_it,
+						*data_custom_it,
+						*input_config_it,
+						*(input_config_it + 1),
+						entry_count);
+				}
+
+				++iteration_count;
+				sec = boost::chrono::high_resolution_clock::now() - start;
+			}
+
+			return static_cast<float>(iteration_count * entry_count) / sec.count();
+		}
+
+		network_tester_plain::tester_batch_size_benchmark::tester_batch_size_benchmark(const network_tester_plain& tester)
+			: tester(tester)
+		{
+		}
+
+		float network_tester_plain::tester_batch_size_benchmark::measure(unsigned int entry_count)
+		{
+			return tester.measure_tester_throughput(entry_count);
+		}
 	}
 }
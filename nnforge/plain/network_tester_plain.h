@@ -20,6 +20,7 @@
 #include "plain_running_configuration.h"
 #include "layer_tester_plain.h"
 #include "buffer_plain_size_configuration.h"
+#include "batch_size_autotuner.h"
 
 namespace nnforge
 {
@@ -63,6 +64,20 @@ namespace nnforge
 
 			void update_buffers_configuration_testing(buffer_plain_size_configuration& buffer_configuration) const;
 
+			// Runs all the layers on dummy data
+			float measure_tester_throughput(unsigned int entry_count) const;
+
+			class tester_batch_size_benchmark : public batch_size_autotuner::benchmark
+			{
+			public:
+				tester_batch_size_benchmark(const network_tester_plain& tester);
+
+				virtual float measure(unsigned int entry_count);
+
+			private:
+				const network_tester_plain& tester;
+			};
+
 			plain_running_configuration_const_smart_ptr plain_config;
 
 			const_layer_tester_plain_list tester_list;
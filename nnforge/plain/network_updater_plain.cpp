@@ -18,14 +18,20 @@
 
 #include <stack>
 #include <numeric>
+#include <iostream>
 
 #include <boost/format.hpp>
+#include <boost/chrono.hpp>
+#include <boost/bind.hpp>
 
 #include "layer_tester_plain_factory.h"
 #include "layer_updater_plain_factory.h"
+#include "plain_memory_usage_tracker.h"
+#include "apply_gradient_plain_task.h"
 
 #include "../neural_network_exception.h"
 #include "../nn_types.h"
+#include "../data_reader_async_prefetcher.h"
 
 #include "../debug_util.h"
 #include <boost/filesystem.hpp>
@@ -46,6 +52,7 @@ namespace nnforge
 			plain_running_configuration_const_smart_ptr plain_config)
 			: network_updater(schema, ef)
 			, plain_config(plain_config)
+			, fused_momentum_reported(false)
 		{
 			const const_layer_list& layer_list = *schema;
 
@@ -77,6 +84,16 @@ namespace nnforge
 		{
 		}
 
+		void network_updater_plain::set_all_reducer(ring_all_reducer_smart_ptr all_reducer)
+		{
+			this->all_reducer = all_reducer;
+		}
+
+		void network_updater_plain::set_weight_synchronizer(weight_synchronizer_smart_ptr synchronizer)
+		{
+			this->synchronizer = synchronizer;
+		}
+
 		std::pair<testing_result_smart_ptr, training_stat_smart_ptr> network_updater_plain::actual_update(
 			supervised_data_reader& reader,
 			const std::vector<std::vector<float> >& learning_rates,
@@ -87,6 +104,34 @@ namespace nnforge
 			const std::map<unsigned int, float>& layer_to_dropout_rate_map)
 		{
 			testing_result_smart_ptr testing_res(new testing_result(ef));
+			memory_usage = memory_usage_stat_smart_ptr(new memory_usage_stat());
+
+			boost::chrono::steady_clock::time_point start = boost::chrono::high_resolution_clock::now();
+			if (all_reducer && synchronizer)
+				throw neural_network_exception("Update cannot be both data-parallel and stale-synchronous");
+			// Partitions of the workers might differ by an entry, and so might the numbers of gradient applications.
+			// Workers having fewer of them pad the epoch with applications of no entries, keeping all-reduce calls matched
+			unsigned int worker_gradient_applied_count = 0;
+			if (all_reducer)
+			{
+				all_reducer->broadcast(data->data_list);
+
+				// Counts are exchanged as 16-bit halves to be exact in float
+				const unsigned int local_gradient_applied_count = (reader.get_entry_count() + batch_size - 1) / batch_size;
+				std::vector<float> gradient_applied_count_list(all_reducer->get_worker_count() * 2, 0.0F);
+				gradient_applied_count_list[all_reducer->get_worker_id() * 2] = static_cast<float>(local_gradient_applied_count >> 16);
+				gradient_applied_count_list[all_reducer->get_worker_id() * 2 + 1] = static_cast<float>(local_gradient_applied_count & 0xFFFF);
+				all_reducer->all_reduce(gradient_applied_count_list);
+				for(unsigned int worker_id = 0; worker_id < all_reducer->get_worker_count(); ++worker_id)
+					worker_gradient_applied_count = std::max(
+						worker_gradient_applied_count,
+						(static_cast<unsigned int>(gradient_applied_count_list[worker_id * 2]) << 16) + static_cast<unsigned int>(gradient_applied_count_list[worker_id * 2 + 1]));
+
+				all_reducer->reset_communication_seconds();
+			}
+			// Shard replicas are initialized from the synchronized weights
+			if (synchronizer)
+				synchronizer->update_started(data->data_list);
 
 			std::vector<std::vector<double> > updates_accumulated;
 			for(std::vector<layer_data_smart_ptr>::const_iterator it = data->data_list.begin(); it != data->data_list.end(); ++it)
@@ -101,11 +146,22 @@ namespace nnforge
 			const unsigned int neuron_count_per_output_feature_map = reader.get_output_configuration().get_neuron_count_per_feature_map();
 			neuron_data_type::input_type type_code = reader.get_input_type();
 			size_t input_neuron_elem_size = reader.get_input_neuron_elem_size();
+			const std::vector<std::pair<float, float> > input_mul_add_list = reader.get_input_mul_add_list();
 
 			if (error_function_fused_with_activation && (neuron_count_per_output_feature_map != 1))
 				throw neural_network_exception("Error function is fused with activation but output_neuron_count_per_feature_map is not equal 1: not implemented");
 
 			unsigned int updater_max_count = std::max(get_updater_max_count(), 1U);
+			unsigned int max_entry_count_in_chunk = max_entry_count_in_single_batch;
+			if (plain_config->autotuner)
+			{
+				updater_batch_size_benchmark bm(*this, data);
+				updater_max_count = plain_config->autotuner->tune(
+					batch_size_autotuner::get_key("updater", *schema, layer_config_list, plain_config->openmp_thread_count),
+					updater_max_count,
+					bm);
+				max_entry_count_in_chunk = updater_max_count;
+			}
 			unsigned int updater_entry_count;
 			std::vector<unsigned int> entry_read_count_list;
 			unsigned int max_entry_read_count;
@@ -125,30 +181,34 @@ namespace nnforge
 				}
 			}
 
+			// Gradient is zero-initialized by the constructor, it keeps momentum as well
 			layer_data_list_smart_ptr gradient(new layer_data_list(*schema));
-			gradient->fill(0.0F);
-			layer_data_list_smart_ptr previous_upd;
+			plain_memory_usage_tracker::track_layer_data_list(memory_usage, *gradient, plain_memory_usage_tracker::gradients_category);
 			if (momentum > 0.0F)
-			{
-				previous_upd = layer_data_list_smart_ptr(new layer_data_list(*schema));
-				previous_upd->fill(0.0F);
-			}
+				report_fused_momentum(*gradient, 1);
+			// Worker 0 alone carries momentum in data-parallel training, as the gradients are summed
+			bool keep_momentum = (!all_reducer) || (all_reducer->get_worker_id() == 0);
 
 			{
 				buffer_plain_size_configuration buffers_config;
 				update_buffers_configuration(buffers_config, updater_entry_count);
 				buffers_config.add_per_entry_buffer(input_neuron_count * input_neuron_elem_size); // input
+				buffers_config.add_per_entry_buffer(input_neuron_count * input_neuron_elem_size); // input being prefetched
 				buffers_config.add_per_entry_buffer(input_neuron_count * sizeof(float)); // converted input
 				buffers_config.add_per_entry_buffer(output_neuron_count * sizeof(float)); // output
+				buffers_config.add_per_entry_buffer(output_neuron_count * sizeof(float)); // output being prefetched
 				buffers_config.add_constant_buffer(output_neuron_count * sizeof(float) * updater_entry_count); // initial error
 				for(std::vector<layer_data_smart_ptr>::iterator it = data->data_list.begin(); it != data->data_list.end(); ++it)
 				{
 					for(layer_data::const_iterator it2 = (*it)->begin(); it2 != (*it)->end(); ++it2)
 					{
 						buffers_config.add_constant_buffer(it2->size() * sizeof(float)); // data
-						buffers_config.add_constant_buffer(it2->size() * sizeof(float)); // gradient
-						if (momentum > 0.0F)
-							buffers_config.add_constant_buffer(it2->size() * sizeof(float)); // previous_upd
+						buffers_config.add_constant_buffer(it2->size() * sizeof(float)); // gradient with momentum
+						for(unsigned int i = 1; i < plain_config->numa_shard_cpu_list.size(); ++i)
+						{
+							buffers_config.add_constant_buffer(it2->size() * sizeof(float)); // data replica
+							buffers_config.add_constant_buffer(it2->size() * sizeof(float)); // gradient replica
+						}
 					}
 				}
 				for(std::vector<layer_data_custom_smart_ptr>::iterator it = data->data_custom_list.begin(); it != data->data_custom_list.end(); ++it)
@@ -159,7 +219,7 @@ namespace nnforge
 					}
 				}
 
-				unsigned int max_entry_count = std::min(std::min(plain_config->get_max_entry_count(buffers_config), reader.get_entry_count()), max_entry_count_in_single_batch);
+				unsigned int max_entry_count = std::min(std::min(plain_config->get_max_entry_count(buffers_config), reader.get_entry_count()), max_entry_count_in_chunk);
 				if (entry_read_count_list.empty() || (max_entry_count >= batch_size))
 				{
 					unsigned int it_count = std::max((max_entry_count + batch_size - 1) / batch_size, 1U);
@@ -169,51 +229,36 @@ namespace nnforge
 				}
 			}
 
-			std::vector<unsigned char> input_buf(max_entry_read_count * input_neuron_count * input_neuron_elem_size);
-			std::vector<float> actual_output_buf(max_entry_read_count * output_neuron_count);
-			additional_buffer_smart_ptr initial_error_buf(new std::vector<float>(updater_entry_count * output_neuron_count));
+			data_reader_async_prefetcher prefetcher(reader, max_entry_read_count);
 			additional_buffer_smart_ptr input_converted_buf(new std::vector<float>(input_neuron_count * max_entry_read_count));
+			memory_usage_stat::scoped_usage prefetcher_usage(memory_usage, plain_memory_usage_tracker::input_staging_category, prefetcher.get_buffers_size());
+			input_converted_buf = plain_memory_usage_tracker::track_buffer(memory_usage, input_converted_buf, plain_memory_usage_tracker::input_staging_category);
 
-			additional_buffer_smart_ptr output_buffer = input_converted_buf;
 			std::vector<std::pair<additional_buffer_smart_ptr, additional_buffer_set> > input_buffer_and_additional_testing_buffers_pack;
-			std::vector<std::pair<additional_buffer_smart_ptr, updater_additional_buffer_set> > input_buffer_and_additional_updater_buffers_pack;
+			additional_buffer_smart_ptr output_buffer = allocate_testing_buffers(input_buffer_and_additional_testing_buffers_pack, input_converted_buf, max_entry_read_count);
+
+			std::vector<updater_shard_smart_ptr> shard_list;
+			plain_thread_pool_smart_ptr shard_pool;
+			if (plain_config->numa_shard_cpu_list.empty())
 			{
-				const const_layer_list& layer_list = *schema;
-				const_layer_list::const_iterator layer_it = layer_list.begin();
-				layer_configuration_specific_list::const_iterator input_config_it = layer_config_list.begin();
-				for(std::vector<const_layer_tester_plain_smart_ptr>::const_iterator it = tester_list.begin(); it != tester_list.end(); ++it, ++layer_it, ++input_config_it)
-				{
-					additional_buffer_set additional_buffers = (*it)->allocate_additional_buffers(
-						max_entry_read_count,
-						*layer_it,
-						*input_config_it,
-						*(input_config_it + 1),
-						plain_config);
-					input_buffer_and_additional_testing_buffers_pack.push_back(std::make_pair(output_buffer, additional_buffers));
-					output_buffer = (*it)->get_output_buffer(output_buffer, additional_buffers);
-				}
-				for(const_layer_updater_plain_list::const_iterator it = updater_list.begin(); it != updater_list.end(); ++it, ++layer_it, ++input_config_it)
-				{
-					updater_additional_buffer_set additional_buffers = (*it)->allocate_additional_buffers(
-						updater_entry_count,
-						*layer_it,
-						*input_config_it,
-						*(input_config_it + 1),
-						plain_config,
-						(it != updater_list.begin()));
-					input_buffer_and_additional_updater_buffers_pack.push_back(std::make_pair(output_buffer, additional_buffers));
-					output_buffer = additional_buffers.output_neurons_buffer;
-				}
+				shard_list.push_back(updater_shard_smart_ptr(new updater_shard()));
+				allocate_updater_shard(shard_list, output_buffer, data, gradient, updater_entry_count, 0);
 			}
+			else
 			{
-				additional_buffer_smart_ptr output_errors = initial_error_buf;
-				for(std::vector<std::pair<additional_buffer_smart_ptr, updater_additional_buffer_set> >::reverse_iterator it = input_buffer_and_additional_updater_buffers_pack.rbegin(); it != input_buffer_and_additional_updater_buffers_pack.rend() - 1; ++it)
-				{
-					if (it->second.input_errors_buffer != 0)
-						output_errors = it->second.input_errors_buffer;
-					else
-						it->second.input_errors_buffer = output_errors;
-				}
+				const unsigned int shard_count = static_cast<unsigned int>(plain_config->numa_shard_cpu_list.size());
+				for(unsigned int i = 0; i < shard_count; ++i)
+					shard_list.push_back(updater_shard_smart_ptr(new updater_shard()));
+				shard_pool = plain_thread_pool_smart_ptr(new plain_thread_pool(plain_config->numa_shard_cpu_list));
+				shard_pool->run_per_thread(boost::bind(
+					&network_updater_plain::allocate_updater_shard,
+					this,
+					boost::ref(shard_list),
+					output_buffer,
+					data,
+					gradient,
+					(updater_entry_count + shard_count - 1) / shard_count,
+					_1));
 			}
 
 			nnforge_uniform_int_distribution<unsigned int> dist(0, static_cast<unsigned int>(random_uniform_list.size() - 1));
@@ -222,21 +267,15 @@ namespace nnforge
 			unsigned int entry_read_count_index = 0;
 			unsigned int entry_gradient_calculated_count = 0;
 			unsigned int gradient_applied_count = 0;
+			unsigned int update_stat_collected_count = 0;
+			unsigned int entry_processed_count = 0;
+			const unsigned int total_entry_count = reader.get_entry_count();
+			prefetcher.start(entry_read_count_list[entry_read_count_index]);
 			while (entries_remained_for_loading)
 			{
-				unsigned int entries_available_for_processing_count = 0;
-				while(entries_available_for_processing_count < entry_read_count_list[entry_read_count_index])
-				{
-					bool entry_read = reader.read(
-						&(*(input_buf.begin() + (input_neuron_count * entries_available_for_processing_count * input_neuron_elem_size))),
-						&(*(actual_output_buf.begin() + (output_neuron_count * entries_available_for_processing_count))));
-					if (!entry_read)
-					{
-						entries_remained_for_loading = false;
-						break;
-					}
-					entries_available_for_processing_count++;
-				}
+				unsigned int entries_available_for_processing_count = prefetcher.wait();
+				if (entries_available_for_processing_count < entry_read_count_list[entry_read_count_index])
+					entries_remained_for_loading = false;
 				entry_read_count_index++;
 				if (entry_read_count_index >= entry_read_count_list.size())
 					entry_read_count_index = 0;
@@ -244,63 +283,23 @@ namespace nnforge
 				if (entries_available_for_processing_count == 0)
 					break;
 
-				const unsigned int const_entries_available_for_processing_count = entries_available_for_processing_count;
+				// The next chunk is read while the current one is processed
+				if (entries_remained_for_loading)
+					prefetcher.start(entry_read_count_list[entry_read_count_index]);
 
-				// Convert input
-				{
-					const int elem_count = static_cast<int>(entries_available_for_processing_count * input_neuron_count);
-					const std::vector<float>::iterator input_converted_buf_it_start = input_converted_buf->begin();
-					if (type_code == neuron_data_type::type_byte)
-					{
-						const unsigned char * const input_buf_it_start = &(*input_buf.begin());
-						#pragma omp parallel for default(none) schedule(guided) num_threads(plain_config->openmp_thread_count)
-						for(int i = 0; i < elem_count; ++i)
-							*(input_converted_buf_it_start + i) = static_cast<float>(*(input_buf_it_start + i)) * (1.0F / 255.0F);
-					}
-					else if (type_code == neuron_data_type::type_float)
-					{
-						const float * const input_buf_it_start = reinterpret_cast<float *>(&(*input_buf.begin()));
-						#pragma omp parallel for default(none) schedule(guided) num_threads(plain_config->openmp_thread_count)
-						for(int i = 0; i < elem_count; ++i)
-							*(input_converted_buf_it_start + i) = *(input_buf_it_start + i);
-					}
-					else
-						throw neural_network_exception((boost::format("actual_update cannot handle input neurons of type %1%") % type_code).str());
-				}
+				const std::vector<unsigned char>& input_buf = prefetcher.get_input_buffer();
+				const std::vector<float>& actual_output_buf = prefetcher.get_output_buffer();
 
-				// Run testing layers
-				const const_layer_list& layer_list = *schema;
-				{
-					const_layer_list::const_iterator layer_it = layer_list.begin();
-					unsigned int layer_id = 0;
-					layer_configuration_specific_list::const_iterator input_config_it = layer_config_list.begin();
-					std::vector<std::pair<additional_buffer_smart_ptr, additional_buffer_set> >::iterator buffers_it = input_buffer_and_additional_testing_buffers_pack.begin();
-					for(std::vector<const_layer_tester_plain_smart_ptr>::const_iterator it = tester_list.begin(); it != tester_list.end(); ++it, ++layer_it, ++input_config_it, ++buffers_it, ++layer_id)
-					{
-						std::map<unsigned int, float>::const_iterator dropout_it = layer_to_dropout_rate_map.find(layer_id);
-						if (dropout_it != layer_to_dropout_rate_map.end())
-						{
-							unsigned int offset = dist(gen);
-							apply_dropout(
-								buffers_it->first,
-								dropout_it->second,
-								mask,
-								entries_available_for_processing_count * layer_config_list[layer_id].get_neuron_count(),
-								offset);
-						}
+				const unsigned int const_entries_available_for_processing_count = entries_available_for_processing_count;
 
-						(*it)->test(
-							buffers_it->first,
-							buffers_it->second,
-							plain_config,
-							*layer_it,
-							const_layer_data_smart_ptr(),
-							const_layer_data_custom_smart_ptr(),
-							*input_config_it,
-							*(input_config_it + 1),
-							entries_available_for_processing_count);
-					}
-				}
+				convert_input(input_buf, *input_converted_buf, entries_available_for_processing_count * input_neuron_count, type_code, input_mul_add_list, neuron_count_per_input_feature_map);
+
+				run_testing_layers(
+					input_buffer_and_additional_testing_buffers_pack,
+					layer_to_dropout_rate_map,
+					dist,
+					mask,
+					entries_available_for_processing_count);
 
 				// Apply dropout to the input of the first updater layer
 				{
@@ -309,183 +308,103 @@ namespace nnforge
 					{
 						unsigned int offset = dist(gen);
 						apply_dropout(
-							input_buffer_and_additional_updater_buffers_pack[0].first,
+							shard_list[0]->input_buffer_and_additional_updater_buffers_pack[0].first,
 							dropout_it->second,
 							mask,
 							entries_available_for_processing_count * layer_config_list[testing_layer_count].get_neuron_count(),
-							offset);
+							offset,
+							plain_config);
 					}
 				}
 
 				unsigned int base_input_entry_id = 0;
 				while(base_input_entry_id < entries_available_for_processing_count)
 				{
-					std::stack<unsigned int> offset_list;
-
 					unsigned int current_updater_entry_count = std::min(std::min(entries_available_for_processing_count - base_input_entry_id, updater_entry_count), batch_size - entry_gradient_calculated_count);
 
-					// Forward updater
+					// Offsets are drawn in the order the layers consume them
+					std::vector<unsigned int> dropout_offset_list;
+					for(unsigned int layer_id = testing_layer_count + 1; layer_id < testing_layer_count + static_cast<unsigned int>(updater_list.size()); ++layer_id)
 					{
-						const_layer_list::const_iterator layer_it = layer_list.begin() + testing_layer_count;
-						layer_configuration_specific_list::const_iterator input_config_it = layer_config_list.begin() + testing_layer_count;
-						std::vector<std::pair<additional_buffer_smart_ptr, updater_additional_buffer_set> >::iterator updater_buffers_it = input_buffer_and_additional_updater_buffers_pack.begin();
-						layer_data_list::const_iterator data_it = data->data_list.begin() + testing_layer_count;
-						layer_data_custom_list::const_iterator data_custom_it = data->data_custom_list.begin() + testing_layer_count;
-						unsigned int layer_id = testing_layer_count;
-						for(std::vector<const_layer_updater_plain_smart_ptr>::const_iterator it = updater_list.begin(); it != updater_list.end(); ++it, ++layer_it, ++input_config_it, ++updater_buffers_it, ++data_it, ++data_custom_it, ++layer_id)
-						{
-							if (it != updater_list.begin())
-							{
-								std::map<unsigned int, float>::const_iterator dropout_it = layer_to_dropout_rate_map.find(layer_id);
-								if (dropout_it != layer_to_dropout_rate_map.end())
-								{
-									unsigned int offset = dist(gen);
-									offset_list.push(offset);
-									apply_dropout(
-										updater_buffers_it->first,
-										dropout_it->second,
-										mask,
-										current_updater_entry_count * layer_config_list[layer_id].get_neuron_count(),
-										offset);
-								}
-							}
-
-							(*it)->test(
-								updater_buffers_it->first,
-								updater_buffers_it->second.output_neurons_buffer,
-								updater_buffers_it->second.additional_buffers,
-								plain_config,
-								*layer_it,
-								*data_it,
-								*data_custom_it,
-								*input_config_it,
-								*(input_config_it + 1),
-								current_updater_entry_count,
-								(it == updater_list.begin()) ? base_input_entry_id : 0);
-						}
+						if (layer_to_dropout_rate_map.find(layer_id) != layer_to_dropout_rate_map.end())
+							dropout_offset_list.push_back(dist(gen));
 					}
 
-					// Set initial error and accumulate error
 					{
-						const std::vector<float>::iterator initial_error_it = initial_error_buf->begin();
-						const std::vector<float>::const_iterator actual_output_buf_it = actual_output_buf.begin() + (output_neuron_count * base_input_entry_id);
-						const std::vector<float>::const_iterator output_buffer_it = output_buffer->begin();
-						testing_result& tr = *testing_res;
-						const int elem_count = current_updater_entry_count;
-						std::vector<double> errors(plain_config->openmp_thread_count, 0.0);
-						const std::vector<double>::iterator errors_it = errors.begin();
-						#pragma omp parallel default(none) shared(tr) num_threads(plain_config->openmp_thread_count)
+						const unsigned int shard_entry_count = (current_updater_entry_count + static_cast<unsigned int>(shard_list.size()) - 1) / static_cast<unsigned int>(shard_list.size());
+						unsigned int offset_in_chunk = 0;
+						for(std::vector<updater_shard_smart_ptr>::iterator it = shard_list.begin(); it != shard_list.end(); ++it)
 						{
-							int thread_id = 0;
-							#ifdef _OPENMP
-								thread_id = omp_get_thread_num();
-							#endif
-
-							#pragma omp for schedule(guided)
-							for(int updater_entry_id = 0; updater_entry_id < elem_count; ++updater_entry_id)
-							{
-								const float * predicted_vals = &(*(output_buffer_it + (updater_entry_id * output_neuron_count)));
-								const float * actual_vals = &(*(actual_output_buf_it + (updater_entry_id * output_neuron_count)));
-								float * initial_errors = &(*(initial_error_it + (updater_entry_id * output_neuron_count)));
-
-								float error;
-								if (error_function_fused_with_activation)
-									error = tr.ef->calculate_gradient_and_error_fused_with_activation(actual_vals, predicted_vals, initial_errors, output_neuron_count);
-								else
-									error = tr.ef->calculate_gradient_and_error(actual_vals, predicted_vals, initial_errors, output_neuron_count);
-								*(errors_it + thread_id) += static_cast<double>(error);
-							}
+							updater_shard& shard = **it;
+							shard.base_input_entry_id = base_input_entry_id + offset_in_chunk;
+							shard.offset_in_chunk = offset_in_chunk;
+							shard.entry_count = std::min(shard_entry_count, current_updater_entry_count - offset_in_chunk);
+							offset_in_chunk += shard.entry_count;
 						}
-						double total_error = std::accumulate(errors.begin(), errors.end(), 0.0);
-						tr.add_error(total_error, current_updater_entry_count);
 					}
 
-					// Run backward and update weights
+					if (shard_pool)
 					{
-						const_layer_list::const_reverse_iterator layer_it = layer_list.rbegin() + (error_function_fused_with_activation ? 1 : 0);
-						std::vector<std::pair<additional_buffer_smart_ptr, updater_additional_buffer_set> >::reverse_iterator updater_buffers_it = input_buffer_and_additional_updater_buffers_pack.rbegin();
-						layer_configuration_specific_list::const_reverse_iterator input_config_it = layer_config_list.rbegin() + (error_function_fused_with_activation ? 1 : 0);
-						layer_data_list::const_reverse_iterator data_it = data->data_list.rbegin() + (error_function_fused_with_activation ? 1 : 0);
-						layer_data_custom_list::const_reverse_iterator data_custom_it = data->data_custom_list.rbegin() + (error_function_fused_with_activation ? 1 : 0);
-						layer_data_list::reverse_iterator gradient_it = gradient->rbegin() + (error_function_fused_with_activation ? 1 : 0);
-						additional_buffer_smart_ptr output_errors = initial_error_buf;
-						unsigned int reverse_layer_id = static_cast<unsigned int>(updater_list.size() + testing_layer_count) - 1;
-						for(std::vector<const_layer_updater_plain_smart_ptr>::const_reverse_iterator it = updater_list.rbegin(); it != updater_list.rend(); ++it, ++layer_it, ++input_config_it, ++updater_buffers_it, ++data_it, ++data_custom_it, ++gradient_it, --reverse_layer_id)
-						{
-							if (it != updater_list.rend() - 1)
-							{
-								(*it)->backprop(
-									updater_buffers_it->second.input_errors_buffer,
-									updater_buffers_it->first,
-									output_errors,
-									updater_buffers_it->second.output_neurons_buffer,
-									updater_buffers_it->second.additional_buffers,
-									plain_config,
-									*layer_it,
-									*data_it,
-									*data_custom_it,
-									*(input_config_it + 1),
-									*input_config_it,
-									current_updater_entry_count);
-								
-								/*
-								{
-									boost::filesystem::path dir = "Debug";
-									dir /= "CPU";
-									boost::filesystem::create_directories(dir);
-									debug_util::dump_list(
-										&(*updater_buffers_it->second.input_errors_buffer->begin()),
-										updater_buffers_it->second.input_errors_buffer->size(),
-										(dir / (boost::format("input_errors_%1%.txt") % reverse_layer_id).str()).string().c_str());
-								}
-								*/
-
-								std::map<unsigned int, float>::const_iterator dropout_it = layer_to_dropout_rate_map.find(reverse_layer_id);
-								if (dropout_it != layer_to_dropout_rate_map.end())
-								{
-									unsigned int offset = offset_list.top();
-									offset_list.pop();
-									apply_dropout(
-										updater_buffers_it->second.input_errors_buffer,
-										dropout_it->second,
-										mask,
-										current_updater_entry_count * layer_config_list[reverse_layer_id].get_neuron_count(),
-										offset);
-								}
-							}
-
-							(*it)->update_weights(
-								updater_buffers_it->first,
-								output_errors,
-								updater_buffers_it->second.additional_buffers,
-								*gradient_it,
-								*data_custom_it,
-								plain_config,
-								*layer_it,
-								*(input_config_it + 1),
-								*input_config_it,
-								current_updater_entry_count,
-								(it == updater_list.rend() - 1) ? base_input_entry_id : 0);
+						shard_pool->run_per_thread(boost::bind(
+							&network_updater_plain::run_updater_shard,
+							this,
+							boost::ref(shard_list),
+							boost::cref(actual_output_buf),
+							boost::cref(layer_to_dropout_rate_map),
+							boost::cref(dropout_offset_list),
+							mask,
+							_1));
+					}
+					else
+					{
+						run_updater_shard(
+							shard_list,
+							actual_output_buf,
+							layer_to_dropout_rate_map,
+							dropout_offset_list,
+							mask,
+							0);
+					}
 
-							output_errors = updater_buffers_it->second.input_errors_buffer;
-						}
+					{
+						double total_error = 0.0;
+						for(std::vector<updater_shard_smart_ptr>::const_iterator it = shard_list.begin(); it != shard_list.end(); ++it)
+							total_error += (*it)->error;
+						testing_res->add_error(total_error, current_updater_entry_count);
 					}
 
 					base_input_entry_id += current_updater_entry_count;
 					entry_gradient_calculated_count += current_updater_entry_count;
+					entry_processed_count += current_updater_entry_count;
 
 					if (entry_gradient_calculated_count >= batch_size)
 					{
 						float gradient_normalizer = 1.0F / static_cast<float>(std::max(batch_size, entry_gradient_calculated_count));
+						bool collect_update_stat = (plain_config->training_stat_sample_period > 0)
+							? (gradient_applied_count % plain_config->training_stat_sample_period == 0)
+							: (entry_processed_count >= total_entry_count);
+						reduce_gradient(shard_list);
+						if (all_reducer)
+						{
+							all_reducer->all_reduce(*gradient);
+							gradient_normalizer /= static_cast<float>(all_reducer->get_worker_count());
+						}
 						apply_gradient(
 							data->data_list,
 							*gradient,
-							*previous_upd,
 							updates_accumulated,
 							learning_rates,
 							gradient_normalizer,
 							weight_decay,
-							momentum);
+							momentum,
+							keep_momentum,
+							collect_update_stat);
+						if (synchronizer)
+							synchronizer->gradient_applied(data->data_list);
+						if (collect_update_stat)
+							++update_stat_collected_count;
+						if (shard_pool)
+							shard_pool->run_per_thread(boost::bind(&network_updater_plain::synchronize_updater_shard, this, boost::ref(shard_list), data, _1));
 						entry_gradient_calculated_count = 0;
 						++gradient_applied_count;
 					}
@@ -495,142 +414,1070 @@ namespace nnforge
 			if (entry_gradient_calculated_count > 0)
 			{
 				float gradient_normalizer = 1.0F / static_cast<float>(std::max(batch_size, entry_gradient_calculated_count));
+				// The trailing application is the last one of the epoch
+				bool collect_update_stat = (plain_config->training_stat_sample_period > 0)
+					? (gradient_applied_count % plain_config->training_stat_sample_period == 0)
+					: true;
+				reduce_gradient(shard_list);
+				if (all_reducer)
+				{
+					all_reducer->all_reduce(*gradient);
+					gradient_normalizer /= static_cast<float>(all_reducer->get_worker_count());
+				}
 				apply_gradient(
 					data->data_list,
 					*gradient,
-					*previous_upd,
 					updates_accumulated,
 					learning_rates,
 					gradient_normalizer,
 					weight_decay,
-					momentum);
+					momentum,
+					keep_momentum,
+					collect_update_stat);
+				if (synchronizer)
+					synchronizer->gradient_applied(data->data_list);
+				if (collect_update_stat)
+					++update_stat_collected_count;
 				entry_gradient_calculated_count = 0;
 				++gradient_applied_count;
 			}
 
-			training_stat_smart_ptr training_res(new training_stat());
+			// Gradient keeps no entries here, worker 0 still contributes its momentum
+			while (gradient_applied_count < worker_gradient_applied_count)
+			{
+				all_reducer->all_reduce(*gradient);
+				apply_gradient(
+					data->data_list,
+					*gradient,
+					updates_accumulated,
+					learning_rates,
+					1.0F / static_cast<float>(batch_size * all_reducer->get_worker_count()),
+					weight_decay,
+					momentum,
+					keep_momentum,
+					false);
+				++gradient_applied_count;
+			}
+
+			if (shard_list.size() > 1)
 			{
-				float mult = 1.0F / static_cast<float>(gradient_applied_count);
-				std::vector<layer_data_smart_ptr>::const_iterator it_data = data->data_list.begin();
-				for(std::vector<std::vector<double> >::const_iterator it = updates_accumulated.begin(); it != updates_accumulated.end(); ++it, ++it_data)
+				for(unsigned int shard_id = 0; shard_id < shard_list.size(); ++shard_id)
 				{
-					std::vector<float> updates;
-					std::vector<std::vector<float> >::const_iterator it_data2 = (*it_data)->begin();
-					for(std::vector<double>::const_iterator it2 = it->begin(); it2 != it->end(); ++it2, ++it_data2)
-					{
-						updates.push_back(static_cast<float>(*it2) * mult / static_cast<float>(it_data2->size()));
-					}
-					training_res->absolute_updates.push_back(updates);
+					const updater_shard& shard = *shard_list[shard_id];
+					double bandwidth = (shard.busy_seconds > 0.0) ? shard.transferred_bytes / shard.busy_seconds / static_cast<double>(1 << 30) : 0.0;
+					std::cout << (boost::format("NUMA shard %1%: %2% threads, %3% entries, %4% s busy, %5% GB/s estimated memory traffic")
+						% shard_id % shard.plain_config->openmp_thread_count % shard.processed_entry_count % shard.busy_seconds % bandwidth) << std::endl;
 				}
 			}
 
-			return std::make_pair(testing_res, training_res);
-		}
+			if (all_reducer)
+			{
+				// Time not spent in all-reduce, waiting for the slower workers included, is the share of the ideal linear scaling achieved
+				boost::chrono::duration<float> sec = boost::chrono::high_resolution_clock::now() - start;
+				std::vector<float> worker_stat(4);
+				worker_stat[0] = static_cast<float>(entry_processed_count);
+				worker_stat[1] = sec.count();
+				worker_stat[2] = static_cast<float>(all_reducer->get_communication_seconds());
+				worker_stat[3] = (testing_res->get_entry_count() > 0) ? static_cast<float>(testing_res->get_error_precise() * static_cast<double>(testing_res->get_entry_count())) : 0.0F;
+				all_reducer->all_reduce(worker_stat);
 
-		void network_updater_plain::layer_config_list_modified()
-		{
+				// Training error of all the workers, so that they agree on discarding broken networks
+				testing_res->init(worker_stat[3], static_cast<unsigned int>(worker_stat[0]));
+
+				const unsigned int worker_count = all_reducer->get_worker_count();
+				float average_seconds = worker_stat[1] / static_cast<float>(worker_count);
+				float entries_per_second = (average_seconds > 0.0F) ? worker_stat[0] / average_seconds : 0.0F;
+				float efficiency = (worker_stat[1] > 0.0F) ? (worker_stat[1] - worker_stat[2]) / worker_stat[1] : 1.0F;
+				std::cout << (boost::format("Data-parallel update: %1% workers, %|2$.1f| entries/s total, %|3$.1f| entries/s per worker, %|4$.1f|%% scaling efficiency, %|5$.2f| s of %|6$.2f| s spent in gradient all-reduce on average")
+					% worker_count % entries_per_second % (entries_per_second / static_cast<float>(worker_count)) % (efficiency * 100.0F) % (worker_stat[2] / static_cast<float>(worker_count)) % average_seconds) << std::endl;
+			}
+
+			training_stat_smart_ptr training_res = get_training_stat(updates_accumulated, update_stat_collected_count, data);
+
+			return std::make_pair(testing_res, training_res);
 		}
 
-		void network_updater_plain::apply_gradient(
-			std::vector<layer_data_smart_ptr>& data,
-			std::vector<layer_data_smart_ptr>& gradient,
-			std::vector<layer_data_smart_ptr>& previous_upd,
-			std::vector<std::vector<double> >& updates_accumulated,
+		std::pair<testing_result_smart_ptr, training_stat_smart_ptr> network_updater_plain::actual_update_asynchronous(
+			supervised_data_reader& reader,
 			const std::vector<std::vector<float> >& learning_rates,
-			float normalizer,
+			network_data_smart_ptr data,
+			unsigned int batch_size,
 			float weight_decay,
-			float momentum) const
+			float momentum,
+			const std::map<unsigned int, float>& layer_to_dropout_rate_map,
+			unsigned int worker_count)
 		{
-			const const_layer_list& layer_list = *schema;
+			testing_result_smart_ptr testing_res(new testing_result(ef));
+			memory_usage = memory_usage_stat_smart_ptr(new memory_usage_stat());
 
-			layer_data_list::iterator gradient_it0 = gradient.begin() + testing_layer_count;
-			std::vector<std::vector<float> >::const_iterator learning_rate_it0 = learning_rates.begin() + testing_layer_count;
-			const_layer_list::const_iterator layer_it = layer_list.begin() + testing_layer_count;
-			std::vector<std::vector<double> >::iterator updates_accumulated_it0 = updates_accumulated.begin() + testing_layer_count;
-			if (momentum > 0.0F)
+			if (all_reducer)
+				throw neural_network_exception("Asynchronous update cannot be data-parallel");
+			if (synchronizer)
+				throw neural_network_exception("Asynchronous update cannot be stale-synchronous");
+
+			if (worker_count == 0)
+				worker_count = static_cast<unsigned int>(std::max(plain_config->openmp_thread_count, 1));
+			batch_size = std::max(batch_size, 1U);
+
+			reader.reset();
+
+			const unsigned int input_neuron_count = reader.get_input_configuration().get_neuron_count();
+			const unsigned int output_neuron_count = reader.get_output_configuration().get_neuron_count();
+			const unsigned int neuron_count_per_input_feature_map = reader.get_input_configuration().get_neuron_count_per_feature_map();
+			const unsigned int neuron_count_per_output_feature_map = reader.get_output_configuration().get_neuron_count_per_feature_map();
+			neuron_data_type::input_type type_code = reader.get_input_type();
+			size_t input_neuron_elem_size = reader.get_input_neuron_elem_size();
+			const std::vector<std::pair<float, float> > input_mul_add_list = reader.get_input_mul_add_list();
+			const unsigned int total_entry_count = reader.get_entry_count();
+
+			if (error_function_fused_with_activation && (neuron_count_per_output_feature_map != 1))
+				throw neural_network_exception("Error function is fused with activation but output_neuron_count_per_feature_map is not equal 1: not implemented");
+
+			// Each chunk read consists of whole batches
+			unsigned int max_entry_read_count;
 			{
-				layer_data_list::iterator previous_upd_it0 = previous_upd.begin() + testing_layer_count;
-				for(layer_data_list::iterator data_it0 = data.begin() + testing_layer_count; data_it0 != data.end(); ++data_it0, ++gradient_it0, ++previous_upd_it0, ++learning_rate_it0, ++layer_it, ++updates_accumulated_it0)
+				buffer_plain_size_configuration buffers_config;
+				update_buffers_configuration(buffers_config, batch_size * worker_count);
+				buffers_config.add_per_entry_buffer(input_neuron_count * input_neuron_elem_size); // input
+				buffers_config.add_per_entry_buffer(input_neuron_count * input_neuron_elem_size); // input being prefetched
+				buffers_config.add_per_entry_buffer(input_neuron_count * sizeof(float)); // converted input
+				buffers_config.add_per_entry_buffer(output_neuron_count * sizeof(float)); // output
+				buffers_config.add_per_entry_buffer(output_neuron_count * sizeof(float)); // output being prefetched
+				buffers_config.add_constant_buffer(output_neuron_count * sizeof(float) * batch_size * worker_count); // initial error
+				for(std::vector<layer_data_smart_ptr>::iterator it = data->data_list.begin(); it != data->data_list.end(); ++it)
 				{
-					layer_data::iterator gradient_it = (*gradient_it0)->begin();
-					layer_data::iterator previous_upd_it = (*previous_upd_it0)->begin();
-					std::vector<double>::iterator updates_accumulated_it = updates_accumulated_it0->begin();
-					std::vector<float>::const_iterator learning_rate_it = learning_rate_it0->begin();
-					std::set<unsigned int> weight_decay_part_id_set = (*layer_it)->get_weight_decay_part_id_set();
-					unsigned int part_id = 0;
-					for(layer_data::iterator data_it = (*data_it0)->begin(); data_it != (*data_it0)->end(); ++data_it, ++gradient_it, ++previous_upd_it, ++learning_rate_it, ++part_id, ++updates_accumulated_it)
+					for(layer_data::const_iterator it2 = (*it)->begin(); it2 != (*it)->end(); ++it2)
 					{
-						float actual_weight_decay = (weight_decay_part_id_set.find(part_id) == weight_decay_part_id_set.end()) ? 0.0F : weight_decay;
-						std::vector<float>::iterator gradient_it2 = gradient_it->begin();
-						std::vector<float>::iterator previous_upd_it2 = previous_upd_it->begin();
-						float learning_rate = *learning_rate_it;
-						double accum = 0.0;
-						for(std::vector<float>::iterator data_it2 = data_it->begin(); data_it2 != data_it->end(); ++data_it2, ++gradient_it2, ++previous_upd_it2)
+						buffers_config.add_constant_buffer(it2->size() * sizeof(float)); // data
+						for(unsigned int i = 0; i < worker_count; ++i)
 						{
-							float current_weight = *data_it2;
-							float gr = *gradient_it2;
-							float prev_upd = *previous_upd_it2;
-							float upd = prev_upd * momentum + learning_rate * (gr * normalizer - current_weight * actual_weight_decay);
-							accum += static_cast<double>(fabsf(upd));
-							float new_weight = current_weight + upd;
-							*data_it2 = new_weight;
-							*gradient_it2 = 0.0F;
-							*previous_upd_it2 = upd;
+							buffers_config.add_constant_buffer(it2->size() * sizeof(float)); // gradient with momentum
 						}
-						*updates_accumulated_it += accum;
 					}
 				}
+				for(std::vector<layer_data_custom_smart_ptr>::iterator it = data->data_custom_list.begin(); it != data->data_custom_list.end(); ++it)
+				{
+					for(layer_data_custom::const_iterator it2 = (*it)->begin(); it2 != (*it)->end(); ++it2)
+					{
+						buffers_config.add_constant_buffer(it2->size() * sizeof(float)); // data
+					}
+				}
+
+				unsigned int max_entry_count = std::min(std::min(plain_config->get_max_entry_count(buffers_config), reader.get_entry_count()), max_entry_count_in_single_batch);
+				max_entry_read_count = std::max(max_entry_count / batch_size, 1U) * batch_size;
 			}
-			else
+
+			data_reader_async_prefetcher prefetcher(reader, max_entry_read_count);
+			additional_buffer_smart_ptr input_converted_buf(new std::vector<float>(input_neuron_count * max_entry_read_count));
+			memory_usage_stat::scoped_usage prefetcher_usage(memory_usage, plain_memory_usage_tracker::input_staging_category, prefetcher.get_buffers_size());
+			input_converted_buf = plain_memory_usage_tracker::track_buffer(memory_usage, input_converted_buf, plain_memory_usage_tracker::input_staging_category);
+
+			std::vector<std::pair<additional_buffer_smart_ptr, additional_buffer_set> > input_buffer_and_additional_testing_buffers_pack;
+			additional_buffer_smart_ptr output_buffer = allocate_testing_buffers(input_buffer_and_additional_testing_buffers_pack, input_converted_buf, max_entry_read_count);
+
+			std::vector<updater_shard_smart_ptr> worker_list;
+			for(unsigned int i = 0; i < worker_count; ++i)
+			{
+				worker_list.push_back(updater_shard_smart_ptr(new updater_shard()));
+				allocate_asynchronous_worker(*worker_list.back(), output_buffer, data, batch_size);
+			}
+			if (momentum > 0.0F)
+				report_fused_momentum(*worker_list.front()->gradient, worker_count);
+			// Workers are not pinned
+			std::vector<std::vector<unsigned int> > worker_cpu_set_list(worker_count);
+			plain_thread_pool worker_pool(worker_cpu_set_list);
+
+			nnforge_uniform_int_distribution<unsigned int> dist(0, static_cast<unsigned int>(random_uniform_list.size() - 1));
+			asynchronous_batch_queue queue;
+			queue.batch_size = batch_size;
+			queue.layer_to_dropout_rate_map = &layer_to_dropout_rate_map;
+			queue.learning_rates = &learning_rates;
+			queue.weight_decay = weight_decay;
+			queue.momentum = momentum;
+			queue.mask = static_cast<unsigned int>(random_uniform_list.size() - 1);
+
+			boost::chrono::steady_clock::time_point start = boost::chrono::high_resolution_clock::now();
+			bool entries_remained_for_loading = true;
+			unsigned int entry_processed_count = 0;
+			prefetcher.start(max_entry_read_count);
+			while (entries_remained_for_loading)
 			{
-				for(layer_data_list::iterator data_it0 = data.begin() + testing_layer_count; data_it0 != data.end(); ++data_it0, ++gradient_it0, ++learning_rate_it0, ++layer_it, ++updates_accumulated_it0)
+				unsigned int entries_available_for_processing_count = prefetcher.wait();
+				if (entries_available_for_processing_count < max_entry_read_count)
+					entries_remained_for_loading = false;
+
+				if (entries_available_for_processing_count == 0)
+					break;
+
+				// The next chunk is read while the current one is processed
+				if (entries_remained_for_loading)
+					prefetcher.start(max_entry_read_count);
+
+				convert_input(prefetcher.get_input_buffer(), *input_converted_buf, entries_available_for_processing_count * input_neuron_count, type_code, input_mul_add_list, neuron_count_per_input_feature_map);
+
+				run_testing_layers(
+					input_buffer_and_additional_testing_buffers_pack,
+					layer_to_dropout_rate_map,
+					dist,
+					queue.mask,
+					entries_available_for_processing_count);
+
+				// Apply dropout to the input of the first updater layer
+				{
+					std::map<unsigned int, float>::const_iterator dropout_it = layer_to_dropout_rate_map.find(testing_layer_count);
+					if (dropout_it != layer_to_dropout_rate_map.end())
+					{
+						unsigned int offset = dist(gen);
+						apply_dropout(
+							output_buffer,
+							dropout_it->second,
+							queue.mask,
+							entries_available_for_processing_count * layer_config_list[testing_layer_count].get_neuron_count(),
+							offset,
+							plain_config);
+					}
+				}
+
+				entry_processed_count += entries_available_for_processing_count;
+
+				queue.next_batch_id = 0;
+				queue.batch_count = (entries_available_for_processing_count + batch_size - 1) / batch_size;
+				queue.entry_count = entries_available_for_processing_count;
+				queue.last_chunk = (!entries_remained_for_loading) || (entry_processed_count >= total_entry_count);
+				queue.actual_output_buf = &prefetcher.get_output_buffer();
+				queue.dropout_offset_lists.resize(queue.batch_count);
+				for(std::vector<std::vector<unsigned int> >::iterator it = queue.dropout_offset_lists.begin(); it != queue.dropout_offset_lists.end(); ++it)
 				{
-					layer_data::iterator gradient_it = (*gradient_it0)->begin();
-					std::vector<double>::iterator updates_accumulated_it = updates_accumulated_it0->begin();
-					std::vector<float>::const_iterator learning_rate_it = learning_rate_it0->begin();
-					std::set<unsigned int> weight_decay_part_id_set = (*layer_it)->get_weight_decay_part_id_set();
-					unsigned int part_id = 0;
-					double accum = 0.0;
-					for(layer_data::iterator data_it = (*data_it0)->begin(); data_it != (*data_it0)->end(); ++data_it, ++gradient_it, ++learning_rate_it, ++part_id, ++updates_accumulated_it)
+					it->clear();
+					for(unsigned int layer_id = testing_layer_count + 1; layer_id < testing_layer_count + static_cast<unsigned int>(updater_list.size()); ++layer_id)
 					{
-						float actual_weight_decay = (weight_decay_part_id_set.find(part_id) == weight_decay_part_id_set.end()) ? 0.0F : weight_decay;
-						std::vector<float>::iterator gradient_it2 = gradient_it->begin();
-						float learning_rate = *learning_rate_it;
-						for(std::vector<float>::iterator data_it2 = data_it->begin(); data_it2 != data_it->end(); ++data_it2, ++gradient_it2)
-						{
-							float current_weight = *data_it2;
-							float gr = *gradient_it2;
-							float upd = learning_rate * (gr * normalizer - current_weight * actual_weight_decay);
-							accum += static_cast<double>(fabsf(upd));
-							float new_weight = current_weight + upd;
-							*data_it2 = new_weight;
-							*gradient_it2 = 0.0F;
-						}
-						*updates_accumulated_it += accum;
+						if (layer_to_dropout_rate_map.find(layer_id) != layer_to_dropout_rate_map.end())
+							it->push_back(dist(gen));
 					}
 				}
+
+				for(std::vector<updater_shard_smart_ptr>::iterator it = worker_list.begin(); it != worker_list.end(); ++it)
+					(*it)->accumulated_error = 0.0;
+
+				worker_pool.run_per_thread(boost::bind(
+					&network_updater_plain::run_asynchronous_worker,
+					this,
+					boost::ref(worker_list),
+					boost::ref(queue),
+					_1));
+
+				double total_error = 0.0;
+				for(std::vector<updater_shard_smart_ptr>::const_iterator it = worker_list.begin(); it != worker_list.end(); ++it)
+					total_error += (*it)->accumulated_error;
+				testing_res->add_error(total_error, entries_available_for_processing_count);
+			}
+
+			std::vector<std::vector<double> > updates_accumulated;
+			for(std::vector<layer_data_smart_ptr>::const_iterator it = data->data_list.begin(); it != data->data_list.end(); ++it)
+				updates_accumulated.push_back(std::vector<double>((*it)->size(), 0.0));
+			unsigned int gradient_applied_count = 0;
+			unsigned int update_stat_collected_count = 0;
+			for(std::vector<updater_shard_smart_ptr>::const_iterator it = worker_list.begin(); it != worker_list.end(); ++it)
+			{
+				const updater_shard& worker = **it;
+				gradient_applied_count += worker.gradient_applied_count;
+				update_stat_collected_count += worker.update_stat_collected_count;
+				for(unsigned int layer_id = 0; layer_id < updates_accumulated.size(); ++layer_id)
+					for(unsigned int part_id = 0; part_id < updates_accumulated[layer_id].size(); ++part_id)
+						updates_accumulated[layer_id][part_id] += worker.updates_accumulated[layer_id][part_id];
 			}
+
+			boost::chrono::duration<double> sec = boost::chrono::high_resolution_clock::now() - start;
+			std::cout << (boost::format("Asynchronous update: %1% workers, %2% gradient applications, %3% entries/s")
+				% worker_count % gradient_applied_count % (static_cast<double>(entry_processed_count) / std::max(sec.count(), 1.0e-9))) << std::endl;
+
+			training_stat_smart_ptr training_res = get_training_stat(updates_accumulated, update_stat_collected_count, data);
+
+			return std::make_pair(testing_res, training_res);
 		}
 
-		unsigned int network_updater_plain::get_updater_max_count() const
+		training_stat_smart_ptr network_updater_plain::get_training_stat(
+			const std::vector<std::vector<double> >& updates_accumulated,
+			unsigned int update_stat_collected_count,
+			network_data_smart_ptr data) const
 		{
-			buffer_plain_size_configuration buffer_configuration;
+			training_stat_smart_ptr training_res(new training_stat());
+
+			float mult = (update_stat_collected_count > 0) ? 1.0F / static_cast<float>(update_stat_collected_count) : 0.0F;
+			std::vector<layer_data_smart_ptr>::const_iterator it_data = data->data_list.begin();
+			for(std::vector<std::vector<double> >::const_iterator it = updates_accumulated.begin(); it != updates_accumulated.end(); ++it, ++it_data)
+			{
+				std::vector<float> updates;
+				std::vector<std::vector<float> >::const_iterator it_data2 = (*it_data)->begin();
+				for(std::vector<double>::const_iterator it2 = it->begin(); it2 != it->end(); ++it2, ++it_data2)
+				{
+					updates.push_back(static_cast<float>(*it2) * mult / static_cast<float>(it_data2->size()));
+				}
+				training_res->absolute_updates.push_back(updates);
+			}
+
+			return training_res;
+		}
 
+		additional_buffer_smart_ptr network_updater_plain::allocate_testing_buffers(
+			std::vector<std::pair<additional_buffer_smart_ptr, additional_buffer_set> >& input_buffer_and_additional_testing_buffers_pack,
+			additional_buffer_smart_ptr input_buffer,
+			unsigned int entry_count) const
+		{
+			additional_buffer_smart_ptr output_buffer = input_buffer;
 			const const_layer_list& layer_list = *schema;
 			const_layer_list::const_iterator layer_it = layer_list.begin();
 			layer_configuration_specific_list::const_iterator input_config_it = layer_config_list.begin();
-			for(const_layer_updater_plain_list::const_iterator it = updater_list.begin(); it != updater_list.end(); ++it, ++layer_it, ++input_config_it)
+			for(std::vector<const_layer_tester_plain_smart_ptr>::const_iterator it = tester_list.begin(); it != tester_list.end(); ++it, ++layer_it, ++input_config_it)
 			{
-				(*it)->update_buffer_configuration(
-					buffer_configuration,
+				additional_buffer_set additional_buffers = (*it)->allocate_additional_buffers(
+					entry_count,
 					*layer_it,
 					*input_config_it,
 					*(input_config_it + 1),
-					plain_config,
-					(it != updater_list.begin()));
+					plain_config);
+				additional_buffer_smart_ptr layer_output_buffer = plain_memory_usage_tracker::track_tester_buffers(
+					memory_usage,
+					additional_buffers,
+					(*it)->get_output_buffer(output_buffer, additional_buffers));
+				input_buffer_and_additional_testing_buffers_pack.push_back(std::make_pair(output_buffer, additional_buffers));
+				output_buffer = layer_output_buffer;
 			}
 
-			return plain_config->get_max_entry_count(buffer_configuration, 0.5F);
+			return output_buffer;
+		}
+
+		void network_updater_plain::convert_input(
+			const std::vector<unsigned char>& input_buf,
+			std::vector<float>& input_converted_buf,
+			unsigned int elem_count,
+			neuron_data_type::input_type type_code,
+			const std::vector<std::pair<float, float> >& input_mul_add_list,
+			unsigned int neuron_count_per_input_feature_map) const
+		{
+			const int const_elem_count = static_cast<int>(elem_count);
+			const std::vector<float>::iterator input_converted_buf_it_start = input_converted_buf.begin();
+			if (type_code == neuron_data_type::type_byte)
+			{
+				const unsigned char * const input_buf_it_start = &(*input_buf.begin());
+				#pragma omp parallel for default(none) schedule(guided) num_threads(plain_config->openmp_thread_count)
+				for(int i = 0; i < const_elem_count; ++i)
+					*(input_converted_buf_it_start + i) = static_cast<float>(*(input_buf_it_start + i)) * (1.0F / 255.0F);
+			}
+			else if (type_code == neuron_data_type::type_float)
+			{
+				const float * const input_buf_it_start = reinterpret_cast<const float *>(&(*input_buf.begin()));
+				#pragma omp parallel for default(none) schedule(guided) num_threads(plain_config->openmp_thread_count)
+				for(int i = 0; i < const_elem_count; ++i)
+					*(input_converted_buf_it_start + i) = *(input_buf_it_start + i);
+			}
+			else if (type_code == neuron_data_type::type_half)
+			{
+				const unsigned short * const input_buf_it_start = reinterpret_cast<const unsigned short *>(&(*input_buf.begin()));
+				#pragma omp parallel for default(none) schedule(guided) num_threads(plain_config->openmp_thread_count)
+				for(int i = 0; i < const_elem_count; ++i)
+					*(input_converted_buf_it_start + i) = neuron_data_type::half_to_float(*(input_buf_it_start + i));
+			}
+			else if (type_code == neuron_data_type::type_uint8_scaled)
+			{
+				if (input_mul_add_list.empty())
+					throw neural_network_exception("actual_update got no mult-add pairs for input neurons of type_uint8_scaled");
+
+				// Each workload is a single feature map of a single entry
+				const unsigned char * const input_buf_it_start = &(*input_buf.begin());
+				const std::pair<float, float> * const mul_add_list_start = &(*input_mul_add_list.begin());
+				const int feature_map_count = static_cast<int>(input_mul_add_list.size());
+				const int neuron_count_per_feature_map = static_cast<int>(neuron_count_per_input_feature_map);
+				const int workload_count = const_elem_count / neuron_count_per_feature_map;
+				#pragma omp parallel for default(none) schedule(guided) num_threads(plain_config->openmp_thread_count)
+				for(int workload_id = 0; workload_id < workload_count; ++workload_id)
+				{
+					const std::pair<float, float> mul_add = *(mul_add_list_start + (workload_id % feature_map_count));
+					const unsigned char * src = input_buf_it_start + workload_id * neuron_count_per_feature_map;
+					std::vector<float>::iterator dst = input_converted_buf_it_start + workload_id * neuron_count_per_feature_map;
+					for(int i = 0; i < neuron_count_per_feature_map; ++i)
+						*(dst + i) = static_cast<float>(*(src + i)) * mul_add.first + mul_add.second;
+				}
+			}
+			else
+				throw neural_network_exception((boost::format("actual_update cannot handle input neurons of type %1%") % type_code).str());
+		}
+
+		void network_updater_plain::run_testing_layers(
+			std::vector<std::pair<additional_buffer_smart_ptr, additional_buffer_set> >& input_buffer_and_additional_testing_buffers_pack,
+			const std::map<unsigned int, float>& layer_to_dropout_rate_map,
+			nnforge_uniform_int_distribution<unsigned int>& dist,
+			unsigned int mask,
+			unsigned int entry_count)
+		{
+			const const_layer_list& layer_list = *schema;
+			const_layer_list::const_iterator layer_it = layer_list.begin();
+			unsigned int layer_id = 0;
+			layer_configuration_specific_list::const_iterator input_config_it = layer_config_list.begin();
+			std::vector<std::pair<additional_buffer_smart_ptr, additional_buffer_set> >::iterator buffers_it = input_buffer_and_additional_testing_buffers_pack.begin();
+			for(std::vector<const_layer_tester_plain_smart_ptr>::const_iterator it = tester_list.begin(); it != tester_list.end(); ++it, ++layer_it, ++input_config_it, ++buffers_it, ++layer_id)
+			{
+				std::map<unsigned int, float>::const_iterator dropout_it = layer_to_dropout_rate_map.find(layer_id);
+				if (dropout_it != layer_to_dropout_rate_map.end())
+				{
+					unsigned int offset = dist(gen);
+					apply_dropout(
+						buffers_it->first,
+						dropout_it->second,
+						mask,
+						entry_count * layer_config_list[layer_id].get_neuron_count(),
+						offset,
+						plain_config);
+				}
+
+				(*it)->test(
+					buffers_it->first,
+					buffers_it->second,
+					plain_config,
+					*layer_it,
+					const_layer_data_smart_ptr(),
+					const_layer_data_custom_smart_ptr(),
+					*input_config_it,
+					*(input_config_it + 1),
+					entry_count);
+			}
+		}
+
+		void network_updater_plain::layer_config_list_modified()
+		{
+		}
+
+		void network_updater_plain::apply_gradient(
+			std::vector<layer_data_smart_ptr>& data,
+			std::vector<layer_data_smart_ptr>& gradient,
+			std::vector<std::vector<double> >& updates_accumulated,
+			const std::vector<std::vector<float> >& learning_rates,
+			float normalizer,
+			float weight_decay,
+			float momentum,
+			bool keep_momentum,
+			bool collect_update_stat) const
+		{
+			apply_gradient_plain_task t(
+				*schema,
+				testing_layer_count,
+				data,
+				gradient,
+				learning_rates,
+				normalizer,
+				weight_decay,
+				momentum,
+				keep_momentum,
+				collect_update_stat);
+			plain_config->run_parallel(t.get_workload_count(), t);
+			t.accumulate_updates(updates_accumulated);
+		}
+
+		void network_updater_plain::report_fused_momentum(
+			const layer_data_list& gradient,
+			unsigned int gradient_buffer_count)
+		{
+			if (fused_momentum_reported)
+				return;
+			fused_momentum_reported = true;
+
+			size_t elem_count = 0;
+			for(layer_data_list::const_iterator it = gradient.begin() + testing_layer_count; it != gradient.end(); ++it)
+				for(layer_data::const_iterator it2 = (*it)->begin(); it2 != (*it)->end(); ++it2)
+					elem_count += it2->size();
+			float megabytes = static_cast<float>(elem_count * sizeof(float) * gradient_buffer_count) / (1024.0F * 1024.0F);
+			std::cout << (boost::format("Momentum is kept in gradient buffers: %|1$.1f| MB used for gradients and momentum, %|1$.1f| MB saved") % megabytes) << std::endl;
+		}
+
+		unsigned int network_updater_plain::get_updater_max_count() const
+		{
+			buffer_plain_size_configuration buffer_configuration;
+
+			const const_layer_list& layer_list = *schema;
+			const_layer_list::const_iterator layer_it = layer_list.begin();
+			layer_configuration_specific_list::const_iterator input_config_it = layer_config_list.begin();
+			for(const_layer_updater_plain_list::const_iterator it = updater_list.begin(); it != updater_list.end(); ++it, ++layer_it, ++input_config_it)
+			{
+				(*it)->update_buffer_configuration(
+					buffer_configuration,
+					*layer_it,
+					*input_config_it,
+					*(input_config_it + 1),
+					plain_config,
+					(it != updater_list.begin()));
+			}
+
+			// Only updater layers are accounted for, leave room for testing layers, input buffers and weights, also when autotuning
+			return plain_config->get_max_entry_count(buffer_configuration, 0.5F);
+		}
+
+		float network_updater_plain::measure_updater_throughput(
+			network_data_smart_ptr data,
+			unsigned int updater_entry_count) const
+		{
+			const const_layer_list& layer_list = *schema;
+			const unsigned int output_neuron_count = layer_config_list.back().get_neuron_count();
+
+			additional_buffer_smart_ptr input_buf(new std::vector<float>(layer_config_list[testing_layer_count].get_neuron_count() * updater_entry_count, 0.0F));
+			additional_buffer_smart_ptr initial_error_buf(new std::vector<float>(output_neuron_count * updater_entry_count, 0.0F));
+			layer_data_list_smart_ptr gradient(new layer_data_list(*schema));
+			gradient->fill(0.0F);
+
+			std::vector<std::pair<additional_buffer_smart_ptr, updater_additional_buffer_set> > input_buffer_and_additional_updater_buffers_pack;
+			{
+				additional_buffer_smart_ptr output_buffer = input_buf;
+				const_layer_list::const_iterator layer_it = layer_list.begin() + testing_layer_count;
+				layer_configuration_specific_list::const_iterator input_config_it = layer_config_list.begin() + testing_layer_count;
+				for(const_layer_updater_plain_list::const_iterator it = updater_list.begin(); it != updater_list.end(); ++it, ++layer_it, ++input_config_it)
+				{
+					updater_additional_buffer_set additional_buffers = (*it)->allocate_additional_buffers(
+						updater_entry_count,
+						*layer_it,
+						*input_config_it,
+						*(input_config_it + 1),
+						plain_config,
+						(it != updater_list.begin()));
+					input_buffer_and_additional_updater_buffers_pack.push_back(std::make_pair(output_buffer, additional_buffers));
+					output_buffer = additional_buffers.output_neurons_buffer;
+				}
+
+				additional_buffer_smart_ptr output_errors = initial_error_buf;
+				for(std::vector<std::pair<additional_buffer_smart_ptr, updater_additional_buffer_set> >::reverse_iterator it = input_buffer_and_additional_updater_buffers_pack.rbegin(); it != input_buffer_and_additional_updater_buffers_pack.rend() - 1; ++it)
+				{
+					if (it->second.input_errors_buffer != 0)
+						output_errors = it->second.input_errors_buffer;
+					else
+						it->second.input_errors_buffer = output_errors;
+				}
+			}
+
+			unsigned int iteration_count = 0;
+			boost::chrono::steady_clock::time_point start = boost::chrono::high_resolution_clock::now();
+			boost::chrono::duration<float> sec(0.0F);
+			while ((iteration_count < 2) || (sec.count() < batch_size_autotuner::min_benchmark_seconds))
+			{
+				{
+					const_layer_list::const_iterator layer_it = layer_list.begin() + testing_layer_count;
+					layer_configuration_specific_list::const_iterator input_config_it = layer_config_list.begin() + testing_layer_count;
+					std::vector<std::pair<additional_buffer_smart_ptr, updater_additional_buffer_set> >::iterator updater_buffers_it = input_buffer_and_additional_updater_buffers_pack.begin();
+					layer_data_list::const_iterator data_it = data->data_list.begin() + testing_layer_count;
+					layer_data_custom_list::const_iterator data_custom_it = data->data_custom_list.begin() + testing_layer_count;
+					for(std::vector<const_layer_updater_plain_smart_ptr>::const_iterator it = updater_list.begin(); it != updater_list.end(); ++it, ++layer_it, ++input_config_it, ++updater_buffers_it, ++data_it, ++data_custom_it)
+					{
+						(*it)->test(
+							updater_buffers_it->first,
+							updater_buffers_it->second.output_neurons_buffer,
+							updater_buffers_it->second.additional_buffers,
+							plain_config,
+							*layer_it,
+							*data_it,
+							*data_custom_it,
+							*input_config_it,
+							*(input_config_it + 1),
+							updater_entry_count,
+							0);
+					}
+				}
+
+				{
+					const_layer_list::const_reverse_iterator layer_it = layer_list.rbegin() + (error_function_fused_with_activation ? 1 : 0);
+					std::vector<std::pair<additional_buffer_smart_ptr, updater_additional_buffer_set> >::reverse_iterator updater_buffers_it = input_buffer_and_additional_updater_buffers_pack.rbegin();
+					layer_configuration_specific_list::const_reverse_iterator input_config_it = layer_config_list.rbegin() + (error_function_fused_with_activation ? 1 : 0);
+					layer_data_list::const_reverse_iterator data_it = data->data_list.rbegin() + (error_function_fused_with_activation ? 1 : 0);
+					layer_data_custom_list::const_reverse_iterator data_custom_it = data->data_custom_list.rbegin() + (error_function_fused_with_activation ? 1 : 0);
+					layer_data_list::reverse_iterator gradient_it = gradient->rbegin() + (error_function_fused_with_activation ? 1 : 0);
+					additional_buffer_smart_ptr output_errors = initial_error_buf;
+					for(std::vector<const_layer_updater_plain_smart_ptr>::const_reverse_iterator it = updater_list.rbegin(); it != updater_list.rend(); ++it, ++layer_it, ++input_config_it, ++updater_buffers_it, ++data_it, ++data_custom_it, ++gradient_it)
+					{
+						if (it != updater_list.rend() - 1)
+						{
+							(*it)->backprop(
+								updater_buffers_it->second.input_errors_buffer,
+								updater_buffers_it->first,
+								output_errors,
+								updater_buffers_it->second.output_neurons_buffer,
+								updater_buffers_it->second.additional_buffers,
+								plain_config,
+								*layer_it,
+								*data_it,
+								*data_custom_it,
+								*(input_config_it + 1),
+								*input_config_it,
+								updater_entry_count);
+						}
+
+						(*it)->update_weights(
+							updater_buffers_it->first,
+							output_errors,
+							updater_buffers_it->second.additional_buffers,
+							*gradient_it,
+							*data_custom_it,
+							plain_config,
+							*layer_it,
+							*(input_config_it + 1),
+							*input_config_it,
+							updater_entry_count,
+							0);
+
+						output_errors = updater_buffers_it->second.input_errors_buffer;
+					}
+				}
+
+				++iteration_count;
+				sec = boost::chrono::high_resolution_clock::now() - start;
+			}
+
+			return static_cast<float>(iteration_count * updater_entry_count) / sec.count();
+		}
+
+		network_updater_plain::updater_batch_size_benchmark::updater_batch_size_benchmark(
+			const network_updater_plain& updater,
+			network_data_smart_ptr data)
+			: updater(updater)
+			, data(data)
+		{
+		}
+
+		float network_updater_plain::updater_batch_size_benchmark::measure(unsigned int entry_count)
+		{
+			return updater.measure_updater_throughput(data, entry_count);
+		}
+
+		void network_updater_plain::allocate_updater_shard(
+			std::vector<updater_shard_smart_ptr>& shard_list,
+			additional_buffer_smart_ptr input_buffer,
+			network_data_smart_ptr data,
+			layer_data_list_smart_ptr gradient,
+			unsigned int shard_entry_count,
+			unsigned int shard_id) const
+		{
+			updater_shard& shard = *shard_list[shard_id];
+
+			if (shard_list.size() == 1)
+				shard.plain_config = plain_config;
+			else
+			{
+				const std::vector<unsigned int>& cpu_set = plain_config->numa_shard_cpu_list[shard_id];
+				int thread_count = cpu_set.empty() ? std::max(plain_config->openmp_thread_count / static_cast<int>(shard_list.size()), 1) : static_cast<int>(cpu_set.size());
+				shard.plain_config = plain_running_configuration_const_smart_ptr(new plain_running_configuration(thread_count, plain_config->max_memory_usage_gigabytes));
+			}
+
+			if (plain_config->overlap_weight_update && (shard.plain_config->openmp_thread_count > 1))
+			{
+				shard.backprop_config = plain_running_configuration_const_smart_ptr(new plain_running_configuration(*shard.plain_config, 0, 2));
+				shard.update_weights_config = plain_running_configuration_const_smart_ptr(new plain_running_configuration(*shard.plain_config, 1, 2));
+				shard.update_weights_queue = plain_job_queue_smart_ptr(new plain_job_queue());
+			}
+
+			shard.data_custom_list = data->data_custom_list;
+			if (shard_id == 0)
+			{
+				shard.data_list = data->data_list;
+				shard.gradient = gradient;
+			}
+			else
+			{
+				for(layer_data_list::const_iterator it = data->data_list.begin(); it != data->data_list.end(); ++it)
+					shard.data_list.push_back(layer_data_smart_ptr(new layer_data(**it)));
+				shard.gradient = layer_data_list_smart_ptr(new layer_data_list(*schema));
+				shard.gradient->fill(0.0F);
+				plain_memory_usage_tracker::track_layer_data_list(memory_usage, shard.data_list, plain_memory_usage_tracker::weight_replicas_category);
+				plain_memory_usage_tracker::track_layer_data_list(memory_usage, *shard.gradient, plain_memory_usage_tracker::weight_replicas_category);
+			}
+
+			allocate_updater_shard_buffers(shard, input_buffer, shard_entry_count);
+		}
+
+		void network_updater_plain::allocate_updater_shard_buffers(
+			updater_shard& shard,
+			additional_buffer_smart_ptr input_buffer,
+			unsigned int shard_entry_count) const
+		{
+			const unsigned int output_neuron_count = layer_config_list.back().get_neuron_count();
+			shard.initial_error_buf = additional_buffer_smart_ptr(new std::vector<float>(shard_entry_count * output_neuron_count));
+			shard.initial_error_buf = plain_memory_usage_tracker::track_buffer(memory_usage, shard.initial_error_buf, plain_memory_usage_tracker::activations_category);
+
+			shard.bytes_per_entry = 0.0;
+			shard.bytes_per_chunk = 0.0;
+			{
+				additional_buffer_smart_ptr output_buffer = input_buffer;
+				const const_layer_list& layer_list = *schema;
+				const_layer_list::const_iterator layer_it = layer_list.begin() + testing_layer_count;
+				layer_configuration_specific_list::const_iterator input_config_it = layer_config_list.begin() + testing_layer_count;
+				layer_data_list::const_iterator data_it = shard.data_list.begin() + testing_layer_count;
+				for(const_layer_updater_plain_list::const_iterator it = updater_list.begin(); it != updater_list.end(); ++it, ++layer_it, ++input_config_it, ++data_it)
+				{
+					updater_additional_buffer_set additional_buffers = (*it)->allocate_additional_buffers(
+						shard_entry_count,
+						*layer_it,
+						*input_config_it,
+						*(input_config_it + 1),
+						shard.plain_config,
+						(it != updater_list.begin()));
+					plain_memory_usage_tracker::track_updater_buffers(memory_usage, additional_buffers);
+					shard.input_buffer_and_additional_updater_buffers_pack.push_back(std::make_pair(output_buffer, additional_buffers));
+					output_buffer = additional_buffers.output_neurons_buffer;
+
+					shard.bytes_per_entry += static_cast<double>((input_config_it->get_neuron_count() + (input_config_it + 1)->get_neuron_count()) * sizeof(float) * 2);
+					for(layer_data::const_iterator it2 = (*data_it)->begin(); it2 != (*data_it)->end(); ++it2)
+						shard.bytes_per_chunk += static_cast<double>(it2->size() * sizeof(float) * 4);
+				}
+				shard.output_buffer = output_buffer;
+			}
+			{
+				additional_buffer_smart_ptr output_errors = shard.initial_error_buf;
+				for(std::vector<std::pair<additional_buffer_smart_ptr, updater_additional_buffer_set> >::reverse_iterator it = shard.input_buffer_and_additional_updater_buffers_pack.rbegin(); it != shard.input_buffer_and_additional_updater_buffers_pack.rend() - 1; ++it)
+				{
+					if (it->second.input_errors_buffer != 0)
+						output_errors = it->second.input_errors_buffer;
+					else
+						it->second.input_errors_buffer = output_errors;
+				}
+			}
+
+			shard.base_input_entry_id = 0;
+			shard.offset_in_chunk = 0;
+			shard.entry_count = 0;
+			shard.error = 0.0;
+			shard.processed_entry_count = 0;
+			shard.busy_seconds = 0.0;
+			shard.transferred_bytes = 0.0;
+		}
+
+		void network_updater_plain::run_updater_shard(
+			std::vector<updater_shard_smart_ptr>& shard_list,
+			const std::vector<float>& actual_output_buf,
+			const std::map<unsigned int, float>& layer_to_dropout_rate_map,
+			const std::vector<unsigned int>& dropout_offset_list,
+			unsigned int mask,
+			unsigned int shard_id) const
+		{
+			updater_shard& shard = *shard_list[shard_id];
+
+			shard.error = 0.0;
+			if (shard.entry_count == 0)
+				return;
+
+			boost::chrono::steady_clock::time_point start = boost::chrono::high_resolution_clock::now();
+
+			const const_layer_list& layer_list = *schema;
+			const unsigned int output_neuron_count = layer_config_list.back().get_neuron_count();
+			std::stack<unsigned int> offset_list;
+			unsigned int dropout_offset_id = 0;
+
+			// Forward updater
+			{
+				const_layer_list::const_iterator layer_it = layer_list.begin() + testing_layer_count;
+				layer_configuration_specific_list::const_iterator input_config_it = layer_config_list.begin() + testing_layer_count;
+				std::vector<std::pair<additional_buffer_smart_ptr, updater_additional_buffer_set> >::iterator updater_buffers_it = shard.input_buffer_and_additional_updater_buffers_pack.begin();
+				layer_data_list::const_iterator data_it = shard.data_list.begin() + testing_layer_count;
+				layer_data_custom_list::const_iterator data_custom_it = shard.data_custom_list.begin() + testing_layer_count;
+				unsigned int layer_id = testing_layer_count;
+				for(std::vector<const_layer_updater_plain_smart_ptr>::const_iterator it = updater_list.begin(); it != updater_list.end(); ++it, ++layer_it, ++input_config_it, ++updater_buffers_it, ++data_it, ++data_custom_it, ++layer_id)
+				{
+					if (it != updater_list.begin())
+					{
+						std::map<unsigned int, float>::const_iterator dropout_it = layer_to_dropout_rate_map.find(layer_id);
+						if (dropout_it != layer_to_dropout_rate_map.end())
+						{
+							unsigned int offset = dropout_offset_list[dropout_offset_id] + shard.offset_in_chunk * layer_config_list[layer_id].get_neuron_count();
+							++dropout_offset_id;
+							offset_list.push(offset);
+							apply_dropout(
+								updater_buffers_it->first,
+								dropout_it->second,
+								mask,
+								shard.entry_count * layer_config_list[layer_id].get_neuron_count(),
+								offset,
+								shard.plain_config);
+						}
+					}
+
+					(*it)->test(
+						updater_buffers_it->first,
+						updater_buffers_it->second.output_neurons_buffer,
+						updater_buffers_it->second.additional_buffers,
+						shard.plain_config,
+						*layer_it,
+						*data_it,
+						*data_custom_it,
+						*input_config_it,
+						*(input_config_it + 1),
+						shard.entry_count,
+						(it == updater_list.begin()) ? shard.base_input_entry_id : 0);
+				}
+			}
+
+			// Set initial error and accumulate error
+			{
+				const std::vector<float>::iterator initial_error_it = shard.initial_error_buf->begin();
+				const std::vector<float>::const_iterator actual_output_buf_it = actual_output_buf.begin() + (output_neuron_count * shard.base_input_entry_id);
+				const std::vector<float>::const_iterator output_buffer_it = shard.output_buffer->begin();
+				const error_function& error_func = *ef;
+				const int elem_count = shard.entry_count;
+				std::vector<double> errors(shard.plain_config->openmp_thread_count, 0.0);
+				const std::vector<double>::iterator errors_it = errors.begin();
+				#pragma omp parallel default(none) shared(error_func) num_threads(shard.plain_config->openmp_thread_count)
+				{
+					int thread_id = 0;
+					#ifdef _OPENMP
+						thread_id = omp_get_thread_num();
+					#endif
+
+					#pragma omp for schedule(guided)
+					for(int updater_entry_id = 0; updater_entry_id < elem_count; ++updater_entry_id)
+					{
+						const float * predicted_vals = &(*(output_buffer_it + (updater_entry_id * output_neuron_count)));
+						const float * actual_vals = &(*(actual_output_buf_it + (updater_entry_id * output_neuron_count)));
+						float * initial_errors = &(*(initial_error_it + (updater_entry_id * output_neuron_count)));
+
+						float error;
+						if (error_function_fused_with_activation)
+							error = error_func.calculate_gradient_and_error_fused_with_activation(actual_vals, predicted_vals, initial_errors, output_neuron_count);
+						else
+							error = error_func.calculate_gradient_and_error(actual_vals, predicted_vals, initial_errors, output_neuron_count);
+						*(errors_it + thread_id) += static_cast<double>(error);
+					}
+				}
+				shard.error = std::accumulate(errors.begin(), errors.end(), 0.0);
+			}
+
+			// Run backward and update weights.
+			// Weight gradient of the layer doesn't block backprop of the preceding layers, so when the shard has the queue
+			// it is computed there concurrently with them. Each of the two runs on its half of the threads while the other one is busy,
+			// and on all the threads otherwise
+			{
+				const_layer_list::const_reverse_iterator layer_it = layer_list.rbegin() + (error_function_fused_with_activation ? 1 : 0);
+				std::vector<std::pair<additional_buffer_smart_ptr, updater_additional_buffer_set> >::reverse_iterator updater_buffers_it = shard.input_buffer_and_additional_updater_buffers_pack.rbegin();
+				layer_configuration_specific_list::const_reverse_iterator input_config_it = layer_config_list.rbegin() + (error_function_fused_with_activation ? 1 : 0);
+				layer_data_list::const_reverse_iterator data_it = shard.data_list.rbegin() + (error_function_fused_with_activation ? 1 : 0);
+				layer_data_custom_list::const_reverse_iterator data_custom_it = shard.data_custom_list.rbegin() + (error_function_fused_with_activation ? 1 : 0);
+				additional_buffer_smart_ptr output_errors = shard.initial_error_buf;
+				unsigned int reverse_layer_id = static_cast<unsigned int>(updater_list.size() + testing_layer_count) - 1;
+				// Output errors buffers the queued weight gradient jobs read, with the ids of the jobs
+				std::vector<std::pair<const_additional_buffer_smart_ptr, unsigned int> > queued_output_errors_list;
+				for(std::vector<const_layer_updater_plain_smart_ptr>::const_reverse_iterator it = updater_list.rbegin(); it != updater_list.rend(); ++it, ++layer_it, ++input_config_it, ++updater_buffers_it, ++data_it, ++data_custom_it, --reverse_layer_id)
+				{
+					plain_running_configuration_const_smart_ptr backprop_config = shard.plain_config;
+					if (shard.update_weights_queue && !shard.update_weights_queue->is_idle())
+						backprop_config = shard.backprop_config;
+
+					if (it != updater_list.rend() - 1)
+					{
+						// In-place backprop overwrites output errors the queued jobs might still read
+						for(std::vector<std::pair<const_additional_buffer_smart_ptr, unsigned int> >::const_iterator queued_it = queued_output_errors_list.begin(); queued_it != queued_output_errors_list.end(); ++queued_it)
+						{
+							if (queued_it->first == updater_buffers_it->second.input_errors_buffer)
+								shard.update_weights_queue->wait(queued_it->second);
+						}
+
+						(*it)->backprop(
+							updater_buffers_it->second.input_errors_buffer,
+							updater_buffers_it->first,
+							output_errors,
+							updater_buffers_it->second.output_neurons_buffer,
+							updater_buffers_it->second.additional_buffers,
+							backprop_config,
+							*layer_it,
+							*data_it,
+							*data_custom_it,
+							*(input_config_it + 1),
+							*input_config_it,
+							shard.entry_count);
+						
+						/*
+						{
+							boost::filesystem::path dir = "Debug";
+							dir /= "CPU";
+							boost::filesystem::create_directories(dir);
+							debug_util::dump_list(
+								&(*updater_buffers_it->second.input_errors_buffer->begin()),
+								updater_buffers_it->second.input_errors_buffer->size(),
+								(dir / (boost::format("input_errors_%1%.txt") % reverse_layer_id).str()).string().c_str());
+						}
+						*/
+
+						std::map<unsigned int, float>::const_iterator dropout_it = layer_to_dropout_rate_map.find(reverse_layer_id);
+						if (dropout_it != layer_to_dropout_rate_map.end())
+						{
+							unsigned int offset = offset_list.top();
+							offset_list.pop();
+							apply_dropout(
+								updater_buffers_it->second.input_errors_buffer,
+								dropout_it->second,
+								mask,
+								shard.entry_count * layer_config_list[reverse_layer_id].get_neuron_count(),
+								offset,
+								backprop_config);
+						}
+
+						if (shard.update_weights_queue)
+						{
+							unsigned int job_id = shard.update_weights_queue->submit(boost::bind(
+								&network_updater_plain::update_layer_weights,
+								this,
+								boost::ref(shard),
+								reverse_layer_id - testing_layer_count,
+								output_errors,
+								shard.update_weights_config));
+							queued_output_errors_list.push_back(std::make_pair(output_errors, job_id));
+						}
+						else
+							update_layer_weights(shard, reverse_layer_id - testing_layer_count, output_errors, shard.plain_config);
+					}
+					else
+					{
+						// The first layer's weight gradient is computed here, concurrently with the jobs still queued
+						update_layer_weights(shard, reverse_layer_id - testing_layer_count, output_errors, backprop_config);
+						if (shard.update_weights_queue)
+							shard.update_weights_queue->wait_all();
+					}
+
+					output_errors = updater_buffers_it->second.input_errors_buffer;
+				}
+			}
+
+			boost::chrono::duration<double> sec = boost::chrono::high_resolution_clock::now() - start;
+			shard.busy_seconds += sec.count();
+			shard.processed_entry_count += shard.entry_count;
+			shard.transferred_bytes += shard.bytes_per_chunk + shard.bytes_per_entry * static_cast<double>(shard.entry_count);
+		}
+
+		void network_updater_plain::update_layer_weights(
+			updater_shard& shard,
+			unsigned int updater_id,
+			const_additional_buffer_smart_ptr output_errors,
+			plain_running_configuration_const_smart_ptr config) const
+		{
+			const const_layer_list& layer_list = *schema;
+			const unsigned int layer_id = testing_layer_count + updater_id;
+			updater_additional_buffer_set& buffers = shard.input_buffer_and_additional_updater_buffers_pack[updater_id].second;
+
+			updater_list[updater_id]->update_weights(
+				shard.input_buffer_and_additional_updater_buffers_pack[updater_id].first,
+				output_errors,
+				buffers.additional_buffers,
+				(*shard.gradient)[layer_id],
+				shard.data_custom_list[layer_id],
+				config,
+				layer_list[layer_id],
+				layer_config_list[layer_id],
+				layer_config_list[layer_id + 1],
+				shard.entry_count,
+				(updater_id == 0) ? shard.base_input_entry_id : 0);
+		}
+
+		void network_updater_plain::allocate_asynchronous_worker(
+			updater_shard& worker,
+			additional_buffer_smart_ptr input_buffer,
+			network_data_smart_ptr data,
+			unsigned int batch_size) const
+		{
+			worker.plain_config = plain_running_configuration_const_smart_ptr(new plain_running_configuration(1, plain_config->max_memory_usage_gigabytes));
+			worker.data_list = data->data_list;
+			worker.data_custom_list = data->data_custom_list;
+			worker.gradient = layer_data_list_smart_ptr(new layer_data_list(*schema));
+			plain_memory_usage_tracker::track_layer_data_list(memory_usage, *worker.gradient, plain_memory_usage_tracker::gradients_category);
+			for(std::vector<layer_data_smart_ptr>::const_iterator it = data->data_list.begin(); it != data->data_list.end(); ++it)
+				worker.updates_accumulated.push_back(std::vector<double>((*it)->size(), 0.0));
+			worker.accumulated_error = 0.0;
+			worker.gradient_applied_count = 0;
+			worker.update_stat_collected_count = 0;
+
+			allocate_updater_shard_buffers(worker, input_buffer, batch_size);
+		}
+
+		void network_updater_plain::run_asynchronous_worker(
+			std::vector<updater_shard_smart_ptr>& worker_list,
+			asynchronous_batch_queue& queue,
+			unsigned int worker_id) const
+		{
+			updater_shard& worker = *worker_list[worker_id];
+			const float gradient_normalizer = 1.0F / static_cast<float>(queue.batch_size);
+
+			while (true)
+			{
+				unsigned int batch_id;
+				{
+					boost::lock_guard<boost::mutex> lock(queue.mtx);
+					if (queue.next_batch_id >= queue.batch_count)
+						break;
+					batch_id = queue.next_batch_id;
+					++queue.next_batch_id;
+				}
+
+				worker.base_input_entry_id = batch_id * queue.batch_size;
+				worker.offset_in_chunk = 0;
+				worker.entry_count = std::min(queue.batch_size, queue.entry_count - worker.base_input_entry_id);
+				run_updater_shard(
+					worker_list,
+					*queue.actual_output_buf,
+					*queue.layer_to_dropout_rate_map,
+					queue.dropout_offset_lists[batch_id],
+					queue.mask,
+					worker_id);
+				worker.accumulated_error += worker.error;
+
+				bool collect_update_stat = (plain_config->training_stat_sample_period > 0)
+					? (worker.gradient_applied_count % plain_config->training_stat_sample_period == 0)
+					: (queue.last_chunk && (batch_id == queue.batch_count - 1));
+
+				// Weights are updated without locks, so updates of other workers to the same weights might be lost
+				apply_gradient_plain_task t(
+					*schema,
+					testing_layer_count,
+					worker.data_list,
+					*worker.gradient,
+					*queue.learning_rates,
+					gradient_normalizer,
+					queue.weight_decay,
+					queue.momentum,
+					true,
+					collect_update_stat);
+				t.run_tile(0, t.get_workload_count());
+				t.accumulate_updates(worker.updates_accumulated);
+				if (collect_update_stat)
+					++worker.update_stat_collected_count;
+				++worker.gradient_applied_count;
+			}
+		}
+
+		void network_updater_plain::synchronize_updater_shard(
+			std::vector<updater_shard_smart_ptr>& shard_list,
+			network_data_smart_ptr data,
+			unsigned int shard_id) const
+		{
+			if (shard_id == 0)
+				return;
+
+			updater_shard& shard = *shard_list[shard_id];
+			layer_data_list::const_iterator src_it = data->data_list.begin() + testing_layer_count;
+			for(layer_data_list::iterator dst_it = shard.data_list.begin() + testing_layer_count; dst_it != shard.data_list.end(); ++dst_it, ++src_it)
+				std::copy((*src_it)->begin(), (*src_it)->end(), (*dst_it)->begin());
+			shard.gradient->fill(0.0F);
+		}
+
+		void network_updater_plain::reduce_gradient(std::vector<updater_shard_smart_ptr>& shard_list) const
+		{
+			if (shard_list.size() <= 1)
+				return;
+
+			layer_data_list& dst = *shard_list[0]->gradient;
+			for(unsigned int layer_id = testing_layer_count; layer_id < dst.size(); ++layer_id)
+			{
+				for(unsigned int part_id = 0; part_id < dst[layer_id]->size(); ++part_id)
+				{
+					const std::vector<float>::iterator dst_it = (*dst[layer_id])[part_id].begin();
+					const int elem_count = static_cast<int>((*dst[layer_id])[part_id].size());
+					for(std::vector<updater_shard_smart_ptr>::const_iterator it = shard_list.begin() + 1; it != shard_list.end(); ++it)
+					{
+						const std::vector<float>::const_iterator src_it = (*(*it)->gradient->at(layer_id))[part_id].begin();
+						#pragma omp parallel for default(none) schedule(guided) num_threads(plain_config->openmp_thread_count)
+						for(int i = 0; i < elem_count; ++i)
+							*(dst_it + i) += *(src_it + i);
+					}
+				}
+			}
 		}
 
 		void network_updater_plain::update_buffers_configuration(
@@ -667,13 +1514,14 @@ namespace nnforge
 			const float dropout_rate,
 			const unsigned int mask,
 			const unsigned int elem_count,
-			const unsigned int offset_in_random_list) const
+			const unsigned int offset_in_random_list,
+			plain_running_configuration_const_smart_ptr config) const
 		{
 			const std::vector<float>::const_iterator rnd_it = random_uniform_list.begin();
 			const std::vector<float>::iterator in_it = target_buffer->begin();
 			const float scale = 1.0F / (1.0F - dropout_rate);
 
-			#pragma omp parallel for default(none) schedule(guided) num_threads(plain_config->openmp_thread_count)
+			#pragma omp parallel for default(none) schedule(guided) num_threads(config->openmp_thread_count)
 			for(int i = 0; i < static_cast<int>(elem_count); ++i)
 			{
 				float val = *(in_it + i);
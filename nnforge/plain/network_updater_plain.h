@@ -22,6 +22,12 @@
 #include "plain_running_configuration.h"
 #include "buffer_plain_size_configuration.h"
 #include "layer_tester_plain.h"
+#include "batch_size_autotuner.h"
+#include "plain_thread_pool.h"
+#include "plain_job_queue.h"
+
+#include <map>
+#include <boost/thread/mutex.hpp>
 
 namespace nnforge
 {
@@ -37,6 +43,10 @@ namespace nnforge
 
 			~network_updater_plain();
 
+			virtual void set_all_reducer(ring_all_reducer_smart_ptr all_reducer);
+
+			virtual void set_weight_synchronizer(weight_synchronizer_smart_ptr synchronizer);
+
 		protected:
 			// schema, data and reader are guaranteed to be compatible
 			virtual std::pair<testing_result_smart_ptr, training_stat_smart_ptr> actual_update(
@@ -48,6 +58,17 @@ namespace nnforge
 				float momentum,
 				const std::map<unsigned int, float>& layer_to_dropout_rate_map);
 
+			// Each worker runs updater layers single-threaded on its own buffers and applies its gradient right to data
+			virtual std::pair<testing_result_smart_ptr, training_stat_smart_ptr> actual_update_asynchronous(
+				supervised_data_reader& reader,
+				const std::vector<std::vector<float> >& learning_rates,
+				network_data_smart_ptr data,
+				unsigned int batch_size,
+				float weight_decay,
+				float momentum,
+				const std::map<unsigned int, float>& layer_to_dropout_rate_map,
+				unsigned int worker_count);
+
 			// The method is called when client calls set_input_configuration_specific and the convolution specific configuration is modified.
 			// The layer_config_list is guaranteed to be compatible with schema
 			virtual void layer_config_list_modified();
@@ -58,6 +79,172 @@ namespace nnforge
 
 			unsigned int get_updater_max_count() const;
 
+			// Runs forward and backward passes of updater layers on dummy data
+			float measure_updater_throughput(
+				network_data_smart_ptr data,
+				unsigned int updater_entry_count) const;
+
+			class updater_batch_size_benchmark : public batch_size_autotuner::benchmark
+			{
+			public:
+				updater_batch_size_benchmark(
+					const network_updater_plain& updater,
+					network_data_smart_ptr data);
+
+				virtual float measure(unsigned int entry_count);
+
+			private:
+				const network_updater_plain& updater;
+				network_data_smart_ptr data;
+			};
+
+			// Updater layers process each chunk of entries in shards, each with its own buffers, weights replica and gradient.
+			// There is a single shard unless NUMA sharding is on
+			struct updater_shard
+			{
+				plain_running_configuration_const_smart_ptr plain_config;
+				std::vector<std::pair<additional_buffer_smart_ptr, updater_additional_buffer_set> > input_buffer_and_additional_updater_buffers_pack;
+				additional_buffer_smart_ptr initial_error_buf;
+				additional_buffer_smart_ptr output_buffer;
+				layer_data_list data_list;
+				layer_data_custom_list data_custom_list;
+				layer_data_list_smart_ptr gradient;
+
+				// Entries of the current chunk assigned to the shard
+				unsigned int base_input_entry_id;
+				unsigned int offset_in_chunk;
+				unsigned int entry_count;
+				double error;
+
+				// Estimated memory traffic, activations and errors are read and written once per pass,
+				// weights are read twice and gradients are read and written once per chunk
+				double bytes_per_entry;
+				double bytes_per_chunk;
+
+				unsigned int processed_entry_count;
+				double busy_seconds;
+				double transferred_bytes;
+
+				std::vector<std::vector<double> > updates_accumulated;
+				double accumulated_error;
+				unsigned int gradient_applied_count;
+				unsigned int update_stat_collected_count;
+
+				// Configurations of the two halves of the shard's threads, used when weight update overlaps backprop
+				plain_running_configuration_const_smart_ptr backprop_config;
+				plain_running_configuration_const_smart_ptr update_weights_config;
+
+				// Computes weight gradients concurrently with backprop, empty if they are computed inline.
+				// Declared last so that the pending jobs complete before the buffers they use are released
+				plain_job_queue_smart_ptr update_weights_queue;
+			};
+			typedef nnforge_shared_ptr<updater_shard> updater_shard_smart_ptr;
+
+			// Batches of the current chunk asynchronous workers take one by one
+			struct asynchronous_batch_queue
+			{
+				boost::mutex mtx;
+				unsigned int next_batch_id;
+				unsigned int batch_count;
+				unsigned int batch_size;
+				unsigned int entry_count;
+				bool last_chunk;
+
+				// Offsets in random list for updater layers with dropout, except for the first one, for each batch
+				std::vector<std::vector<unsigned int> > dropout_offset_lists;
+
+				const std::vector<float> * actual_output_buf;
+				const std::map<unsigned int, float> * layer_to_dropout_rate_map;
+				const std::vector<std::vector<float> > * learning_rates;
+				float weight_decay;
+				float momentum;
+				unsigned int mask;
+			};
+
+			// Shard 0 uses data and gradient, other shards replicate them.
+			// Called from the thread bound to the shard so that its buffers are allocated on the shard's node
+			void allocate_updater_shard(
+				std::vector<updater_shard_smart_ptr>& shard_list,
+				additional_buffer_smart_ptr input_buffer,
+				network_data_smart_ptr data,
+				layer_data_list_smart_ptr gradient,
+				unsigned int shard_entry_count,
+				unsigned int shard_id) const;
+
+			// Allocates buffers of updater layers, the first one takes its input from input_buffer
+			void allocate_updater_shard_buffers(
+				updater_shard& shard,
+				additional_buffer_smart_ptr input_buffer,
+				unsigned int shard_entry_count) const;
+
+			// The worker shares data with all the other workers and has its own gradient and previous updates
+			void allocate_asynchronous_worker(
+				updater_shard& worker,
+				additional_buffer_smart_ptr input_buffer,
+				network_data_smart_ptr data,
+				unsigned int batch_size) const;
+
+			// Takes batches from the queue until it is empty, applies gradient of each batch to data without locking
+			void run_asynchronous_worker(
+				std::vector<updater_shard_smart_ptr>& worker_list,
+				asynchronous_batch_queue& queue,
+				unsigned int worker_id) const;
+
+			// Runs forward and backward passes of updater layers on the entries assigned to the shard.
+			// dropout_offset_list contains offsets in random list for updater layers with dropout, except for the first one
+			void run_updater_shard(
+				std::vector<updater_shard_smart_ptr>& shard_list,
+				const std::vector<float>& actual_output_buf,
+				const std::map<unsigned int, float>& layer_to_dropout_rate_map,
+				const std::vector<unsigned int>& dropout_offset_list,
+				unsigned int mask,
+				unsigned int shard_id) const;
+
+			// Accumulates weight gradient of updater updater_id of the shard
+			void update_layer_weights(
+				updater_shard& shard,
+				unsigned int updater_id,
+				const_additional_buffer_smart_ptr output_errors,
+				plain_running_configuration_const_smart_ptr config) const;
+
+			// Copies updated weights to the replica and clears gradient of the shard
+			void synchronize_updater_shard(
+				std::vector<updater_shard_smart_ptr>& shard_list,
+				network_data_smart_ptr data,
+				unsigned int shard_id) const;
+
+			// Accumulates gradients of all the shards in the gradient of shard 0
+			void reduce_gradient(std::vector<updater_shard_smart_ptr>& shard_list) const;
+
+			// Allocates buffers of testing layers, returns output buffer of the last one
+			additional_buffer_smart_ptr allocate_testing_buffers(
+				std::vector<std::pair<additional_buffer_smart_ptr, additional_buffer_set> >& input_buffer_and_additional_testing_buffers_pack,
+				additional_buffer_smart_ptr input_buffer,
+				unsigned int entry_count) const;
+
+			// Converts elem_count input elements to float, input_mul_add_list is used for type_uint8_scaled only
+			void convert_input(
+				const std::vector<unsigned char>& input_buf,
+				std::vector<float>& input_converted_buf,
+				unsigned int elem_count,
+				neuron_data_type::input_type type_code,
+				const std::vector<std::pair<float, float> >& input_mul_add_list,
+				unsigned int neuron_count_per_input_feature_map) const;
+
+			// Runs testing layers, offsets in random list for dropout are drawn from the updater's random generator
+			void run_testing_layers(
+				std::vector<std::pair<additional_buffer_smart_ptr, additional_buffer_set> >& input_buffer_and_additional_testing_buffers_pack,
+				const std::map<unsigned int, float>& layer_to_dropout_rate_map,
+				nnforge_uniform_int_distribution<unsigned int>& dist,
+				unsigned int mask,
+				unsigned int entry_count);
+
+			// Averages absolute updates collected over update_stat_collected_count gradient applications
+			training_stat_smart_ptr get_training_stat(
+				const std::vector<std::vector<double> >& updates_accumulated,
+				unsigned int update_stat_collected_count,
+				network_data_smart_ptr data) const;
+
 			void update_buffers_configuration(
 				buffer_plain_size_configuration& buffer_configuration,
 				unsigned int updater_entry_count) const;
@@ -67,20 +254,33 @@ namespace nnforge
 				const float dropout_rate,
 				const unsigned int mask,
 				const unsigned int updater_count,
-				const unsigned int offset_in_random_list) const;
+				const unsigned int offset_in_random_list,
+				plain_running_configuration_const_smart_ptr config) const;
 
 			void apply_gradient(
 				std::vector<layer_data_smart_ptr>& data,
 				std::vector<layer_data_smart_ptr>& gradient,
-				std::vector<layer_data_smart_ptr>& previous_upd,
 				std::vector<std::vector<double> >& updates_accumulated,
 				const std::vector<std::vector<float> >& learning_rates,
 				float normalizer,
 				float weight_decay,
-				float momentum) const;
+				float momentum,
+				bool keep_momentum,
+				bool collect_update_stat) const;
+
+			// Prints memory saved by keeping momentum in gradient buffers, once per updater
+			void report_fused_momentum(
+				const layer_data_list& gradient,
+				unsigned int gradient_buffer_count);
 
 			plain_running_configuration_const_smart_ptr plain_config;
 
+			// Empty if the update is not data-parallel
+			ring_all_reducer_smart_ptr all_reducer;
+
+			// Empty if the update is not stale-synchronous
+			weight_synchronizer_smart_ptr synchronizer;
+
 			unsigned int testing_layer_count;
 			const_layer_list::const_iterator start_layer_nonempty_weights_iterator;
 
@@ -89,6 +289,8 @@ namespace nnforge
 
 			bool error_function_fused_with_activation;
 
+			bool fused_momentum_reported;
+
 			static unsigned int max_entry_count_in_single_batch;
 		};
 	}
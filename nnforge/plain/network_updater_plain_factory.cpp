@@ -40,5 +40,17 @@ namespace nnforge
 				ef,
 				plain_config));
 		}
+
+		network_updater_smart_ptr network_updater_plain_factory::create_concurrent(
+			network_schema_smart_ptr schema,
+			const_error_function_smart_ptr ef,
+			unsigned int updater_id,
+			unsigned int updater_count) const
+		{
+			return network_updater_smart_ptr(new network_updater_plain(
+				schema,
+				ef,
+				plain_running_configuration_const_smart_ptr(new plain_running_configuration(*plain_config, updater_id, updater_count))));
+		}
 	}
 }
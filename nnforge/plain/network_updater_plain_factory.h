@@ -34,6 +34,12 @@ namespace nnforge
 				network_schema_smart_ptr schema,
 				const_error_function_smart_ptr ef) const;
 
+			virtual network_updater_smart_ptr create_concurrent(
+				network_schema_smart_ptr schema,
+				const_error_function_smart_ptr ef,
+				unsigned int updater_id,
+				unsigned int updater_count) const;
+
 		protected:
 			plain_running_configuration_const_smart_ptr plain_config;
 		};
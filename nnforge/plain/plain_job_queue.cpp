@@ -0,0 +1,128 @@
+/*
+ *  Copyright 2011-2014 Maxim Milakov
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+
+#include "plain_job_queue.h"
+
+#include "../neural_network_exception.h"
+
+#include <boost/bind.hpp>
+#include <boost/thread/locks.hpp>
+
+namespace nnforge
+{
+	namespace plain
+	{
+		plain_job_queue::plain_job_queue()
+			: submitted_count(0)
+			, completed_count(0)
+			, stop_requested(false)
+		{
+			worker_thread = nnforge_shared_ptr<boost::thread>(new boost::thread(boost::bind(&plain_job_queue::worker, this)));
+		}
+
+		plain_job_queue::~plain_job_queue()
+		{
+			{
+				boost::lock_guard<boost::mutex> lock(mtx);
+				stop_requested = true;
+			}
+			job_submitted.notify_one();
+
+			worker_thread->join();
+		}
+
+		unsigned int plain_job_queue::submit(const boost::function<void ()>& job)
+		{
+			unsigned int job_id;
+			{
+				boost::lock_guard<boost::mutex> lock(mtx);
+				job_list.push_back(job);
+				job_id = submitted_count;
+				++submitted_count;
+			}
+			job_submitted.notify_one();
+
+			return job_id;
+		}
+
+		void plain_job_queue::wait(unsigned int job_id)
+		{
+			boost::unique_lock<boost::mutex> lock(mtx);
+			while (completed_count <= job_id)
+				job_completed.wait(lock);
+
+			if (!error.empty())
+				throw neural_network_exception(error);
+		}
+
+		void plain_job_queue::wait_all()
+		{
+			boost::unique_lock<boost::mutex> lock(mtx);
+			while (completed_count < submitted_count)
+				job_completed.wait(lock);
+
+			if (!error.empty())
+				throw neural_network_exception(error);
+		}
+
+		bool plain_job_queue::is_idle()
+		{
+			boost::lock_guard<boost::mutex> lock(mtx);
+			return (completed_count == submitted_count);
+		}
+
+		void plain_job_queue::worker()
+		{
+			while (true)
+			{
+				boost::function<void ()> job;
+				bool skip;
+				{
+					boost::unique_lock<boost::mutex> lock(mtx);
+					while ((!stop_requested) && job_list.empty())
+						job_submitted.wait(lock);
+					if (job_list.empty())
+						return;
+					job = job_list.front();
+					job_list.pop_front();
+					skip = !error.empty();
+				}
+
+				std::string own_error;
+				if (!skip)
+				{
+					try
+					{
+						job();
+					}
+					catch (const std::exception& e)
+					{
+						own_error = e.what();
+					}
+				}
+
+				{
+					boost::lock_guard<boost::mutex> lock(mtx);
+					if (error.empty())
+						error = own_error;
+					++completed_count;
+				}
+				job_completed.notify_all();
+			}
+		}
+	}
+}
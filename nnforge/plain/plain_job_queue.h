@@ -0,0 +1,76 @@
+/*
+ *  Copyright 2011-2014 Maxim Milakov
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+
+#pragma once
+
+#include "../nn_types.h"
+
+#include <deque>
+#include <string>
+#include <boost/thread/thread.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/condition_variable.hpp>
+#include <boost/function.hpp>
+
+namespace nnforge
+{
+	namespace plain
+	{
+		// Runs submitted jobs one by one in submission order on a dedicated thread.
+		// Jobs get sequential ids starting from 0, the jobs following the failed one are skipped
+		class plain_job_queue
+		{
+		public:
+			plain_job_queue();
+
+			// Waits for all the jobs submitted to complete
+			~plain_job_queue();
+
+			// Returns the id of the job
+			unsigned int submit(const boost::function<void ()>& job);
+
+			// Waits for job job_id and all the jobs submitted before it to complete, throws if any of them failed
+			void wait(unsigned int job_id);
+
+			// Waits for all the jobs submitted to complete, throws if any of them failed
+			void wait_all();
+
+			// Returns true if all the jobs submitted are completed
+			bool is_idle();
+
+		private:
+			void worker();
+
+			std::deque<boost::function<void ()> > job_list;
+			unsigned int submitted_count;
+			unsigned int completed_count;
+			bool stop_requested;
+			std::string error;
+
+			boost::mutex mtx;
+			boost::condition_variable job_submitted;
+			boost::condition_variable job_completed;
+			nnforge_shared_ptr<boost::thread> worker_thread;
+
+		private:
+			plain_job_queue(const plain_job_queue&);
+			plain_job_queue& operator =(const plain_job_queue&);
+		};
+
+		typedef nnforge_shared_ptr<plain_job_queue> plain_job_queue_smart_ptr;
+	}
+}
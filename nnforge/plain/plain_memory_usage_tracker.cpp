@@ -0,0 +1,81 @@
+/*
+ *  Copyright 2011-2014 Maxim Milakov
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include "plain_memory_usage_tracker.h"
+
+namespace nnforge
+{
+	namespace plain
+	{
+		const char * plain_memory_usage_tracker::activations_category = "activations";
+		const char * plain_memory_usage_tracker::additional_buffers_category = "additional_buffers";
+		const char * plain_memory_usage_tracker::gradients_category = "gradients";
+		const char * plain_memory_usage_tracker::input_staging_category = "input_staging";
+		const char * plain_memory_usage_tracker::weight_replicas_category = "weight_replicas";
+
+		additional_buffer_smart_ptr plain_memory_usage_tracker::track_buffer(
+			memory_usage_stat_smart_ptr stat,
+			additional_buffer_smart_ptr buffer,
+			const std::string& category)
+		{
+			if (!buffer)
+				return buffer;
+
+			return memory_usage_stat::track(stat, buffer, category, buffer->size() * sizeof(float));
+		}
+
+		additional_buffer_smart_ptr plain_memory_usage_tracker::track_tester_buffers(
+			memory_usage_stat_smart_ptr stat,
+			additional_buffer_set& additional_buffers,
+			additional_buffer_smart_ptr output_buffer)
+		{
+			additional_buffer_smart_ptr res = output_buffer;
+			for(additional_buffer_set::iterator it = additional_buffers.begin(); it != additional_buffers.end(); ++it)
+			{
+				bool is_output = (*it == output_buffer);
+				*it = track_buffer(stat, *it, is_output ? activations_category : additional_buffers_category);
+				if (is_output)
+					res = *it;
+			}
+
+			return res;
+		}
+
+		void plain_memory_usage_tracker::track_updater_buffers(
+			memory_usage_stat_smart_ptr stat,
+			updater_additional_buffer_set& buffers)
+		{
+			buffers.output_neurons_buffer = track_buffer(stat, buffers.output_neurons_buffer, activations_category);
+			buffers.input_errors_buffer = track_buffer(stat, buffers.input_errors_buffer, activations_category);
+			for(std::vector<additional_buffer_smart_ptr>::iterator it = buffers.additional_buffers.begin(); it != buffers.additional_buffers.end(); ++it)
+				*it = track_buffer(stat, *it, additional_buffers_category);
+		}
+
+		void plain_memory_usage_tracker::track_layer_data_list(
+			memory_usage_stat_smart_ptr stat,
+			layer_data_list& data_list,
+			const std::string& category)
+		{
+			for(layer_data_list::iterator it = data_list.begin(); it != data_list.end(); ++it)
+			{
+				size_t bytes = 0;
+				for(layer_data::const_iterator it2 = (*it)->begin(); it2 != (*it)->end(); ++it2)
+					bytes += it2->size() * sizeof(float);
+				*it = memory_usage_stat::track(stat, *it, category, bytes);
+			}
+		}
+	}
+}
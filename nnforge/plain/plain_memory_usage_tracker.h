@@ -0,0 +1,67 @@
+/*
+ *  Copyright 2011-2014 Maxim Milakov
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#pragma once
+
+#include "layer_tester_plain.h"
+#include "layer_updater_plain.h"
+
+#include "../memory_usage_stat.h"
+#include "../layer_data_list.h"
+
+#include <string>
+
+namespace nnforge
+{
+	namespace plain
+	{
+		// Wraps buffers so that they are accounted in memory_usage_stat while alive. All the methods do nothing if stat is empty
+		class plain_memory_usage_tracker
+		{
+		public:
+			static additional_buffer_smart_ptr track_buffer(
+				memory_usage_stat_smart_ptr stat,
+				additional_buffer_smart_ptr buffer,
+				const std::string& category);
+
+			// output_buffer is the one returned by layer tester for these additional buffers,
+			// it is accounted as activations if it is one of them. Returns tracked output buffer
+			static additional_buffer_smart_ptr track_tester_buffers(
+				memory_usage_stat_smart_ptr stat,
+				additional_buffer_set& additional_buffers,
+				additional_buffer_smart_ptr output_buffer);
+
+			// Output neurons and input errors are accounted as activations
+			static void track_updater_buffers(
+				memory_usage_stat_smart_ptr stat,
+				updater_additional_buffer_set& buffers);
+
+			static void track_layer_data_list(
+				memory_usage_stat_smart_ptr stat,
+				layer_data_list& data_list,
+				const std::string& category);
+
+			static const char * activations_category;
+			static const char * additional_buffers_category;
+			static const char * gradients_category;
+			static const char * input_staging_category;
+			static const char * weight_replicas_category;
+
+		private:
+			plain_memory_usage_tracker();
+		};
+	}
+}
@@ -16,6 +16,12 @@
 
 #include "plain_running_configuration.h"
 
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <boost/filesystem.hpp>
+#include <boost/format.hpp>
+
 #ifdef _OPENMP
 #include <omp.h>
 #endif
@@ -26,13 +32,137 @@ namespace nnforge
 	{
 		plain_running_configuration::plain_running_configuration(
 			int openmp_thread_count,
-			float max_memory_usage_gigabytes)
+			float max_memory_usage_gigabytes,
+			bool batch_size_autotune,
+			const std::string& batch_size_profile_file_path,
+			bool use_thread_pool,
+			const std::string& thread_affinity,
+			int numa_node_count,
+			float tester_chunk_cache_size_megabytes,
+			unsigned int training_stat_sample_period,
+			bool overlap_weight_update)
 			: openmp_thread_count(openmp_thread_count)
 			, max_memory_usage_gigabytes(max_memory_usage_gigabytes)
+			, tester_chunk_cache_size_megabytes(tester_chunk_cache_size_megabytes)
+			, training_stat_sample_period(training_stat_sample_period)
+			, overlap_weight_update(overlap_weight_update)
 		{
 			#ifndef _OPENMP
 			this->openmp_thread_count = 1;
 			#endif
+
+			if (batch_size_autotune)
+				autotuner = batch_size_autotuner_smart_ptr(new batch_size_autotuner(batch_size_profile_file_path));
+
+			core_list = plain_thread_pool::parse_core_list(thread_affinity);
+			if (use_thread_pool || !core_list.empty())
+			{
+				thread_pool = plain_thread_pool_smart_ptr(new plain_thread_pool(std::max(openmp_thread_count, 1), core_list));
+				this->openmp_thread_count = static_cast<int>(thread_pool->get_thread_count());
+			}
+
+			if (numa_node_count != 1)
+			{
+				std::vector<std::vector<unsigned int> > node_cpu_list = get_numa_node_cpu_list();
+				unsigned int shard_count = (numa_node_count > 0) ? static_cast<unsigned int>(numa_node_count) : static_cast<unsigned int>(node_cpu_list.size());
+				if (node_cpu_list.size() < shard_count)
+					std::cout << (boost::format("Warning: %1% NUMA shards requested while %2% NUMA nodes detected") % shard_count % node_cpu_list.size()) << std::endl;
+				if (shard_count > 1)
+				{
+					for(unsigned int i = 0; i < shard_count; ++i)
+						numa_shard_cpu_list.push_back(node_cpu_list.empty() ? std::vector<unsigned int>() : node_cpu_list[i % node_cpu_list.size()]);
+				}
+			}
+		}
+
+		plain_running_configuration::plain_running_configuration(
+			const plain_running_configuration& parent,
+			unsigned int part_id,
+			unsigned int part_count)
+			: max_memory_usage_gigabytes(parent.max_memory_usage_gigabytes / static_cast<float>(part_count))
+			, tester_chunk_cache_size_megabytes(parent.tester_chunk_cache_size_megabytes)
+			, training_stat_sample_period(parent.training_stat_sample_period)
+			, overlap_weight_update(parent.overlap_weight_update)
+			, autotuner(parent.autotuner)
+		{
+			// Threads or cores are split into contiguous ranges, parts share one if there are less of them than parts
+			unsigned int total_count = parent.core_list.empty() ? static_cast<unsigned int>(std::max(parent.openmp_thread_count, 1)) : static_cast<unsigned int>(parent.core_list.size());
+			unsigned int first = part_id * total_count / part_count;
+			unsigned int last = std::max((part_id + 1) * total_count / part_count, first + 1);
+			openmp_thread_count = static_cast<int>(last - first);
+
+			if (!parent.core_list.empty())
+			{
+				for(unsigned int i = first; i < last; ++i)
+					core_list.push_back(parent.core_list[i % parent.core_list.size()]);
+			}
+
+			// Parts are created on the thread which doesn't run them, so it should not be pinned, the workers are pinned instead
+			if (parent.thread_pool)
+			{
+				std::vector<std::vector<unsigned int> > cpu_set_list(openmp_thread_count);
+				for(unsigned int i = 0; i < core_list.size(); ++i)
+					cpu_set_list[i].push_back(core_list[i]);
+				thread_pool = plain_thread_pool_smart_ptr(new plain_thread_pool(cpu_set_list));
+			}
+
+			// Shards are split into contiguous ranges too, a single shard is not worth sharding within the part
+			if (!parent.numa_shard_cpu_list.empty())
+			{
+				unsigned int shard_count = static_cast<unsigned int>(parent.numa_shard_cpu_list.size());
+				unsigned int first_shard = part_id * shard_count / part_count;
+				unsigned int last_shard = (part_id + 1) * shard_count / part_count;
+				if (last_shard - first_shard > 1)
+					numa_shard_cpu_list.assign(parent.numa_shard_cpu_list.begin() + first_shard, parent.numa_shard_cpu_list.begin() + last_shard);
+				if ((part_id == 0) && (shard_count < part_count * 2))
+					std::cout << (boost::format("Warning: %1% NUMA shards split into %2% parts, parts with less than 2 shards don't shard the work") % shard_count % part_count) << std::endl;
+			}
+		}
+
+		std::vector<std::vector<unsigned int> > plain_running_configuration::get_numa_node_cpu_list()
+		{
+			std::vector<std::vector<unsigned int> > res;
+
+			boost::filesystem::path node_dir = "/sys/devices/system/node";
+			for(unsigned int node_id = 0; ; ++node_id)
+			{
+				boost::filesystem::path cpu_list_file_path = node_dir / (boost::format("node%1%") % node_id).str() / "cpulist";
+				if (!boost::filesystem::exists(cpu_list_file_path))
+					break;
+
+				std::ifstream in(cpu_list_file_path.string().c_str());
+				std::string cpu_list_str;
+				std::getline(in, cpu_list_str);
+				std::vector<unsigned int> cpu_list = plain_thread_pool::parse_core_list(cpu_list_str);
+
+				// Memory-only nodes have no cores
+				if (!cpu_list.empty())
+					res.push_back(cpu_list);
+			}
+
+			return res;
+		}
+
+		void plain_running_configuration::run_parallel(
+			int workload_count,
+			plain_thread_pool::task& t) const
+		{
+			if (thread_pool)
+			{
+				thread_pool->run(workload_count, t);
+				return;
+			}
+
+			// Tasks set up their scratch buffers once per tile, so tiles are contiguous ranges, a few per thread for balancing
+			int tile_count = std::min(workload_count, std::max(openmp_thread_count, 1) * plain_thread_pool::tiles_per_thread);
+			int tile_size = (tile_count > 0) ? (workload_count + tile_count - 1) / tile_count : 1;
+			#pragma omp parallel for default(none) schedule(dynamic) num_threads(openmp_thread_count) shared(t,workload_count,tile_count,tile_size)
+			for(int tile_id = 0; tile_id < tile_count; ++tile_id)
+			{
+				int start_workload_id = tile_id * tile_size;
+				if (start_workload_id < workload_count)
+					t.run_tile(start_workload_id, std::min(start_workload_id + tile_size, workload_count));
+			}
 		}
 
 		unsigned int plain_running_configuration::get_max_entry_count(
@@ -45,6 +175,17 @@ namespace nnforge
 			return static_cast<unsigned int>(entry_count_limited_by_global);
 		}
 
+		unsigned int plain_running_configuration::get_cache_entry_count(const buffer_plain_size_configuration& buffers_config) const
+		{
+			if (tester_chunk_cache_size_megabytes <= 0.0F)
+				return 0;
+
+			size_t cache_size = static_cast<size_t>(tester_chunk_cache_size_megabytes * static_cast<float>(1 << 20));
+			size_t entry_count = cache_size / std::max<size_t>(buffers_config.per_entry_buffer_size, 1);
+
+			return static_cast<unsigned int>(std::max<size_t>(entry_count, 1));
+		}
+
 		std::ostream& operator<< (std::ostream& out, const plain_running_configuration& running_configuration)
 		{
 			out << "--- Configuration ---" << std::endl;
@@ -58,6 +199,24 @@ namespace nnforge
 
 			out << "Max memory usage = " << running_configuration.max_memory_usage_gigabytes << " GB" << std::endl;
 			out << "OpenMP thread count = " << running_configuration.openmp_thread_count << std::endl;
+			if (running_configuration.tester_chunk_cache_size_megabytes > 0.0F)
+				out << "Tester chunk cache size = " << running_configuration.tester_chunk_cache_size_megabytes << " MB" << std::endl;
+			else
+				out << "Tester chunking = off" << std::endl;
+			out << "Batch size autotuning = " << (running_configuration.autotuner ? "on" : "off") << std::endl;
+			if (running_configuration.thread_pool)
+				out << "Thread pool = " << running_configuration.thread_pool->get_thread_count() << " threads" << std::endl;
+			else
+				out << "Thread pool = off" << std::endl;
+			if (!running_configuration.numa_shard_cpu_list.empty())
+				out << "NUMA shards = " << running_configuration.numa_shard_cpu_list.size() << std::endl;
+			else
+				out << "NUMA sharding = off" << std::endl;
+			if (running_configuration.training_stat_sample_period > 0)
+				out << "Training stat sample period = " << running_configuration.training_stat_sample_period << std::endl;
+			else
+				out << "Training stat sample period = epoch end" << std::endl;
+			out << "Weight update overlap = " << (running_configuration.overlap_weight_update ? "on" : "off") << std::endl;
 
 			return out;
 		}
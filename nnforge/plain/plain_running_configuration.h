@@ -17,8 +17,12 @@
 #pragma once
 
 #include <ostream>
+#include <string>
+#include <vector>
 
 #include "buffer_plain_size_configuration.h"
+#include "batch_size_autotuner.h"
+#include "plain_thread_pool.h"
 
 #include "../nn_types.h"
 
@@ -31,15 +35,66 @@ namespace nnforge
 		public:
 			plain_running_configuration(
 				int openmp_thread_count,
-				float max_memory_usage_gigabytes);
+				float max_memory_usage_gigabytes,
+				bool batch_size_autotune = false,
+				const std::string& batch_size_profile_file_path = std::string(),
+				bool use_thread_pool = false,
+				const std::string& thread_affinity = std::string(),
+				int numa_node_count = 1,
+				float tester_chunk_cache_size_megabytes = 0.0F,
+				unsigned int training_stat_sample_period = 1,
+				bool overlap_weight_update = false);
+
+			// Configuration for part part_id of part_count equal parts of the parent's threads, cores, memory and NUMA shards.
+			// The part shares the autotuner and overlaps weight update if the parent does, it doesn't shard the work when it gets less than 2 shards
+			plain_running_configuration(
+				const plain_running_configuration& parent,
+				unsigned int part_id,
+				unsigned int part_count);
 
 			unsigned int get_max_entry_count(
 				const buffer_plain_size_configuration& buffers_config,
 				float ratio = 1.0F) const;
 
+			// Returns entry count such that per-entry buffers fit into tester chunk cache size, 0 if tester chunking is off
+			unsigned int get_cache_entry_count(const buffer_plain_size_configuration& buffers_config) const;
+
+			// Runs t for workload items [0, workload_count) on the thread pool if it is enabled, with OpenMP otherwise.
+			// Either way t gets contiguous tiles of workload items, a few per thread
+			void run_parallel(
+				int workload_count,
+				plain_thread_pool::task& t) const;
+
+			// Returns cpu lists of NUMA nodes, empty if topology is not available
+			static std::vector<std::vector<unsigned int> > get_numa_node_cpu_list();
+
 			float max_memory_usage_gigabytes;
 			int openmp_thread_count;
 
+			// Tester streams chunks of entries of this size through all the layers, 0 means all the entries read are processed at once
+			float tester_chunk_cache_size_megabytes;
+
+			// Updater collects absolute update statistics on every training_stat_sample_period-th gradient application,
+			// 0 means on the last gradient application of the epoch only
+			unsigned int training_stat_sample_period;
+
+			// Updater computes weight gradient of a layer on half of the threads while backprop of preceding layers runs on the other half
+			bool overlap_weight_update;
+
+			// Empty if batch sizes are not autotuned
+			batch_size_autotuner_smart_ptr autotuner;
+
+			// Empty if kernels run in OpenMP parallel regions. Only convolution kernels and gradient application run on the pool,
+			// the rest of the layers use OpenMP regardless, and OpenMP threads spinning after their regions compete with the pool for cores
+			plain_thread_pool_smart_ptr thread_pool;
+
+			// Cores thread pool workers are pinned to, empty if they are not pinned
+			std::vector<unsigned int> core_list;
+
+			// Cores of each shard the updater splits the work between, empty if updater doesn't shard the work.
+			// The cpu set of a shard is empty when NUMA topology is not available
+			std::vector<std::vector<unsigned int> > numa_shard_cpu_list;
+
 		private:
 			plain_running_configuration();
 			plain_running_configuration(const plain_running_configuration&);
@@ -0,0 +1,326 @@
+/*
+ *  Copyright 2011-2014 Maxim Milakov
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include "plain_thread_pool.h"
+
+#include "../neural_network_exception.h"
+
+#include <algorithm>
+#include <sstream>
+#include <iostream>
+#include <boost/bind.hpp>
+#include <boost/format.hpp>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace nnforge
+{
+	namespace plain
+	{
+		const int plain_thread_pool::tiles_per_thread = 8;
+
+		plain_thread_pool::task::~task()
+		{
+		}
+
+		plain_thread_pool::plain_thread_pool(
+			unsigned int thread_count,
+			const std::vector<unsigned int>& core_list)
+			: thread_count(core_list.empty() ? std::max(thread_count, 1U) : static_cast<unsigned int>(core_list.size()))
+			, caller_participates(core_list.empty())
+			, current_task(0)
+			, tile_size(1)
+			, steal_enabled(true)
+			, generation(0)
+			, busy_thread_count(0)
+			, stop_requested(false)
+		{
+			for(unsigned int i = 0; i < this->thread_count; ++i)
+			{
+				std::vector<unsigned int> cpu_set;
+				if (!core_list.empty())
+					cpu_set.push_back(core_list[i]);
+				cpu_set_list.push_back(cpu_set);
+				range_list.push_back(nnforge_shared_ptr<workload_range>(new workload_range()));
+			}
+
+			// The calling thread serves as thread 0 only when threads are not pinned,
+			// pinning it would restrict OpenMP regions and threads it creates later to a single core
+			for(unsigned int i = (caller_participates ? 1 : 0); i < this->thread_count; ++i)
+				thread_list.push_back(nnforge_shared_ptr<boost::thread>(new boost::thread(boost::bind(&plain_thread_pool::worker, this, i))));
+		}
+
+		plain_thread_pool::plain_thread_pool(const std::vector<std::vector<unsigned int> >& cpu_set_list)
+			: thread_count(static_cast<unsigned int>(cpu_set_list.size()))
+			, cpu_set_list(cpu_set_list)
+			, caller_participates(false)
+			, current_task(0)
+			, tile_size(1)
+			, steal_enabled(true)
+			, generation(0)
+			, busy_thread_count(0)
+			, stop_requested(false)
+		{
+			if (cpu_set_list.empty())
+				throw neural_network_exception("Thread pool cannot be created with empty list of cpu sets");
+
+			for(unsigned int i = 0; i < thread_count; ++i)
+				range_list.push_back(nnforge_shared_ptr<workload_range>(new workload_range()));
+
+			for(unsigned int i = 0; i < thread_count; ++i)
+				thread_list.push_back(nnforge_shared_ptr<boost::thread>(new boost::thread(boost::bind(&plain_thread_pool::worker, this, i))));
+		}
+
+		plain_thread_pool::~plain_thread_pool()
+		{
+			{
+				boost::lock_guard<boost::mutex> lock(run_mtx);
+				stop_requested = true;
+			}
+			run_started.notify_all();
+
+			for(std::vector<nnforge_shared_ptr<boost::thread> >::iterator it = thread_list.begin(); it != thread_list.end(); ++it)
+				(*it)->join();
+		}
+
+		void plain_thread_pool::run(
+			int workload_count,
+			task& t)
+		{
+			if (workload_count <= 0)
+				return;
+
+			if ((thread_count == 1) && caller_participates)
+			{
+				t.run_tile(0, workload_count);
+				return;
+			}
+
+			execute(workload_count, t, false);
+		}
+
+		void plain_thread_pool::run_per_thread(const boost::function<void (unsigned int)>& f)
+		{
+			function_task t(f);
+			execute(static_cast<int>(thread_count), t, true);
+		}
+
+		void plain_thread_pool::execute(
+			int workload_count,
+			task& t,
+			bool per_thread)
+		{
+			{
+				boost::lock_guard<boost::mutex> lock(run_mtx);
+
+				int workload_count_per_thread = per_thread ? 1 : (workload_count + static_cast<int>(thread_count) - 1) / static_cast<int>(thread_count);
+				for(unsigned int i = 0; i < thread_count; ++i)
+				{
+					range_list[i]->start = std::min(static_cast<int>(i) * workload_count_per_thread, workload_count);
+					range_list[i]->end = std::min(range_list[i]->start + workload_count_per_thread, workload_count);
+				}
+				tile_size = std::max(workload_count_per_thread / tiles_per_thread, 1);
+				steal_enabled = !per_thread;
+
+				current_task = &t;
+				error.clear();
+				busy_thread_count = caller_participates ? thread_count - 1 : thread_count;
+				++generation;
+			}
+			run_started.notify_all();
+
+			std::string own_error;
+			if (caller_participates)
+			{
+				try
+				{
+					process(0);
+				}
+				catch (const std::exception& e)
+				{
+					own_error = e.what();
+				}
+			}
+
+			{
+				boost::unique_lock<boost::mutex> lock(run_mtx);
+				while (busy_thread_count > 0)
+					run_finished.wait(lock);
+				current_task = 0;
+				if (own_error.empty())
+					own_error = error;
+			}
+
+			if (!own_error.empty())
+				throw neural_network_exception(own_error);
+		}
+
+		unsigned int plain_thread_pool::get_thread_count() const
+		{
+			return thread_count;
+		}
+
+		void plain_thread_pool::worker(unsigned int thread_id)
+		{
+			try_pin_current_thread(cpu_set_list[thread_id]);
+
+			unsigned int processed_generation = 0;
+			while (true)
+			{
+				{
+					boost::unique_lock<boost::mutex> lock(run_mtx);
+					while ((!stop_requested) && (generation == processed_generation))
+						run_started.wait(lock);
+					if (stop_requested)
+						return;
+					processed_generation = generation;
+				}
+
+				std::string own_error;
+				try
+				{
+					process(thread_id);
+				}
+				catch (const std::exception& e)
+				{
+					own_error = e.what();
+				}
+
+				{
+					boost::lock_guard<boost::mutex> lock(run_mtx);
+					if (error.empty())
+						error = own_error;
+					--busy_thread_count;
+					if (busy_thread_count == 0)
+						run_finished.notify_one();
+				}
+			}
+		}
+
+		void plain_thread_pool::process(unsigned int thread_id)
+		{
+			int start;
+			int end;
+			while (take_own_tile(thread_id, start, end))
+				current_task->run_tile(start, end);
+			if (steal_enabled)
+			{
+				while (steal_tile(thread_id, start, end))
+					current_task->run_tile(start, end);
+			}
+		}
+
+		bool plain_thread_pool::take_own_tile(
+			unsigned int thread_id,
+			int& start,
+			int& end)
+		{
+			workload_range& range = *range_list[thread_id];
+			boost::lock_guard<boost::mutex> lock(range.mtx);
+			if (range.start >= range.end)
+				return false;
+
+			start = range.start;
+			end = std::min(range.start + tile_size, range.end);
+			range.start = end;
+
+			return true;
+		}
+
+		bool plain_thread_pool::steal_tile(
+			unsigned int thread_id,
+			int& start,
+			int& end)
+		{
+			for(unsigned int i = 1; i < thread_count; ++i)
+			{
+				workload_range& range = *range_list[(thread_id + i) % thread_count];
+				boost::lock_guard<boost::mutex> lock(range.mtx);
+				if (range.start >= range.end)
+					continue;
+
+				// Take the tail so that the owner keeps processing its range sequentially
+				end = range.end;
+				start = std::max(range.end - tile_size, range.start);
+				range.end = start;
+
+				return true;
+			}
+
+			return false;
+		}
+
+		void plain_thread_pool::try_pin_current_thread(const std::vector<unsigned int>& cpu_set)
+		{
+			if (cpu_set.empty())
+				return;
+
+			#ifdef __linux__
+			cpu_set_t cpuset;
+			CPU_ZERO(&cpuset);
+			for(std::vector<unsigned int>::const_iterator it = cpu_set.begin(); it != cpu_set.end(); ++it)
+				CPU_SET(*it, &cpuset);
+			int res = pthread_setaffinity_np(pthread_self(), sizeof(cpuset), &cpuset);
+			if (res != 0)
+				std::cout << (boost::format("Warning: Unable to pin thread to %1% core(s) starting from core %2%, error %3%") % cpu_set.size() % cpu_set.front() % res) << std::endl;
+			#endif
+		}
+
+		plain_thread_pool::function_task::function_task(const boost::function<void (unsigned int)>& f)
+			: f(f)
+		{
+		}
+
+		void plain_thread_pool::function_task::run_tile(
+			int start_workload_id,
+			int end_workload_id)
+		{
+			for(int workload_id = start_workload_id; workload_id < end_workload_id; ++workload_id)
+				f(static_cast<unsigned int>(workload_id));
+		}
+
+		std::vector<unsigned int> plain_thread_pool::parse_core_list(const std::string& core_list_str)
+		{
+			std::vector<unsigned int> res;
+
+			std::istringstream in(core_list_str);
+			std::string item;
+			while (std::getline(in, item, ','))
+			{
+				if (item.empty())
+					continue;
+
+				unsigned int first_core_id;
+				unsigned int last_core_id;
+				char dash;
+				std::istringstream item_in(item);
+				if (!(item_in >> first_core_id))
+					throw neural_network_exception((boost::format("Invalid core list: %1%") % core_list_str).str());
+				last_core_id = first_core_id;
+				if ((item_in >> dash) && ((dash != '-') || !(item_in >> last_core_id) || (last_core_id < first_core_id)))
+					throw neural_network_exception((boost::format("Invalid core list: %1%") % core_list_str).str());
+
+				for(unsigned int core_id = first_core_id; core_id <= last_core_id; ++core_id)
+					res.push_back(core_id);
+			}
+
+			return res;
+		}
+	}
+}
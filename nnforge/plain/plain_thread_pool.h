@@ -0,0 +1,147 @@
+/*
+ *  Copyright 2011-2014 Maxim Milakov
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#pragma once
+
+#include "../nn_types.h"
+
+#include <vector>
+#include <string>
+#include <boost/thread/thread.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/condition_variable.hpp>
+#include <boost/function.hpp>
+
+namespace nnforge
+{
+	namespace plain
+	{
+		// Persistent worker threads, optionally pinned to cores.
+		// The workload range of each run is split evenly between threads, idle threads steal tiles from the busy ones.
+		class plain_thread_pool
+		{
+		public:
+			class task
+			{
+			public:
+				virtual ~task();
+
+				// Process workload items [start_workload_id, end_workload_id)
+				virtual void run_tile(
+					int start_workload_id,
+					int end_workload_id) = 0;
+			};
+
+			// Threads are pinned to the cores from core_list if it is not empty, its size then overrides thread_count.
+			// The calling thread participates in the work only if threads are not pinned, it is never pinned itself
+			plain_thread_pool(
+				unsigned int thread_count,
+				const std::vector<unsigned int>& core_list);
+
+			// Thread i is pinned to all the cores from cpu_set_list[i], not pinned if the set is empty.
+			// The calling thread doesn't participate in the work, it only waits for the workers
+			explicit plain_thread_pool(const std::vector<std::vector<unsigned int> >& cpu_set_list);
+
+			~plain_thread_pool();
+
+			// The calling thread participates in the work unless threads are pinned. Not reentrant
+			void run(
+				int workload_count,
+				task& t);
+
+			// Thread i calls f(i), no work stealing. Not reentrant
+			void run_per_thread(const boost::function<void (unsigned int)>& f);
+
+			unsigned int get_thread_count() const;
+
+			// Parses comma separated list of cores, like "0,1,2,3"
+			static std::vector<unsigned int> parse_core_list(const std::string& core_list_str);
+
+			// Number of tiles each thread's range is split into
+			static const int tiles_per_thread;
+
+		private:
+			struct workload_range
+			{
+				boost::mutex mtx;
+				int start;
+				int end;
+			};
+
+			class function_task : public task
+			{
+			public:
+				function_task(const boost::function<void (unsigned int)>& f);
+
+				virtual void run_tile(
+					int start_workload_id,
+					int end_workload_id);
+
+			private:
+				const boost::function<void (unsigned int)>& f;
+
+			private:
+				function_task& operator =(const function_task&);
+			};
+
+			void execute(
+				int workload_count,
+				task& t,
+				bool per_thread);
+
+			void worker(unsigned int thread_id);
+
+			void process(unsigned int thread_id);
+
+			bool take_own_tile(
+				unsigned int thread_id,
+				int& start,
+				int& end);
+
+			bool steal_tile(
+				unsigned int thread_id,
+				int& start,
+				int& end);
+
+			// Prints warning if pinning fails, does nothing for empty cpu_set
+			static void try_pin_current_thread(const std::vector<unsigned int>& cpu_set);
+
+			unsigned int thread_count;
+			std::vector<std::vector<unsigned int> > cpu_set_list;
+			bool caller_participates;
+
+			std::vector<nnforge_shared_ptr<workload_range> > range_list;
+			std::vector<nnforge_shared_ptr<boost::thread> > thread_list;
+
+			boost::mutex run_mtx;
+			boost::condition_variable run_started;
+			boost::condition_variable run_finished;
+			task * current_task;
+			int tile_size;
+			bool steal_enabled;
+			unsigned int generation;
+			unsigned int busy_thread_count;
+			bool stop_requested;
+			std::string error;
+
+		private:
+			plain_thread_pool(const plain_thread_pool&);
+			plain_thread_pool& operator =(const plain_thread_pool&);
+		};
+
+		typedef nnforge_shared_ptr<plain_thread_pool> plain_thread_pool_smart_ptr;
+	}
+}
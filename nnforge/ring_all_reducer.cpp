@@ -0,0 +1,201 @@
+/*
+ *  Copyright 2011-2014 Maxim Milakov
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include "ring_all_reducer.h"
+
+#include "neural_network_exception.h"
+
+#include <algorithm>
+#include <functional>
+#include <boost/bind.hpp>
+#include <boost/ref.hpp>
+#include <boost/format.hpp>
+#include <boost/chrono.hpp>
+
+namespace nnforge
+{
+	ring_all_reducer::ring_all_reducer(
+		const std::string& endpoint,
+		unsigned int worker_id,
+		unsigned int worker_count,
+		float connect_timeout_seconds)
+		: worker_id(worker_id)
+		, worker_count(worker_count)
+		, endpoint(endpoint, worker_count)
+		, next_socket(io_service)
+		, prev_socket(io_service)
+		, communication_seconds(0.0)
+	{
+		if (worker_id >= worker_count)
+			throw neural_network_exception((boost::format("Invalid worker %1% of %2%") % worker_id % worker_count).str());
+
+		if (worker_count > 1)
+			connect(connect_timeout_seconds);
+	}
+
+	ring_all_reducer::~ring_all_reducer()
+	{
+	}
+
+	void ring_all_reducer::connect(float connect_timeout_seconds)
+	{
+		boost::asio::basic_socket_acceptor<socket_endpoint::protocol> acceptor(io_service);
+		endpoint.listen(acceptor, worker_id);
+
+		// The next worker might not have started listening yet
+		endpoint.connect(next_socket, (worker_id + 1) % worker_count, connect_timeout_seconds);
+
+		acceptor.accept(prev_socket);
+		acceptor.close();
+		endpoint.unlink(worker_id);
+		endpoint.set_options(prev_socket);
+
+		// Check the ring is assembled as expected
+		unsigned int own_header[2] = {worker_id, worker_count};
+		unsigned int prev_header[2];
+		boost::asio::write(next_socket, boost::asio::buffer(own_header, sizeof(own_header)));
+		boost::asio::read(prev_socket, boost::asio::buffer(prev_header, sizeof(prev_header)));
+		if ((prev_header[0] != (worker_id + worker_count - 1) % worker_count) || (prev_header[1] != worker_count))
+			throw neural_network_exception((boost::format("Worker %1% of %2% connected instead of worker %3% of %4%") % prev_header[0] % prev_header[1] % ((worker_id + worker_count - 1) % worker_count) % worker_count).str());
+	}
+
+	void ring_all_reducer::all_reduce(std::vector<float>& buf)
+	{
+		if ((worker_count == 1) || buf.empty())
+			return;
+
+		boost::chrono::steady_clock::time_point start = boost::chrono::steady_clock::now();
+
+		recv_buf.resize(get_chunk_start(buf.size(), 1) + 1);
+
+		// Reduce-scatter, worker ends up with the sum of chunk worker_id + 1
+		for(unsigned int step = 0; step < worker_count - 1; ++step)
+		{
+			unsigned int send_chunk_id = (worker_id + worker_count - step) % worker_count;
+			unsigned int recv_chunk_id = (worker_id + worker_count - step - 1) % worker_count;
+			exchange(buf, send_chunk_id, recv_chunk_id);
+
+			std::vector<float>::iterator dst_it = buf.begin() + get_chunk_start(buf.size(), recv_chunk_id);
+			std::vector<float>::iterator dst_it_end = buf.begin() + get_chunk_start(buf.size(), recv_chunk_id + 1);
+			std::transform(dst_it, dst_it_end, recv_buf.begin(), dst_it, std::plus<float>());
+		}
+
+		// All-gather, sums are copied, so they are the same on all the workers
+		for(unsigned int step = 0; step < worker_count - 1; ++step)
+		{
+			unsigned int send_chunk_id = (worker_id + 1 + worker_count - step) % worker_count;
+			unsigned int recv_chunk_id = (worker_id + worker_count - step) % worker_count;
+			exchange(buf, send_chunk_id, recv_chunk_id);
+
+			size_t recv_start = get_chunk_start(buf.size(), recv_chunk_id);
+			std::copy(recv_buf.begin(), recv_buf.begin() + (get_chunk_start(buf.size(), recv_chunk_id + 1) - recv_start), buf.begin() + recv_start);
+		}
+
+		boost::chrono::duration<double> sec = boost::chrono::steady_clock::now() - start;
+		communication_seconds += sec.count();
+	}
+
+	void ring_all_reducer::all_reduce(layer_data_list& data)
+	{
+		staging_buf.clear();
+		for(layer_data_list::const_iterator it = data.begin(); it != data.end(); ++it)
+			for(layer_data::const_iterator it2 = (*it)->begin(); it2 != (*it)->end(); ++it2)
+				staging_buf.insert(staging_buf.end(), it2->begin(), it2->end());
+
+		all_reduce(staging_buf);
+
+		std::vector<float>::const_iterator src_it = staging_buf.begin();
+		for(layer_data_list::iterator it = data.begin(); it != data.end(); ++it)
+		{
+			for(layer_data::iterator it2 = (*it)->begin(); it2 != (*it)->end(); ++it2)
+			{
+				std::copy(src_it, src_it + it2->size(), it2->begin());
+				src_it += it2->size();
+			}
+		}
+	}
+
+	void ring_all_reducer::broadcast(layer_data_list& data)
+	{
+		if (worker_id != 0)
+			data.fill(0.0F);
+
+		all_reduce(data);
+	}
+
+	void ring_all_reducer::exchange(
+		const std::vector<float>& buf,
+		unsigned int send_chunk_id,
+		unsigned int recv_chunk_id)
+	{
+		size_t send_start = get_chunk_start(buf.size(), send_chunk_id);
+		size_t send_elem_count = get_chunk_start(buf.size(), send_chunk_id + 1) - send_start;
+		size_t recv_elem_count = get_chunk_start(buf.size(), recv_chunk_id + 1) - get_chunk_start(buf.size(), recv_chunk_id);
+
+		// Both transfers run at once, otherwise all the workers could block sending chunks not fitting into socket buffers
+		boost::system::error_code write_ec;
+		boost::system::error_code read_ec;
+		boost::asio::async_write(
+			next_socket,
+			boost::asio::buffer(&(*buf.begin()) + send_start, send_elem_count * sizeof(float)),
+			boost::bind(&ring_all_reducer::on_transfer_completed, boost::ref(write_ec), boost::asio::placeholders::error));
+		boost::asio::async_read(
+			prev_socket,
+			boost::asio::buffer(&(*recv_buf.begin()), recv_elem_count * sizeof(float)),
+			boost::bind(&ring_all_reducer::on_transfer_completed, boost::ref(read_ec), boost::asio::placeholders::error));
+		io_service.run();
+		io_service.reset();
+
+		if (write_ec)
+			throw neural_network_exception((boost::format("Error sending data to worker %1%: %2%") % ((worker_id + 1) % worker_count) % write_ec.message()).str());
+		if (read_ec)
+			throw neural_network_exception((boost::format("Error receiving data from worker %1%: %2%") % ((worker_id + worker_count - 1) % worker_count) % read_ec.message()).str());
+	}
+
+	void ring_all_reducer::on_transfer_completed(
+		boost::system::error_code& res,
+		const boost::system::error_code& ec)
+	{
+		res = ec;
+	}
+
+	size_t ring_all_reducer::get_chunk_start(
+		size_t elem_count,
+		unsigned int chunk_id) const
+	{
+		return elem_count * chunk_id / worker_count;
+	}
+
+	unsigned int ring_all_reducer::get_worker_id() const
+	{
+		return worker_id;
+	}
+
+	unsigned int ring_all_reducer::get_worker_count() const
+	{
+		return worker_count;
+	}
+
+	double ring_all_reducer::get_communication_seconds() const
+	{
+		return communication_seconds;
+	}
+
+	void ring_all_reducer::reset_communication_seconds()
+	{
+		communication_seconds = 0.0;
+	}
+}
@@ -0,0 +1,99 @@
+/*
+ *  Copyright 2011-2014 Maxim Milakov
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#pragma once
+
+#include "layer_data_list.h"
+#include "socket_endpoint.h"
+#include "nn_types.h"
+
+#include <vector>
+#include <string>
+#include <boost/asio.hpp>
+
+namespace nnforge
+{
+	// Sums buffers of worker processes with ring all-reduce: reduce-scatter followed by all-gather,
+	// each worker sends to the next worker in the ring and receives from the previous one.
+	// The result is bitwise identical on all the workers. All the workers should have the same float representation
+	class ring_all_reducer
+	{
+	public:
+		// endpoint is either tcp:<host>:<base_port>, worker i listens on port base_port + i,
+		// or unix:<path_prefix>, worker i listens on the socket <path_prefix>i.
+		// Blocks until the ring is connected, waiting for the next worker to start for connect_timeout_seconds at most
+		ring_all_reducer(
+			const std::string& endpoint,
+			unsigned int worker_id,
+			unsigned int worker_count,
+			float connect_timeout_seconds = 60.0F);
+
+		~ring_all_reducer();
+
+		// Sums buf of all the workers in place
+		void all_reduce(std::vector<float>& buf);
+
+		// Sums the data of all the workers in place
+		void all_reduce(layer_data_list& data);
+
+		// Copies the data of worker 0 to all the workers
+		void broadcast(layer_data_list& data);
+
+		unsigned int get_worker_id() const;
+
+		unsigned int get_worker_count() const;
+
+		// Time spent in all-reduce since the last reset, including waiting for the other workers
+		double get_communication_seconds() const;
+
+		void reset_communication_seconds();
+
+	protected:
+		void connect(float connect_timeout_seconds);
+
+		// Sends chunk send_chunk_id to the next worker while receiving chunk recv_chunk_id from the previous one into recv_buf
+		void exchange(
+			const std::vector<float>& buf,
+			unsigned int send_chunk_id,
+			unsigned int recv_chunk_id);
+
+		size_t get_chunk_start(
+			size_t elem_count,
+			unsigned int chunk_id) const;
+
+		static void on_transfer_completed(
+			boost::system::error_code& res,
+			const boost::system::error_code& ec);
+
+		unsigned int worker_id;
+		unsigned int worker_count;
+		socket_endpoint endpoint;
+
+		boost::asio::io_service io_service;
+		boost::asio::generic::stream_protocol::socket next_socket;
+		boost::asio::generic::stream_protocol::socket prev_socket;
+
+		std::vector<float> recv_buf;
+		std::vector<float> staging_buf;
+		double communication_seconds;
+
+	private:
+		ring_all_reducer(const ring_all_reducer&);
+		ring_all_reducer& operator =(const ring_all_reducer&);
+	};
+
+	typedef nnforge_shared_ptr<ring_all_reducer> ring_all_reducer_smart_ptr;
+}
@@ -117,4 +117,11 @@ namespace nnforge
 	{
 		return false;
 	}
+
+	nnforge_shared_ptr<data_transformer> rotate_band_data_transformer::clone(unsigned int seed) const
+	{
+		nnforge_shared_ptr<rotate_band_data_transformer> res(new rotate_band_data_transformer(*this));
+		res->generator = rnd::get_random_generator(seed);
+		return res;
+	}
 }
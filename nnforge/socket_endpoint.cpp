@@ -0,0 +1,134 @@
+/*
+ *  Copyright 2011-2014 Maxim Milakov
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+
+#include "socket_endpoint.h"
+
+#include "neural_network_exception.h"
+
+#include <cstdio>
+#include <sstream>
+#include <boost/format.hpp>
+#include <boost/chrono.hpp>
+#include <boost/thread/thread.hpp>
+
+namespace nnforge
+{
+	socket_endpoint::socket_endpoint(
+		const std::string& endpoint,
+		unsigned int process_count)
+		: local(false)
+		, base_port(0)
+	{
+		if (endpoint.compare(0, 4, "tcp:") == 0)
+		{
+			std::string host_and_port = endpoint.substr(4);
+			std::string::size_type pos = host_and_port.rfind(':');
+			std::istringstream port_in(pos == std::string::npos ? std::string() : host_and_port.substr(pos + 1));
+			unsigned int port;
+			if (!(port_in >> port) || (port + process_count > 65536))
+				throw neural_network_exception((boost::format("Invalid TCP endpoint: %1%") % endpoint).str());
+			host = host_and_port.substr(0, pos);
+			base_port = static_cast<unsigned short>(port);
+		}
+		else if (endpoint.compare(0, 5, "unix:") == 0)
+		{
+			#ifndef BOOST_ASIO_HAS_LOCAL_SOCKETS
+			throw neural_network_exception("Unix domain sockets are not supported on this platform");
+			#endif
+			local = true;
+			path_prefix = endpoint.substr(5);
+		}
+		else
+			throw neural_network_exception((boost::format("Unknown endpoint: %1%, tcp:<host>:<base_port> or unix:<path_prefix> expected") % endpoint).str());
+	}
+
+	socket_endpoint::protocol::endpoint socket_endpoint::get_endpoint(unsigned int process_id) const
+	{
+		if (local)
+		{
+			#ifdef BOOST_ASIO_HAS_LOCAL_SOCKETS
+			return protocol::endpoint(boost::asio::local::stream_protocol::endpoint(get_path(process_id)));
+			#endif
+		}
+
+		boost::asio::io_service resolver_service;
+		boost::asio::ip::tcp::resolver resolver(resolver_service);
+		boost::asio::ip::tcp::resolver::query query(host, (boost::format("%1%") % (base_port + process_id)).str());
+		return protocol::endpoint(resolver.resolve(query)->endpoint());
+	}
+
+	void socket_endpoint::listen(
+		boost::asio::basic_socket_acceptor<protocol>& acceptor,
+		unsigned int process_id) const
+	{
+		protocol::endpoint own_endpoint = get_endpoint(process_id);
+		unlink(process_id);
+
+		acceptor.open(own_endpoint.protocol());
+		if (!local)
+			acceptor.set_option(boost::asio::socket_base::reuse_address(true));
+		acceptor.bind(own_endpoint);
+		acceptor.listen();
+	}
+
+	void socket_endpoint::unlink(unsigned int process_id) const
+	{
+		if (local)
+			std::remove(get_path(process_id).c_str());
+	}
+
+	void socket_endpoint::connect(
+		protocol::socket& socket,
+		unsigned int process_id,
+		float connect_timeout_seconds) const
+	{
+		protocol::endpoint remote_endpoint = get_endpoint(process_id);
+		boost::chrono::steady_clock::time_point start = boost::chrono::steady_clock::now();
+		while (true)
+		{
+			boost::system::error_code ec;
+			socket.open(remote_endpoint.protocol());
+			socket.connect(remote_endpoint, ec);
+			if (!ec)
+				break;
+			socket.close();
+
+			boost::chrono::duration<float> sec = boost::chrono::steady_clock::now() - start;
+			if (sec.count() > connect_timeout_seconds)
+				throw neural_network_exception((boost::format("Unable to connect to process %1%: %2%") % process_id % ec.message()).str());
+			boost::this_thread::sleep_for(boost::chrono::milliseconds(100));
+		}
+
+		set_options(socket);
+	}
+
+	void socket_endpoint::set_options(protocol::socket& socket) const
+	{
+		if (!local)
+			socket.set_option(boost::asio::ip::tcp::no_delay(true));
+	}
+
+	bool socket_endpoint::is_local() const
+	{
+		return local;
+	}
+
+	std::string socket_endpoint::get_path(unsigned int process_id) const
+	{
+		return (boost::format("%1%%2%") % path_prefix % process_id).str();
+	}
+}
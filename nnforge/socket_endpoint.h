@@ -0,0 +1,65 @@
+/*
+ *  Copyright 2011-2014 Maxim Milakov
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+
+#pragma once
+
+#include <string>
+#include <boost/asio.hpp>
+
+namespace nnforge
+{
+	// Endpoints of a group of processes: tcp:<host>:<base_port>, process i listens on port base_port + i,
+	// or unix:<path_prefix>, process i listens on the socket <path_prefix>i
+	class socket_endpoint
+	{
+	public:
+		typedef boost::asio::generic::stream_protocol protocol;
+
+		socket_endpoint(
+			const std::string& endpoint,
+			unsigned int process_count);
+
+		protocol::endpoint get_endpoint(unsigned int process_id) const;
+
+		// Binds the acceptor to the endpoint of process_id and starts listening, the stale socket file is removed
+		void listen(
+			boost::asio::basic_socket_acceptor<protocol>& acceptor,
+			unsigned int process_id) const;
+
+		// Removes the socket file of process_id, does nothing for TCP
+		void unlink(unsigned int process_id) const;
+
+		// Connects to process_id, waiting for it to start listening for connect_timeout_seconds at most
+		void connect(
+			protocol::socket& socket,
+			unsigned int process_id,
+			float connect_timeout_seconds) const;
+
+		// Disables Nagle's algorithm for TCP sockets
+		void set_options(protocol::socket& socket) const;
+
+		bool is_local() const;
+
+	private:
+		std::string get_path(unsigned int process_id) const;
+
+		bool local;
+		std::string host;
+		unsigned short base_port;
+		std::string path_prefix;
+	};
+}
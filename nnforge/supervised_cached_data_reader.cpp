@@ -0,0 +1,204 @@
+/*
+ *  Copyright 2011-2014 Maxim Milakov
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include "supervised_cached_data_reader.h"
+
+#include "supervised_data_stream_writer.h"
+#include "supervised_data_mapped_reader.h"
+#include "neural_network_exception.h"
+
+#include <cstring>
+#include <boost/format.hpp>
+#include <boost/filesystem/fstream.hpp>
+
+namespace nnforge
+{
+	supervised_cached_data_reader::supervised_cached_data_reader(
+		supervised_data_reader_smart_ptr original_reader,
+		const std::string& cache_key,
+		const boost::filesystem::path& cache_file_path)
+		: original_reader(original_reader)
+		, cache_key(cache_key)
+		, cache_file_path(cache_file_path)
+		, cached(false)
+		, entry_read_count(0)
+	{
+		input_configuration = original_reader->get_input_configuration();
+		output_configuration = original_reader->get_output_configuration();
+		type_code = original_reader->get_input_type();
+		input_mul_add_list = original_reader->get_input_mul_add_list();
+		input_entry_size = neuron_data_type::get_input_size(type_code) * input_configuration.get_neuron_count();
+		output_neuron_count = output_configuration.get_neuron_count();
+		entry_count = original_reader->get_entry_count();
+	}
+
+	supervised_cached_data_reader::~supervised_cached_data_reader()
+	{
+	}
+
+	boost::filesystem::path supervised_cached_data_reader::get_key_file_path() const
+	{
+		boost::filesystem::path res = cache_file_path;
+		res += ".key";
+		return res;
+	}
+
+	void supervised_cached_data_reader::ensure_cached()
+	{
+		if (cached)
+			return;
+
+		if (cache_file_path.empty())
+		{
+			size_t entry_size = input_entry_size + output_neuron_count * sizeof(float);
+			entry_data.resize(entry_size * entry_count);
+			original_reader->reset();
+			for(unsigned int entry_id = 0; entry_id < entry_count; ++entry_id)
+			{
+				unsigned char * dst = &(*entry_data.begin()) + entry_id * entry_size;
+				if (!original_reader->read(dst, reinterpret_cast<float *>(dst + input_entry_size)))
+					throw neural_network_exception((boost::format("Original reader has %1% entries while %2% are reported") % entry_id % entry_count).str());
+			}
+		}
+		else
+		{
+			std::string existing_key;
+			if (boost::filesystem::exists(cache_file_path) && boost::filesystem::exists(get_key_file_path()))
+			{
+				boost::filesystem::ifstream key_in(get_key_file_path(), std::ios_base::in | std::ios_base::binary);
+				existing_key.assign(std::istreambuf_iterator<char>(key_in), std::istreambuf_iterator<char>());
+			}
+
+			if (existing_key != cache_key)
+				write_cache_file();
+
+			cache_file_reader = supervised_data_reader_smart_ptr(new supervised_data_mapped_reader(cache_file_path));
+			if (cache_file_reader->get_entry_count() != entry_count)
+				throw neural_network_exception((boost::format("Cache file %1% has %2% entries while %3% are expected") % cache_file_path.string() % cache_file_reader->get_entry_count() % entry_count).str());
+			cache_file_reader->rewind(entry_read_count);
+		}
+
+		// The original reader is not needed anymore
+		original_reader.reset();
+		cached = true;
+	}
+
+	void supervised_cached_data_reader::write_cache_file()
+	{
+		boost::filesystem::remove(get_key_file_path());
+
+		boost::filesystem::path temp_file_path = cache_file_path;
+		temp_file_path += ".tmp";
+		{
+			nnforge_shared_ptr<std::ostream> out(new boost::filesystem::ofstream(temp_file_path, std::ios_base::out | std::ios_base::binary | std::ios_base::trunc));
+			supervised_data_stream_writer writer(out, input_configuration, output_configuration, type_code, input_mul_add_list);
+
+			std::vector<unsigned char> input(input_entry_size);
+			std::vector<float> output(output_neuron_count);
+			original_reader->reset();
+			for(unsigned int entry_id = 0; entry_id < entry_count; ++entry_id)
+			{
+				if (!original_reader->read(&(*input.begin()), &(*output.begin())))
+					throw neural_network_exception((boost::format("Original reader has %1% entries while %2% are reported") % entry_id % entry_count).str());
+				writer.write(type_code, &(*input.begin()), &(*output.begin()));
+			}
+		}
+		boost::filesystem::rename(temp_file_path, cache_file_path);
+
+		// The key is written last, so the interrupted cache file is never taken as valid
+		boost::filesystem::ofstream key_out(get_key_file_path(), std::ios_base::out | std::ios_base::binary | std::ios_base::trunc);
+		key_out << cache_key;
+	}
+
+	bool supervised_cached_data_reader::read(
+		void * input_elems,
+		float * output_elems)
+	{
+		if (entry_read_count >= entry_count)
+			return false;
+
+		ensure_cached();
+
+		if (cache_file_reader)
+		{
+			if (!cache_file_reader->read(input_elems, output_elems))
+				return false;
+		}
+		else
+		{
+			const unsigned char * src = &(*entry_data.begin()) + entry_read_count * (input_entry_size + output_neuron_count * sizeof(float));
+			if (input_elems)
+				memcpy(input_elems, src, input_entry_size);
+			if (output_elems)
+				memcpy(output_elems, src + input_entry_size, output_neuron_count * sizeof(float));
+		}
+
+		++entry_read_count;
+
+		return true;
+	}
+
+	bool supervised_cached_data_reader::raw_read(std::vector<unsigned char>& all_elems)
+	{
+		if (entry_read_count >= entry_count)
+			return false;
+
+		all_elems.resize(input_entry_size + output_neuron_count * sizeof(float));
+		return read(&(*all_elems.begin()), reinterpret_cast<float *>(&(*(all_elems.begin() + input_entry_size))));
+	}
+
+	void supervised_cached_data_reader::rewind(unsigned int entry_id)
+	{
+		entry_read_count = entry_id;
+		if (cache_file_reader)
+			cache_file_reader->rewind(entry_id);
+	}
+
+	void supervised_cached_data_reader::reset()
+	{
+		rewind(0);
+	}
+
+	void supervised_cached_data_reader::next_epoch()
+	{
+		rewind(0);
+	}
+
+	layer_configuration_specific supervised_cached_data_reader::get_input_configuration() const
+	{
+		return input_configuration;
+	}
+
+	layer_configuration_specific supervised_cached_data_reader::get_output_configuration() const
+	{
+		return output_configuration;
+	}
+
+	neuron_data_type::input_type supervised_cached_data_reader::get_input_type() const
+	{
+		return type_code;
+	}
+
+	std::vector<std::pair<float, float> > supervised_cached_data_reader::get_input_mul_add_list() const
+	{
+		return input_mul_add_list;
+	}
+
+	unsigned int supervised_cached_data_reader::get_entry_count() const
+	{
+		return entry_count;
+	}
+}
@@ -0,0 +1,99 @@
+/*
+ *  Copyright 2011-2014 Maxim Milakov
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#pragma once
+
+#include "supervised_data_reader.h"
+#include "neuron_data_type.h"
+#include "nn_types.h"
+
+#include <vector>
+#include <string>
+#include <boost/filesystem.hpp>
+
+namespace nnforge
+{
+	// Reads all the entries of the original reader once, on the first read, and reads them from the cache afterwards.
+	// The cache is kept in memory if cache_file_path is empty, otherwise it is written to cache_file_path and mapped into memory.
+	// The cache file is reused if it was written for the same cache_key, so the key should identify the original data
+	// and everything applied to it. Entries are cached in the order of the first pass, next_epoch doesn't reach the original reader
+	class supervised_cached_data_reader : public supervised_data_reader
+	{
+	public:
+		supervised_cached_data_reader(
+			supervised_data_reader_smart_ptr original_reader,
+			const std::string& cache_key,
+			const boost::filesystem::path& cache_file_path = boost::filesystem::path());
+
+		virtual ~supervised_cached_data_reader();
+
+		virtual bool read(
+			void * input_elems,
+			float * output_elems);
+
+		virtual bool raw_read(std::vector<unsigned char>& all_elems);
+
+		virtual void rewind(unsigned int entry_id);
+
+		virtual void reset();
+
+		virtual void next_epoch();
+
+		virtual layer_configuration_specific get_input_configuration() const;
+
+		virtual layer_configuration_specific get_output_configuration() const;
+
+		virtual neuron_data_type::input_type get_input_type() const;
+
+		virtual std::vector<std::pair<float, float> > get_input_mul_add_list() const;
+
+		virtual unsigned int get_entry_count() const;
+
+	protected:
+		// Fills the cache or opens the existing cache file if it is not done yet
+		void ensure_cached();
+
+		void write_cache_file();
+
+		boost::filesystem::path get_key_file_path() const;
+
+	protected:
+		supervised_data_reader_smart_ptr original_reader;
+		std::string cache_key;
+		boost::filesystem::path cache_file_path;
+		layer_configuration_specific input_configuration;
+		layer_configuration_specific output_configuration;
+		neuron_data_type::input_type type_code;
+		std::vector<std::pair<float, float> > input_mul_add_list;
+		size_t input_entry_size;
+		unsigned int output_neuron_count;
+		unsigned int entry_count;
+
+		bool cached;
+		// Entries cached in memory, input followed by output for each entry
+		std::vector<unsigned char> entry_data;
+		// Reader of the cache file
+		supervised_data_reader_smart_ptr cache_file_reader;
+
+		unsigned int entry_read_count;
+
+	private:
+		supervised_cached_data_reader(const supervised_cached_data_reader&);
+		supervised_cached_data_reader& operator =(const supervised_cached_data_reader&);
+	};
+
+	typedef nnforge_shared_ptr<supervised_cached_data_reader> supervised_cached_data_reader_smart_ptr;
+}
@@ -0,0 +1,282 @@
+/*
+ *  Copyright 2011-2014 Maxim Milakov
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+
+#include "supervised_compressed_data_stream_reader.h"
+
+#include "supervised_data_stream_schema.h"
+#include "neural_network_exception.h"
+
+#include <algorithm>
+#include <cstring>
+#include <boost/uuid/uuid_io.hpp>
+#include <boost/format.hpp>
+#include <boost/bind.hpp>
+#include <boost/thread/locks.hpp>
+#include <zlib.h>
+
+namespace nnforge
+{
+	supervised_compressed_data_stream_reader::supervised_compressed_data_stream_reader(
+		nnforge_shared_ptr<std::istream> input_stream,
+		unsigned int decompression_thread_count,
+		unsigned int prefetch_block_count)
+		: in_stream(input_stream)
+		, decompression_thread_count(std::max(decompression_thread_count, 1U))
+		, started(false)
+		, stop_requested(false)
+		, entry_read_count(0)
+		, current_slot(0)
+	{
+		in_stream->exceptions(std::ostream::eofbit | std::ostream::failbit | std::ostream::badbit);
+
+		start_pos = in_stream->tellg();
+
+		boost::uuids::uuid guid_read;
+		in_stream->read(reinterpret_cast<char*>(guid_read.data), sizeof(guid_read.data));
+		if (guid_read != supervised_data_stream_schema::supervised_data_stream_v2_guid)
+			throw neural_network_exception((boost::format("Unknown compressed supervised data GUID encountered in input stream: %1%") % guid_read).str());
+
+		input_configuration.read(*in_stream);
+		output_configuration.read(*in_stream);
+
+		input_neuron_count = input_configuration.get_neuron_count();
+		output_neuron_count = output_configuration.get_neuron_count();
+
+		unsigned int type_code_read;
+		in_stream->read(reinterpret_cast<char*>(&type_code_read), sizeof(type_code_read));
+		type_code = static_cast<neuron_data_type::input_type>(type_code_read);
+
+		if (type_code == neuron_data_type::type_uint8_scaled)
+			input_mul_add_list = neuron_data_type::read_mul_add_list(*in_stream, input_configuration.feature_map_count);
+
+		in_stream->read(reinterpret_cast<char*>(&entry_count), sizeof(entry_count));
+		in_stream->read(reinterpret_cast<char*>(&block_entry_count), sizeof(block_entry_count));
+		unsigned long long block_index_offset;
+		in_stream->read(reinterpret_cast<char*>(&block_index_offset), sizeof(block_index_offset));
+
+		entry_size = get_input_neuron_elem_size() * input_neuron_count + sizeof(float) * output_neuron_count;
+
+		unsigned int block_count = (entry_count + block_entry_count - 1) / block_entry_count;
+		block_offsets.resize(block_count + 1);
+		in_stream->seekg(start_pos + static_cast<std::istream::off_type>(block_index_offset));
+		in_stream->read(reinterpret_cast<char*>(&(*block_offsets.begin())), sizeof(unsigned long long) * block_offsets.size());
+
+		slot_list.resize(std::min(std::max(prefetch_block_count, this->decompression_thread_count), std::max(block_count, 1U)));
+		for(std::vector<block_slot>::iterator it = slot_list.begin(); it != slot_list.end(); ++it)
+			it->data.resize(entry_size * block_entry_count);
+	}
+
+	supervised_compressed_data_stream_reader::~supervised_compressed_data_stream_reader()
+	{
+		stop();
+	}
+
+	bool supervised_compressed_data_stream_reader::is_compressed(std::istream& input_stream)
+	{
+		std::istream::pos_type pos = input_stream.tellg();
+		std::ios_base::iostate exceptions = input_stream.exceptions();
+		input_stream.exceptions(std::ios_base::goodbit);
+
+		boost::uuids::uuid guid_read;
+		input_stream.read(reinterpret_cast<char*>(guid_read.data), sizeof(guid_read.data));
+		bool res = input_stream.good() && (guid_read == supervised_data_stream_schema::supervised_data_stream_v2_guid);
+
+		input_stream.clear();
+		input_stream.seekg(pos);
+		input_stream.exceptions(exceptions);
+
+		return res;
+	}
+
+	void supervised_compressed_data_stream_reader::reset()
+	{
+		rewind(0);
+	}
+
+	void supervised_compressed_data_stream_reader::rewind(unsigned int entry_id)
+	{
+		stop();
+
+		entry_read_count = entry_id;
+		current_slot = 0;
+	}
+
+	bool supervised_compressed_data_stream_reader::entry_available()
+	{
+		return (entry_read_count < entry_count);
+	}
+
+	bool supervised_compressed_data_stream_reader::read(
+		void * input_neurons,
+		float * output_neurons)
+	{
+		if (!entry_available())
+			return false;
+
+		const unsigned char * src = get_current_entry();
+		size_t input_size = get_input_neuron_elem_size() * input_neuron_count;
+		if (input_neurons)
+			memcpy(input_neurons, src, input_size);
+		if (output_neurons)
+			memcpy(output_neurons, src + input_size, sizeof(float) * output_neuron_count);
+
+		finish_current_entry();
+
+		return true;
+	}
+
+	bool supervised_compressed_data_stream_reader::raw_read(std::vector<unsigned char>& all_elems)
+	{
+		if (!entry_available())
+			return false;
+
+		const unsigned char * src = get_current_entry();
+		all_elems.assign(src, src + entry_size);
+
+		finish_current_entry();
+
+		return true;
+	}
+
+	const unsigned char * supervised_compressed_data_stream_reader::get_current_entry()
+	{
+		if (!started)
+			start();
+
+		unsigned int block_id = entry_read_count / block_entry_count;
+		if (current_slot == 0)
+		{
+			const block_slot& slot = slot_list[block_id % slot_list.size()];
+			boost::unique_lock<boost::mutex> lock(mtx);
+			while (error.empty() && ((slot.state != slot_state_decompressed) || (slot.block_id != block_id)))
+				slot_state_changed.wait(lock);
+
+			if (!error.empty())
+				throw neural_network_exception(error);
+
+			current_slot = &slot;
+		}
+
+		return &(*current_slot->data.begin()) + (entry_read_count - block_id * block_entry_count) * entry_size;
+	}
+
+	void supervised_compressed_data_stream_reader::finish_current_entry()
+	{
+		++entry_read_count;
+
+		if (((entry_read_count % block_entry_count) == 0) || (entry_read_count == entry_count))
+		{
+			{
+				boost::lock_guard<boost::mutex> lock(mtx);
+				block_slot& slot = slot_list[current_slot->block_id % slot_list.size()];
+				slot.state = slot_state_free;
+				slot.block_id += static_cast<unsigned int>(slot_list.size());
+			}
+			slot_state_changed.notify_all();
+			current_slot = 0;
+		}
+	}
+
+	void supervised_compressed_data_stream_reader::start()
+	{
+		// Slot (id % slot count) receives blocks with IDs id, id + slot count, ... in turn
+		unsigned int first_block_id = entry_read_count / block_entry_count;
+		for(unsigned int i = 0; i < slot_list.size(); ++i)
+		{
+			block_slot& slot = slot_list[(first_block_id + i) % slot_list.size()];
+			slot.state = slot_state_free;
+			slot.block_id = first_block_id + i;
+		}
+		stop_requested = false;
+		error.clear();
+
+		for(unsigned int worker_id = 0; worker_id < decompression_thread_count; ++worker_id)
+			thread_list.push_back(nnforge_shared_ptr<boost::thread>(new boost::thread(boost::bind(&supervised_compressed_data_stream_reader::decompress_blocks, this, worker_id, first_block_id))));
+
+		started = true;
+	}
+
+	void supervised_compressed_data_stream_reader::stop()
+	{
+		{
+			boost::lock_guard<boost::mutex> lock(mtx);
+			stop_requested = true;
+		}
+		slot_state_changed.notify_all();
+
+		for(std::vector<nnforge_shared_ptr<boost::thread> >::iterator it = thread_list.begin(); it != thread_list.end(); ++it)
+			(*it)->join();
+		thread_list.clear();
+
+		started = false;
+	}
+
+	void supervised_compressed_data_stream_reader::decompress_blocks(
+		unsigned int worker_id,
+		unsigned int first_block_id)
+	{
+		try
+		{
+			const unsigned int block_count = static_cast<unsigned int>(block_offsets.size() - 1);
+			std::vector<unsigned char> compressed_buf;
+			for(unsigned int block_id = first_block_id + worker_id; block_id < block_count; block_id += decompression_thread_count)
+			{
+				block_slot& slot = slot_list[block_id % slot_list.size()];
+				{
+					boost::unique_lock<boost::mutex> lock(mtx);
+					while ((!stop_requested) && ((slot.state != slot_state_free) || (slot.block_id != block_id)))
+						slot_state_changed.wait(lock);
+					if (stop_requested)
+						return;
+				}
+
+				compressed_buf.resize(static_cast<size_t>(block_offsets[block_id + 1] - block_offsets[block_id]));
+				{
+					boost::lock_guard<boost::mutex> lock(stream_mtx);
+					in_stream->seekg(start_pos + static_cast<std::istream::off_type>(block_offsets[block_id]));
+					in_stream->read(reinterpret_cast<char*>(&(*compressed_buf.begin())), compressed_buf.size());
+				}
+
+				uLongf block_size = static_cast<uLongf>(std::min(block_entry_count, entry_count - block_id * block_entry_count) * entry_size);
+				uLongf decompressed_size = block_size;
+				int res = uncompress(&(*slot.data.begin()), &decompressed_size, &(*compressed_buf.begin()), static_cast<uLong>(compressed_buf.size()));
+				if ((res != Z_OK) || (decompressed_size != block_size))
+					throw neural_network_exception((boost::format("zlib failed to decompress block %1%, error %2%") % block_id % res).str());
+
+				{
+					boost::lock_guard<boost::mutex> lock(mtx);
+					slot.state = slot_state_decompressed;
+				}
+				slot_state_changed.notify_all();
+			}
+		}
+		catch (const std::exception& e)
+		{
+			set_error(e.what());
+		}
+	}
+
+	void supervised_compressed_data_stream_reader::set_error(const std::string& message)
+	{
+		{
+			boost::lock_guard<boost::mutex> lock(mtx);
+			if (error.empty())
+				error = message;
+		}
+		slot_state_changed.notify_all();
+	}
+}
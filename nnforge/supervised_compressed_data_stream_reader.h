@@ -0,0 +1,156 @@
+/*
+ *  Copyright 2011-2014 Maxim Milakov
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+
+#pragma once
+
+#include "supervised_data_reader.h"
+#include "neuron_data_type.h"
+#include "nn_types.h"
+
+#include <vector>
+#include <string>
+#include <istream>
+#include <boost/thread/thread.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/condition_variable.hpp>
+
+namespace nnforge
+{
+	// Reads supervised data written by supervised_compressed_data_stream_writer.
+	// Blocks are decompressed by worker threads ahead of the consumer, block i by worker (i % decompression_thread_count),
+	// into prefetch_block_count slots. Rewinding seeks straight to the block holding the entry
+	class supervised_compressed_data_stream_reader : public supervised_data_reader
+	{
+	public:
+		// The constructor modifies input_stream to throw exceptions in case of failure
+		supervised_compressed_data_stream_reader(
+			nnforge_shared_ptr<std::istream> input_stream,
+			unsigned int decompression_thread_count = 2,
+			unsigned int prefetch_block_count = 4);
+
+		virtual ~supervised_compressed_data_stream_reader();
+
+		// Returns true if the stream contains data in format written by supervised_compressed_data_stream_writer, stream position is kept
+		static bool is_compressed(std::istream& input_stream);
+
+		virtual void reset();
+
+		virtual bool read(
+			void * input_neurons,
+			float * output_neurons);
+
+		virtual bool raw_read(std::vector<unsigned char>& all_elems);
+
+		virtual layer_configuration_specific get_input_configuration() const
+		{
+			return input_configuration;
+		}
+
+		virtual layer_configuration_specific get_output_configuration() const
+		{
+			return output_configuration;
+		}
+
+		virtual neuron_data_type::input_type get_input_type() const
+		{
+			return type_code;
+		}
+
+		virtual std::vector<std::pair<float, float> > get_input_mul_add_list() const
+		{
+			return input_mul_add_list;
+		}
+
+		virtual unsigned int get_entry_count() const
+		{
+			return entry_count;
+		}
+
+		virtual void rewind(unsigned int entry_id);
+
+	protected:
+		enum slot_state
+		{
+			slot_state_free,
+			slot_state_decompressed
+		};
+
+		struct block_slot
+		{
+			slot_state state;
+			// The block to be decompressed into the slot next, or decompressed there if the state is slot_state_decompressed
+			unsigned int block_id;
+			std::vector<unsigned char> data;
+		};
+
+		bool entry_available();
+
+		// Returns the entry entry_read_count, waiting for its block to be decompressed
+		const unsigned char * get_current_entry();
+
+		// Moves to the next entry, the slot is released when all the entries of the block are read
+		void finish_current_entry();
+
+		void start();
+
+		void stop();
+
+		void decompress_blocks(
+			unsigned int worker_id,
+			unsigned int first_block_id);
+
+		void set_error(const std::string& message);
+
+	protected:
+		nnforge_shared_ptr<std::istream> in_stream;
+		unsigned int input_neuron_count;
+		unsigned int output_neuron_count;
+		layer_configuration_specific input_configuration;
+		layer_configuration_specific output_configuration;
+		neuron_data_type::input_type type_code;
+		std::vector<std::pair<float, float> > input_mul_add_list;
+		unsigned int entry_count;
+		unsigned int block_entry_count;
+		size_t entry_size;
+
+		std::istream::pos_type start_pos;
+		// block_offsets[block_id] is the offset of the block from the start of the data, the last element is the end of the last block
+		std::vector<unsigned long long> block_offsets;
+
+		unsigned int decompression_thread_count;
+		std::vector<block_slot> slot_list;
+
+		// Guards in_stream, which workers read blocks from
+		boost::mutex stream_mtx;
+
+		boost::mutex mtx;
+		boost::condition_variable slot_state_changed;
+		std::vector<nnforge_shared_ptr<boost::thread> > thread_list;
+		bool started;
+		bool stop_requested;
+		std::string error;
+
+		unsigned int entry_read_count;
+		const block_slot * current_slot;
+
+	private:
+		supervised_compressed_data_stream_reader(const supervised_compressed_data_stream_reader&);
+		supervised_compressed_data_stream_reader& operator =(const supervised_compressed_data_stream_reader&);
+	};
+
+	typedef nnforge_shared_ptr<supervised_compressed_data_stream_reader> supervised_compressed_data_stream_reader_smart_ptr;
+}
@@ -0,0 +1,127 @@
+/*
+ *  Copyright 2011-2014 Maxim Milakov
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+
+#include "supervised_compressed_data_stream_writer.h"
+
+#include "supervised_data_stream_schema.h"
+#include "neural_network_exception.h"
+
+#include <boost/format.hpp>
+#include <zlib.h>
+
+namespace nnforge
+{
+	const unsigned int supervised_compressed_data_stream_writer::default_block_entry_count = 256;
+
+	supervised_compressed_data_stream_writer::supervised_compressed_data_stream_writer(
+		nnforge_shared_ptr<std::ostream> output_stream,
+		const layer_configuration_specific& input_configuration,
+		const layer_configuration_specific& output_configuration,
+		neuron_data_type::input_type type_code,
+		unsigned int block_entry_count,
+		const std::vector<std::pair<float, float> >& input_mul_add_list)
+		: out_stream(output_stream)
+		, block_entry_count(block_entry_count)
+		, entry_count(0)
+	{
+		if (type_code == neuron_data_type::type_unknown)
+			throw neural_network_exception("Type for input elements is not specified for supervised_compressed_data_stream_writer");
+		if (block_entry_count == 0)
+			throw neural_network_exception("Block entry count for supervised_compressed_data_stream_writer should be positive");
+		if ((type_code == neuron_data_type::type_uint8_scaled) && (input_mul_add_list.size() != input_configuration.feature_map_count))
+			throw neural_network_exception((boost::format("%1% mult-add pairs specified for %2% input feature maps") % input_mul_add_list.size() % input_configuration.feature_map_count).str());
+
+		out_stream->exceptions(std::ostream::failbit | std::ostream::badbit);
+
+		entry_size = neuron_data_type::get_input_size(type_code) * input_configuration.get_neuron_count() + sizeof(float) * output_configuration.get_neuron_count();
+
+		start_pos = out_stream->tellp();
+
+		out_stream->write(reinterpret_cast<const char*>(supervised_data_stream_schema::supervised_data_stream_v2_guid.data), sizeof(supervised_data_stream_schema::supervised_data_stream_v2_guid.data));
+
+		input_configuration.write(*out_stream);
+
+		output_configuration.write(*out_stream);
+
+		unsigned int t = static_cast<unsigned int>(type_code);
+		out_stream->write(reinterpret_cast<const char*>(&t), sizeof(t));
+
+		if (type_code == neuron_data_type::type_uint8_scaled)
+			neuron_data_type::write_mul_add_list(*out_stream, input_mul_add_list);
+
+		// Entry count and block index offset are updated in the destructor
+		entry_count_pos = out_stream->tellp();
+		out_stream->write(reinterpret_cast<const char*>(&entry_count), sizeof(entry_count));
+		out_stream->write(reinterpret_cast<const char*>(&block_entry_count), sizeof(block_entry_count));
+		unsigned long long block_index_offset = 0;
+		out_stream->write(reinterpret_cast<const char*>(&block_index_offset), sizeof(block_index_offset));
+
+		block_buf.reserve(entry_size * block_entry_count);
+	}
+
+	supervised_compressed_data_stream_writer::~supervised_compressed_data_stream_writer()
+	{
+		if (!block_buf.empty())
+			write_block();
+
+		// write block index
+		std::ostream::pos_type current_pos = out_stream->tellp();
+		unsigned long long block_index_offset = static_cast<unsigned long long>(current_pos - start_pos);
+		block_offsets.push_back(block_index_offset);
+		out_stream->write(reinterpret_cast<const char*>(&(*block_offsets.begin())), sizeof(unsigned long long) * block_offsets.size());
+		current_pos = out_stream->tellp();
+
+		// write entry count and block index offset
+		out_stream->seekp(entry_count_pos);
+		out_stream->write(reinterpret_cast<const char*>(&entry_count), sizeof(entry_count));
+		out_stream->write(reinterpret_cast<const char*>(&block_entry_count), sizeof(block_entry_count));
+		out_stream->write(reinterpret_cast<const char*>(&block_index_offset), sizeof(block_index_offset));
+
+		out_stream->seekp(current_pos);
+
+		out_stream->flush();
+	}
+
+	void supervised_compressed_data_stream_writer::raw_write(
+		const void * all_entry_data,
+		size_t data_length)
+	{
+		if (data_length != entry_size)
+			throw neural_network_exception((boost::format("Entry of %1% bytes written to supervised_compressed_data_stream_writer expecting %2% bytes") % data_length % entry_size).str());
+
+		const unsigned char * data = static_cast<const unsigned char *>(all_entry_data);
+		block_buf.insert(block_buf.end(), data, data + data_length);
+		entry_count++;
+
+		if (block_buf.size() >= entry_size * block_entry_count)
+			write_block();
+	}
+
+	void supervised_compressed_data_stream_writer::write_block()
+	{
+		uLongf compressed_size = compressBound(static_cast<uLong>(block_buf.size()));
+		compressed_buf.resize(compressed_size);
+		int res = compress2(&(*compressed_buf.begin()), &compressed_size, &(*block_buf.begin()), static_cast<uLong>(block_buf.size()), Z_BEST_SPEED);
+		if (res != Z_OK)
+			throw neural_network_exception((boost::format("zlib failed to compress block %1%, error %2%") % block_offsets.size() % res).str());
+
+		block_offsets.push_back(static_cast<unsigned long long>(out_stream->tellp() - start_pos));
+		out_stream->write(reinterpret_cast<const char*>(&(*compressed_buf.begin())), compressed_size);
+
+		block_buf.clear();
+	}
+}
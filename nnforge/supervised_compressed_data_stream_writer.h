@@ -0,0 +1,75 @@
+/*
+ *  Copyright 2011-2014 Maxim Milakov
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+
+#pragma once
+
+#include "data_writer.h"
+#include "layer_configuration_specific.h"
+#include "neuron_data_type.h"
+#include "nn_types.h"
+
+#include <vector>
+#include <ostream>
+
+namespace nnforge
+{
+	// Writes supervised data in version 2 format: the header is the same as for supervised_data_stream_writer
+	// with block entry count and the position of block index added. Entries are grouped into blocks of block_entry_count entries,
+	// each block compressed with zlib at the fastest level. Block index, written at the end, holds the offsets of all the blocks
+	class supervised_compressed_data_stream_writer : public data_writer
+	{
+	public:
+		// The constructor modifies output_stream to throw exceptions in case of failure
+		// The stream should be created with std::ios_base::binary flag
+		supervised_compressed_data_stream_writer(
+			nnforge_shared_ptr<std::ostream> output_stream,
+			const layer_configuration_specific& input_configuration,
+			const layer_configuration_specific& output_configuration,
+			neuron_data_type::input_type type_code,
+			unsigned int block_entry_count = default_block_entry_count,
+			const std::vector<std::pair<float, float> >& input_mul_add_list = std::vector<std::pair<float, float> >());
+
+		virtual ~supervised_compressed_data_stream_writer();
+
+		virtual void raw_write(
+			const void * all_entry_data,
+			size_t data_length);
+
+		static const unsigned int default_block_entry_count;
+
+	private:
+		void write_block();
+
+		nnforge_shared_ptr<std::ostream> out_stream;
+		size_t entry_size;
+		unsigned int block_entry_count;
+
+		std::ostream::pos_type start_pos;
+		std::ostream::pos_type entry_count_pos;
+		unsigned int entry_count;
+
+		std::vector<unsigned long long> block_offsets;
+		std::vector<unsigned char> block_buf;
+		std::vector<unsigned char> compressed_buf;
+
+	private:
+		supervised_compressed_data_stream_writer(const supervised_compressed_data_stream_writer&);
+		supervised_compressed_data_stream_writer& operator =(const supervised_compressed_data_stream_writer&);
+	};
+
+	typedef nnforge_shared_ptr<supervised_compressed_data_stream_writer> supervised_compressed_data_stream_writer_smart_ptr;
+}
@@ -0,0 +1,169 @@
+/*
+ *  Copyright 2011-2014 Maxim Milakov
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+
+#include "supervised_data_mapped_reader.h"
+
+#include "supervised_data_stream_schema.h"
+#include "neural_network_exception.h"
+
+#include <boost/uuid/uuid_io.hpp>
+#include <boost/format.hpp>
+#include <boost/filesystem/fstream.hpp>
+#include <algorithm>
+#include <cstring>
+
+#ifndef _WIN32
+#include <sys/mman.h>
+#endif
+
+namespace nnforge
+{
+	supervised_data_mapped_reader::supervised_data_mapped_reader(
+		const boost::filesystem::path& file_path,
+		bool random_access)
+		: entry_read_count(0)
+	{
+		size_t header_size;
+		{
+			boost::filesystem::ifstream in(file_path, std::ios_base::in | std::ios_base::binary);
+			in.exceptions(std::ostream::eofbit | std::ostream::failbit | std::ostream::badbit);
+
+			boost::uuids::uuid guid_read;
+			in.read(reinterpret_cast<char*>(guid_read.data), sizeof(guid_read.data));
+			if (guid_read != supervised_data_stream_schema::supervised_data_stream_guid)
+				throw neural_network_exception((boost::format("Unknown supervised data GUID encountered in input file %1%: %2%") % file_path.string() % guid_read).str());
+
+			input_configuration.read(in);
+			output_configuration.read(in);
+
+			unsigned int type_code_read;
+			in.read(reinterpret_cast<char*>(&type_code_read), sizeof(type_code_read));
+			type_code = static_cast<neuron_data_type::input_type>(type_code_read);
+
+			if (type_code == neuron_data_type::type_uint8_scaled)
+				input_mul_add_list = neuron_data_type::read_mul_add_list(in, input_configuration.feature_map_count);
+
+			in.read(reinterpret_cast<char*>(&entry_count), sizeof(entry_count));
+
+			header_size = static_cast<size_t>(in.tellg());
+		}
+
+		input_size = get_input_neuron_elem_size() * input_configuration.get_neuron_count();
+		output_size = sizeof(float) * output_configuration.get_neuron_count();
+		entry_size = input_size + output_size;
+
+		file.open(file_path.string());
+		if (file.size() < header_size + entry_size * static_cast<size_t>(entry_count))
+			throw neural_network_exception((boost::format("Supervised data file %1% is truncated: %2% bytes while %3% entries of %4% bytes each are declared") % file_path.string() % file.size() % entry_count % entry_size).str());
+
+		entries = reinterpret_cast<const unsigned char *>(file.data()) + header_size;
+
+		// The mapping starts at the page boundary as it maps the file from the very beginning
+		#ifndef _WIN32
+		madvise(const_cast<char *>(file.data()), file.size(), random_access ? MADV_RANDOM : MADV_SEQUENTIAL);
+		#endif
+	}
+
+	supervised_data_mapped_reader::~supervised_data_mapped_reader()
+	{
+	}
+
+	void supervised_data_mapped_reader::reset()
+	{
+		entry_read_count = 0;
+	}
+
+	bool supervised_data_mapped_reader::read(
+		void * input_neurons,
+		float * output_neurons)
+	{
+		if (entry_read_count >= entry_count)
+			return false;
+
+		const unsigned char * src = entries + entry_size * static_cast<size_t>(entry_read_count);
+		if (input_neurons)
+			memcpy(input_neurons, src, input_size);
+		if (output_neurons)
+			memcpy(output_neurons, src + input_size, output_size);
+
+		entry_read_count++;
+
+		return true;
+	}
+
+	unsigned int supervised_data_mapped_reader::read_batch(
+		unsigned int entry_count,
+		void * input_elems,
+		float * output_elems)
+	{
+		if (entry_read_count >= this->entry_count)
+			return 0;
+
+		unsigned int entries_to_read = std::min(entry_count, this->entry_count - entry_read_count);
+
+		const unsigned char * src = entries + entry_size * static_cast<size_t>(entry_read_count);
+		unsigned char * input_dst = static_cast<unsigned char *>(input_elems);
+		unsigned char * output_dst = reinterpret_cast<unsigned char *>(output_elems);
+		for(unsigned int i = 0; i < entries_to_read; ++i, src += entry_size)
+		{
+			if (input_dst)
+			{
+				memcpy(input_dst, src, input_size);
+				input_dst += input_size;
+			}
+			if (output_dst)
+			{
+				memcpy(output_dst, src + input_size, output_size);
+				output_dst += output_size;
+			}
+		}
+
+		entry_read_count += entries_to_read;
+
+		return entries_to_read;
+	}
+
+	bool supervised_data_mapped_reader::raw_read(std::vector<unsigned char>& all_elems)
+	{
+		if (entry_read_count >= entry_count)
+			return false;
+
+		const unsigned char * src = entries + entry_size * static_cast<size_t>(entry_read_count);
+		all_elems.assign(src, src + entry_size);
+
+		entry_read_count++;
+
+		return true;
+	}
+
+	const unsigned char * supervised_data_mapped_reader::borrow_raw_entries(
+		unsigned int entry_id,
+		unsigned int entry_count,
+		size_t& entry_size)
+	{
+		if ((entry_id > this->entry_count) || (entry_count > this->entry_count - entry_id))
+			throw neural_network_exception((boost::format("Entries %1% to %2% requested while there are %3% entries only") % entry_id % (entry_id + entry_count) % this->entry_count).str());
+
+		entry_size = this->entry_size;
+		return entries + this->entry_size * static_cast<size_t>(entry_id);
+	}
+
+	void supervised_data_mapped_reader::rewind(unsigned int entry_id)
+	{
+		entry_read_count = entry_id;
+	}
+}
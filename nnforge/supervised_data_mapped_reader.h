@@ -0,0 +1,107 @@
+/*
+ *  Copyright 2011-2014 Maxim Milakov
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+
+#pragma once
+
+#include "supervised_data_reader.h"
+#include "neuron_data_type.h"
+#include "nn_types.h"
+
+#include <vector>
+#include <boost/filesystem.hpp>
+#include <boost/iostreams/device/mapped_file.hpp>
+
+namespace nnforge
+{
+	// Reads supervised data file mapped into memory, entries are copied straight from the mapping
+	// and might be borrowed without copying at all with borrow_raw_entries
+	class supervised_data_mapped_reader : public supervised_data_reader
+	{
+	public:
+		// The mapping is advised to be accessed randomly if random_access is true and sequentially otherwise
+		supervised_data_mapped_reader(
+			const boost::filesystem::path& file_path,
+			bool random_access = false);
+
+		virtual ~supervised_data_mapped_reader();
+
+		virtual void reset();
+
+		virtual bool read(
+			void * input_neurons,
+			float * output_neurons);
+
+		virtual unsigned int read_batch(
+			unsigned int entry_count,
+			void * input_elems,
+			float * output_elems);
+
+		virtual bool raw_read(std::vector<unsigned char>& all_elems);
+
+		virtual const unsigned char * borrow_raw_entries(
+			unsigned int entry_id,
+			unsigned int entry_count,
+			size_t& entry_size);
+
+		virtual layer_configuration_specific get_input_configuration() const
+		{
+			return input_configuration;
+		}
+
+		virtual layer_configuration_specific get_output_configuration() const
+		{
+			return output_configuration;
+		}
+
+		virtual neuron_data_type::input_type get_input_type() const
+		{
+			return type_code;
+		}
+
+		virtual std::vector<std::pair<float, float> > get_input_mul_add_list() const
+		{
+			return input_mul_add_list;
+		}
+
+		virtual unsigned int get_entry_count() const
+		{
+			return entry_count;
+		}
+
+		virtual void rewind(unsigned int entry_id);
+
+	protected:
+		boost::iostreams::mapped_file_source file;
+		const unsigned char * entries;
+		size_t input_size;
+		size_t output_size;
+		size_t entry_size;
+		layer_configuration_specific input_configuration;
+		layer_configuration_specific output_configuration;
+		neuron_data_type::input_type type_code;
+		std::vector<std::pair<float, float> > input_mul_add_list;
+		unsigned int entry_count;
+
+		unsigned int entry_read_count;
+
+	private:
+		supervised_data_mapped_reader(const supervised_data_mapped_reader&);
+		supervised_data_mapped_reader& operator =(const supervised_data_mapped_reader&);
+	};
+
+	typedef nnforge_shared_ptr<supervised_data_mapped_reader> supervised_data_mapped_reader_smart_ptr;
+}
@@ -19,6 +19,7 @@
 
 #include <boost/format.hpp>
 #include <cstring>
+#include <algorithm>
 
 namespace nnforge
 {
@@ -78,6 +79,8 @@ namespace nnforge
 			case neuron_data_type::type_float:
 				input_src = &(*input_data_list_float[entry_read_count]->begin());
 				break;
+			default:
+				throw neural_network_exception((boost::format("Unexpected input type %1% for supervised_data_mem_reader") % type_code).str());
 			}
 			memcpy(input_neurons, input_src, input_neuron_count * neuron_data_type::get_input_size(type_code));
 		}
@@ -85,11 +88,43 @@ namespace nnforge
 		if (output_neurons)
 		{
 			const float * output_src = &(*output_data_list[entry_read_count]->begin());
-			memcpy(output_neurons, output_src, input_neuron_count * sizeof(float));
+			memcpy(output_neurons, output_src, output_neuron_count * sizeof(float));
 		}
 
 		entry_read_count++;
 
 		return true;
 	}
+
+	unsigned int supervised_data_mem_reader::read_batch(
+		unsigned int entry_count,
+		void * input_neurons,
+		float * output_neurons)
+	{
+		unsigned int entries_to_read = std::min(entry_count, this->entry_count - entry_read_count);
+
+		if (input_neurons)
+		{
+			size_t input_size = input_neuron_count * neuron_data_type::get_input_size(type_code);
+			unsigned char * input_dst = static_cast<unsigned char *>(input_neurons);
+			for(unsigned int i = 0; i < entries_to_read; ++i, input_dst += input_size)
+			{
+				if (type_code == neuron_data_type::type_byte)
+					memcpy(input_dst, &(*input_data_list_byte[entry_read_count + i]->begin()), input_size);
+				else
+					memcpy(input_dst, &(*input_data_list_float[entry_read_count + i]->begin()), input_size);
+			}
+		}
+
+		if (output_neurons)
+		{
+			float * output_dst = output_neurons;
+			for(unsigned int i = 0; i < entries_to_read; ++i, output_dst += output_neuron_count)
+				memcpy(output_dst, &(*output_data_list[entry_read_count + i]->begin()), output_neuron_count * sizeof(float));
+		}
+
+		entry_read_count += entries_to_read;
+
+		return entries_to_read;
+	}
 }
@@ -51,6 +51,11 @@ namespace nnforge
 			void * input_neurons,
 			float * output_neurons);
 
+		virtual unsigned int read_batch(
+			unsigned int entry_count,
+			void * input_neurons,
+			float * output_neurons);
+
 		virtual layer_configuration_specific get_input_configuration() const
 		{
 			return input_configuration;
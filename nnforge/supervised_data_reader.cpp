@@ -17,6 +17,7 @@
 #include "supervised_data_reader.h"
 
 #include "neural_network_exception.h"
+#include "feature_map_data_stat_accumulator.h"
 
 #include <vector>
 #include <limits>
@@ -58,76 +59,48 @@ namespace nnforge
 		return read(input_elems, 0);
 	}
 
-	std::vector<feature_map_data_stat> supervised_data_reader::get_feature_map_output_data_stat_list()
+	unsigned int supervised_data_reader::read_batch(
+		unsigned int entry_count,
+		void * input_elems,
+		float * output_elems)
 	{
-		std::vector<feature_map_data_stat> res;
+		size_t input_size = get_input_neuron_elem_size() * get_input_configuration().get_neuron_count();
+		unsigned int output_neuron_count = get_output_configuration().get_neuron_count();
+		unsigned char * input_ptr = static_cast<unsigned char *>(input_elems);
 
-		reset();
+		unsigned int entries_read = 0;
+		while ((entries_read < entry_count) && read(
+			(input_ptr != 0) ? input_ptr + input_size * entries_read : 0,
+			(output_elems != 0) ? output_elems + output_neuron_count * entries_read : 0))
+			++entries_read;
+
+		return entries_read;
+	}
 
+	unsigned int supervised_data_reader::read_batch(
+		unsigned int entry_count,
+		void * input_elems)
+	{
+		return read_batch(entry_count, input_elems, 0);
+	}
+
+	std::vector<feature_map_data_stat> supervised_data_reader::get_feature_map_output_data_stat_list(
+		unsigned int worker_count,
+		unsigned int sample_entry_count,
+		std::vector<float> * average_confidence_list)
+	{
 		unsigned int entry_count = get_entry_count();
 		if (entry_count == 0)
 			throw neural_network_exception("Unable to stat data reader with no entries");
 
 		layer_configuration_specific output_configuration = get_output_configuration();
-		res.resize(output_configuration.feature_map_count);
-
-		for(std::vector<feature_map_data_stat>::iterator it = res.begin(); it != res.end(); ++it)
-		{
-			it->min = std::numeric_limits<float>::max();
-			it->max = -std::numeric_limits<float>::max();
-			it->average = 0.0F;
-			it->std_dev = 0.0F;
-		}
+		feature_map_data_stat_accumulator acc(output_configuration.feature_map_count, output_configuration.get_neuron_count_per_feature_map());
+		acc.add_output(*this, worker_count, sample_entry_count);
 
-		std::vector<float> output_data(output_configuration.get_neuron_count());
-		unsigned int neuron_count_per_feature_map = output_configuration.get_neuron_count_per_feature_map();
+		if (average_confidence_list)
+			*average_confidence_list = acc.get_average_confidence_list(entry_count);
 
-		while(read(0, &(*output_data.begin())))
-		{
-			std::vector<float>::const_iterator data_it = output_data.begin();
-			for(std::vector<feature_map_data_stat>::iterator fm_it = res.begin(); fm_it != res.end(); ++fm_it)
-			{
-				float current_sum = 0.0F;
-				for(unsigned int i = 0; i < neuron_count_per_feature_map; ++i)
-				{
-					float val = *data_it;
-					fm_it->min = std::min(fm_it->min, val);
-					fm_it->max = std::max(fm_it->max, val);
-					current_sum += val;
-					++data_it;
-				}
-				fm_it->average += current_sum;
-			}
-		}
-
-		float mult = 1.0F / ((float)entry_count * (float)neuron_count_per_feature_map);
-		for(std::vector<feature_map_data_stat>::iterator it = res.begin(); it != res.end(); ++it)
-			it->average *= mult;
-
-		reset();
-
-		while(read(0, &(*output_data.begin())))
-		{
-			std::vector<float>::const_iterator data_it = output_data.begin();
-			for(std::vector<feature_map_data_stat>::iterator fm_it = res.begin(); fm_it != res.end(); ++fm_it)
-			{
-				float current_sum = 0.0F;
-				float average = fm_it->average;
-				for(unsigned int i = 0; i < neuron_count_per_feature_map; ++i)
-				{
-					float val = *data_it;
-					float diff = val - average;
-					current_sum += diff * diff;
-					++data_it;
-				}
-				fm_it->std_dev += current_sum;
-			}
-		}
-
-		for(std::vector<feature_map_data_stat>::iterator it = res.begin(); it != res.end(); ++it)
-			it->std_dev = sqrtf(it->std_dev * mult);
-
-		return res;
+		return acc.get_stat_list();
 	}
 
 	void supervised_data_reader::fill_class_buckets_entry_id_lists(std::vector<randomized_classifier_keeper>& class_buckets_entry_id_lists)
@@ -61,11 +61,27 @@ namespace nnforge
 
 		virtual bool read(void * input_elems);
 
+		// Reads up to entry_count entries stored contiguously, returns the number of entries actually read
+		// If any pointer is null the method should just discard corresponding data
+		// The default implementation calls read for each entry, readers should override it when they can do it cheaper
+		virtual unsigned int read_batch(
+			unsigned int entry_count,
+			void * input_elems,
+			float * output_elems);
+
+		virtual unsigned int read_batch(
+			unsigned int entry_count,
+			void * input_elems);
+
 		virtual layer_configuration_specific get_output_configuration() const = 0;
 
 		output_neuron_value_set_smart_ptr get_output_neuron_value_set(unsigned int sample_count);
 
-		std::vector<feature_map_data_stat> get_feature_map_output_data_stat_list();
+		// See get_feature_map_input_data_stat_list
+		std::vector<feature_map_data_stat> get_feature_map_output_data_stat_list(
+			unsigned int worker_count = 1,
+			unsigned int sample_entry_count = 0,
+			std::vector<float> * average_confidence_list = 0);
 
 		void fill_class_buckets_entry_id_lists(std::vector<randomized_classifier_keeper>& class_buckets_entry_id_lists);
 
@@ -0,0 +1,181 @@
+/*
+ *  Copyright 2011-2014 Maxim Milakov
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include "supervised_data_sharer.h"
+
+#include "supervised_shared_data_reader.h"
+#include "neural_network_exception.h"
+
+#include <algorithm>
+#include <cstring>
+#include <boost/thread/locks.hpp>
+
+namespace nnforge
+{
+	supervised_data_sharer::supervised_data_sharer(
+		supervised_data_reader& original_reader,
+		unsigned int consumer_count,
+		unsigned int queue_entry_count)
+		: original_reader(original_reader)
+		, queue_entry_count(std::max(queue_entry_count, 1U))
+		, position_list(consumer_count, 0)
+		, active_list(consumer_count, false)
+		, read_entry_count(0)
+		, original_entries_finished(false)
+		, filling(false)
+	{
+		input_size = original_reader.get_input_configuration().get_neuron_count() * original_reader.get_input_neuron_elem_size();
+		output_neuron_count = original_reader.get_output_configuration().get_neuron_count();
+
+		input_buf.resize(input_size * this->queue_entry_count);
+		output_buf.resize(static_cast<size_t>(output_neuron_count) * this->queue_entry_count);
+
+		for(unsigned int consumer_id = 0; consumer_id < consumer_count; ++consumer_id)
+			consumer_reader_list.push_back(supervised_data_reader_smart_ptr(new supervised_shared_data_reader(*this, consumer_id)));
+	}
+
+	supervised_data_sharer::~supervised_data_sharer()
+	{
+	}
+
+	supervised_data_reader_smart_ptr supervised_data_sharer::get_consumer_reader(unsigned int consumer_id)
+	{
+		return consumer_reader_list[consumer_id];
+	}
+
+	void supervised_data_sharer::start_pass(const std::vector<unsigned int>& active_consumer_id_list)
+	{
+		boost::lock_guard<boost::mutex> lock(mtx);
+
+		original_reader.reset();
+
+		std::fill(position_list.begin(), position_list.end(), 0);
+		std::fill(active_list.begin(), active_list.end(), false);
+		for(std::vector<unsigned int>::const_iterator it = active_consumer_id_list.begin(); it != active_consumer_id_list.end(); ++it)
+			active_list[*it] = true;
+		read_entry_count = 0;
+		original_entries_finished = false;
+	}
+
+	void supervised_data_sharer::finish(unsigned int consumer_id)
+	{
+		{
+			boost::lock_guard<boost::mutex> lock(mtx);
+			active_list[consumer_id] = false;
+		}
+		position_changed.notify_all();
+	}
+
+	void supervised_data_sharer::reset(unsigned int consumer_id)
+	{
+		boost::lock_guard<boost::mutex> lock(mtx);
+		if (position_list[consumer_id] != 0)
+			throw neural_network_exception("Shared data reader cannot be reset after it has read entries within the pass");
+	}
+
+	unsigned int supervised_data_sharer::read(
+		unsigned int consumer_id,
+		unsigned int entry_count,
+		void * input_elems,
+		float * output_elems)
+	{
+		unsigned char * input_ptr = static_cast<unsigned char *>(input_elems);
+		unsigned int entries_read = 0;
+
+		boost::unique_lock<boost::mutex> lock(mtx);
+		if (!active_list[consumer_id])
+			throw neural_network_exception("Shared data reader is not active within the pass");
+
+		while (entries_read < entry_count)
+		{
+			unsigned int position = position_list[consumer_id];
+			if (position < read_entry_count)
+			{
+				// Slots holding entries from the slowest consumer position on are not overwritten, so they are copied without the lock
+				unsigned int slot_id = position % queue_entry_count;
+				unsigned int copy_count = std::min(std::min(entry_count - entries_read, read_entry_count - position), queue_entry_count - slot_id);
+				lock.unlock();
+
+				if (input_ptr != 0)
+					memcpy(input_ptr + input_size * entries_read, &(*(input_buf.begin() + input_size * slot_id)), input_size * copy_count);
+				if (output_elems != 0)
+					memcpy(output_elems + static_cast<size_t>(output_neuron_count) * entries_read, &(*(output_buf.begin() + static_cast<size_t>(output_neuron_count) * slot_id)), sizeof(float) * output_neuron_count * copy_count);
+
+				lock.lock();
+				position_list[consumer_id] += copy_count;
+				entries_read += copy_count;
+				position_changed.notify_all();
+			}
+			else if (original_entries_finished)
+				break;
+			else if (filling || (read_entry_count - get_min_position() >= queue_entry_count))
+				position_changed.wait(lock);
+			else
+				fill(lock);
+		}
+
+		return entries_read;
+	}
+
+	unsigned int supervised_data_sharer::get_min_position() const
+	{
+		unsigned int res = read_entry_count;
+		for(unsigned int consumer_id = 0; consumer_id < position_list.size(); ++consumer_id)
+			if (active_list[consumer_id])
+				res = std::min(res, position_list[consumer_id]);
+
+		return res;
+	}
+
+	void supervised_data_sharer::fill(boost::unique_lock<boost::mutex>& lock)
+	{
+		// Fill a quarter of the ring at most, so that consumers waiting for the entries don't wait for the whole ring to be read
+		unsigned int slot_id = read_entry_count % queue_entry_count;
+		unsigned int free_slot_count = queue_entry_count - (read_entry_count - get_min_position());
+		unsigned int fill_count = std::min(std::min(free_slot_count, queue_entry_count - slot_id), std::max(queue_entry_count / 4, 1U));
+
+		filling = true;
+		lock.unlock();
+
+		unsigned int entries_filled;
+		try
+		{
+			entries_filled = original_reader.read_batch(
+				fill_count,
+				&(*(input_buf.begin() + input_size * slot_id)),
+				&(*(output_buf.begin() + static_cast<size_t>(output_neuron_count) * slot_id)));
+		}
+		catch (...)
+		{
+			lock.lock();
+			filling = false;
+			position_changed.notify_all();
+			throw;
+		}
+
+		lock.lock();
+		filling = false;
+		read_entry_count += entries_filled;
+		if (entries_filled < fill_count)
+			original_entries_finished = true;
+		position_changed.notify_all();
+	}
+
+	const supervised_data_reader& supervised_data_sharer::get_original_reader() const
+	{
+		return original_reader;
+	}
+}
@@ -0,0 +1,94 @@
+/*
+ *  Copyright 2011-2014 Maxim Milakov
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#pragma once
+
+#include "supervised_data_reader.h"
+#include "nn_types.h"
+
+#include <vector>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/condition_variable.hpp>
+
+namespace nnforge
+{
+	// Lets several consumers read the same entries of the original reader concurrently, each entry is read (and decoded) once per pass.
+	// Entries are kept in the ring of queue_entry_count entries until all the active consumers have read them,
+	// so the fastest consumer runs at most queue_entry_count entries ahead of the slowest one
+	class supervised_data_sharer
+	{
+	public:
+		supervised_data_sharer(
+			supervised_data_reader& original_reader,
+			unsigned int consumer_count,
+			unsigned int queue_entry_count);
+
+		~supervised_data_sharer();
+
+		// The reader is valid as long as the sharer exists, it should be used by single thread only
+		supervised_data_reader_smart_ptr get_consumer_reader(unsigned int consumer_id);
+
+		// Resets the original reader, consumers from active_consumer_id_list start reading it from the beginning.
+		// Should not be called while consumers of the previous pass are reading
+		void start_pass(const std::vector<unsigned int>& active_consumer_id_list);
+
+		// Consumer should call it when it stops reading within the pass, either all the entries are read or not
+		void finish(unsigned int consumer_id);
+
+		// Returns the number of entries read, it is less than entry_count only when there are no more entries in the pass
+		// If any pointer is null the method should just discard corresponding data
+		unsigned int read(
+			unsigned int consumer_id,
+			unsigned int entry_count,
+			void * input_elems,
+			float * output_elems);
+
+		// Consumer is allowed to reset only before reading any entry within the pass
+		void reset(unsigned int consumer_id);
+
+		const supervised_data_reader& get_original_reader() const;
+
+	protected:
+		// Returns the position of the slowest active consumer, read_entry_count if there are no active consumers
+		unsigned int get_min_position() const;
+
+		// Reads the entries into the free slots, the lock is released while reading
+		void fill(boost::unique_lock<boost::mutex>& lock);
+
+		supervised_data_reader& original_reader;
+		unsigned int queue_entry_count;
+		size_t input_size;
+		unsigned int output_neuron_count;
+
+		std::vector<unsigned char> input_buf;
+		std::vector<float> output_buf;
+
+		boost::mutex mtx;
+		boost::condition_variable position_changed;
+		std::vector<unsigned int> position_list;
+		std::vector<bool> active_list;
+		unsigned int read_entry_count;
+		bool original_entries_finished;
+		bool filling;
+		std::vector<supervised_data_reader_smart_ptr> consumer_reader_list;
+
+	private:
+		supervised_data_sharer(const supervised_data_sharer&);
+		supervised_data_sharer& operator =(const supervised_data_sharer&);
+	};
+
+	typedef nnforge_shared_ptr<supervised_data_sharer> supervised_data_sharer_smart_ptr;
+}
@@ -20,6 +20,8 @@
 
 #include <boost/uuid/uuid_io.hpp>
 #include <boost/format.hpp>
+#include <algorithm>
+#include <cstring>
 
 namespace nnforge
 {
@@ -44,6 +46,9 @@ namespace nnforge
 		in_stream->read(reinterpret_cast<char*>(&type_code_read), sizeof(type_code_read));
 		type_code = static_cast<neuron_data_type::input_type>(type_code_read);
 
+		if (type_code == neuron_data_type::type_uint8_scaled)
+			input_mul_add_list = neuron_data_type::read_mul_add_list(*in_stream, input_configuration.feature_map_count);
+
 		in_stream->read(reinterpret_cast<char*>(&entry_count), sizeof(entry_count));
 
 		reset_pos = in_stream->tellg();
@@ -82,6 +87,44 @@ namespace nnforge
 		return true;
 	}
 
+	unsigned int supervised_data_stream_reader::read_batch(
+		unsigned int entry_count,
+		void * input_elems,
+		float * output_elems)
+	{
+		unsigned int entries_to_read = std::min(entry_count, this->entry_count - entry_read_count);
+		if (entries_to_read == 0)
+			return 0;
+
+		size_t input_size = get_input_neuron_elem_size() * input_neuron_count;
+		size_t output_size = sizeof(float) * output_neuron_count;
+		size_t entry_size = input_size + output_size;
+
+		batch_buf.resize(entry_size * entries_to_read);
+		in_stream->read(reinterpret_cast<char*>(&(*batch_buf.begin())), entry_size * entries_to_read);
+
+		const unsigned char * src = &(*batch_buf.begin());
+		unsigned char * input_dst = static_cast<unsigned char *>(input_elems);
+		unsigned char * output_dst = reinterpret_cast<unsigned char *>(output_elems);
+		for(unsigned int i = 0; i < entries_to_read; ++i, src += entry_size)
+		{
+			if (input_dst)
+			{
+				memcpy(input_dst, src, input_size);
+				input_dst += input_size;
+			}
+			if (output_dst)
+			{
+				memcpy(output_dst, src + input_size, output_size);
+				output_dst += output_size;
+			}
+		}
+
+		entry_read_count += entries_to_read;
+
+		return entries_to_read;
+	}
+
 	bool supervised_data_stream_reader::raw_read(std::vector<unsigned char>& all_elems)
 	{
 		if (!entry_available())
@@ -91,6 +134,8 @@ namespace nnforge
 		all_elems.resize(bytes_to_read);
 		in_stream->read(reinterpret_cast<char*>(&(*all_elems.begin())), bytes_to_read);
 
+		entry_read_count++;
+
 		return true;
 	}
 
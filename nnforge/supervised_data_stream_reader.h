@@ -42,6 +42,12 @@ namespace nnforge
 			void * input_neurons,
 			float * output_neurons);
 
+		// Reads all the entries with a single stream read and then splits them into input and output
+		virtual unsigned int read_batch(
+			unsigned int entry_count,
+			void * input_elems,
+			float * output_elems);
+
 		virtual bool raw_read(std::vector<unsigned char>& all_elems);
 
 		virtual layer_configuration_specific get_input_configuration() const
@@ -59,6 +65,11 @@ namespace nnforge
 			return type_code;
 		}
 
+		virtual std::vector<std::pair<float, float> > get_input_mul_add_list() const
+		{
+			return input_mul_add_list;
+		}
+
 		virtual unsigned int get_entry_count() const
 		{
 			return entry_count;
@@ -76,11 +87,14 @@ namespace nnforge
 		layer_configuration_specific input_configuration;
 		layer_configuration_specific output_configuration;
 		neuron_data_type::input_type type_code;
+		std::vector<std::pair<float, float> > input_mul_add_list;
 		unsigned int entry_count;
 
 		unsigned int entry_read_count;
 		std::istream::pos_type reset_pos;
 
+		std::vector<unsigned char> batch_buf;
+
 	private:
 		supervised_data_stream_reader(const supervised_data_stream_reader&);
 		supervised_data_stream_reader& operator =(const supervised_data_stream_reader&);
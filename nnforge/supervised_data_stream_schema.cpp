@@ -25,4 +25,12 @@ namespace nnforge
 	, 0x44, 0x51
 	, 0x86, 0x72
 	, 0xc2, 0xd7, 0x0, 0xa1, 0x9b, 0x3e };
+
+	// {FF479761-60A0-40BC-A84E-A0F6F300A29C}
+	const boost::uuids::uuid supervised_data_stream_schema::supervised_data_stream_v2_guid =
+	{ 0xff, 0x47, 0x97, 0x61
+	, 0x60, 0xa0
+	, 0x40, 0xbc
+	, 0xa8, 0x4e
+	, 0xa0, 0xf6, 0xf3, 0x0, 0xa2, 0x9c };
 }
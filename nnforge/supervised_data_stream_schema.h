@@ -25,6 +25,9 @@ namespace nnforge
 	public:
 		static const boost::uuids::uuid supervised_data_stream_guid;
 
+		// Entries are grouped into blocks compressed separately, see supervised_compressed_data_stream_writer
+		static const boost::uuids::uuid supervised_data_stream_v2_guid;
+
 	private:
 		supervised_data_stream_schema();
 		supervised_data_stream_schema(const supervised_data_stream_schema&);
@@ -26,13 +26,20 @@ namespace nnforge
 		nnforge_shared_ptr<std::ostream> output_stream,
 		const layer_configuration_specific& input_configuration,
 		const layer_configuration_specific& output_configuration,
-		neuron_data_type::input_type type_code)
-		: out_stream(output_stream), entry_count(0), type_code(type_code)
+		neuron_data_type::input_type type_code,
+		const std::vector<std::pair<float, float> >& input_mul_add_list)
+		: out_stream(output_stream), entry_count(0), type_code(type_code), input_mul_add_list(input_mul_add_list)
 	{
+		if ((type_code == neuron_data_type::type_uint8_scaled) && (input_mul_add_list.size() != input_configuration.feature_map_count))
+			throw neural_network_exception((boost::format("%1% mult-add pairs specified for %2% input feature maps") % input_mul_add_list.size() % input_configuration.feature_map_count).str());
+
 		out_stream->exceptions(std::ostream::failbit | std::ostream::badbit);
 
 		input_neuron_count = input_configuration.get_neuron_count();
 		output_neuron_count = output_configuration.get_neuron_count();
+		neuron_count_per_input_feature_map = input_configuration.get_neuron_count_per_feature_map();
+		if (type_code != neuron_data_type::type_unknown)
+			input_elem_size = neuron_data_type::get_input_size(type_code);
 
 		out_stream->write(reinterpret_cast<const char*>(supervised_data_stream_schema::supervised_data_stream_guid.data), sizeof(supervised_data_stream_schema::supervised_data_stream_guid.data));
 
@@ -43,6 +50,9 @@ namespace nnforge
 		type_code_pos = out_stream->tellp();
 		out_stream->write(reinterpret_cast<const char*>(&type_code), sizeof(type_code));
 
+		if (type_code == neuron_data_type::type_uint8_scaled)
+			neuron_data_type::write_mul_add_list(*out_stream, input_mul_add_list);
+
 		entry_count_pos = out_stream->tellp();
 		out_stream->write(reinterpret_cast<const char*>(&entry_count), sizeof(entry_count));
 	}
@@ -74,6 +84,9 @@ namespace nnforge
 	{
 		if (this->type_code == neuron_data_type::type_unknown)
 		{
+			if (type_code == neuron_data_type::type_uint8_scaled)
+				throw neural_network_exception("type_uint8_scaled should be specified when creating supervised_data_stream_writer");
+
 			this->type_code = type_code;
 			input_elem_size = neuron_data_type::get_input_size(this->type_code);
 		}
@@ -111,10 +124,35 @@ namespace nnforge
 			type_code = neuron_data_type::type_float;
 			input_elem_size = neuron_data_type::get_input_size(type_code);
 		}
-		else if (type_code != neuron_data_type::type_float)
-			throw neural_network_exception((boost::format("Cannot write elements with different input type: %1% %2%") % type_code % neuron_data_type::type_float).str());
 
-		out_stream->write(reinterpret_cast<const char*>(input_neurons), input_elem_size * input_neuron_count);
+		switch (type_code)
+		{
+		case neuron_data_type::type_float:
+			out_stream->write(reinterpret_cast<const char*>(input_neurons), input_elem_size * input_neuron_count);
+			break;
+		case neuron_data_type::type_half:
+			{
+				converted_input_buf.resize(input_elem_size * input_neuron_count);
+				unsigned short * dst = reinterpret_cast<unsigned short *>(&(*converted_input_buf.begin()));
+				for(unsigned int i = 0; i < input_neuron_count; ++i)
+					dst[i] = neuron_data_type::float_to_half(input_neurons[i]);
+				out_stream->write(reinterpret_cast<const char*>(&(*converted_input_buf.begin())), converted_input_buf.size());
+			}
+			break;
+		case neuron_data_type::type_uint8_scaled:
+			{
+				converted_input_buf.resize(input_elem_size * input_neuron_count);
+				unsigned char * dst = &(*converted_input_buf.begin());
+				const float * src = input_neurons;
+				for(std::vector<std::pair<float, float> >::const_iterator it = input_mul_add_list.begin(); it != input_mul_add_list.end(); ++it)
+					for(unsigned int i = 0; i < neuron_count_per_input_feature_map; ++i)
+						*(dst++) = neuron_data_type::float_to_uint8_scaled(*(src++), *it);
+				out_stream->write(reinterpret_cast<const char*>(&(*converted_input_buf.begin())), converted_input_buf.size());
+			}
+			break;
+		default:
+			throw neural_network_exception((boost::format("Cannot write elements with different input type: %1% %2%") % type_code % neuron_data_type::type_float).str());
+		}
 		out_stream->write(reinterpret_cast<const char*>(output_neurons), sizeof(*output_neurons) * output_neuron_count);
 		entry_count++;
 	}
@@ -129,4 +167,16 @@ namespace nnforge
 		out_stream->write(reinterpret_cast<const char*>(all_entry_data), data_length);
 		entry_count++;
 	}
+
+	void supervised_data_stream_writer::raw_write_batch(
+		const void * all_entry_data,
+		size_t entry_size,
+		unsigned int entry_count)
+	{
+		if (type_code == neuron_data_type::type_unknown)
+			throw neural_network_exception("Type for input elements is not specified for supervised_data_stream_writer");
+
+		out_stream->write(reinterpret_cast<const char*>(all_entry_data), entry_size * entry_count);
+		this->entry_count += entry_count;
+	}
 }
@@ -32,11 +32,13 @@ namespace nnforge
 	public:
 		// The constructor modifies output_stream to throw exceptions in case of failure
 		// The stream should be created with std::ios_base::binary flag
+		// type_uint8_scaled should be specified here, along with (mult, add) pair for each input feature map
 		supervised_data_stream_writer(
 			nnforge_shared_ptr<std::ostream> output_stream,
 			const layer_configuration_specific& input_configuration,
 			const layer_configuration_specific& output_configuration,
-			neuron_data_type::input_type type_code = neuron_data_type::type_unknown);
+			neuron_data_type::input_type type_code = neuron_data_type::type_unknown,
+			const std::vector<std::pair<float, float> >& input_mul_add_list = std::vector<std::pair<float, float> >());
 
 		virtual ~supervised_data_stream_writer();
 
@@ -45,6 +47,7 @@ namespace nnforge
 			const void * input_neurons,
 			const float * output_neurons);
 
+		// Input neurons are converted if the writer is created with type_half or type_uint8_scaled
 		void write(
 			const float * input_neurons,
 			const float * output_neurons);
@@ -57,6 +60,11 @@ namespace nnforge
 			const void * all_entry_data,
 			size_t data_length);
 
+		virtual void raw_write_batch(
+			const void * all_entry_data,
+			size_t entry_size,
+			unsigned int entry_count);
+
 	private:
 		nnforge_shared_ptr<std::ostream> out_stream;
 		unsigned int input_neuron_count;
@@ -69,6 +77,10 @@ namespace nnforge
 		std::ostream::pos_type entry_count_pos;
 		unsigned int entry_count;
 
+		unsigned int neuron_count_per_input_feature_map;
+		std::vector<std::pair<float, float> > input_mul_add_list;
+		std::vector<unsigned char> converted_input_buf;
+
 	private:
 		supervised_data_stream_writer(const supervised_data_stream_writer&);
 		supervised_data_stream_writer& operator =(const supervised_data_stream_writer&);
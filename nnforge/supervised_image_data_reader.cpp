@@ -0,0 +1,266 @@
+/*
+ *  Copyright 2011-2014 Maxim Milakov
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+
+#include "supervised_image_data_reader.h"
+
+#include "neural_network_exception.h"
+
+#include <algorithm>
+#include <cstring>
+#include <boost/bind.hpp>
+#include <boost/format.hpp>
+#include <boost/thread/locks.hpp>
+#include <opencv2/core/core.hpp>
+#include <opencv2/highgui/highgui.hpp>
+#include <opencv2/imgproc/imgproc.hpp>
+
+namespace nnforge
+{
+	supervised_image_data_reader::supervised_image_data_reader(
+		varying_data_stream_reader_smart_ptr original_reader,
+		const layer_configuration_specific& input_configuration,
+		const layer_configuration_specific& output_configuration,
+		unsigned int worker_count,
+		unsigned int queue_entry_count)
+		: original_reader(original_reader)
+		, input_configuration(input_configuration)
+		, output_configuration(output_configuration)
+		, worker_count(std::max(worker_count, 1U))
+		, started(false)
+		, stop_requested(false)
+		, entry_read_count(0)
+	{
+		if (input_configuration.dimension_sizes.size() != 2)
+			throw neural_network_exception((boost::format("supervised_image_data_reader is unable to read images into %1%D input") % input_configuration.dimension_sizes.size()).str());
+		if ((input_configuration.feature_map_count != 1) && (input_configuration.feature_map_count != 3))
+			throw neural_network_exception((boost::format("supervised_image_data_reader is unable to read images into %1% feature maps") % input_configuration.feature_map_count).str());
+
+		slot_list.resize(std::max(queue_entry_count, this->worker_count));
+		for(std::vector<queue_slot>::iterator it = slot_list.begin(); it != slot_list.end(); ++it)
+		{
+			it->input.resize(input_configuration.get_neuron_count());
+			it->output.resize(output_configuration.get_neuron_count());
+		}
+	}
+
+	supervised_image_data_reader::~supervised_image_data_reader()
+	{
+		stop();
+	}
+
+	bool supervised_image_data_reader::read(
+		void * input_elems,
+		float * output_elems)
+	{
+		if (entry_read_count >= get_entry_count())
+			return false;
+
+		if (!started)
+			start();
+
+		queue_slot& slot = slot_list[entry_read_count % slot_list.size()];
+		{
+			boost::unique_lock<boost::mutex> lock(mtx);
+			while (error.empty() && ((slot.state != slot_state_decoded) || (slot.entry_id != entry_read_count)))
+				slot_state_changed.wait(lock);
+
+			if (!error.empty())
+				throw neural_network_exception(error);
+		}
+
+		if (input_elems != 0)
+			memcpy(input_elems, &(*slot.input.begin()), slot.input.size());
+		if (output_elems != 0)
+			memcpy(output_elems, &(*slot.output.begin()), slot.output.size() * sizeof(float));
+
+		{
+			boost::lock_guard<boost::mutex> lock(mtx);
+			slot.state = slot_state_free;
+			slot.entry_id += static_cast<unsigned int>(slot_list.size());
+			++entry_read_count;
+		}
+		slot_state_changed.notify_all();
+
+		return true;
+	}
+
+	void supervised_image_data_reader::start()
+	{
+		// Slot (id % slot count) receives entries with IDs id, id + slot count, ... in turn
+		for(unsigned int i = 0; i < slot_list.size(); ++i)
+		{
+			queue_slot& slot = slot_list[(entry_read_count + i) % slot_list.size()];
+			slot.state = slot_state_free;
+			slot.entry_id = entry_read_count + i;
+		}
+		stop_requested = false;
+		error.clear();
+
+		for(unsigned int worker_id = 0; worker_id < worker_count; ++worker_id)
+			thread_list.push_back(nnforge_shared_ptr<boost::thread>(new boost::thread(boost::bind(&supervised_image_data_reader::decode_entries, this, worker_id, entry_read_count))));
+
+		started = true;
+	}
+
+	void supervised_image_data_reader::stop()
+	{
+		{
+			boost::lock_guard<boost::mutex> lock(mtx);
+			stop_requested = true;
+		}
+		slot_state_changed.notify_all();
+
+		for(std::vector<nnforge_shared_ptr<boost::thread> >::iterator it = thread_list.begin(); it != thread_list.end(); ++it)
+			(*it)->join();
+		thread_list.clear();
+
+		started = false;
+	}
+
+	void supervised_image_data_reader::decode_entries(
+		unsigned int worker_id,
+		unsigned int first_entry_id)
+	{
+		try
+		{
+			const unsigned int entry_count = get_entry_count();
+			std::vector<unsigned char> entry_data;
+			for(unsigned int entry_id = first_entry_id + worker_id; entry_id < entry_count; entry_id += worker_count)
+			{
+				queue_slot& slot = slot_list[entry_id % slot_list.size()];
+				{
+					boost::unique_lock<boost::mutex> lock(mtx);
+					while ((!stop_requested) && ((slot.state != slot_state_free) || (slot.entry_id != entry_id)))
+						slot_state_changed.wait(lock);
+					if (stop_requested)
+						return;
+				}
+
+				{
+					boost::lock_guard<boost::mutex> lock(original_reader_mtx);
+					original_reader->raw_read(entry_id, entry_data);
+				}
+
+				decode_entry(entry_data, slot);
+
+				{
+					boost::lock_guard<boost::mutex> lock(mtx);
+					slot.state = slot_state_decoded;
+				}
+				slot_state_changed.notify_all();
+			}
+		}
+		catch (const std::exception& e)
+		{
+			set_error(e.what());
+		}
+	}
+
+	void supervised_image_data_reader::decode_entry(
+		const std::vector<unsigned char>& entry_data,
+		queue_slot& slot) const
+	{
+		const size_t output_size = slot.output.size() * sizeof(float);
+		if (entry_data.size() <= output_size)
+			throw neural_network_exception((boost::format("Entry %1% of %2% bytes contains no image") % slot.entry_id % entry_data.size()).str());
+
+		memcpy(&(*slot.output.begin()), &(*entry_data.begin()), output_size);
+
+		const int width = static_cast<int>(input_configuration.dimension_sizes[0]);
+		const int height = static_cast<int>(input_configuration.dimension_sizes[1]);
+		const bool is_color = (input_configuration.feature_map_count == 3);
+
+		cv::Mat encoded_image(1, static_cast<int>(entry_data.size() - output_size), CV_8UC1, const_cast<unsigned char *>(&(*(entry_data.begin() + output_size))));
+		cv::Mat image = cv::imdecode(encoded_image, is_color ? CV_LOAD_IMAGE_COLOR : CV_LOAD_IMAGE_GRAYSCALE);
+		if (image.empty())
+			throw neural_network_exception((boost::format("Unable to decode image of entry %1%") % slot.entry_id).str());
+
+		if ((image.cols != width) || (image.rows != height))
+		{
+			cv::Mat image_resized;
+			cv::resize(image, image_resized, cv::Size(width, height));
+			image = image_resized;
+		}
+
+		const int plane_size = width * height;
+		unsigned char * dst = &(*slot.input.begin());
+		for(int y = 0; y < height; ++y)
+		{
+			const unsigned char * src = image.ptr<unsigned char>(y);
+			if (is_color)
+			{
+				// OpenCV stores pixels as BGR
+				for(int x = 0; x < width; ++x, src += 3)
+				{
+					dst[y * width + x] = src[2];
+					dst[plane_size + y * width + x] = src[1];
+					dst[plane_size * 2 + y * width + x] = src[0];
+				}
+			}
+			else
+				memcpy(dst + y * width, src, width);
+		}
+	}
+
+	void supervised_image_data_reader::set_error(const std::string& message)
+	{
+		{
+			boost::lock_guard<boost::mutex> lock(mtx);
+			if (error.empty())
+				error = message;
+		}
+		slot_state_changed.notify_all();
+	}
+
+	bool supervised_image_data_reader::raw_read(std::vector<unsigned char>& all_elems)
+	{
+		const size_t input_size = input_configuration.get_neuron_count();
+		all_elems.resize(input_size + output_configuration.get_neuron_count() * sizeof(float));
+		return read(&(*all_elems.begin()), reinterpret_cast<float *>(&(*(all_elems.begin() + input_size))));
+	}
+
+	void supervised_image_data_reader::rewind(unsigned int entry_id)
+	{
+		stop();
+		entry_read_count = entry_id;
+	}
+
+	void supervised_image_data_reader::reset()
+	{
+		rewind(0);
+	}
+
+	layer_configuration_specific supervised_image_data_reader::get_input_configuration() const
+	{
+		return input_configuration;
+	}
+
+	layer_configuration_specific supervised_image_data_reader::get_output_configuration() const
+	{
+		return output_configuration;
+	}
+
+	neuron_data_type::input_type supervised_image_data_reader::get_input_type() const
+	{
+		return neuron_data_type::type_byte;
+	}
+
+	unsigned int supervised_image_data_reader::get_entry_count() const
+	{
+		return original_reader->get_entry_count();
+	}
+}
@@ -0,0 +1,123 @@
+/*
+ *  Copyright 2011-2014 Maxim Milakov
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+
+#pragma once
+
+#include "supervised_data_reader.h"
+#include "varying_data_stream_reader.h"
+#include "nn_types.h"
+
+#include <vector>
+#include <string>
+#include <boost/thread/thread.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/condition_variable.hpp>
+
+namespace nnforge
+{
+	// Reads entries of varying data stream, each of them being output neurons (float each) followed by the image
+	// encoded in any format OpenCV decodes, JPEG and PNG included. Images are decoded by worker threads into the bounded queue,
+	// entry i by worker (i % worker_count), resized to the input configuration if they have different size
+	// and split into planes: red, green and blue for 3 input feature maps, grayscale for 1 feature map.
+	// Input neurons are bytes, so the reader might be followed by the same transformers as the readers of .sdt files
+	class supervised_image_data_reader : public supervised_data_reader
+	{
+	public:
+		// Input configuration should be 2D with 1 or 3 feature maps
+		supervised_image_data_reader(
+			varying_data_stream_reader_smart_ptr original_reader,
+			const layer_configuration_specific& input_configuration,
+			const layer_configuration_specific& output_configuration,
+			unsigned int worker_count,
+			unsigned int queue_entry_count);
+
+		virtual ~supervised_image_data_reader();
+
+		// The method should return true in case entry is read and false if there is no more entries available (and no entry is read in this case)
+		// If any parameter is null the method should just discard corresponding data
+		virtual bool read(
+			void * input_elems,
+			float * output_elems);
+
+		// Returns decoded input neurons followed by output neurons, the same way supervised_data_stream_reader does
+		virtual bool raw_read(std::vector<unsigned char>& all_elems);
+
+		virtual void rewind(unsigned int entry_id);
+
+		virtual void reset();
+
+		virtual layer_configuration_specific get_input_configuration() const;
+
+		virtual layer_configuration_specific get_output_configuration() const;
+
+		virtual neuron_data_type::input_type get_input_type() const;
+
+		virtual unsigned int get_entry_count() const;
+
+	protected:
+		enum slot_state
+		{
+			slot_state_free,
+			slot_state_decoded
+		};
+
+		struct queue_slot
+		{
+			slot_state state;
+			// The entry to be decoded into the slot next, or decoded there if the state is slot_state_decoded
+			unsigned int entry_id;
+			std::vector<unsigned char> input;
+			std::vector<float> output;
+		};
+
+		void start();
+
+		void stop();
+
+		void decode_entries(
+			unsigned int worker_id,
+			unsigned int first_entry_id);
+
+		void decode_entry(
+			const std::vector<unsigned char>& entry_data,
+			queue_slot& slot) const;
+
+		void set_error(const std::string& message);
+
+		varying_data_stream_reader_smart_ptr original_reader;
+		layer_configuration_specific input_configuration;
+		layer_configuration_specific output_configuration;
+		unsigned int worker_count;
+
+		std::vector<queue_slot> slot_list;
+
+		// Guards original_reader, which workers read entries from
+		boost::mutex original_reader_mtx;
+
+		boost::mutex mtx;
+		boost::condition_variable slot_state_changed;
+		std::vector<nnforge_shared_ptr<boost::thread> > thread_list;
+		bool started;
+		bool stop_requested;
+		unsigned int entry_read_count;
+		std::string error;
+
+	private:
+		supervised_image_data_reader(const supervised_image_data_reader&);
+		supervised_image_data_reader& operator =(const supervised_image_data_reader&);
+	};
+}
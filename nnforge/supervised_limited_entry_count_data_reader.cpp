@@ -17,6 +17,7 @@
 #include "supervised_limited_entry_count_data_reader.h"
 
 #include <cstring>
+#include <algorithm>
 
 namespace nnforge
 {
@@ -79,11 +80,31 @@ namespace nnforge
 		return original_reader->get_input_type();
 	}
 
+	std::vector<std::pair<float, float> > supervised_limited_entry_count_data_reader::get_input_mul_add_list() const
+	{
+		return original_reader->get_input_mul_add_list();
+	}
+
 	void supervised_limited_entry_count_data_reader::rewind(unsigned int entry_id)
 	{
 		original_reader->rewind(entry_id);
 	}
 
+	unsigned int supervised_limited_entry_count_data_reader::read_batch(
+		unsigned int entry_count,
+		void * input_elems,
+		float * output_elems)
+	{
+		unsigned int entries_to_read = std::min(entry_count, std::min(max_entry_count, original_reader->get_entry_count()) - entry_read_count);
+		if (entries_to_read == 0)
+			return 0;
+
+		unsigned int entries_read = original_reader->read_batch(entries_to_read, input_elems, output_elems);
+		entry_read_count += entries_read;
+
+		return entries_read;
+	}
+
 	bool supervised_limited_entry_count_data_reader::raw_read(std::vector<unsigned char>& all_elems)
 	{
 		if (!entry_available())
@@ -17,6 +17,7 @@
 #include "supervised_multiple_epoch_data_reader.h"
 
 #include <cstring>
+#include <algorithm>
 
 namespace nnforge
 {
@@ -65,6 +66,9 @@ namespace nnforge
 	void supervised_multiple_epoch_data_reader::next_epoch()
 	{
 		epoch_id = (epoch_id + 1) % epoch_count;
+		// The whole set is passed, let the original reader change the order if it is able to
+		if (epoch_id == 0)
+			original_reader->next_epoch();
 		start_original_entry_id = (static_cast<unsigned long long>(epoch_id) * original_reader->get_entry_count()) / epoch_count;
 		local_entry_count = (static_cast<unsigned long long>(epoch_id + 1) * original_reader->get_entry_count()) / epoch_count - start_original_entry_id;
 		entry_read_count = 0;
@@ -91,11 +95,31 @@ namespace nnforge
 		return original_reader->get_input_type();
 	}
 
+	std::vector<std::pair<float, float> > supervised_multiple_epoch_data_reader::get_input_mul_add_list() const
+	{
+		return original_reader->get_input_mul_add_list();
+	}
+
 	void supervised_multiple_epoch_data_reader::rewind(unsigned int entry_id)
 	{
 		original_reader->rewind(start_original_entry_id + entry_id);
 	}
 
+	unsigned int supervised_multiple_epoch_data_reader::read_batch(
+		unsigned int entry_count,
+		void * input_elems,
+		float * output_elems)
+	{
+		unsigned int entries_to_read = std::min(entry_count, local_entry_count - entry_read_count);
+		if (entries_to_read == 0)
+			return 0;
+
+		unsigned int entries_read = original_reader->read_batch(entries_to_read, input_elems, output_elems);
+		entry_read_count += entries_read;
+
+		return entries_read;
+	}
+
 	bool supervised_multiple_epoch_data_reader::raw_read(std::vector<unsigned char>& all_elems)
 	{
 		if (!entry_available())
@@ -37,6 +37,11 @@ namespace nnforge
 			void * input_elems,
 			float * output_elems);
 
+		virtual unsigned int read_batch(
+			unsigned int entry_count,
+			void * input_elems,
+			float * output_elems);
+
 		virtual bool raw_read(std::vector<unsigned char>& all_elems);
 
 		virtual void rewind(unsigned int entry_id);
@@ -51,6 +56,8 @@ namespace nnforge
 
 		virtual neuron_data_type::input_type get_input_type() const;
 
+		virtual std::vector<std::pair<float, float> > get_input_mul_add_list() const;
+
 		virtual unsigned int get_entry_count() const;
 
 	protected:
@@ -0,0 +1,174 @@
+/*
+ *  Copyright 2011-2014 Maxim Milakov
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include "supervised_parallel_data_writer.h"
+
+#include "neural_network_exception.h"
+
+#include <algorithm>
+#include <cstring>
+#include <boost/format.hpp>
+#include <boost/bind.hpp>
+#include <boost/thread/locks.hpp>
+
+namespace nnforge
+{
+	const unsigned int supervised_parallel_data_writer::default_queue_entry_count = 4096;
+
+	supervised_parallel_data_writer::supervised_parallel_data_writer(
+		data_writer_smart_ptr underlying_writer,
+		const layer_configuration_specific& input_configuration,
+		const layer_configuration_specific& output_configuration,
+		neuron_data_type::input_type type_code,
+		unsigned int queue_entry_count)
+		: underlying_writer(underlying_writer)
+		, queue_entry_count(std::max(queue_entry_count, 1U))
+		, next_sequence_id(0)
+		, write_count(0)
+		, finish_requested(false)
+	{
+		input_size = neuron_data_type::get_input_size(type_code) * input_configuration.get_neuron_count();
+		output_size = sizeof(float) * output_configuration.get_neuron_count();
+		entry_size = input_size + output_size;
+
+		queue_data.resize(entry_size * this->queue_entry_count);
+		slot_filled_list.resize(this->queue_entry_count, false);
+
+		writing_thread = nnforge_shared_ptr<boost::thread>(new boost::thread(boost::bind(&supervised_parallel_data_writer::write_entries, this)));
+	}
+
+	supervised_parallel_data_writer::~supervised_parallel_data_writer()
+	{
+		try
+		{
+			finish();
+		}
+		catch (...)
+		{
+		}
+	}
+
+	void supervised_parallel_data_writer::write(
+		unsigned int sequence_id,
+		const void * input_neurons,
+		const float * output_neurons)
+	{
+		unsigned int slot_id = sequence_id % queue_entry_count;
+		{
+			boost::unique_lock<boost::mutex> lock(mtx);
+			if (sequence_id < next_sequence_id)
+				throw neural_network_exception((boost::format("Entry %1% is written to supervised_parallel_data_writer twice") % sequence_id).str());
+			while (error.empty() && (sequence_id - next_sequence_id >= queue_entry_count))
+				queue_changed.wait(lock);
+
+			if (!error.empty())
+				throw neural_network_exception(error);
+			if (slot_filled_list[slot_id])
+				throw neural_network_exception((boost::format("Entry %1% is written to supervised_parallel_data_writer twice") % sequence_id).str());
+		}
+
+		// The slot is owned by this entry until it is marked filled
+		unsigned char * dst = &(*queue_data.begin()) + slot_id * entry_size;
+		memcpy(dst, input_neurons, input_size);
+		memcpy(dst + input_size, output_neurons, output_size);
+
+		{
+			boost::lock_guard<boost::mutex> lock(mtx);
+			slot_filled_list[slot_id] = true;
+			++write_count;
+		}
+		queue_changed.notify_all();
+	}
+
+	void supervised_parallel_data_writer::abort(const std::string& message)
+	{
+		set_error(message);
+	}
+
+	void supervised_parallel_data_writer::finish()
+	{
+		if (!writing_thread)
+			return;
+
+		{
+			boost::lock_guard<boost::mutex> lock(mtx);
+			finish_requested = true;
+		}
+		queue_changed.notify_all();
+
+		writing_thread->join();
+		writing_thread.reset();
+
+		if (!error.empty())
+			throw neural_network_exception(error);
+	}
+
+	void supervised_parallel_data_writer::write_entries()
+	{
+		try
+		{
+			while (true)
+			{
+				unsigned int first_slot_id;
+				unsigned int entry_count;
+				{
+					boost::unique_lock<boost::mutex> lock(mtx);
+					first_slot_id = next_sequence_id % queue_entry_count;
+					while (error.empty() && (!slot_filled_list[first_slot_id]) && (!finish_requested))
+						queue_changed.wait(lock);
+
+					if (!error.empty())
+						return;
+					if (!slot_filled_list[first_slot_id])
+					{
+						// Finish is requested, all the producers are done
+						if (write_count != next_sequence_id)
+							throw neural_network_exception((boost::format("Entry %1% is not written to supervised_parallel_data_writer while %2% entries are") % next_sequence_id % write_count).str());
+						return;
+					}
+
+					// Consecutive entries are contiguous in the ring up to its end
+					entry_count = 1;
+					while ((first_slot_id + entry_count < queue_entry_count) && slot_filled_list[first_slot_id + entry_count])
+						++entry_count;
+				}
+
+				underlying_writer->raw_write_batch(&(*queue_data.begin()) + first_slot_id * entry_size, entry_size, entry_count);
+
+				{
+					boost::lock_guard<boost::mutex> lock(mtx);
+					std::fill(slot_filled_list.begin() + first_slot_id, slot_filled_list.begin() + first_slot_id + entry_count, false);
+					next_sequence_id += entry_count;
+				}
+				queue_changed.notify_all();
+			}
+		}
+		catch (const std::exception& e)
+		{
+			set_error(e.what());
+		}
+	}
+
+	void supervised_parallel_data_writer::set_error(const std::string& message)
+	{
+		{
+			boost::lock_guard<boost::mutex> lock(mtx);
+			if (error.empty())
+				error = message;
+		}
+		queue_changed.notify_all();
+	}
+}
@@ -0,0 +1,96 @@
+/*
+ *  Copyright 2011-2014 Maxim Milakov
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#pragma once
+
+#include "data_writer.h"
+#include "layer_configuration_specific.h"
+#include "neuron_data_type.h"
+#include "nn_types.h"
+
+#include <vector>
+#include <string>
+#include <boost/thread/thread.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/condition_variable.hpp>
+
+namespace nnforge
+{
+	// Accepts entries from several producer threads and writes them to the underlying writer on a background thread
+	// in the order of their sequence numbers, which should be 0, 1, 2, ... without gaps.
+	// Entry with sequence number seq goes to slot (seq % queue_entry_count) of the ring, the producer waits while the slot is taken
+	// by entry (seq - queue_entry_count). Consecutive entries queued are passed to the underlying writer with a single raw_write_batch call.
+	// Pass supervised_compressed_data_stream_writer as the underlying writer to compress the data
+	class supervised_parallel_data_writer
+	{
+	public:
+		// Entries are written in the layout of underlying_writer raw_write, with input data of type_code
+		supervised_parallel_data_writer(
+			data_writer_smart_ptr underlying_writer,
+			const layer_configuration_specific& input_configuration,
+			const layer_configuration_specific& output_configuration,
+			neuron_data_type::input_type type_code,
+			unsigned int queue_entry_count = default_queue_entry_count);
+
+		// Calls finish, errors are ignored
+		~supervised_parallel_data_writer();
+
+		// Might be called from several threads concurrently. Rethrows the error the background thread encountered
+		void write(
+			unsigned int sequence_id,
+			const void * input_neurons,
+			const float * output_neurons);
+
+		// Makes pending and subsequent write and finish calls throw with message.
+		// A producer which fails to produce its entry should call it, otherwise other producers might wait for the entry forever
+		void abort(const std::string& message);
+
+		// Waits for all the entries to be passed to the underlying writer and stops the background thread.
+		// Should be called once all the producers are done, throws if some sequence numbers are missing
+		void finish();
+
+		static const unsigned int default_queue_entry_count;
+
+	private:
+		void write_entries();
+
+		void set_error(const std::string& message);
+
+		data_writer_smart_ptr underlying_writer;
+		size_t input_size;
+		size_t output_size;
+		size_t entry_size;
+		unsigned int queue_entry_count;
+
+		std::vector<unsigned char> queue_data;
+		std::vector<bool> slot_filled_list;
+		// Sequence number of the next entry to pass to the underlying writer
+		unsigned int next_sequence_id;
+		unsigned int write_count;
+
+		boost::mutex mtx;
+		boost::condition_variable queue_changed;
+		nnforge_shared_ptr<boost::thread> writing_thread;
+		bool finish_requested;
+		std::string error;
+
+	private:
+		supervised_parallel_data_writer(const supervised_parallel_data_writer&);
+		supervised_parallel_data_writer& operator =(const supervised_parallel_data_writer&);
+	};
+
+	typedef nnforge_shared_ptr<supervised_parallel_data_writer> supervised_parallel_data_writer_smart_ptr;
+}
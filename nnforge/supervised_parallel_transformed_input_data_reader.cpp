@@ -0,0 +1,343 @@
+/*
+ *  Copyright 2011-2014 Maxim Milakov
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include "supervised_parallel_transformed_input_data_reader.h"
+
+#include "neural_network_exception.h"
+
+#include <algorithm>
+#include <cstring>
+#include <boost/bind.hpp>
+#include <boost/thread/locks.hpp>
+
+namespace nnforge
+{
+	supervised_parallel_transformed_input_data_reader::supervised_parallel_transformed_input_data_reader(
+		supervised_data_reader_smart_ptr original_reader,
+		const std::vector<data_transformer_smart_ptr>& transformer_list,
+		unsigned int worker_count,
+		unsigned int queue_entry_count,
+		unsigned int seed)
+		: original_reader(original_reader)
+		, transformer_list(transformer_list)
+		, worker_count(std::max(worker_count, 1U))
+		, seed_generator(rnd::get_random_generator(seed))
+		, total_sample_count(1)
+		, started(false)
+		, stop_requested(false)
+		, original_entries_finished(false)
+		, fed_entry_count(0)
+		, consumed_entry_count(0)
+	{
+		config_list.push_back(original_reader->get_input_configuration());
+		type_list.push_back(original_reader->get_input_type());
+		size_t max_input_size = config_list.back().get_neuron_count() * neuron_data_type::get_input_size(type_list.back());
+		for(std::vector<data_transformer_smart_ptr>::const_iterator it = transformer_list.begin(); it != transformer_list.end(); ++it)
+		{
+			if (!(*it)->clone(0))
+				throw neural_network_exception("Transformer cannot be cloned and cannot be applied in parallel");
+
+			config_list.push_back((*it)->get_transformed_configuration(config_list.back()));
+			type_list.push_back((*it)->get_transformed_data_type(type_list.back()));
+			sample_count_list.push_back((*it)->get_sample_count());
+			total_sample_count *= sample_count_list.back();
+			max_input_size = std::max(max_input_size, config_list.back().get_neuron_count() * neuron_data_type::get_input_size(type_list.back()));
+		}
+		output_size = original_reader->get_output_configuration().get_neuron_count();
+
+		slot_list.resize(std::max(queue_entry_count, this->worker_count));
+		for(std::vector<queue_slot>::iterator it = slot_list.begin(); it != slot_list.end(); ++it)
+		{
+			it->state = slot_state_free;
+			it->entry_id = 0;
+			it->original_input.resize(config_list.front().get_neuron_count() * neuron_data_type::get_input_size(type_list.front()));
+			it->transformed_input.resize(config_list.back().get_neuron_count() * neuron_data_type::get_input_size(type_list.back()));
+			it->output.resize(output_size);
+		}
+
+		worker_transformer_list.resize(this->worker_count);
+		worker_buffer_list.resize(this->worker_count * 2, std::vector<unsigned char>(max_input_size));
+
+		draw_epoch_seeds();
+	}
+
+	supervised_parallel_transformed_input_data_reader::~supervised_parallel_transformed_input_data_reader()
+	{
+		stop();
+	}
+
+	bool supervised_parallel_transformed_input_data_reader::read(
+		void * input_elems,
+		float * output_elems)
+	{
+		if (!started)
+			start();
+
+		queue_slot& slot = slot_list[consumed_entry_count % slot_list.size()];
+		{
+			boost::unique_lock<boost::mutex> lock(mtx);
+			while (error.empty()
+				&& ((slot.state != slot_state_transformed) || (slot.entry_id != consumed_entry_count))
+				&& !(original_entries_finished && (consumed_entry_count >= fed_entry_count)))
+				slot_state_changed.wait(lock);
+
+			if (!error.empty())
+				throw neural_network_exception(error);
+
+			if ((slot.state != slot_state_transformed) || (slot.entry_id != consumed_entry_count))
+				return false;
+		}
+
+		if (input_elems != 0)
+			memcpy(input_elems, &(*slot.transformed_input.begin()), slot.transformed_input.size());
+		if (output_elems != 0)
+			memcpy(output_elems, &(*slot.output.begin()), output_size * sizeof(float));
+
+		{
+			boost::lock_guard<boost::mutex> lock(mtx);
+			slot.state = slot_state_free;
+			++consumed_entry_count;
+		}
+		slot_state_changed.notify_all();
+
+		return true;
+	}
+
+	void supervised_parallel_transformed_input_data_reader::start()
+	{
+		std::vector<unsigned int>::const_iterator seed_it = epoch_seed_list.begin();
+		for(unsigned int worker_id = 0; worker_id < worker_count; ++worker_id)
+		{
+			worker_transformer_list[worker_id].clear();
+			for(std::vector<data_transformer_smart_ptr>::const_iterator it = transformer_list.begin(); it != transformer_list.end(); ++it, ++seed_it)
+				worker_transformer_list[worker_id].push_back((*it)->clone(*seed_it));
+		}
+
+		for(std::vector<queue_slot>::iterator it = slot_list.begin(); it != slot_list.end(); ++it)
+			it->state = slot_state_free;
+		stop_requested = false;
+		original_entries_finished = false;
+		fed_entry_count = 0;
+		consumed_entry_count = 0;
+		error.clear();
+
+		thread_list.push_back(nnforge_shared_ptr<boost::thread>(new boost::thread(boost::bind(&supervised_parallel_transformed_input_data_reader::feed, this))));
+		for(unsigned int worker_id = 0; worker_id < worker_count; ++worker_id)
+			thread_list.push_back(nnforge_shared_ptr<boost::thread>(new boost::thread(boost::bind(&supervised_parallel_transformed_input_data_reader::transform_entries, this, worker_id))));
+
+		started = true;
+	}
+
+	void supervised_parallel_transformed_input_data_reader::draw_epoch_seeds()
+	{
+		epoch_seed_list.resize(worker_count * transformer_list.size());
+		for(std::vector<unsigned int>::iterator it = epoch_seed_list.begin(); it != epoch_seed_list.end(); ++it)
+			*it = static_cast<unsigned int>(seed_generator());
+	}
+
+	void supervised_parallel_transformed_input_data_reader::stop()
+	{
+		{
+			boost::lock_guard<boost::mutex> lock(mtx);
+			stop_requested = true;
+		}
+		slot_state_changed.notify_all();
+
+		for(std::vector<nnforge_shared_ptr<boost::thread> >::iterator it = thread_list.begin(); it != thread_list.end(); ++it)
+			(*it)->join();
+		thread_list.clear();
+
+		started = false;
+	}
+
+	void supervised_parallel_transformed_input_data_reader::feed()
+	{
+		try
+		{
+			std::vector<unsigned char> original_input(slot_list.front().original_input.size());
+			std::vector<float> output(output_size);
+			for(unsigned int entry_id = 0; ; ++entry_id)
+			{
+				if ((entry_id % total_sample_count) == 0)
+				{
+					if (!original_reader->read(&(*original_input.begin()), &(*output.begin())))
+						break;
+				}
+
+				queue_slot& slot = slot_list[entry_id % slot_list.size()];
+				{
+					boost::unique_lock<boost::mutex> lock(mtx);
+					while ((!stop_requested) && (slot.state != slot_state_free))
+						slot_state_changed.wait(lock);
+					if (stop_requested)
+						return;
+				}
+
+				slot.entry_id = entry_id;
+				std::copy(original_input.begin(), original_input.end(), slot.original_input.begin());
+				std::copy(output.begin(), output.end(), slot.output.begin());
+
+				{
+					boost::lock_guard<boost::mutex> lock(mtx);
+					slot.state = slot_state_original;
+					fed_entry_count = entry_id + 1;
+				}
+				slot_state_changed.notify_all();
+			}
+		}
+		catch (const std::exception& e)
+		{
+			set_error(e.what());
+			return;
+		}
+
+		{
+			boost::lock_guard<boost::mutex> lock(mtx);
+			original_entries_finished = true;
+		}
+		slot_state_changed.notify_all();
+	}
+
+	void supervised_parallel_transformed_input_data_reader::transform_entries(unsigned int worker_id)
+	{
+		try
+		{
+			for(unsigned int entry_id = worker_id; ; entry_id += worker_count)
+			{
+				queue_slot& slot = slot_list[entry_id % slot_list.size()];
+				{
+					boost::unique_lock<boost::mutex> lock(mtx);
+					while ((!stop_requested)
+						&& ((slot.state != slot_state_original) || (slot.entry_id != entry_id))
+						&& !(original_entries_finished && (entry_id >= fed_entry_count)))
+						slot_state_changed.wait(lock);
+					if (stop_requested || ((slot.state != slot_state_original) || (slot.entry_id != entry_id)))
+						return;
+				}
+
+				transform_entry(worker_id, slot);
+
+				{
+					boost::lock_guard<boost::mutex> lock(mtx);
+					slot.state = slot_state_transformed;
+				}
+				slot_state_changed.notify_all();
+			}
+		}
+		catch (const std::exception& e)
+		{
+			set_error(e.what());
+		}
+	}
+
+	void supervised_parallel_transformed_input_data_reader::transform_entry(
+		unsigned int worker_id,
+		queue_slot& slot)
+	{
+		std::vector<unsigned int> sample_id_list(transformer_list.size());
+		{
+			unsigned int sample_id = slot.entry_id % total_sample_count;
+			for(int i = static_cast<int>(transformer_list.size()) - 1; i >= 0; --i)
+			{
+				sample_id_list[i] = sample_id % sample_count_list[i];
+				sample_id /= sample_count_list[i];
+			}
+		}
+
+		const unsigned char * src = &(*slot.original_input.begin());
+		for(unsigned int i = 0; i < transformer_list.size(); ++i)
+		{
+			unsigned char * dst = (i == transformer_list.size() - 1) ? &(*slot.transformed_input.begin()) : &(*worker_buffer_list[worker_id * 2 + (i % 2)].begin());
+			data_transformer& transformer = *worker_transformer_list[worker_id][i];
+			if (transformer.is_in_place())
+			{
+				memcpy(dst, src, config_list[i].get_neuron_count() * neuron_data_type::get_input_size(type_list[i]));
+				transformer.transform(0, dst, type_list[i], config_list[i], sample_id_list[i]);
+			}
+			else
+				transformer.transform(src, dst, type_list[i], config_list[i], sample_id_list[i]);
+			src = dst;
+		}
+
+		if (transformer_list.empty())
+			memcpy(&(*slot.transformed_input.begin()), src, slot.transformed_input.size());
+	}
+
+	void supervised_parallel_transformed_input_data_reader::set_error(const std::string& message)
+	{
+		{
+			boost::lock_guard<boost::mutex> lock(mtx);
+			if (error.empty())
+				error = message;
+		}
+		slot_state_changed.notify_all();
+	}
+
+	void supervised_parallel_transformed_input_data_reader::reset()
+	{
+		stop();
+		for(std::vector<data_transformer_smart_ptr>::iterator it = transformer_list.begin(); it != transformer_list.end(); ++it)
+			(*it)->reset();
+		original_reader->reset();
+	}
+
+	void supervised_parallel_transformed_input_data_reader::next_epoch()
+	{
+		stop();
+		for(std::vector<data_transformer_smart_ptr>::iterator it = transformer_list.begin(); it != transformer_list.end(); ++it)
+			(*it)->reset();
+		draw_epoch_seeds();
+		original_reader->next_epoch();
+	}
+
+	layer_configuration_specific supervised_parallel_transformed_input_data_reader::get_input_configuration() const
+	{
+		return config_list.back();
+	}
+
+	layer_configuration_specific supervised_parallel_transformed_input_data_reader::get_output_configuration() const
+	{
+		return original_reader->get_output_configuration();
+	}
+
+	unsigned int supervised_parallel_transformed_input_data_reader::get_entry_count() const
+	{
+		return original_reader->get_entry_count() * total_sample_count;
+	}
+
+	neuron_data_type::input_type supervised_parallel_transformed_input_data_reader::get_input_type() const
+	{
+		return type_list.back();
+	}
+
+	std::vector<std::pair<float, float> > supervised_parallel_transformed_input_data_reader::get_input_mul_add_list() const
+	{
+		if (type_list.back() != type_list.front())
+			return std::vector<std::pair<float, float> >();
+
+		return original_reader->get_input_mul_add_list();
+	}
+
+	void supervised_parallel_transformed_input_data_reader::rewind(unsigned int entry_id)
+	{
+		throw std::runtime_error("rewind not implemented for supervised_parallel_transformed_input_data_reader");
+	}
+
+	bool supervised_parallel_transformed_input_data_reader::raw_read(std::vector<unsigned char>& all_elems)
+	{
+		throw std::runtime_error("raw_read not implemented for supervised_parallel_transformed_input_data_reader");
+	}
+}
@@ -0,0 +1,137 @@
+/*
+ *  Copyright 2011-2014 Maxim Milakov
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#pragma once
+
+#include "supervised_data_reader.h"
+#include "data_transformer.h"
+#include "rnd.h"
+#include "nn_types.h"
+
+#include <vector>
+#include <string>
+#include <boost/thread/thread.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/condition_variable.hpp>
+
+namespace nnforge
+{
+	// Applies the chain of transformers to the input data with worker threads, the same way the chain of
+	// supervised_transformed_input_data_reader objects does. Entries are read from the original reader by a separate thread
+	// into the bounded queue, entry i is transformed by worker (i % worker_count) with its own copies of transformers,
+	// their random generators are seeded with the seeds drawn from seed for the current epoch each time the reading starts.
+	// The result is reproducible for fixed seed and worker count, reset repeats the entries of the epoch, next_epoch draws new seeds
+	class supervised_parallel_transformed_input_data_reader : public supervised_data_reader
+	{
+	public:
+		supervised_parallel_transformed_input_data_reader(
+			supervised_data_reader_smart_ptr original_reader,
+			const std::vector<data_transformer_smart_ptr>& transformer_list,
+			unsigned int worker_count,
+			unsigned int queue_entry_count,
+			unsigned int seed);
+
+		virtual ~supervised_parallel_transformed_input_data_reader();
+
+		// The method should return true in case entry is read and false if there is no more entries available (and no entry is read in this case)
+		// If any parameter is null the method should just discard corresponding data
+		virtual bool read(
+			void * input_elems,
+			float * output_elems);
+
+		virtual bool raw_read(std::vector<unsigned char>& all_elems);
+
+		virtual void rewind(unsigned int entry_id);
+
+		virtual void reset();
+
+		virtual void next_epoch();
+
+		virtual layer_configuration_specific get_input_configuration() const;
+
+		virtual layer_configuration_specific get_output_configuration() const;
+
+		virtual neuron_data_type::input_type get_input_type() const;
+
+		virtual std::vector<std::pair<float, float> > get_input_mul_add_list() const;
+
+		virtual unsigned int get_entry_count() const;
+
+	protected:
+		enum slot_state
+		{
+			slot_state_free,
+			slot_state_original,
+			slot_state_transformed
+		};
+
+		struct queue_slot
+		{
+			slot_state state;
+			unsigned int entry_id;
+			std::vector<unsigned char> original_input;
+			std::vector<unsigned char> transformed_input;
+			std::vector<float> output;
+		};
+
+		void start();
+
+		void draw_epoch_seeds();
+
+		void stop();
+
+		void feed();
+
+		void transform_entries(unsigned int worker_id);
+
+		void transform_entry(
+			unsigned int worker_id,
+			queue_slot& slot);
+
+		void set_error(const std::string& message);
+
+		supervised_data_reader_smart_ptr original_reader;
+		std::vector<data_transformer_smart_ptr> transformer_list;
+		unsigned int worker_count;
+		random_generator seed_generator;
+		std::vector<unsigned int> epoch_seed_list;
+
+		// Input configuration and type of each transformer, the last elements are for the transformed data
+		std::vector<layer_configuration_specific> config_list;
+		std::vector<neuron_data_type::input_type> type_list;
+		std::vector<unsigned int> sample_count_list;
+		unsigned int total_sample_count;
+		size_t output_size;
+
+		std::vector<queue_slot> slot_list;
+		std::vector<std::vector<data_transformer_smart_ptr> > worker_transformer_list;
+		std::vector<std::vector<unsigned char> > worker_buffer_list;
+
+		boost::mutex mtx;
+		boost::condition_variable slot_state_changed;
+		std::vector<nnforge_shared_ptr<boost::thread> > thread_list;
+		bool started;
+		bool stop_requested;
+		bool original_entries_finished;
+		unsigned int fed_entry_count;
+		unsigned int consumed_entry_count;
+		std::string error;
+
+	private:
+		supervised_parallel_transformed_input_data_reader(const supervised_parallel_transformed_input_data_reader&);
+		supervised_parallel_transformed_input_data_reader& operator =(const supervised_parallel_transformed_input_data_reader&);
+	};
+}
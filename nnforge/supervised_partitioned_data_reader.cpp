@@ -0,0 +1,134 @@
+/*
+ *  Copyright 2011-2014 Maxim Milakov
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include "supervised_partitioned_data_reader.h"
+
+#include "neural_network_exception.h"
+
+#include <algorithm>
+#include <boost/format.hpp>
+
+namespace nnforge
+{
+	supervised_partitioned_data_reader::supervised_partitioned_data_reader(
+		supervised_data_reader_smart_ptr original_reader,
+		unsigned int partition_id,
+		unsigned int partition_count)
+		: original_reader(original_reader)
+	{
+		if (partition_id >= partition_count)
+			throw neural_network_exception((boost::format("Invalid partition %1% of %2%") % partition_id % partition_count).str());
+
+		const unsigned int base_entry_count = original_reader->get_entry_count() / partition_count;
+		const unsigned int extended_partition_count = original_reader->get_entry_count() % partition_count;
+		local_entry_count = base_entry_count + ((partition_id < extended_partition_count) ? 1 : 0);
+		start_original_entry_id = partition_id * base_entry_count + std::min(partition_id, extended_partition_count);
+		entry_read_count = 0;
+		original_reader->rewind(start_original_entry_id);
+	}
+
+	supervised_partitioned_data_reader::supervised_partitioned_data_reader()
+	{
+	}
+
+	supervised_partitioned_data_reader::~supervised_partitioned_data_reader()
+	{
+	}
+
+	bool supervised_partitioned_data_reader::entry_available()
+	{
+		return (entry_read_count < local_entry_count);
+	}
+
+	bool supervised_partitioned_data_reader::read(
+		void * input_elems,
+		float * output_elems)
+	{
+		if (!entry_available())
+			return false;
+
+		++entry_read_count;
+		return original_reader->read(input_elems, output_elems);
+	}
+
+	unsigned int supervised_partitioned_data_reader::read_batch(
+		unsigned int entry_count,
+		void * input_elems,
+		float * output_elems)
+	{
+		unsigned int entries_to_read = std::min(entry_count, local_entry_count - entry_read_count);
+		if (entries_to_read == 0)
+			return 0;
+
+		unsigned int entries_read = original_reader->read_batch(entries_to_read, input_elems, output_elems);
+		entry_read_count += entries_read;
+
+		return entries_read;
+	}
+
+	void supervised_partitioned_data_reader::reset()
+	{
+		entry_read_count = 0;
+		original_reader->rewind(start_original_entry_id);
+	}
+
+	void supervised_partitioned_data_reader::next_epoch()
+	{
+		original_reader->next_epoch();
+		entry_read_count = 0;
+		original_reader->rewind(start_original_entry_id);
+	}
+
+	layer_configuration_specific supervised_partitioned_data_reader::get_input_configuration() const
+	{
+		return original_reader->get_input_configuration();
+	}
+
+	layer_configuration_specific supervised_partitioned_data_reader::get_output_configuration() const
+	{
+		return original_reader->get_output_configuration();
+	}
+
+	unsigned int supervised_partitioned_data_reader::get_entry_count() const
+	{
+		return local_entry_count;
+	}
+
+	neuron_data_type::input_type supervised_partitioned_data_reader::get_input_type() const
+	{
+		return original_reader->get_input_type();
+	}
+
+	std::vector<std::pair<float, float> > supervised_partitioned_data_reader::get_input_mul_add_list() const
+	{
+		return original_reader->get_input_mul_add_list();
+	}
+
+	void supervised_partitioned_data_reader::rewind(unsigned int entry_id)
+	{
+		entry_read_count = entry_id;
+		original_reader->rewind(start_original_entry_id + entry_id);
+	}
+
+	bool supervised_partitioned_data_reader::raw_read(std::vector<unsigned char>& all_elems)
+	{
+		if (!entry_available())
+			return false;
+
+		++entry_read_count;
+		return original_reader->raw_read(all_elems);
+	}
+}
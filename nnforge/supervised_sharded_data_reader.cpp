@@ -0,0 +1,366 @@
+/*
+ *  Copyright 2011-2014 Maxim Milakov
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include "supervised_sharded_data_reader.h"
+
+#include "neural_network_exception.h"
+
+#include <algorithm>
+#include <cstring>
+#include <boost/format.hpp>
+#include <boost/bind.hpp>
+#include <boost/thread/locks.hpp>
+#include <boost/filesystem/fstream.hpp>
+
+namespace nnforge
+{
+	supervised_sharded_data_reader::supervised_sharded_data_reader(
+		const std::vector<supervised_data_reader_smart_ptr>& shard_reader_list,
+		unsigned int worker_count,
+		unsigned int queue_entry_count,
+		bool shuffle_shards,
+		unsigned int seed)
+		: shard_reader_list(shard_reader_list)
+		, worker_count(std::max(worker_count, 1U))
+		, queue_entry_count(std::max(queue_entry_count, 1U))
+		, shuffle_shards(shuffle_shards)
+		, seed_generator(rnd::get_random_generator(seed))
+		, started(false)
+		, stop_requested(false)
+		, entry_read_count(0)
+		, first_shard_pos(0)
+		, current_shard_pos(0)
+	{
+		if (shard_reader_list.empty())
+			throw neural_network_exception("No shards specified for sharded data reader");
+
+		supervised_data_reader& first_reader = *shard_reader_list.front();
+		for(unsigned int i = 1; i < shard_reader_list.size(); ++i)
+		{
+			supervised_data_reader& reader = *shard_reader_list[i];
+			if ((!(reader.get_input_configuration() == first_reader.get_input_configuration()))
+				|| (!(reader.get_output_configuration() == first_reader.get_output_configuration()))
+				|| (reader.get_input_type() != first_reader.get_input_type())
+				|| (reader.get_input_mul_add_list() != first_reader.get_input_mul_add_list()))
+				throw neural_network_exception((boost::format("Shard %1% has configuration or input type different from that of shard 0") % i).str());
+		}
+
+		input_entry_size = first_reader.get_input_neuron_elem_size() * first_reader.get_input_configuration().get_neuron_count();
+		output_neuron_count = first_reader.get_output_configuration().get_neuron_count();
+		entry_size = input_entry_size + output_neuron_count * sizeof(float);
+
+		entry_count = 0;
+		for(std::vector<supervised_data_reader_smart_ptr>::const_iterator it = shard_reader_list.begin(); it != shard_reader_list.end(); ++it)
+			entry_count += (*it)->get_entry_count();
+
+		queue_list.resize(std::min(this->worker_count, static_cast<unsigned int>(shard_reader_list.size())));
+		this->worker_count = static_cast<unsigned int>(queue_list.size());
+		for(std::vector<worker_queue>::iterator it = queue_list.begin(); it != queue_list.end(); ++it)
+			it->data.resize(entry_size * this->queue_entry_count);
+
+		epoch_seed = static_cast<unsigned int>(seed_generator());
+		prepare_epoch();
+	}
+
+	supervised_sharded_data_reader::~supervised_sharded_data_reader()
+	{
+		stop();
+	}
+
+	std::vector<boost::filesystem::path> supervised_sharded_data_reader::get_shard_path_list(
+		const boost::filesystem::path& folder,
+		const std::string& shard_spec)
+	{
+		std::vector<boost::filesystem::path> res;
+
+		boost::filesystem::path spec_path = folder / shard_spec;
+		if (boost::filesystem::is_regular_file(spec_path))
+		{
+			boost::filesystem::ifstream in(spec_path);
+			std::string line;
+			while (std::getline(in, line))
+			{
+				std::string::size_type last = line.find_last_not_of(" \t\r\n");
+				if (last == std::string::npos)
+					continue;
+				line.erase(last + 1);
+				std::string::size_type first = line.find_first_not_of(" \t");
+				if (line[first] == '#')
+					continue;
+
+				boost::filesystem::path shard_path = line.substr(first);
+				if (!shard_path.is_absolute())
+					shard_path = spec_path.parent_path() / shard_path;
+				res.push_back(shard_path);
+			}
+		}
+		else
+		{
+			boost::filesystem::path shard_folder = spec_path.parent_path();
+			std::string pattern = spec_path.filename().string();
+			std::string expression_str;
+			for(std::string::const_iterator it = pattern.begin(); it != pattern.end(); ++it)
+			{
+				if (*it == '*')
+					expression_str += ".*";
+				else if (*it == '?')
+					expression_str += ".";
+				else
+				{
+					if (strchr("\\^$.|+()[]{}", *it) != 0)
+						expression_str += '\\';
+					expression_str += *it;
+				}
+			}
+			nnforge_regex expression(expression_str);
+
+			if (boost::filesystem::is_directory(shard_folder))
+			{
+				for(boost::filesystem::directory_iterator it = boost::filesystem::directory_iterator(shard_folder); it != boost::filesystem::directory_iterator(); it++)
+				{
+					boost::filesystem::path file_path = it->path();
+					std::string file_name = file_path.filename().string();
+					if (boost::filesystem::is_regular_file(file_path) && nnforge_regex_match(file_name, expression))
+						res.push_back(file_path);
+				}
+			}
+			std::sort(res.begin(), res.end());
+		}
+
+		if (res.empty())
+			throw neural_network_exception((boost::format("No shards found for %1%") % spec_path.string()).str());
+
+		return res;
+	}
+
+	void supervised_sharded_data_reader::prepare_epoch()
+	{
+		unsigned int shard_count = static_cast<unsigned int>(shard_reader_list.size());
+		shard_id_list.resize(shard_count);
+		for(unsigned int i = 0; i < shard_count; ++i)
+			shard_id_list[i] = i;
+		if (shuffle_shards)
+		{
+			random_generator gen = rnd::get_random_generator(epoch_seed);
+			for(unsigned int i = shard_count; i > 1; --i)
+			{
+				nnforge_uniform_int_distribution<unsigned int> dist(0, i - 1);
+				std::swap(shard_id_list[i - 1], shard_id_list[dist(gen)]);
+			}
+		}
+
+		shard_end_entry_id_list.resize(shard_count);
+		unsigned int end_entry_id = 0;
+		for(unsigned int i = 0; i < shard_count; ++i)
+		{
+			end_entry_id += shard_reader_list[shard_id_list[i]]->get_entry_count();
+			shard_end_entry_id_list[i] = end_entry_id;
+		}
+	}
+
+	bool supervised_sharded_data_reader::entry_available()
+	{
+		return (entry_read_count < entry_count);
+	}
+
+	bool supervised_sharded_data_reader::read(
+		void * input_elems,
+		float * output_elems)
+	{
+		if (!entry_available())
+			return false;
+
+		if (!started)
+			start();
+
+		while (entry_read_count >= shard_end_entry_id_list[current_shard_pos])
+			++current_shard_pos;
+
+		worker_queue& queue = queue_list[(current_shard_pos - first_shard_pos) % worker_count];
+		{
+			boost::unique_lock<boost::mutex> lock(mtx);
+			while (error.empty() && (queue.pushed_count == queue.popped_count))
+				queue_changed.wait(lock);
+
+			if (!error.empty())
+				throw neural_network_exception(error);
+		}
+
+		const unsigned char * src = &(*queue.data.begin()) + (queue.popped_count % queue_entry_count) * entry_size;
+		if (input_elems)
+			memcpy(input_elems, src, input_entry_size);
+		if (output_elems)
+			memcpy(output_elems, src + input_entry_size, output_neuron_count * sizeof(float));
+
+		{
+			boost::lock_guard<boost::mutex> lock(mtx);
+			++queue.popped_count;
+		}
+		queue_changed.notify_all();
+
+		++entry_read_count;
+
+		return true;
+	}
+
+	bool supervised_sharded_data_reader::raw_read(std::vector<unsigned char>& all_elems)
+	{
+		if (!entry_available())
+			return false;
+
+		all_elems.resize(entry_size);
+		return read(&(*all_elems.begin()), reinterpret_cast<float *>(&(*(all_elems.begin() + input_entry_size))));
+	}
+
+	void supervised_sharded_data_reader::rewind(unsigned int entry_id)
+	{
+		stop();
+
+		entry_read_count = entry_id;
+	}
+
+	void supervised_sharded_data_reader::reset()
+	{
+		rewind(0);
+	}
+
+	void supervised_sharded_data_reader::next_epoch()
+	{
+		stop();
+
+		for(std::vector<supervised_data_reader_smart_ptr>::iterator it = shard_reader_list.begin(); it != shard_reader_list.end(); ++it)
+			(*it)->next_epoch();
+
+		epoch_seed = static_cast<unsigned int>(seed_generator());
+		prepare_epoch();
+		entry_read_count = 0;
+	}
+
+	void supervised_sharded_data_reader::start()
+	{
+		first_shard_pos = static_cast<unsigned int>(std::upper_bound(shard_end_entry_id_list.begin(), shard_end_entry_id_list.end(), entry_read_count) - shard_end_entry_id_list.begin());
+		current_shard_pos = first_shard_pos;
+		unsigned int first_shard_entry_id = entry_read_count - ((first_shard_pos > 0) ? shard_end_entry_id_list[first_shard_pos - 1] : 0);
+
+		for(std::vector<worker_queue>::iterator it = queue_list.begin(); it != queue_list.end(); ++it)
+		{
+			it->pushed_count = 0;
+			it->popped_count = 0;
+		}
+		stop_requested = false;
+		error.clear();
+
+		for(unsigned int worker_id = 0; worker_id < worker_count; ++worker_id)
+			thread_list.push_back(nnforge_shared_ptr<boost::thread>(new boost::thread(boost::bind(&supervised_sharded_data_reader::read_shards, this, worker_id, first_shard_pos, first_shard_entry_id))));
+
+		started = true;
+	}
+
+	void supervised_sharded_data_reader::stop()
+	{
+		{
+			boost::lock_guard<boost::mutex> lock(mtx);
+			stop_requested = true;
+		}
+		queue_changed.notify_all();
+
+		for(std::vector<nnforge_shared_ptr<boost::thread> >::iterator it = thread_list.begin(); it != thread_list.end(); ++it)
+			(*it)->join();
+		thread_list.clear();
+
+		started = false;
+	}
+
+	void supervised_sharded_data_reader::read_shards(
+		unsigned int worker_id,
+		unsigned int first_shard_pos,
+		unsigned int first_shard_entry_id)
+	{
+		try
+		{
+			worker_queue& queue = queue_list[worker_id];
+			const unsigned int shard_count = static_cast<unsigned int>(shard_id_list.size());
+			for(unsigned int shard_pos = first_shard_pos + worker_id; shard_pos < shard_count; shard_pos += worker_count)
+			{
+				unsigned int shard_id = shard_id_list[shard_pos];
+				supervised_data_reader& reader = *shard_reader_list[shard_id];
+				unsigned int shard_entry_id = (shard_pos == first_shard_pos) ? first_shard_entry_id : 0;
+				reader.rewind(shard_entry_id);
+
+				for(unsigned int shard_entry_count = reader.get_entry_count(); shard_entry_id < shard_entry_count; ++shard_entry_id)
+				{
+					{
+						boost::unique_lock<boost::mutex> lock(mtx);
+						while ((!stop_requested) && (queue.pushed_count - queue.popped_count == queue_entry_count))
+							queue_changed.wait(lock);
+						if (stop_requested)
+							return;
+					}
+
+					// The consumer doesn't touch the entry until it is pushed
+					unsigned char * dst = &(*queue.data.begin()) + (queue.pushed_count % queue_entry_count) * entry_size;
+					if (!reader.read(dst, reinterpret_cast<float *>(dst + input_entry_size)))
+						throw neural_network_exception((boost::format("Shard %1% has fewer entries than reported") % shard_id).str());
+
+					{
+						boost::lock_guard<boost::mutex> lock(mtx);
+						++queue.pushed_count;
+					}
+					queue_changed.notify_all();
+				}
+			}
+		}
+		catch (const std::exception& e)
+		{
+			set_error(e.what());
+		}
+	}
+
+	void supervised_sharded_data_reader::set_error(const std::string& message)
+	{
+		{
+			boost::lock_guard<boost::mutex> lock(mtx);
+			if (error.empty())
+				error = message;
+		}
+		queue_changed.notify_all();
+	}
+
+	layer_configuration_specific supervised_sharded_data_reader::get_input_configuration() const
+	{
+		return shard_reader_list.front()->get_input_configuration();
+	}
+
+	layer_configuration_specific supervised_sharded_data_reader::get_output_configuration() const
+	{
+		return shard_reader_list.front()->get_output_configuration();
+	}
+
+	neuron_data_type::input_type supervised_sharded_data_reader::get_input_type() const
+	{
+		return shard_reader_list.front()->get_input_type();
+	}
+
+	std::vector<std::pair<float, float> > supervised_sharded_data_reader::get_input_mul_add_list() const
+	{
+		return shard_reader_list.front()->get_input_mul_add_list();
+	}
+
+	unsigned int supervised_sharded_data_reader::get_entry_count() const
+	{
+		return entry_count;
+	}
+}
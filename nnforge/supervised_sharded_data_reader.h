@@ -0,0 +1,137 @@
+/*
+ *  Copyright 2011-2014 Maxim Milakov
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#pragma once
+
+#include "supervised_data_reader.h"
+#include "rnd.h"
+#include "nn_types.h"
+
+#include <vector>
+#include <string>
+#include <boost/filesystem.hpp>
+#include <boost/thread/thread.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/condition_variable.hpp>
+
+namespace nnforge
+{
+	// Presents entries of several shard readers as a single reader, shards are read one after another.
+	// Shards are assigned to worker threads round-robin in the current order and read ahead of the consumer,
+	// each worker having its own queue of queue_entry_count entries, so the next shards are read in parallel with the current one.
+	// Entry IDs are global in the current shard order. Shard order is shuffled on next_epoch if shuffle_shards is set,
+	// and is kept on reset. Shard readers should support rewind
+	class supervised_sharded_data_reader : public supervised_data_reader
+	{
+	public:
+		supervised_sharded_data_reader(
+			const std::vector<supervised_data_reader_smart_ptr>& shard_reader_list,
+			unsigned int worker_count,
+			unsigned int queue_entry_count,
+			bool shuffle_shards,
+			unsigned int seed);
+
+		virtual ~supervised_sharded_data_reader();
+
+		// shard_spec is either the name of a manifest file in folder, listing shard paths one per line,
+		// or a file name pattern with * and ? wildcards, optionally prefixed with subfolder of folder.
+		// Relative paths in the manifest are relative to its folder, empty lines and lines starting with # are skipped.
+		// Files matched by the pattern are sorted by name
+		static std::vector<boost::filesystem::path> get_shard_path_list(
+			const boost::filesystem::path& folder,
+			const std::string& shard_spec);
+
+		virtual bool read(
+			void * input_elems,
+			float * output_elems);
+
+		virtual bool raw_read(std::vector<unsigned char>& all_elems);
+
+		virtual void rewind(unsigned int entry_id);
+
+		virtual void reset();
+
+		virtual void next_epoch();
+
+		virtual layer_configuration_specific get_input_configuration() const;
+
+		virtual layer_configuration_specific get_output_configuration() const;
+
+		virtual neuron_data_type::input_type get_input_type() const;
+
+		virtual std::vector<std::pair<float, float> > get_input_mul_add_list() const;
+
+		virtual unsigned int get_entry_count() const;
+
+	protected:
+		struct worker_queue
+		{
+			std::vector<unsigned char> data;
+			unsigned int pushed_count;
+			unsigned int popped_count;
+		};
+
+		bool entry_available();
+
+		// Draws shard order of the current epoch
+		void prepare_epoch();
+
+		void start();
+
+		void stop();
+
+		void read_shards(
+			unsigned int worker_id,
+			unsigned int first_shard_pos,
+			unsigned int first_shard_entry_id);
+
+		void set_error(const std::string& message);
+
+	protected:
+		std::vector<supervised_data_reader_smart_ptr> shard_reader_list;
+		unsigned int worker_count;
+		unsigned int queue_entry_count;
+		bool shuffle_shards;
+		size_t input_entry_size;
+		unsigned int output_neuron_count;
+		size_t entry_size;
+		unsigned int entry_count;
+
+		random_generator seed_generator;
+		unsigned int epoch_seed;
+		std::vector<unsigned int> shard_id_list;
+		// shard_end_entry_id_list[pos] is the global ID of the entry following the last entry of the shard at position pos
+		std::vector<unsigned int> shard_end_entry_id_list;
+
+		std::vector<worker_queue> queue_list;
+		boost::mutex mtx;
+		boost::condition_variable queue_changed;
+		std::vector<nnforge_shared_ptr<boost::thread> > thread_list;
+		bool started;
+		bool stop_requested;
+		std::string error;
+
+		unsigned int entry_read_count;
+		unsigned int first_shard_pos;
+		unsigned int current_shard_pos;
+
+	private:
+		supervised_sharded_data_reader(const supervised_sharded_data_reader&);
+		supervised_sharded_data_reader& operator =(const supervised_sharded_data_reader&);
+	};
+
+	typedef nnforge_shared_ptr<supervised_sharded_data_reader> supervised_sharded_data_reader_smart_ptr;
+}
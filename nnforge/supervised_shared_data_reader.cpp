@@ -0,0 +1,95 @@
+/*
+ *  Copyright 2011-2014 Maxim Milakov
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include "supervised_shared_data_reader.h"
+
+#include "supervised_data_sharer.h"
+
+#include <stdexcept>
+
+namespace nnforge
+{
+	supervised_shared_data_reader::supervised_shared_data_reader(
+		supervised_data_sharer& sharer,
+		unsigned int consumer_id)
+		: sharer(sharer)
+		, consumer_id(consumer_id)
+	{
+	}
+
+	supervised_shared_data_reader::~supervised_shared_data_reader()
+	{
+	}
+
+	bool supervised_shared_data_reader::read(
+		void * input_elems,
+		float * output_elems)
+	{
+		return (sharer.read(consumer_id, 1, input_elems, output_elems) == 1);
+	}
+
+	unsigned int supervised_shared_data_reader::read_batch(
+		unsigned int entry_count,
+		void * input_elems,
+		float * output_elems)
+	{
+		return sharer.read(consumer_id, entry_count, input_elems, output_elems);
+	}
+
+	void supervised_shared_data_reader::reset()
+	{
+		sharer.reset(consumer_id);
+	}
+
+	void supervised_shared_data_reader::next_epoch()
+	{
+	}
+
+	layer_configuration_specific supervised_shared_data_reader::get_input_configuration() const
+	{
+		return sharer.get_original_reader().get_input_configuration();
+	}
+
+	layer_configuration_specific supervised_shared_data_reader::get_output_configuration() const
+	{
+		return sharer.get_original_reader().get_output_configuration();
+	}
+
+	neuron_data_type::input_type supervised_shared_data_reader::get_input_type() const
+	{
+		return sharer.get_original_reader().get_input_type();
+	}
+
+	std::vector<std::pair<float, float> > supervised_shared_data_reader::get_input_mul_add_list() const
+	{
+		return sharer.get_original_reader().get_input_mul_add_list();
+	}
+
+	unsigned int supervised_shared_data_reader::get_entry_count() const
+	{
+		return sharer.get_original_reader().get_entry_count();
+	}
+
+	void supervised_shared_data_reader::rewind(unsigned int entry_id)
+	{
+		throw std::runtime_error("rewind not implemented for supervised_shared_data_reader");
+	}
+
+	bool supervised_shared_data_reader::raw_read(std::vector<unsigned char>& all_elems)
+	{
+		throw std::runtime_error("raw_read not implemented for supervised_shared_data_reader");
+	}
+}
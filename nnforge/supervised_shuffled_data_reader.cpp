@@ -0,0 +1,212 @@
+/*
+ *  Copyright 2011-2014 Maxim Milakov
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+
+#include "supervised_shuffled_data_reader.h"
+
+#include "neural_network_exception.h"
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <boost/format.hpp>
+
+namespace nnforge
+{
+	supervised_shuffled_data_reader::supervised_shuffled_data_reader(
+		supervised_data_reader_smart_ptr original_reader,
+		unsigned int block_entry_count,
+		unsigned int window_block_count,
+		unsigned int seed)
+		: original_reader(original_reader)
+		, block_entry_count(std::max(block_entry_count, 1U))
+		, window_block_count(std::max(window_block_count, 1U))
+		, seed_generator(rnd::get_random_generator(seed))
+		, entry_read_count(0)
+	{
+		input_entry_size = original_reader->get_input_neuron_elem_size() * original_reader->get_input_configuration().get_neuron_count();
+		output_neuron_count = original_reader->get_output_configuration().get_neuron_count();
+		entry_count = original_reader->get_entry_count();
+
+		epoch_seed = static_cast<unsigned int>(seed_generator());
+		prepare_epoch();
+	}
+
+	supervised_shuffled_data_reader::~supervised_shuffled_data_reader()
+	{
+	}
+
+	void supervised_shuffled_data_reader::prepare_epoch()
+	{
+		random_generator gen = rnd::get_random_generator(epoch_seed);
+
+		unsigned int block_count = (entry_count + block_entry_count - 1) / block_entry_count;
+		block_id_list.resize(block_count);
+		for(unsigned int i = 0; i < block_count; ++i)
+			block_id_list[i] = i;
+		for(unsigned int i = block_count; i > 1; --i)
+		{
+			nnforge_uniform_int_distribution<unsigned int> dist(0, i - 1);
+			std::swap(block_id_list[i - 1], block_id_list[dist(gen)]);
+		}
+
+		// The last block might be shorter, so windows containing it are shorter as well
+		window_start_entry_id_list.clear();
+		unsigned int window_start_entry_id = 0;
+		for(unsigned int i = 0; i < block_count; ++i)
+		{
+			if (i % window_block_count == 0)
+				window_start_entry_id_list.push_back(window_start_entry_id);
+			window_start_entry_id += std::min(block_entry_count, entry_count - block_id_list[i] * block_entry_count);
+		}
+
+		loaded_window_id = std::numeric_limits<unsigned int>::max();
+	}
+
+	unsigned int supervised_shuffled_data_reader::get_window_entry_id(unsigned int entry_id)
+	{
+		unsigned int window_id = static_cast<unsigned int>(std::upper_bound(window_start_entry_id_list.begin(), window_start_entry_id_list.end(), entry_id) - window_start_entry_id_list.begin()) - 1;
+
+		if (window_id != loaded_window_id)
+		{
+			unsigned int start_block_index = window_id * window_block_count;
+			unsigned int end_block_index = std::min(start_block_index + window_block_count, static_cast<unsigned int>(block_id_list.size()));
+			unsigned int window_entry_count = ((window_id + 1 < window_start_entry_id_list.size()) ? window_start_entry_id_list[window_id + 1] : entry_count) - window_start_entry_id_list[window_id];
+
+			window_input_elems.resize(input_entry_size * window_entry_count);
+			window_output_elems.resize(output_neuron_count * window_entry_count);
+			unsigned int entries_loaded = 0;
+			for(unsigned int block_index = start_block_index; block_index < end_block_index; ++block_index)
+			{
+				unsigned int start_original_entry_id = block_id_list[block_index] * block_entry_count;
+				unsigned int block_size = std::min(block_entry_count, entry_count - start_original_entry_id);
+				original_reader->rewind(start_original_entry_id);
+				unsigned int entries_read = original_reader->read_batch(
+					block_size,
+					&(*(window_input_elems.begin() + input_entry_size * entries_loaded)),
+					&(*(window_output_elems.begin() + output_neuron_count * entries_loaded)));
+				if (entries_read != block_size)
+					throw neural_network_exception((boost::format("Only %1% entries of %2% read from the block starting at entry %3%") % entries_read % block_size % start_original_entry_id).str());
+				entries_loaded += block_size;
+			}
+
+			random_generator gen = rnd::get_random_generator(epoch_seed + window_id + 1);
+			window_entry_id_list.resize(window_entry_count);
+			for(unsigned int i = 0; i < window_entry_count; ++i)
+				window_entry_id_list[i] = i;
+			for(unsigned int i = window_entry_count; i > 1; --i)
+			{
+				nnforge_uniform_int_distribution<unsigned int> dist(0, i - 1);
+				std::swap(window_entry_id_list[i - 1], window_entry_id_list[dist(gen)]);
+			}
+
+			loaded_window_id = window_id;
+		}
+
+		return window_entry_id_list[entry_id - window_start_entry_id_list[window_id]];
+	}
+
+	bool supervised_shuffled_data_reader::read(
+		void * input_elems,
+		float * output_elems)
+	{
+		if (entry_read_count >= entry_count)
+			return false;
+
+		unsigned int window_entry_id = get_window_entry_id(entry_read_count);
+		if (input_elems)
+			memcpy(input_elems, &(*(window_input_elems.begin() + input_entry_size * window_entry_id)), input_entry_size);
+		if (output_elems)
+			memcpy(output_elems, &(*(window_output_elems.begin() + output_neuron_count * window_entry_id)), output_neuron_count * sizeof(float));
+
+		++entry_read_count;
+
+		return true;
+	}
+
+	unsigned int supervised_shuffled_data_reader::read_batch(
+		unsigned int entry_count,
+		void * input_elems,
+		float * output_elems)
+	{
+		unsigned int entries_to_read = std::min(entry_count, this->entry_count - entry_read_count);
+
+		unsigned char * input_dst = static_cast<unsigned char *>(input_elems);
+		for(unsigned int i = 0; i < entries_to_read; ++i)
+		{
+			read(input_dst, output_elems);
+			if (input_dst)
+				input_dst += input_entry_size;
+			if (output_elems)
+				output_elems += output_neuron_count;
+		}
+
+		return entries_to_read;
+	}
+
+	bool supervised_shuffled_data_reader::raw_read(std::vector<unsigned char>& all_elems)
+	{
+		if (entry_read_count >= entry_count)
+			return false;
+
+		all_elems.resize(input_entry_size + output_neuron_count * sizeof(float));
+		return read(&(*all_elems.begin()), reinterpret_cast<float *>(&(*(all_elems.begin() + input_entry_size))));
+	}
+
+	void supervised_shuffled_data_reader::rewind(unsigned int entry_id)
+	{
+		entry_read_count = entry_id;
+	}
+
+	void supervised_shuffled_data_reader::reset()
+	{
+		entry_read_count = 0;
+	}
+
+	void supervised_shuffled_data_reader::next_epoch()
+	{
+		original_reader->next_epoch();
+
+		epoch_seed = static_cast<unsigned int>(seed_generator());
+		prepare_epoch();
+		entry_read_count = 0;
+	}
+
+	layer_configuration_specific supervised_shuffled_data_reader::get_input_configuration() const
+	{
+		return original_reader->get_input_configuration();
+	}
+
+	layer_configuration_specific supervised_shuffled_data_reader::get_output_configuration() const
+	{
+		return original_reader->get_output_configuration();
+	}
+
+	neuron_data_type::input_type supervised_shuffled_data_reader::get_input_type() const
+	{
+		return original_reader->get_input_type();
+	}
+
+	std::vector<std::pair<float, float> > supervised_shuffled_data_reader::get_input_mul_add_list() const
+	{
+		return original_reader->get_input_mul_add_list();
+	}
+
+	unsigned int supervised_shuffled_data_reader::get_entry_count() const
+	{
+		return entry_count;
+	}
+}
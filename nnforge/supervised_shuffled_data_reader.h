@@ -0,0 +1,100 @@
+/*
+ *  Copyright 2011-2014 Maxim Milakov
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+
+#pragma once
+
+#include "supervised_data_reader.h"
+#include "rnd.h"
+
+#include <vector>
+
+namespace nnforge
+{
+	// Reads entries of the original reader in new random order each epoch, without rewriting the data.
+	// Entries are split into blocks of contiguous entries, blocks are visited in random order, window_block_count of them at a time,
+	// and entries of each window are shuffled in memory. So the original reader is read sequentially block by block.
+	// The order is reproduced on reset and changes on next_epoch, the original reader should support rewind
+	class supervised_shuffled_data_reader : public supervised_data_reader
+	{
+	public:
+		supervised_shuffled_data_reader(
+			supervised_data_reader_smart_ptr original_reader,
+			unsigned int block_entry_count,
+			unsigned int window_block_count,
+			unsigned int seed);
+
+		virtual ~supervised_shuffled_data_reader();
+
+		virtual bool read(
+			void * input_elems,
+			float * output_elems);
+
+		virtual unsigned int read_batch(
+			unsigned int entry_count,
+			void * input_elems,
+			float * output_elems);
+
+		virtual bool raw_read(std::vector<unsigned char>& all_elems);
+
+		virtual void rewind(unsigned int entry_id);
+
+		virtual void reset();
+
+		virtual void next_epoch();
+
+		virtual layer_configuration_specific get_input_configuration() const;
+
+		virtual layer_configuration_specific get_output_configuration() const;
+
+		virtual neuron_data_type::input_type get_input_type() const;
+
+		virtual std::vector<std::pair<float, float> > get_input_mul_add_list() const;
+
+		virtual unsigned int get_entry_count() const;
+
+	protected:
+		// Draws block order of the current epoch
+		void prepare_epoch();
+
+		// Returns index of the entry in the window containing entry entry_id of the current order, loads the window if it is not loaded
+		unsigned int get_window_entry_id(unsigned int entry_id);
+
+	protected:
+		supervised_data_reader_smart_ptr original_reader;
+		unsigned int block_entry_count;
+		unsigned int window_block_count;
+		size_t input_entry_size;
+		unsigned int output_neuron_count;
+		unsigned int entry_count;
+
+		random_generator seed_generator;
+		unsigned int epoch_seed;
+		std::vector<unsigned int> block_id_list;
+		std::vector<unsigned int> window_start_entry_id_list;
+
+		unsigned int loaded_window_id;
+		std::vector<unsigned char> window_input_elems;
+		std::vector<float> window_output_elems;
+		std::vector<unsigned int> window_entry_id_list;
+
+		unsigned int entry_read_count;
+
+	private:
+		supervised_shuffled_data_reader(const supervised_shuffled_data_reader&);
+		supervised_shuffled_data_reader& operator =(const supervised_shuffled_data_reader&);
+	};
+}
@@ -84,6 +84,45 @@ namespace nnforge
 		return true;
 	}
 
+	unsigned int supervised_transformed_input_data_reader::read_batch(
+		unsigned int entry_count,
+		void * input_elems,
+		float * output_elems)
+	{
+		if (transformer_sample_count > 1)
+			return supervised_data_reader::read_batch(entry_count, input_elems, output_elems);
+
+		neuron_data_type::input_type original_input_type = original_reader->get_input_type();
+		layer_configuration_specific original_input_configuration = original_reader->get_input_configuration();
+		size_t original_input_size = neuron_data_type::get_input_size(original_input_type) * original_input_configuration.get_neuron_count();
+		size_t input_size = neuron_data_type::get_input_size(transformer->get_transformed_data_type(original_input_type))
+			* transformer->get_transformed_configuration(original_input_configuration).get_neuron_count();
+
+		unsigned char * original_input = static_cast<unsigned char *>(input_elems);
+		if ((local_input_ptr != 0) && (input_elems != 0))
+		{
+			batch_input_buf.resize(original_input_size * entry_count);
+			original_input = &(*batch_input_buf.begin());
+		}
+
+		unsigned int entries_read = original_reader->read_batch(entry_count, original_input, output_elems);
+
+		if (input_elems != 0)
+		{
+			for(unsigned int i = 0; i < entries_read; ++i)
+			{
+				transformer->transform(
+					(local_input_ptr != 0) ? original_input + original_input_size * i : 0,
+					static_cast<unsigned char *>(input_elems) + input_size * i,
+					original_input_type,
+					original_input_configuration,
+					0);
+			}
+		}
+
+		return entries_read;
+	}
+
 	void supervised_transformed_input_data_reader::reset()
 	{
 		current_sample_id = 0;
@@ -118,6 +157,15 @@ namespace nnforge
 		return transformer->get_transformed_data_type(original_reader->get_input_type());
 	}
 
+	std::vector<std::pair<float, float> > supervised_transformed_input_data_reader::get_input_mul_add_list() const
+	{
+		neuron_data_type::input_type original_type = original_reader->get_input_type();
+		if (transformer->get_transformed_data_type(original_type) != original_type)
+			return std::vector<std::pair<float, float> >();
+
+		return original_reader->get_input_mul_add_list();
+	}
+
 	void supervised_transformed_input_data_reader::rewind(unsigned int entry_id)
 	{
 		throw std::runtime_error("rewind not implemented for supervised_transformed_input_data_reader");
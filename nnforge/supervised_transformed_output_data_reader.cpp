@@ -83,6 +83,43 @@ namespace nnforge
 		return true;
 	}
 
+	unsigned int supervised_transformed_output_data_reader::read_batch(
+		unsigned int entry_count,
+		void * input_elems,
+		float * output_elems)
+	{
+		if (transformer_sample_count > 1)
+			return supervised_data_reader::read_batch(entry_count, input_elems, output_elems);
+
+		layer_configuration_specific original_output_configuration = original_reader->get_output_configuration();
+		unsigned int original_output_neuron_count = original_output_configuration.get_neuron_count();
+		unsigned int output_neuron_count = transformer->get_transformed_configuration(original_output_configuration).get_neuron_count();
+
+		float * original_output = output_elems;
+		if ((local_output_ptr != 0) && (output_elems != 0))
+		{
+			batch_output_buf.resize(original_output_neuron_count * entry_count);
+			original_output = &(*batch_output_buf.begin());
+		}
+
+		unsigned int entries_read = original_reader->read_batch(entry_count, input_elems, original_output);
+
+		if (output_elems != 0)
+		{
+			for(unsigned int i = 0; i < entries_read; ++i)
+			{
+				transformer->transform(
+					(local_output_ptr != 0) ? original_output + original_output_neuron_count * i : 0,
+					output_elems + output_neuron_count * i,
+					neuron_data_type::type_float,
+					original_output_configuration,
+					0);
+			}
+		}
+
+		return entries_read;
+	}
+
 	void supervised_transformed_output_data_reader::reset()
 	{
 		current_sample_id = 0;
@@ -117,6 +154,11 @@ namespace nnforge
 		return original_reader->get_input_type();
 	}
 
+	std::vector<std::pair<float, float> > supervised_transformed_output_data_reader::get_input_mul_add_list() const
+	{
+		return original_reader->get_input_mul_add_list();
+	}
+
 	void supervised_transformed_output_data_reader::rewind(unsigned int entry_id)
 	{
 		throw std::runtime_error("rewind not implemented for supervised_transformed_output_data_reader");
@@ -38,6 +38,12 @@ namespace nnforge
 			void * input_elems,
 			float * output_elems);
 
+		// Reads the batch from the original reader at once when each original entry produces a single sample
+		virtual unsigned int read_batch(
+			unsigned int entry_count,
+			void * input_elems,
+			float * output_elems);
+
 		virtual bool raw_read(std::vector<unsigned char>& all_elems);
 
 		virtual void rewind(unsigned int entry_id);
@@ -52,6 +58,8 @@ namespace nnforge
 
 		virtual neuron_data_type::input_type get_input_type() const;
 
+		virtual std::vector<std::pair<float, float> > get_input_mul_add_list() const;
+
 		virtual unsigned int get_entry_count() const;
 
 	protected:
@@ -68,5 +76,7 @@ namespace nnforge
 		size_t input_buf_size;
 		unsigned int current_sample_id;
 		unsigned int transformer_sample_count;
+
+		std::vector<float> batch_output_buf;
 	};
 }
@@ -16,6 +16,7 @@
 
 #include "unsupervised_data_reader.h"
 #include "neural_network_exception.h"
+#include "feature_map_data_stat_accumulator.h"
 
 #include <boost/format.hpp>
 
@@ -32,101 +33,64 @@ namespace nnforge
 	{
 	}
 
+	std::vector<std::pair<float, float> > unsupervised_data_reader::get_input_mul_add_list() const
+	{
+		return std::vector<std::pair<float, float> >();
+	}
+
 	size_t unsupervised_data_reader::get_input_neuron_elem_size() const
 	{
 		return neuron_data_type::get_input_size(get_input_type());
 	}
 
-	std::vector<feature_map_data_stat> unsupervised_data_reader::get_feature_map_input_data_stat_list()
+	std::vector<feature_map_data_stat> unsupervised_data_reader::get_feature_map_input_data_stat_list(
+		unsigned int worker_count,
+		unsigned int sample_entry_count,
+		std::vector<float> * average_confidence_list)
 	{
-		std::vector<feature_map_data_stat> res;
-
 		neuron_data_type::input_type type_code = get_input_type();
 
 		if (type_code != neuron_data_type::type_float)
 			throw neural_network_exception(((boost::format("Unable to stat data reader with input data type %1%") % type_code).str()));
 
-		reset();
-
 		unsigned int entry_count = get_entry_count();
 		if (entry_count == 0)
 			throw neural_network_exception("Unable to stat data reader with no entries");
 
 		layer_configuration_specific input_configuration = get_input_configuration();
-		res.resize(input_configuration.feature_map_count);
-
-		for(std::vector<feature_map_data_stat>::iterator it = res.begin(); it != res.end(); ++it)
-		{
-			it->min = std::numeric_limits<float>::max();
-			it->max = -std::numeric_limits<float>::max();
-			it->average = 0.0F;
-			it->std_dev = 0.0F;
-		}
-
-		std::vector<float> input_data(input_configuration.get_neuron_count());
-		unsigned int neuron_count_per_feature_map = input_configuration.get_neuron_count_per_feature_map();
-
-		double mult = 1.0 / ((double)entry_count * (double)neuron_count_per_feature_map);
-
-		{
-			std::vector<double> avg(input_configuration.feature_map_count, 0.0);
-			while(read(&(*input_data.begin())))
-			{
-				std::vector<float>::const_iterator data_it = input_data.begin();
-				std::vector<double>::iterator avg_it = avg.begin();
-				for(std::vector<feature_map_data_stat>::iterator fm_it = res.begin(); fm_it != res.end(); ++fm_it, ++avg_it)
-				{
-					double current_sum = 0.0;
-					for(unsigned int i = 0; i < neuron_count_per_feature_map; ++i)
-					{
-						float val = *data_it;
-						fm_it->min = std::min(fm_it->min, val);
-						fm_it->max = std::max(fm_it->max, val);
-						current_sum += static_cast<double>(val);
-						++data_it;
-					}
-					*avg_it += current_sum;
-				}
-			}
-
-			std::vector<double>::const_iterator avg_it = avg.begin();
-			for(std::vector<feature_map_data_stat>::iterator it = res.begin(); it != res.end(); ++it, ++avg_it)
-				it->average = static_cast<float>(*avg_it * mult);
-		}
+		feature_map_data_stat_accumulator acc(input_configuration.feature_map_count, input_configuration.get_neuron_count_per_feature_map());
+		acc.add_input(*this, worker_count, sample_entry_count);
 
-		reset();
+		if (average_confidence_list)
+			*average_confidence_list = acc.get_average_confidence_list(entry_count);
 
-		{
-			std::vector<double> stddv(input_configuration.feature_map_count, 0.0);
-			while(read(&(*input_data.begin())))
-			{
-				std::vector<float>::const_iterator data_it = input_data.begin();
-				std::vector<double>::iterator stddv_it = stddv.begin();
-				for(std::vector<feature_map_data_stat>::iterator fm_it = res.begin(); fm_it != res.end(); ++fm_it, ++stddv_it)
-				{
-					double current_sum = 0.0F;
-					float average = fm_it->average;
-					for(unsigned int i = 0; i < neuron_count_per_feature_map; ++i)
-					{
-						float val = *data_it;
-						float diff = val - average;
-						current_sum += static_cast<double>(diff * diff);
-						++data_it;
-					}
-					*stddv_it += current_sum;
-				}
-			}
-
-			std::vector<double>::const_iterator stddv_it = stddv.begin();
-			for(std::vector<feature_map_data_stat>::iterator it = res.begin(); it != res.end(); ++it, ++stddv_it)
-				it->std_dev = static_cast<float>(sqrt(*stddv_it * mult));
-		}
-
-		return res;
+		return acc.get_stat_list();
 	}
 
 	void unsupervised_data_reader::next_epoch()
 	{
 		reset();
 	}
+
+	const unsigned char * unsupervised_data_reader::borrow_raw_entries(
+		unsigned int entry_id,
+		unsigned int entry_count,
+		size_t& entry_size)
+	{
+		return 0;
+	}
+
+	unsigned int unsupervised_data_reader::read_batch(
+		unsigned int entry_count,
+		void * input_elems)
+	{
+		size_t input_size = get_input_neuron_elem_size() * get_input_configuration().get_neuron_count();
+		unsigned char * input_ptr = static_cast<unsigned char *>(input_elems);
+
+		unsigned int entries_read = 0;
+		while ((entries_read < entry_count) && read(input_ptr + input_size * entries_read))
+			++entries_read;
+
+		return entries_read;
+	}
 }
@@ -35,9 +35,23 @@ namespace nnforge
 		// The method should return true in case entry is read and false if there is no more entries available (and no entry is read in this case)
 		virtual bool read(void * input_elems) = 0;
 
+		// Reads up to entry_count entries stored contiguously, returns the number of entries actually read
+		// The default implementation calls read for each entry, readers should override it when they can do it cheaper
+		virtual unsigned int read_batch(
+			unsigned int entry_count,
+			void * input_elems);
+
 		// The method should return true in case entry is read and false if there is no more entries available (and no entry is read in this case)
 		virtual bool raw_read(std::vector<unsigned char>& all_elems) = 0;
 
+		// Returns pointer to entries [entry_id, entry_id + entry_count) stored contiguously in raw_read layout, without copying them,
+		// entry_size is set to the size of a single entry. The memory stays valid while the reader exists.
+		// The default implementation returns null, meaning the reader doesn't keep entries in memory and they should be read instead
+		virtual const unsigned char * borrow_raw_entries(
+			unsigned int entry_id,
+			unsigned int entry_count,
+			size_t& entry_size);
+
 		virtual void reset() = 0;
 
 		virtual void next_epoch();
@@ -48,11 +62,21 @@ namespace nnforge
 
 		virtual neuron_data_type::input_type get_input_type() const = 0;
 
+		// Returns (mult, add) pair for each input feature map if input type is type_uint8_scaled, empty list otherwise
+		// The default implementation returns empty list
+		virtual std::vector<std::pair<float, float> > get_input_mul_add_list() const;
+
 		virtual unsigned int get_entry_count() const = 0;
 
 		size_t get_input_neuron_elem_size() const;
 
-		std::vector<feature_map_data_stat> get_feature_map_input_data_stat_list();
+		// Statistics are computed in a single pass over the data, chunks of entries are processed by worker_count threads.
+		// If sample_entry_count is non-zero and less than the entry count, statistics are computed over that many randomly chosen entries,
+		// which requires rewind, and half-widths of 95% confidence intervals for averages are written to average_confidence_list if it is not null
+		std::vector<feature_map_data_stat> get_feature_map_input_data_stat_list(
+			unsigned int worker_count = 1,
+			unsigned int sample_entry_count = 0,
+			std::vector<float> * average_confidence_list = 0);
 
 	protected:
 		unsupervised_data_reader();
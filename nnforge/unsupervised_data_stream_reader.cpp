@@ -20,6 +20,7 @@
 
 #include <boost/uuid/uuid_io.hpp>
 #include <boost/format.hpp>
+#include <algorithm>
 
 namespace nnforge
 {
@@ -73,6 +74,25 @@ namespace nnforge
 		return true;
 	}
 
+	unsigned int unsupervised_data_stream_reader::read_batch(
+		unsigned int entry_count,
+		void * input_elems)
+	{
+		unsigned int entries_to_read = std::min(entry_count, this->entry_count - entry_read_count);
+		if (entries_to_read == 0)
+			return 0;
+
+		size_t bytes_to_read = get_input_neuron_elem_size() * input_neuron_count * entries_to_read;
+		if (input_elems)
+			in_stream->read(reinterpret_cast<char*>(input_elems), bytes_to_read);
+		else
+			in_stream->seekg(bytes_to_read, std::ios_base::cur);
+
+		entry_read_count += entries_to_read;
+
+		return entries_to_read;
+	}
+
 	bool unsupervised_data_stream_reader::raw_read(std::vector<unsigned char>& all_elems)
 	{
 		if (!entry_available())
@@ -81,6 +101,8 @@ namespace nnforge
 		all_elems.resize(get_input_neuron_elem_size() * input_neuron_count);
 		in_stream->read(reinterpret_cast<char*>(&(*all_elems.begin())), get_input_neuron_elem_size() * input_neuron_count);
 
+		entry_read_count++;
+
 		return true;
 	}
 
@@ -40,6 +40,11 @@ namespace nnforge
 
 		virtual bool read(void * input_neurons);
 
+		// Entries are stored contiguously in the stream, so they are read with a single stream read
+		virtual unsigned int read_batch(
+			unsigned int entry_count,
+			void * input_elems);
+
 		virtual bool raw_read(std::vector<unsigned char>& all_elems);
 
 		virtual layer_configuration_specific get_input_configuration() const
@@ -96,6 +96,15 @@ namespace nnforge
 		return transformer->get_transformed_data_type(original_reader->get_input_type());
 	}
 
+	std::vector<std::pair<float, float> > unsupervised_transformed_input_data_reader::get_input_mul_add_list() const
+	{
+		neuron_data_type::input_type original_type = original_reader->get_input_type();
+		if (transformer->get_transformed_data_type(original_type) != original_type)
+			return std::vector<std::pair<float, float> >();
+
+		return original_reader->get_input_mul_add_list();
+	}
+
 	void unsupervised_transformed_input_data_reader::rewind(unsigned int entry_id)
 	{
 		throw std::runtime_error("rewind not implemented for unsupervised_transformed_input_data_reader");
@@ -48,6 +48,8 @@ namespace nnforge
 
 		virtual neuron_data_type::input_type get_input_type() const;
 
+		virtual std::vector<std::pair<float, float> > get_input_mul_add_list() const;
+
 		virtual unsigned int get_entry_count() const;
 
 	protected:
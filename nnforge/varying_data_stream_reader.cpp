@@ -0,0 +1,73 @@
+/*
+ *  Copyright 2011-2014 Maxim Milakov
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+
+#include "varying_data_stream_reader.h"
+
+#include "varying_data_stream_schema.h"
+#include "neural_network_exception.h"
+
+#include <boost/uuid/uuid_io.hpp>
+#include <boost/format.hpp>
+
+namespace nnforge
+{
+	varying_data_stream_reader::varying_data_stream_reader(nnforge_shared_ptr<std::istream> input_stream)
+		: in_stream(input_stream)
+	{
+		in_stream->exceptions(std::istream::eofbit | std::istream::failbit | std::istream::badbit);
+
+		boost::uuids::uuid guid_read;
+		in_stream->read(reinterpret_cast<char*>(guid_read.data), sizeof(guid_read.data));
+		if (guid_read != varying_data_stream_schema::varying_data_stream_guid)
+			throw neural_network_exception((boost::format("Unknown varying data GUID encountered in input stream: %1%") % guid_read).str());
+
+		unsigned int entry_count;
+		in_stream->read(reinterpret_cast<char*>(&entry_count), sizeof(entry_count));
+
+		entry_offsets.resize(entry_count + 1);
+		in_stream->read(reinterpret_cast<char*>(&(*entry_offsets.begin())), sizeof(unsigned long long) * entry_offsets.size());
+
+		start_pos = in_stream->tellg();
+	}
+
+	varying_data_stream_reader::~varying_data_stream_reader()
+	{
+	}
+
+	unsigned int varying_data_stream_reader::get_entry_count() const
+	{
+		return static_cast<unsigned int>(entry_offsets.size() - 1);
+	}
+
+	size_t varying_data_stream_reader::get_entry_size(unsigned int entry_id) const
+	{
+		return static_cast<size_t>(entry_offsets[entry_id + 1] - entry_offsets[entry_id]);
+	}
+
+	void varying_data_stream_reader::raw_read(
+		unsigned int entry_id,
+		std::vector<unsigned char>& all_elems)
+	{
+		if (entry_id >= get_entry_count())
+			throw neural_network_exception((boost::format("Entry %1% requested from varying data stream with %2% entries") % entry_id % get_entry_count()).str());
+
+		all_elems.resize(get_entry_size(entry_id));
+		in_stream->seekg(start_pos + static_cast<std::istream::off_type>(entry_offsets[entry_id]));
+		if (!all_elems.empty())
+			in_stream->read(reinterpret_cast<char*>(&(*all_elems.begin())), all_elems.size());
+	}
+}
@@ -0,0 +1,59 @@
+/*
+ *  Copyright 2011-2014 Maxim Milakov
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+
+#pragma once
+
+#include "nn_types.h"
+
+#include <vector>
+#include <istream>
+
+namespace nnforge
+{
+	// Reads entries of variable length written by varying_data_stream_writer,
+	// any entry is read directly using the table of entry offsets
+	class varying_data_stream_reader
+	{
+	public:
+		// The constructor modifies input_stream to throw exceptions in case of failure
+		// The stream should be created with std::ios_base::binary flag
+		varying_data_stream_reader(nnforge_shared_ptr<std::istream> input_stream);
+
+		virtual ~varying_data_stream_reader();
+
+		unsigned int get_entry_count() const;
+
+		size_t get_entry_size(unsigned int entry_id) const;
+
+		void raw_read(
+			unsigned int entry_id,
+			std::vector<unsigned char>& all_elems);
+
+	protected:
+		nnforge_shared_ptr<std::istream> in_stream;
+
+		std::istream::pos_type start_pos;
+
+		std::vector<unsigned long long> entry_offsets;
+
+	private:
+		varying_data_stream_reader(const varying_data_stream_reader&);
+		varying_data_stream_reader& operator =(const varying_data_stream_reader&);
+	};
+
+	typedef nnforge_shared_ptr<varying_data_stream_reader> varying_data_stream_reader_smart_ptr;
+}
@@ -0,0 +1,46 @@
+/*
+ *  Copyright 2011-2014 Maxim Milakov
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#pragma once
+
+#include "layer_data_list.h"
+#include "nn_types.h"
+
+namespace nnforge
+{
+	// Lets training exchange weights with other workers in the middle of an update,
+	// the updater keeps its own state, momentum included, across the exchanges
+	class weight_synchronizer
+	{
+	public:
+		virtual ~weight_synchronizer();
+
+		// Called before the first batch is processed, the method may replace the weights in data
+		virtual void update_started(layer_data_list& data) = 0;
+
+		// Called after each gradient application, the method may replace the weights in data
+		virtual void gradient_applied(layer_data_list& data) = 0;
+
+	protected:
+		weight_synchronizer();
+
+	private:
+		weight_synchronizer(const weight_synchronizer&);
+		weight_synchronizer& operator =(const weight_synchronizer&);
+	};
+
+	typedef nnforge_shared_ptr<weight_synchronizer> weight_synchronizer_smart_ptr;
+}